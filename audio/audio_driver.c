@@ -30,6 +30,11 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <queues/spsc_queue.h>
+#endif
+
 #include "audio_driver.h"
 #include "audio_thread_wrapper.h"
 #include "../gfx/video_driver.h"
@@ -40,11 +45,23 @@
 #include "../driver.h"
 #include "../configuration.h"
 #include "../retroarch.h"
+#include "../performance_counters.h"
 #include "../verbosity.h"
 #include "../list_special.h"
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Largest amount of samples the audio pipeline thread
+ * runs through the chain at once. Bigger pushes are split. */
+#define AUDIO_PIPELINE_MAX_SAMPLES      (AUDIO_CHUNK_SIZE_NONBLOCKING >> 2)
+
+/* Size of the ring between the emulation thread and the audio
+ * pipeline thread. This bounds the latency added by the
+ * pipeline to about AUDIO_CHUNK_SIZE_NONBLOCKING samples. */
+#define AUDIO_PIPELINE_QUEUE_SIZE       (AUDIO_CHUNK_SIZE_NONBLOCKING * sizeof(int16_t))
+
+#define AUDIO_PIPELINE_FLAG_SLOWMOTION  (1 << 0)
+
 /**
  * db_to_gain:
  * @db          : Decibels.
@@ -180,10 +197,49 @@ static void *audio_driver_context_audio_data             = NULL;
 
 static bool audio_suspended                              = false;
 
+#ifdef HAVE_THREADS
+typedef struct audio_pipeline_chunk
+{
+   uint32_t samples;
+   uint32_t flags;
+} audio_pipeline_chunk_t;
+
+static sthread_t *audio_pipeline_thread                  = NULL;
+/* Held by the pipeline thread while it runs the chain.
+ * Anything else touching the DSP filter, resampler, mixer
+ * or the driver while the pipeline is running takes it too. */
+static slock_t *audio_pipeline_lock                      = NULL;
+static slock_t *audio_pipeline_wait_lock                 = NULL;
+static scond_t *audio_pipeline_data_cond                 = NULL;
+static scond_t *audio_pipeline_space_cond                = NULL;
+static spsc_queue_t *audio_pipeline_queue                = NULL;
+static int16_t *audio_pipeline_input_buf                 = NULL;
+static int16_t *audio_pipeline_conv_buf                  = NULL;
+static bool audio_pipeline_alive                         = false;
+#endif
+
 static void audio_mixer_play_stop_sequential_cb(
       audio_mixer_sound_t *sound, unsigned reason);
 static void audio_mixer_play_stop_cb(
       audio_mixer_sound_t *sound, unsigned reason);
+static void audio_driver_process(const int16_t *data, size_t samples,
+      bool is_slowmotion, int16_t *conv_buf);
+
+static void audio_driver_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (audio_pipeline_lock)
+      slock_lock(audio_pipeline_lock);
+#endif
+}
+
+static void audio_driver_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (audio_pipeline_lock)
+      slock_unlock(audio_pipeline_lock);
+#endif
+}
 
 enum resampler_quality audio_driver_get_resampler_quality(void)
 {
@@ -340,6 +396,215 @@ const char *config_get_audio_driver_options(void)
    return char_list_new_special(STRING_LIST_AUDIO_DRIVERS, NULL);
 }
 
+#ifdef HAVE_THREADS
+static void audio_pipeline_signal(scond_t *cond)
+{
+   slock_lock(audio_pipeline_wait_lock);
+   scond_signal(cond);
+   slock_unlock(audio_pipeline_wait_lock);
+}
+
+/* Waits until the pipeline thread can read @size bytes.
+ * Returns false once the pipeline is being shut down. */
+static bool audio_pipeline_wait_data(size_t size)
+{
+   bool alive;
+
+   slock_lock(audio_pipeline_wait_lock);
+   while (audio_pipeline_alive
+         && spsc_read_avail(audio_pipeline_queue) < size)
+      scond_wait(audio_pipeline_data_cond, audio_pipeline_wait_lock);
+   alive = audio_pipeline_alive;
+   slock_unlock(audio_pipeline_wait_lock);
+
+   return alive;
+}
+
+/* Waits until the emulation thread can write @size bytes.
+ * audio_pipeline_alive is only ever changed by this thread. */
+static bool audio_pipeline_wait_space(size_t size)
+{
+   if (spsc_write_avail(audio_pipeline_queue) >= size)
+      return true;
+
+   slock_lock(audio_pipeline_wait_lock);
+   while (audio_pipeline_alive
+         && spsc_write_avail(audio_pipeline_queue) < size)
+      scond_wait(audio_pipeline_space_cond, audio_pipeline_wait_lock);
+   slock_unlock(audio_pipeline_wait_lock);
+
+   return audio_pipeline_alive;
+}
+
+static void audio_pipeline_thread_loop(void *data)
+{
+   audio_pipeline_chunk_t chunk;
+
+   (void)data;
+
+   for (;;)
+   {
+      size_t size;
+
+      if (!audio_pipeline_wait_data(sizeof(chunk)))
+         break;
+
+      slock_lock(audio_pipeline_lock);
+
+      spsc_read(audio_pipeline_queue, &chunk, sizeof(chunk));
+      size = chunk.samples * sizeof(int16_t);
+
+      if (!audio_pipeline_wait_data(size))
+      {
+         slock_unlock(audio_pipeline_lock);
+         break;
+      }
+
+      spsc_read(audio_pipeline_queue, audio_pipeline_input_buf, size);
+      audio_pipeline_signal(audio_pipeline_space_cond);
+
+      if (audio_driver_active)
+         audio_driver_process(audio_pipeline_input_buf, chunk.samples,
+               (chunk.flags & AUDIO_PIPELINE_FLAG_SLOWMOTION) != 0,
+               audio_pipeline_conv_buf);
+
+      slock_unlock(audio_pipeline_lock);
+   }
+}
+
+/**
+ * audio_pipeline_push:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to queue.
+ * @is_slowmotion        : whether slow motion was active.
+ *
+ * Hands samples over to the audio pipeline thread. Only blocks
+ * if the pipeline thread is more than a queue behind, which is
+ * what keeps audio sync working.
+ **/
+static void audio_pipeline_push(const int16_t *data, size_t samples,
+      bool is_slowmotion)
+{
+   audio_pipeline_chunk_t chunk;
+
+   chunk.flags = is_slowmotion ? AUDIO_PIPELINE_FLAG_SLOWMOTION : 0;
+
+   while (samples > 0)
+   {
+      size_t size;
+
+      chunk.samples = (uint32_t)MIN(samples, AUDIO_PIPELINE_MAX_SAMPLES);
+      size          = chunk.samples * sizeof(int16_t);
+
+      if (!audio_pipeline_wait_space(sizeof(chunk) + size))
+         return;
+
+      spsc_write(audio_pipeline_queue, &chunk, sizeof(chunk));
+      spsc_write(audio_pipeline_queue, data, size);
+      audio_pipeline_signal(audio_pipeline_data_cond);
+
+      data    += chunk.samples;
+      samples -= chunk.samples;
+   }
+}
+
+/* Waits until the pipeline thread has written out
+ * everything queued so far. */
+static void audio_pipeline_drain(void)
+{
+   size_t capacity = spsc_capacity(audio_pipeline_queue);
+
+   slock_lock(audio_pipeline_wait_lock);
+   while (audio_pipeline_alive
+         && spsc_write_avail(audio_pipeline_queue) < capacity)
+      scond_wait(audio_pipeline_space_cond, audio_pipeline_wait_lock);
+   slock_unlock(audio_pipeline_wait_lock);
+
+   /* The last chunk might still be running through the chain. */
+   audio_driver_lock();
+   audio_driver_unlock();
+}
+
+static void audio_pipeline_deinit(void)
+{
+   if (audio_pipeline_thread)
+   {
+      slock_lock(audio_pipeline_wait_lock);
+      audio_pipeline_alive = false;
+      scond_signal(audio_pipeline_data_cond);
+      scond_signal(audio_pipeline_space_cond);
+      slock_unlock(audio_pipeline_wait_lock);
+
+      sthread_join(audio_pipeline_thread);
+   }
+   audio_pipeline_thread     = NULL;
+   audio_pipeline_alive      = false;
+
+   if (audio_pipeline_data_cond)
+      scond_free(audio_pipeline_data_cond);
+   if (audio_pipeline_space_cond)
+      scond_free(audio_pipeline_space_cond);
+   if (audio_pipeline_wait_lock)
+      slock_free(audio_pipeline_wait_lock);
+   if (audio_pipeline_lock)
+      slock_free(audio_pipeline_lock);
+   audio_pipeline_data_cond  = NULL;
+   audio_pipeline_space_cond = NULL;
+   audio_pipeline_wait_lock  = NULL;
+   audio_pipeline_lock       = NULL;
+
+   spsc_free(audio_pipeline_queue);
+   audio_pipeline_queue      = NULL;
+
+   if (audio_pipeline_input_buf)
+      free(audio_pipeline_input_buf);
+   if (audio_pipeline_conv_buf)
+      free(audio_pipeline_conv_buf);
+   audio_pipeline_input_buf  = NULL;
+   audio_pipeline_conv_buf   = NULL;
+}
+
+static bool audio_pipeline_init(size_t outsamples_max)
+{
+   audio_pipeline_queue      = spsc_new(AUDIO_PIPELINE_QUEUE_SIZE);
+   audio_pipeline_input_buf  = (int16_t*)malloc(
+         AUDIO_PIPELINE_MAX_SAMPLES * sizeof(int16_t));
+   /* The pipeline thread converts into its own buffer, the
+    * shared one is used to batch up single samples. */
+   audio_pipeline_conv_buf   = (int16_t*)malloc(
+         outsamples_max * sizeof(int16_t));
+   audio_pipeline_wait_lock  = slock_new();
+   audio_pipeline_data_cond  = scond_new();
+   audio_pipeline_space_cond = scond_new();
+
+   if (     !audio_pipeline_queue
+         || !audio_pipeline_input_buf
+         || !audio_pipeline_conv_buf
+         || !audio_pipeline_wait_lock
+         || !audio_pipeline_data_cond
+         || !audio_pipeline_space_cond)
+      goto error;
+
+   audio_pipeline_lock       = slock_new();
+   if (!audio_pipeline_lock)
+      goto error;
+
+   audio_pipeline_alive      = true;
+   audio_pipeline_thread     = sthread_create(
+         audio_pipeline_thread_loop, NULL);
+   if (!audio_pipeline_thread)
+      goto error;
+
+   RARCH_LOG("[Audio]: Started audio pipeline thread.\n");
+
+   return true;
+
+error:
+   audio_pipeline_deinit();
+   return false;
+}
+#endif
+
 static bool audio_driver_deinit_internal(void)
 {
    settings_t *settings = config_get_ptr();
@@ -560,6 +825,18 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
 
    audio_driver_mixer_init(settings->uints.audio_out_rate);
 
+#ifdef HAVE_THREADS
+   if (
+         !audio_cb_inited
+         && audio_driver_active
+         && settings->bools.audio_pipeline_enable
+         )
+   {
+      if (!audio_pipeline_init(outsamples_max))
+         RARCH_WARN("[Audio]: Failed to start audio pipeline thread, processing audio inline.\n");
+   }
+#endif
+
    /* Threaded driver is initially stopped. */
    if (
          audio_driver_active
@@ -580,9 +857,13 @@ void audio_driver_set_nonblocking_state(bool enable)
          audio_driver_active
          && audio_driver_context_audio_data
       )
+   {
+      audio_driver_lock();
       current_audio->set_nonblock_state(
             audio_driver_context_audio_data,
             settings->bools.audio_sync ? enable : true);
+      audio_driver_unlock();
+   }
 
    audio_driver_chunk_size = enable ?
       audio_driver_chunk_nonblock_size :
@@ -590,20 +871,19 @@ void audio_driver_set_nonblocking_state(bool enable)
 }
 
 /**
- * audio_driver_flush:
+ * audio_driver_process:
  * @data                 : pointer to audio buffer.
- * @right                : amount of samples to write.
+ * @samples              : amount of samples to write.
+ * @is_slowmotion        : whether slow motion is active.
+ * @conv_buf             : buffer for the s16 output.
  *
- * Writes audio samples to audio driver. Will first
- * perform DSP processing (if enabled) and resampling.
+ * Performs DSP processing (if enabled), resampling and
+ * mixing, then writes the result to the audio driver.
  **/
-static void audio_driver_flush(const int16_t *data, size_t samples)
+static void audio_driver_process(const int16_t *data, size_t samples,
+      bool is_slowmotion, int16_t *conv_buf)
 {
    struct resampler_data src_data;
-   bool is_perfcnt_enable            = false;
-   bool is_paused                    = false;
-   bool is_idle                      = false;
-   bool is_slowmotion                = false;
    const void *output_data           = NULL;
    unsigned output_frames            = 0;
    float audio_volume_gain           = !audio_driver_mute_enable ?
@@ -612,18 +892,6 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
    src_data.data_out                 = NULL;
    src_data.output_frames            = 0;
 
-   if (recording_data)
-      recording_push_audio(data, samples);
-
-   runloop_get_status(&is_paused, &is_idle, &is_slowmotion,
-         &is_perfcnt_enable);
-
-   if (            is_paused                ||
-		   !audio_driver_active     ||
-		   !audio_driver_input_data ||
-		   !audio_driver_output_samples_buf)
-      return;
-
    convert_s16_to_float(audio_driver_input_data, data, samples,
          audio_volume_gain);
 
@@ -710,10 +978,10 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
       output_frames  *= sizeof(float);
    else
    {
-      convert_float_to_s16(audio_driver_output_samples_conv_buf,
+      convert_float_to_s16(conv_buf,
             (const float*)output_data, output_frames * 2);
 
-      output_data     = audio_driver_output_samples_conv_buf;
+      output_data     = conv_buf;
       output_frames  *= sizeof(int16_t);
    }
 
@@ -722,6 +990,48 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
       audio_driver_active = false;
 }
 
+/**
+ * audio_driver_flush:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to write.
+ *
+ * Writes audio samples to audio driver, or hands them
+ * over to the audio pipeline thread if it is running.
+ **/
+static void audio_driver_flush(const int16_t *data, size_t samples)
+{
+   static struct retro_perf_counter audio_perf_flush;
+   bool is_perfcnt_enable            = false;
+   bool is_paused                    = false;
+   bool is_idle                      = false;
+   bool is_slowmotion                = false;
+
+   if (recording_data)
+      recording_push_audio(data, samples);
+
+   runloop_get_status(&is_paused, &is_idle, &is_slowmotion,
+         &is_perfcnt_enable);
+
+   if (            is_paused                ||
+		   !audio_driver_active     ||
+		   !audio_driver_input_data ||
+		   !audio_driver_output_samples_buf)
+      return;
+
+   performance_counter_init(audio_perf_flush, "audio_driver_flush");
+   performance_counter_start_plus(is_perfcnt_enable, audio_perf_flush);
+
+#ifdef HAVE_THREADS
+   if (audio_pipeline_thread)
+      audio_pipeline_push(data, samples, is_slowmotion);
+   else
+#endif
+      audio_driver_process(data, samples, is_slowmotion,
+            audio_driver_output_samples_conv_buf);
+
+   performance_counter_stop_plus(is_perfcnt_enable, audio_perf_flush);
+}
+
 /**
  * audio_driver_sample:
  * @left                 : value of the left audio channel.
@@ -832,13 +1142,16 @@ size_t audio_driver_sample_batch_rewind(const int16_t *data, size_t frames)
 
 void audio_driver_dsp_filter_free(void)
 {
+   audio_driver_lock();
    if (audio_driver_dsp)
       retro_dsp_filter_free(audio_driver_dsp);
    audio_driver_dsp = NULL;
+   audio_driver_unlock();
 }
 
 void audio_driver_dsp_filter_init(const char *device)
 {
+   retro_dsp_filter_t *dsp       = NULL;
    struct string_list *plugs     = NULL;
 #if defined(HAVE_DYLIB) && !defined(HAVE_FILTERS_BUILTIN)
    char *basedir   = (char*)calloc(PATH_MAX_LENGTH, sizeof(*basedir));
@@ -853,11 +1166,14 @@ void audio_driver_dsp_filter_init(const char *device)
    if (!plugs)
       goto error;
 #endif
-   audio_driver_dsp = retro_dsp_filter_new(
-         device, plugs, audio_driver_input);
-   if (!audio_driver_dsp)
+   dsp = retro_dsp_filter_new(device, plugs, audio_driver_input);
+   if (!dsp)
       goto error;
 
+   audio_driver_lock();
+   audio_driver_dsp = dsp;
+   audio_driver_unlock();
+
 #if defined(HAVE_DYLIB) && !defined(HAVE_FILTERS_BUILTIN)
    free(basedir);
    free(ext_name);
@@ -962,10 +1278,12 @@ bool audio_driver_find_driver(void)
 
 void audio_driver_deinit_resampler(void)
 {
+   audio_driver_lock();
    if (audio_driver_resampler && audio_driver_resampler_data)
       audio_driver_resampler->free(audio_driver_resampler_data);
    audio_driver_resampler      = NULL;
    audio_driver_resampler_data = NULL;
+   audio_driver_unlock();
 }
 
 bool audio_driver_free_devices_list(void)
@@ -1091,6 +1409,8 @@ static void audio_mixer_play_stop_cb(
    }
 }
 
+static void audio_driver_mixer_play_stream_internal(unsigned i, unsigned type);
+
 static void audio_mixer_play_stop_sequential_cb(
       audio_mixer_sound_t *sound, unsigned reason)
 {
@@ -1122,7 +1442,10 @@ static void audio_mixer_play_stop_sequential_cb(
             {
                if (audio_mixer_streams[i].state == AUDIO_STREAM_STATE_STOPPED)
                {
-                  audio_driver_mixer_play_stream_sequential(i);
+                  /* Called from within the mixer, the lock
+                   * is already held. */
+                  audio_driver_mixer_play_stream_internal(i,
+                        AUDIO_STREAM_STATE_PLAYING_SEQUENTIAL);
                   break;
                }
             }
@@ -1165,36 +1488,43 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    if (params->state == AUDIO_STREAM_STATE_NONE)
       return false;
 
-   buf = malloc(params->bufsize);
+   /* Compressed tracks are decoded from the file while they play. */
+   if (params->path)
+      handle = audio_mixer_load_file(params->path, params->type);
 
-   if (!buf)
-      return false;
+   if (!handle && params->buf)
+   {
+      buf = malloc(params->bufsize);
 
-   memcpy(buf, params->buf, params->bufsize);
+      if (!buf)
+         return false;
 
-   switch (params->type)
-   {
-      case AUDIO_MIXER_TYPE_WAV:
-         handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_OGG:
-         handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_MOD:
-         handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
-         break;
-      case AUDIO_MIXER_TYPE_FLAC:
+      memcpy(buf, params->buf, params->bufsize);
+
+      switch (params->type)
+      {
+         case AUDIO_MIXER_TYPE_WAV:
+            handle = audio_mixer_load_wav(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_OGG:
+            handle = audio_mixer_load_ogg(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_MOD:
+            handle = audio_mixer_load_mod(buf, (int32_t)params->bufsize);
+            break;
+         case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-         handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_flac(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_MP3:
+            break;
+         case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-         handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
+            handle = audio_mixer_load_mp3(buf, (int32_t)params->bufsize);
 #endif
-         break;
-      case AUDIO_MIXER_TYPE_NONE:
-         break;
+            break;
+         case AUDIO_MIXER_TYPE_NONE:
+            break;
+      }
    }
 
    if (!handle)
@@ -1203,6 +1533,8 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
       return false;
    }
 
+   audio_driver_lock();
+
    switch (params->state)
    {
       case AUDIO_STREAM_STATE_PLAYING_LOOPED:
@@ -1230,6 +1562,8 @@ bool audio_driver_mixer_add_stream(audio_mixer_stream_params_t *params)
    audio_mixer_streams[free_slot].volume  = params->volume;
    audio_mixer_streams[free_slot].stop_cb = stop_cb;
 
+   audio_driver_unlock();
+
    return true;
 }
 
@@ -1269,20 +1603,26 @@ static void audio_driver_mixer_play_stream_internal(unsigned i, unsigned type)
 
 void audio_driver_mixer_play_stream(unsigned i)
 {
+   audio_driver_lock();
    audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_cb;
    audio_driver_mixer_play_stream_internal(i, AUDIO_STREAM_STATE_PLAYING);
+   audio_driver_unlock();
 }
 
 void audio_driver_mixer_play_stream_looped(unsigned i)
 {
+   audio_driver_lock();
    audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_cb;
    audio_driver_mixer_play_stream_internal(i, AUDIO_STREAM_STATE_PLAYING_LOOPED);
+   audio_driver_unlock();
 }
 
 void audio_driver_mixer_play_stream_sequential(unsigned i)
 {
+   audio_driver_lock();
    audio_mixer_streams[i].stop_cb = audio_mixer_play_stop_sequential_cb;
    audio_driver_mixer_play_stream_internal(i, AUDIO_STREAM_STATE_PLAYING_SEQUENTIAL);
+   audio_driver_unlock();
 }
 
 float audio_driver_mixer_get_stream_volume(unsigned i)
@@ -1302,13 +1642,17 @@ void audio_driver_mixer_set_stream_volume(unsigned i, float vol)
 
    audio_mixer_streams[i].volume  = vol;
 
+   audio_driver_lock();
+
    voice                          = audio_mixer_streams[i].voice;
 
    if (voice)
       audio_mixer_voice_set_volume(voice, db_to_gain(vol));
+
+   audio_driver_unlock();
 }
 
-void audio_driver_mixer_stop_stream(unsigned i)
+static void audio_driver_mixer_stop_stream_internal(unsigned i)
 {
    bool set_state              = false;
 
@@ -1338,7 +1682,14 @@ void audio_driver_mixer_stop_stream(unsigned i)
    }
 }
 
-void audio_driver_mixer_remove_stream(unsigned i)
+void audio_driver_mixer_stop_stream(unsigned i)
+{
+   audio_driver_lock();
+   audio_driver_mixer_stop_stream_internal(i);
+   audio_driver_unlock();
+}
+
+static void audio_driver_mixer_remove_stream_internal(unsigned i)
 {
    bool destroy                = false;
 
@@ -1350,7 +1701,7 @@ void audio_driver_mixer_remove_stream(unsigned i)
       case AUDIO_STREAM_STATE_PLAYING:
       case AUDIO_STREAM_STATE_PLAYING_LOOPED:
       case AUDIO_STREAM_STATE_PLAYING_SEQUENTIAL:
-         audio_driver_mixer_stop_stream(i);
+         audio_driver_mixer_stop_stream_internal(i);
          destroy = true;
          break;
       case AUDIO_STREAM_STATE_STOPPED:
@@ -1378,6 +1729,13 @@ void audio_driver_mixer_remove_stream(unsigned i)
    }
 }
 
+void audio_driver_mixer_remove_stream(unsigned i)
+{
+   audio_driver_lock();
+   audio_driver_mixer_remove_stream_internal(i);
+   audio_driver_unlock();
+}
+
 static void audio_driver_mixer_deinit(void)
 {
    unsigned i;
@@ -1395,6 +1753,9 @@ static void audio_driver_mixer_deinit(void)
 
 bool audio_driver_deinit(void)
 {
+#ifdef HAVE_THREADS
+   audio_pipeline_deinit();
+#endif
    audio_driver_mixer_deinit();
    audio_driver_free_devices_list();
    if (!audio_driver_deinit_internal())
@@ -1438,8 +1799,10 @@ void audio_driver_monitor_set_rate(void)
    double new_src_ratio = (double)settings->uints.audio_out_rate /
       audio_driver_input;
 
+   audio_driver_lock();
    audio_source_ratio_original = new_src_ratio;
    audio_source_ratio_current  = new_src_ratio;
+   audio_driver_unlock();
 }
 
 bool audio_driver_callback(void)
@@ -1483,10 +1846,17 @@ static INLINE bool audio_driver_alive(void)
 
 bool audio_driver_start(bool is_shutdown)
 {
+   bool ret = false;
+
    if (!current_audio || !current_audio->start
          || !audio_driver_context_audio_data)
       goto error;
-   if (!current_audio->start(audio_driver_context_audio_data, is_shutdown))
+
+   audio_driver_lock();
+   ret = current_audio->start(audio_driver_context_audio_data, is_shutdown);
+   audio_driver_unlock();
+
+   if (!ret)
       goto error;
 
    return true;
@@ -1501,12 +1871,26 @@ error:
 
 bool audio_driver_stop(void)
 {
+   bool ret = false;
+
    if (!current_audio || !current_audio->stop
          || !audio_driver_context_audio_data)
       return false;
    if (!audio_driver_alive())
       return false;
-   return current_audio->stop(audio_driver_context_audio_data);
+
+#ifdef HAVE_THREADS
+   /* Don't leave queued audio behind to be
+    * written to a stopped driver. */
+   if (audio_pipeline_thread)
+      audio_pipeline_drain();
+#endif
+
+   audio_driver_lock();
+   ret = current_audio->stop(audio_driver_context_audio_data);
+   audio_driver_unlock();
+
+   return ret;
 }
 
 void audio_driver_unset_callback(void)
@@ -167,6 +167,9 @@ typedef struct audio_mixer_stream_params
    enum audio_mixer_state state;
    void *buf;
    char *basename;
+   /* If set, OGG/FLAC/MP3 streams are decoded from
+    * this file while they play and buf can be NULL. */
+   char *path;
    size_t bufsize;
    audio_mixer_stop_cb_t cb;
 } audio_mixer_stream_params_t;
@@ -121,9 +121,16 @@ const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, in
 }
 
 const uint8_t* cheevos_patch_address(unsigned address, int console)
+{
+   return cheevos_patch_address_size(address, console, NULL);
+}
+
+const uint8_t* cheevos_patch_address_size(unsigned address, int console,
+      size_t* size)
 {
    rarch_system_info_t* system = runloop_get_system_info();
    const void* pointer = NULL;
+   size_t bank_size    = 0;
 
    if (console == RC_CONSOLE_NINTENDO)
    {
@@ -197,7 +204,8 @@ const uint8_t* cheevos_patch_address(unsigned address, int console)
          {
             unsigned addr = address;
             pointer       = desc->core.ptr;
-            
+            bank_size     = desc->core.offset + desc->core.len;
+
             address       = (unsigned)cheevos_var_reduce(
                (addr - desc->core.start) & desc->disconnect_mask,
                desc->core.disconnect);
@@ -240,7 +248,8 @@ const uint8_t* cheevos_patch_address(unsigned address, int console)
 
          if (address < meminfo.size)
          {
-            pointer = meminfo.data;
+            pointer   = meminfo.data;
+            bank_size = meminfo.size;
             break;
          }
 
@@ -260,5 +269,8 @@ const uint8_t* cheevos_patch_address(unsigned address, int console)
       return NULL;
    }
 
+   if (size)
+      *size = address < bank_size ? bank_size - address : 0;
+
    return (const uint8_t*)pointer + address;
 }
@@ -16,6 +16,7 @@
 #ifndef __RARCH_CHEEVOS_FIXUP_H
 #define __RARCH_CHEEVOS_FIXUP_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <boolean.h>
 
@@ -43,6 +44,11 @@ const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, in
 
 const uint8_t* cheevos_patch_address(unsigned address, int console);
 
+/* Same as cheevos_patch_address, also returns in @size how many
+ * bytes of the memory bank can be read from the returned pointer. */
+const uint8_t* cheevos_patch_address_size(unsigned address, int console,
+      size_t* size);
+
 RETRO_END_DECLS
 
 #endif
@@ -46,6 +46,7 @@
 #include "cheevos.h"
 #include "var.h"
 #include "cond.h"
+#include "program.h"
 
 #include "../file_path_special.h"
 #include "../paths.h"
@@ -110,18 +111,6 @@
 #define CHEEVOS_JSON_KEY_SUCCESS      0x110461deU
 #define CHEEVOS_JSON_KEY_ERROR        0x0d2011cfU
 
-typedef struct
-{
-   cheevos_cond_t *conds;
-   unsigned        count;
-} cheevos_condset_t;
-
-typedef struct
-{
-   cheevos_condset_t *condsets;
-   unsigned count;
-} cheevos_condition_t;
-
 typedef struct
 {
    unsigned    id;
@@ -134,6 +123,7 @@ typedef struct
    int         active;
    int         last;
    int         modified;
+   int         trigger;
 
    cheevos_condition_t condition;
 } cheevo_t;
@@ -195,20 +185,6 @@ typedef struct
    const uint32_t *ext_hashes;
 } cheevos_finder_t;
 
-typedef struct
-{
-   cheevos_var_t var;
-   double        multiplier;
-   bool          compare_next;
-} cheevos_term_t;
-
-typedef struct
-{
-   cheevos_term_t *terms;
-   unsigned        count;
-   unsigned        compare_count;
-} cheevos_expr_t;
-
 typedef struct
 {
    unsigned    id;
@@ -222,6 +198,11 @@ typedef struct
    cheevos_condition_t cancel;
    cheevos_condition_t submit;
    cheevos_expr_t      value;
+
+   int start_trigger;
+   int cancel_trigger;
+   int submit_trigger;
+   int value_expr;
 } cheevos_leaderboard_t;
 
 typedef struct
@@ -234,8 +215,8 @@ typedef struct
    cheevos_console_t console_id;
    bool core_supports;
    bool addrs_patched;
-   int  add_buffer;
-   int  add_hits;
+   cheevos_program_t *program;
+   uint64_t eval_usec;
 
    cheevoset_t core;
    cheevoset_t unofficial;
@@ -267,8 +248,8 @@ static cheevos_locals_t cheevos_locals =
    /* console_id          */ CHEEVOS_CONSOLE_NONE,
    /* core_supports       */ true,
    /* addrs_patched       */ false,
-   /* add_buffer          */ 0,
-   /* add_hits            */ 0,
+   /* program             */ NULL,
+   /* eval_usec           */ 0,
 
    /* core                */ {NULL, 0},
    /* unofficial          */ {NULL, 0},
@@ -1257,278 +1238,6 @@ error:
 Test all the achievements (call once per frame).
 *****************************************************************************/
 
-static int cheevos_test_condition(cheevos_cond_t *cond)
-{
-   unsigned sval = 0;
-   unsigned tval = 0;
-
-   if (!cond)
-      return 0;
-
-   sval          = cheevos_var_get_value(&cond->source) +
-                   cheevos_locals.add_buffer;
-   tval          = cheevos_var_get_value(&cond->target);
-
-   switch (cond->op)
-   {
-      case CHEEVOS_COND_OP_EQUALS:
-         return (sval == tval);
-      case CHEEVOS_COND_OP_LESS_THAN:
-         return (sval < tval);
-      case CHEEVOS_COND_OP_LESS_THAN_OR_EQUAL:
-         return (sval <= tval);
-      case CHEEVOS_COND_OP_GREATER_THAN:
-         return (sval > tval);
-      case CHEEVOS_COND_OP_GREATER_THAN_OR_EQUAL:
-         return (sval >= tval);
-      case CHEEVOS_COND_OP_NOT_EQUAL_TO:
-         return (sval != tval);
-      default:
-         break;
-   }
-
-   return 1;
-}
-
-static int cheevos_test_pause_cond_set(const cheevos_condset_t *condset,
-      int *dirty_conds, int *reset_conds, int process_pause)
-{
-   int cond_valid            = 0;
-   int set_valid             = 1; /* must start true so AND logic works */
-   cheevos_cond_t *cond      = NULL;
-   const cheevos_cond_t *end = condset->conds + condset->count;
-
-   cheevos_locals.add_buffer = 0;
-   cheevos_locals.add_hits   = 0;
-
-   for (cond = condset->conds; cond < end; cond++)
-   {
-      if (cond->pause != process_pause)
-         continue;
-
-      if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE)
-      {
-         cheevos_locals.add_buffer += cheevos_var_get_value(&cond->source);
-         continue;
-      }
-
-      if (cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE)
-      {
-         cheevos_locals.add_buffer -= cheevos_var_get_value(&cond->source);
-         continue;
-      }
-
-      if (cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
-      {
-         if (cheevos_test_condition(cond))
-         {
-            cond->curr_hits++;
-            *dirty_conds = 1;
-         }
-
-         cheevos_locals.add_hits += cond->curr_hits;
-         continue;
-      }
-
-      /* always evaluate the condition to ensure delta values get tracked correctly */
-      cond_valid = cheevos_test_condition(cond);
-
-      /* if the condition has a target hit count that has already been met,
-       * it's automatically true, even if not currently true. */
-      if (  (cond->req_hits != 0) &&
-            (cond->curr_hits + cheevos_locals.add_hits) >= cond->req_hits)
-      {
-            cond_valid = 1;
-      }
-      else if (cond_valid)
-      {
-         cond->curr_hits++;
-         *dirty_conds = 1;
-
-         /* Process this logic, if this condition is true: */
-         if (cond->req_hits == 0)
-            ; /* Not a hit-based requirement: ignore any additional logic! */
-         else if ((cond->curr_hits + cheevos_locals.add_hits) < cond->req_hits)
-            cond_valid = 0; /* HitCount target has not yet been met, condition is not yet valid. */
-      }
-
-      cheevos_locals.add_buffer = 0;
-      cheevos_locals.add_hits   = 0;
-
-      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
-      {
-         /* as soon as we find a PauseIf that evaluates to true,
-          * stop processing the rest of the group. */
-         if (cond_valid)
-            return 1;
-
-         /* if we make it to the end of the function, make sure we are
-          * indicating nothing matched. if we do find a later PauseIf match,
-          * it'll automatically return true via the previous condition. */
-         set_valid = 0;
-
-         if (cond->req_hits == 0)
-         {
-            /* PauseIf didn't evaluate true, and doesn't have a HitCount,
-             * reset the HitCount to indicate the condition didn't match. */
-            if (cond->curr_hits != 0)
-            {
-               cond->curr_hits = 0;
-               *dirty_conds = 1;
-            }
-         }
-         else
-         {
-            /* PauseIf has a HitCount that hasn't been met, ignore it for now. */
-         }
-      }
-      else if (cond->type == CHEEVOS_COND_TYPE_RESET_IF)
-      {
-         if (cond_valid)
-         {
-            *reset_conds = 1; /* Resets all hits found so far */
-            set_valid    = 0; /* Cannot be valid if we've hit a reset condition. */
-         }
-      }
-      else /* Sequential or non-sequential? */
-         set_valid &= cond_valid;
-   }
-
-   return set_valid;
-}
-
-static int cheevos_test_cond_set(const cheevos_condset_t *condset,
-      int *dirty_conds, int *reset_conds)
-{
-   int in_pause              = 0;
-   int has_pause             = 0;
-   cheevos_cond_t *cond      = NULL;
-
-   if (!condset)
-      return 1; /* important: empty group must evaluate true */
-
-   /* the ints below are used for Pause conditions and their dependent AddSource/AddHits. */
-
-   /* this loop needs to go backwards to check AddSource/AddHits */
-   cond = condset->conds + condset->count - 1;
-   for (; cond >= condset->conds; cond--)
-   {
-      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
-      {
-         has_pause = 1;
-         in_pause = 1;
-         cond->pause = 1;
-      }
-      else if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE ||
-               cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE ||
-               cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
-      {
-         cond->pause = in_pause;
-      }
-      else
-      {
-         in_pause = 0;
-         cond->pause = 0;
-      }
-   }
-
-   if (has_pause)
-   {  /* one or more Pause conditions exists, if any of them are true,
-       * stop processing this group. */
-      if (cheevos_test_pause_cond_set(condset, dirty_conds, reset_conds, 1))
-         return 0;
-   }
-
-   /* process the non-Pause conditions to see if the group is true */
-   return cheevos_test_pause_cond_set(condset, dirty_conds, reset_conds, 0);
-}
-
-static int cheevos_reset_cond_set(cheevos_condset_t *condset, int deltas)
-{
-   int dirty                 = 0;
-   const cheevos_cond_t *end = NULL;
-
-   if (!condset)
-      return 0;
-
-   end                       = condset->conds + condset->count;
-
-   if (deltas)
-   {
-      cheevos_cond_t *cond      = NULL;
-      for (cond = condset->conds; cond < end; cond++)
-      {
-         dirty                 |= cond->curr_hits != 0;
-
-         cond->curr_hits        = 0;
-
-         cond->source.previous  = cond->source.value;
-         cond->target.previous  = cond->target.value;
-      }
-   }
-   else
-   {
-      cheevos_cond_t *cond      = NULL;
-      for (cond = condset->conds; cond < end; cond++)
-      {
-         dirty           |= cond->curr_hits != 0;
-         cond->curr_hits  = 0;
-      }
-   }
-
-   return dirty;
-}
-
-static int cheevos_test_cheevo(cheevo_t *cheevo)
-{
-   int dirty_conds              = 0;
-   int reset_conds              = 0;
-   int ret_val                  = 0;
-   int ret_val_sub_cond         = 0;
-   cheevos_condset_t *condset   = NULL;
-   cheevos_condset_t *end       = NULL;
-
-   if (!cheevo)
-      return 0;
-
-   ret_val_sub_cond             = cheevo->condition.count == 1;
-   condset                      = cheevo->condition.condsets;
-
-   if (!condset)
-      return 0;
-
-   end                          = condset + cheevo->condition.count;
-
-   if (condset < end)
-   {
-      ret_val = cheevos_test_cond_set(condset, &dirty_conds, &reset_conds);
-      condset++;
-   }
-
-   while (condset < end)
-   {
-      ret_val_sub_cond |= cheevos_test_cond_set(
-            condset, &dirty_conds, &reset_conds);
-      condset++;
-   }
-
-   if (dirty_conds)
-      cheevo->dirty |= CHEEVOS_DIRTY_CONDITIONS;
-
-   if (reset_conds)
-   {
-      int dirty = 0;
-
-      for (condset = cheevo->condition.condsets; condset < end; condset++)
-         dirty |= cheevos_reset_cond_set(condset, 0);
-
-      if (dirty)
-         cheevo->dirty |= CHEEVOS_DIRTY_CONDITIONS;
-   }
-
-   return (ret_val && ret_val_sub_cond);
-}
-
 static void cheevos_url_encode(const char *str, char *encoded, size_t len)
 {
    if (!str)
@@ -1629,17 +1338,15 @@ static void cheevos_test_cheevo_set(const cheevoset_t *set)
    {
       if (cheevo->active & mode)
       {
-         int valid = cheevos_test_cheevo(cheevo);
+         int dirty = 0;
+         int valid = cheevos_program_test(cheevos_locals.program,
+               cheevo->trigger, &dirty);
 
-         if (cheevo->last)
-         {
-            cheevos_condset_t* condset   = cheevo->condition.condsets;
-            const cheevos_condset_t* end = cheevo->condition.condsets
-               + cheevo->condition.count;
+         if (dirty)
+            cheevo->dirty |= CHEEVOS_DIRTY_CONDITIONS;
 
-            for (; condset < end; condset++)
-               cheevos_reset_cond_set(condset, 0);
-         }
+         if (cheevo->last)
+            cheevos_program_reset(cheevos_locals.program, cheevo->trigger);
          else if (valid)
          {
             char msg[256];
@@ -1687,98 +1394,6 @@ static void cheevos_test_cheevo_set(const cheevoset_t *set)
    }
 }
 
-static int cheevos_test_lboard_condition(const cheevos_condition_t* condition)
-{
-   int dirty_conds              = 0;
-   int reset_conds              = 0;
-   int ret_val                  = 0;
-   int ret_val_sub_cond         = 0;
-   cheevos_condset_t *condset   = NULL;
-   const cheevos_condset_t *end = NULL;
-
-   if (!condition)
-      return 0;
-
-   ret_val_sub_cond             = condition->count == 1;
-   condset                      = condition->condsets;
-   end                          = condset + condition->count;
-
-   if (condset < end)
-   {
-      ret_val = cheevos_test_cond_set(
-            condset, &dirty_conds, &reset_conds);
-      condset++;
-   }
-
-   while (condset < end)
-   {
-      ret_val_sub_cond |= cheevos_test_cond_set(
-            condset, &dirty_conds, &reset_conds);
-      condset++;
-   }
-
-   if (reset_conds)
-   {
-      for (condset = condition->condsets; condset < end; condset++)
-         cheevos_reset_cond_set(condset, 0);
-   }
-
-   return (ret_val && ret_val_sub_cond);
-}
-
-static int cheevos_expr_value(cheevos_expr_t* expr)
-{
-   unsigned i;
-   int values[16];
-   /* Separate possible values with '$' operator, submit the largest */
-   unsigned current_value = 0;
-   cheevos_term_t* term   = NULL;
-
-   if (!expr)
-      return 0;
-
-   term                   = expr->terms;
-
-   if (!term)
-      return 0;
-
-   if (expr->compare_count >=  ARRAY_SIZE(values))
-   {
-      CHEEVOS_ERR("[CHEEVOS]: too many values in the leaderboard expression: %u\n", expr->compare_count);
-      return 0;
-   }
-
-   memset(values, 0, sizeof values);
-
-   for (i = expr->count; i != 0; i--, term++)
-   {
-      if (current_value >= ARRAY_SIZE(values))
-      {
-         CHEEVOS_ERR("[CHEEVOS]: too many values in the leaderboard expression: %u\n", current_value);
-         return 0;
-      }
-
-      values[current_value] +=
-         cheevos_var_get_value(&term->var) * term->multiplier;
-
-      if (term->compare_next)
-         current_value++;
-   }
-
-   if (expr->compare_count > 1)
-   {
-      unsigned j;
-      int maximum = values[0];
-
-      for (j = 1; j < expr->compare_count; j++)
-         maximum = values[j] > maximum ? values[j] : maximum;
-
-      return maximum;
-   }
-   else
-      return values[0];
-}
-
 static void cheevos_make_lboard_url(const cheevos_leaderboard_t *lboard,
       char* url, size_t url_size)
 {
@@ -1847,7 +1462,8 @@ static void cheevos_test_leaderboards(void)
    {
       if (lboard->active)
       {
-         int value = cheevos_expr_value(&lboard->value);
+         int value = cheevos_program_value(cheevos_locals.program,
+               lboard->value_expr);
 
          if (value != lboard->last_value)
          {
@@ -1856,7 +1472,8 @@ static void cheevos_test_leaderboards(void)
             lboard->last_value = value;
          }
 
-         if (cheevos_test_lboard_condition(&lboard->submit))
+         if (cheevos_program_test(cheevos_locals.program,
+                  lboard->submit_trigger, NULL))
          {
             lboard->active = 0;
 
@@ -1888,7 +1505,8 @@ static void cheevos_test_leaderboards(void)
             }
          }
 
-         if (cheevos_test_lboard_condition(&lboard->cancel))
+         if (cheevos_program_test(cheevos_locals.program,
+                  lboard->cancel_trigger, NULL))
          {
             CHEEVOS_LOG("[CHEEVOS]: cancel lboard %s\n", lboard->title);
             lboard->active = 0;
@@ -1898,7 +1516,8 @@ static void cheevos_test_leaderboards(void)
       }
       else
       {
-         if (cheevos_test_lboard_condition(&lboard->start))
+         if (cheevos_program_test(cheevos_locals.program,
+                  lboard->start_trigger, NULL))
          {
             char msg[256];
 
@@ -2252,6 +1871,11 @@ bool cheevos_unload(void)
    cheevos_locals.core.count         = 0;
    cheevos_locals.unofficial.count   = 0;
 
+   cheevos_program_free(cheevos_locals.program);
+   cheevos_locals.program            = NULL;
+   cheevos_locals.addrs_patched      = false;
+   cheevos_locals.eval_usec          = 0;
+
    cheevos_loaded     = false;
    cheevos_hardcore_paused = false;
 
@@ -2446,8 +2070,92 @@ static void cheevos_patch_lbs(cheevos_leaderboard_t *leaderboard)
    }
 }
 
+static bool cheevos_compile_set(cheevos_program_t *program,
+      cheevoset_t *set)
+{
+   unsigned i;
+
+   for (i = 0; i < set->count; i++)
+   {
+      cheevo_t *cheevo = set->cheevos + i;
+
+      cheevo->trigger  = cheevos_program_add_condition(program,
+            &cheevo->condition);
+
+      if (cheevo->trigger < 0)
+         return false;
+   }
+
+   return true;
+}
+
+static bool cheevos_compile_lbs(cheevos_program_t *program)
+{
+   unsigned i;
+
+   for (i = 0; i < cheevos_locals.lboard_count; i++)
+   {
+      cheevos_leaderboard_t *lboard = cheevos_locals.leaderboards + i;
+
+      lboard->start_trigger  = cheevos_program_add_condition(program,
+            &lboard->start);
+      lboard->cancel_trigger = cheevos_program_add_condition(program,
+            &lboard->cancel);
+      lboard->submit_trigger = cheevos_program_add_condition(program,
+            &lboard->submit);
+      lboard->value_expr     = cheevos_program_add_expr(program,
+            &lboard->value);
+
+      if (  lboard->start_trigger  < 0 || lboard->cancel_trigger < 0 ||
+            lboard->submit_trigger < 0 || lboard->value_expr     < 0)
+         return false;
+   }
+
+   return true;
+}
+
+/* Compiles the conditions of all achievements and leaderboards, the
+ * addresses must already be patched. */
+static void cheevos_compile(void)
+{
+   cheevos_eval_stats_t stats;
+   cheevos_program_t *program = cheevos_program_new();
+
+   cheevos_program_free(cheevos_locals.program);
+   cheevos_locals.program = NULL;
+
+   if (!program)
+      return;
+
+   if (  !cheevos_compile_set(program, &cheevos_locals.core) ||
+         !cheevos_compile_set(program, &cheevos_locals.unofficial) ||
+         (cheevos_locals.leaderboards && !cheevos_compile_lbs(program)))
+   {
+      CHEEVOS_ERR("[CHEEVOS]: out of memory compiling the conditions\n");
+      cheevos_program_free(program);
+      return;
+   }
+
+   cheevos_program_get_stats(program, &stats);
+   CHEEVOS_LOG("[CHEEVOS]: compiled %u instructions reading %u addresses\n",
+         stats.instructions, stats.addresses);
+
+   cheevos_locals.program = program;
+}
+
+void cheevos_get_eval_stats(cheevos_eval_stats_t *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+
+   if (cheevos_locals.program)
+      cheevos_program_get_stats(cheevos_locals.program, stats);
+
+   stats->usec = cheevos_locals.eval_usec;
+}
+
 void cheevos_test(void)
 {
+   retro_time_t start;
    settings_t *settings = config_get_ptr();
 
    if (!cheevos_locals.addrs_patched)
@@ -2455,10 +2163,18 @@ void cheevos_test(void)
       cheevos_patch_addresses(&cheevos_locals.core);
       cheevos_patch_addresses(&cheevos_locals.unofficial);
       cheevos_patch_lbs(cheevos_locals.leaderboards);
+      cheevos_compile();
 
       cheevos_locals.addrs_patched = true;
    }
 
+   if (!cheevos_locals.program)
+      return;
+
+   start = cpu_features_get_time_usec();
+
+   /* Every address is read once, all conditions use this snapshot. */
+   cheevos_program_snapshot(cheevos_locals.program);
    cheevos_test_cheevo_set(&cheevos_locals.core);
 
    if (settings)
@@ -2471,6 +2187,8 @@ void cheevos_test(void)
           !cheevos_hardcore_paused)
          cheevos_test_leaderboards();
    }
+
+   cheevos_locals.eval_usec = cpu_features_get_time_usec() - start;
 }
 
 bool cheevos_set_cheats(void)
@@ -133,6 +133,16 @@ enum
    CHEEVOS_FORMAT_OTHER
 };
 
+typedef struct cheevos_eval_stats
+{
+   /* Size of the compiled conditions. */
+   unsigned instructions;
+   unsigned addresses;
+   /* Cost of the last frame. */
+   unsigned executed;
+   uint64_t usec;
+} cheevos_eval_stats_t;
+
 bool cheevos_load(const void *data);
 
 void cheevos_reset_game(void);
@@ -157,6 +167,8 @@ bool cheevos_get_support_cheevos(void);
 
 cheevos_console_t cheevos_get_console(void);
 
+void cheevos_get_eval_stats(cheevos_eval_stats_t *stats);
+
 extern bool cheevos_loaded;
 extern bool cheevos_hardcore_active;
 extern bool cheevos_hardcore_paused;
@@ -0,0 +1,802 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2015-2018 - Andre Leiradella
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+
+#include "program.h"
+
+#include "../verbosity.h"
+
+enum
+{
+   /* Starts a condition set, source is the number of instructions in the
+    * pause group that follows and target the number of the other ones. */
+   CHEEVOS_OPCODE_SET = 0,
+   CHEEVOS_OPCODE_STANDARD,
+   CHEEVOS_OPCODE_PAUSE_IF,
+   CHEEVOS_OPCODE_RESET_IF,
+   CHEEVOS_OPCODE_ADD_SOURCE,
+   CHEEVOS_OPCODE_SUB_SOURCE,
+   CHEEVOS_OPCODE_ADD_HITS,
+   /* A term of an expression, target indexes the multipliers and op is
+    * set when the next term starts a new value. */
+   CHEEVOS_OPCODE_TERM
+};
+
+enum
+{
+   CHEEVOS_OPERAND_CONST = 0,
+   CHEEVOS_OPERAND_MEMORY,
+   CHEEVOS_OPERAND_DELTA
+};
+
+typedef struct
+{
+   uint8_t  opcode;
+   uint8_t  op;
+   unsigned source;
+   unsigned target;
+   unsigned req_hits;
+   unsigned curr_hits;
+} cheevos_insn_t;
+
+typedef struct
+{
+   /* The snapshot slot for memory operands, the value otherwise. */
+   unsigned value;
+   unsigned mask;
+   uint8_t  shift;
+   uint8_t  type;
+   uint8_t  is_bcd;
+   unsigned previous;
+} cheevos_operand_t;
+
+typedef struct
+{
+   unsigned bank;
+   unsigned address;
+   unsigned width;
+} cheevos_read_t;
+
+typedef struct
+{
+   unsigned first;
+   unsigned count;
+   unsigned compare_count;
+} cheevos_entry_t;
+
+struct cheevos_program
+{
+   cheevos_insn_t    *insns;
+   cheevos_operand_t *operands;
+   cheevos_read_t    *reads;
+   cheevos_entry_t   *entries;
+   double            *multipliers;
+   unsigned          *snapshot;
+
+   int               *banks;
+   uint8_t          **memory;
+
+   unsigned insn_count, insn_capacity;
+   unsigned operand_count, operand_capacity;
+   unsigned read_count, read_capacity;
+   unsigned entry_count, entry_capacity;
+   unsigned multiplier_count, multiplier_capacity;
+   unsigned bank_count, bank_capacity;
+
+   /* Instructions executed since the last snapshot. */
+   unsigned executed;
+};
+
+/*****************************************************************************
+Compiling
+*****************************************************************************/
+
+/* Makes room for one more element in the array at *data. */
+static bool cheevos_program_grow(void** data, unsigned* capacity,
+      unsigned count, size_t size)
+{
+   unsigned new_capacity;
+   void* new_data;
+
+   if (count < *capacity)
+      return true;
+
+   new_capacity = *capacity ? *capacity * 2 : 16;
+   new_data     = realloc(*data, new_capacity * size);
+
+   if (!new_data)
+      return false;
+
+   *data        = new_data;
+   *capacity    = new_capacity;
+   return true;
+}
+
+static cheevos_insn_t* cheevos_program_emit(cheevos_program_t* program,
+      unsigned opcode)
+{
+   cheevos_insn_t* insn;
+
+   if (!cheevos_program_grow((void**)&program->insns,
+            &program->insn_capacity, program->insn_count, sizeof(*insn)))
+      return NULL;
+
+   insn = program->insns + program->insn_count++;
+   memset(insn, 0, sizeof(*insn));
+   insn->opcode = opcode;
+   return insn;
+}
+
+static int cheevos_program_add_bank(cheevos_program_t* program, int bank_id)
+{
+   unsigned i;
+   uint8_t** memory;
+
+   for (i = 0; i < program->bank_count; i++)
+      if (program->banks[i] == bank_id)
+         return i;
+
+   if (!cheevos_program_grow((void**)&program->banks,
+            &program->bank_capacity, program->bank_count,
+            sizeof(*program->banks)))
+      return -1;
+
+   /* Keep the pointer array in step with the bank ids. */
+   memory = (uint8_t**)realloc(program->memory,
+         program->bank_capacity * sizeof(*memory));
+
+   if (!memory)
+      return -1;
+
+   program->memory = memory;
+   program->banks[program->bank_count] = bank_id;
+   return program->bank_count++;
+}
+
+/* Returns the snapshot slot holding width bytes at address. */
+static int cheevos_program_add_read(cheevos_program_t* program,
+      int bank_id, unsigned address, unsigned width)
+{
+   unsigned i;
+   cheevos_read_t* read;
+   int bank = cheevos_program_add_bank(program, bank_id);
+
+   if (bank < 0)
+      return -1;
+
+   for (i = 0; i < program->read_count; i++)
+   {
+      read = program->reads + i;
+
+      if (read->bank == (unsigned)bank && read->address == address
+            && read->width == width)
+         return i;
+   }
+
+   if (!cheevos_program_grow((void**)&program->reads,
+            &program->read_capacity, program->read_count, sizeof(*read)))
+      return -1;
+
+   read          = program->reads + program->read_count;
+   read->bank    = bank;
+   read->address = address;
+   read->width   = width;
+
+   return program->read_count++;
+}
+
+/* Operands are never shared, each delta keeps its own previous value. */
+static int cheevos_program_add_operand(cheevos_program_t* program,
+      const cheevos_var_t* var)
+{
+   cheevos_operand_t* operand;
+   unsigned width = 1;
+   int slot;
+
+   if (!cheevos_program_grow((void**)&program->operands,
+            &program->operand_capacity, program->operand_count,
+            sizeof(*operand)))
+      return -1;
+
+   operand = program->operands + program->operand_count;
+   memset(operand, 0, sizeof(*operand));
+   operand->is_bcd   = var->is_bcd;
+   operand->previous = var->previous;
+
+   switch (var->type)
+   {
+      case CHEEVOS_VAR_TYPE_VALUE_COMP:
+         operand->value = var->value;
+         return program->operand_count++;
+
+      case CHEEVOS_VAR_TYPE_ADDRESS:
+      case CHEEVOS_VAR_TYPE_DELTA_MEM:
+         break;
+
+      default:
+         /* Dynamic variables are not supported and read as zero. */
+         return program->operand_count++;
+   }
+
+   /* Unmapped addresses read as zero, and so do their deltas. */
+   if (var->bank_id < 0)
+      return program->operand_count++;
+
+   switch (var->size)
+   {
+      case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
+         operand->mask  = 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
+         operand->shift = 4;
+         operand->mask  = 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_EIGHT_BITS:
+         operand->mask  = 0xff;
+         break;
+      case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
+         operand->mask  = 0xffff;
+         width          = 2;
+         break;
+      case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
+         operand->mask  = 0xffffffff;
+         width          = 4;
+         break;
+      default:
+         operand->shift = var->size - CHEEVOS_VAR_SIZE_BIT_0;
+         operand->mask  = 1;
+         break;
+   }
+
+   slot = cheevos_program_add_read(program, var->bank_id, var->value, width);
+
+   if (slot < 0)
+      return -1;
+
+   operand->value = slot;
+   operand->type  = var->type == CHEEVOS_VAR_TYPE_DELTA_MEM
+      ? CHEEVOS_OPERAND_DELTA : CHEEVOS_OPERAND_MEMORY;
+
+   return program->operand_count++;
+}
+
+static cheevos_entry_t* cheevos_program_add_entry(cheevos_program_t* program)
+{
+   cheevos_entry_t* entry;
+
+   if (!cheevos_program_grow((void**)&program->entries,
+            &program->entry_capacity, program->entry_count, sizeof(*entry)))
+      return NULL;
+
+   entry                = program->entries + program->entry_count++;
+   entry->first         = program->insn_count;
+   entry->count         = 0;
+   entry->compare_count = 0;
+   return entry;
+}
+
+static bool cheevos_program_add_cond(cheevos_program_t* program,
+      const cheevos_cond_t* cond)
+{
+   cheevos_insn_t* insn;
+   unsigned opcode = CHEEVOS_OPCODE_STANDARD;
+   int source, target = 0;
+
+   switch (cond->type)
+   {
+      case CHEEVOS_COND_TYPE_PAUSE_IF:
+         opcode = CHEEVOS_OPCODE_PAUSE_IF;
+         break;
+      case CHEEVOS_COND_TYPE_RESET_IF:
+         opcode = CHEEVOS_OPCODE_RESET_IF;
+         break;
+      case CHEEVOS_COND_TYPE_ADD_SOURCE:
+         opcode = CHEEVOS_OPCODE_ADD_SOURCE;
+         break;
+      case CHEEVOS_COND_TYPE_SUB_SOURCE:
+         opcode = CHEEVOS_OPCODE_SUB_SOURCE;
+         break;
+      case CHEEVOS_COND_TYPE_ADD_HITS:
+         opcode = CHEEVOS_OPCODE_ADD_HITS;
+         break;
+      default:
+         break;
+   }
+
+   source = cheevos_program_add_operand(program, &cond->source);
+
+   /* AddSource and SubSource never look at their target. */
+   if (     opcode != CHEEVOS_OPCODE_ADD_SOURCE
+         && opcode != CHEEVOS_OPCODE_SUB_SOURCE)
+      target = cheevos_program_add_operand(program, &cond->target);
+
+   if (source < 0 || target < 0)
+      return false;
+
+   insn = cheevos_program_emit(program, opcode);
+
+   if (!insn)
+      return false;
+
+   insn->op        = cond->op;
+   insn->source    = source;
+   insn->target    = target;
+   insn->req_hits  = cond->req_hits;
+   insn->curr_hits = cond->curr_hits;
+   return true;
+}
+
+static bool cheevos_program_add_condset(cheevos_program_t* program,
+      cheevos_condset_t* condset)
+{
+   unsigned set, pause_count = 0;
+   int in_pause              = 0;
+   cheevos_cond_t* cond      = NULL;
+   const cheevos_cond_t* end = condset->conds + condset->count;
+
+   /* PauseIf conditions and the AddSource/AddHits chains leading to them
+    * form the pause group, this loop needs to go backwards to find them. */
+   for (cond = condset->conds + condset->count - 1;
+         cond >= condset->conds; cond--)
+   {
+      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
+         in_pause = 1;
+      else if (cond->type != CHEEVOS_COND_TYPE_ADD_SOURCE &&
+               cond->type != CHEEVOS_COND_TYPE_SUB_SOURCE &&
+               cond->type != CHEEVOS_COND_TYPE_ADD_HITS)
+         in_pause = 0;
+
+      cond->pause  = in_pause;
+      pause_count += in_pause;
+   }
+
+   if (!cheevos_program_emit(program, CHEEVOS_OPCODE_SET))
+      return false;
+
+   set = program->insn_count - 1;
+
+   for (cond = condset->conds; cond < end; cond++)
+      if (cond->pause && !cheevos_program_add_cond(program, cond))
+         return false;
+
+   for (cond = condset->conds; cond < end; cond++)
+      if (!cond->pause && !cheevos_program_add_cond(program, cond))
+         return false;
+
+   program->insns[set].source = pause_count;
+   program->insns[set].target = condset->count - pause_count;
+   return true;
+}
+
+int cheevos_program_add_condition(cheevos_program_t* program,
+      cheevos_condition_t* condition)
+{
+   unsigned i;
+   cheevos_entry_t* entry = cheevos_program_add_entry(program);
+
+   if (!entry)
+      return -1;
+
+   if (condition->condsets)
+   {
+      for (i = 0; i < condition->count; i++)
+         if (!cheevos_program_add_condset(program, condition->condsets + i))
+            return -1;
+
+      entry->compare_count = condition->count;
+   }
+
+   entry->count = program->insn_count - entry->first;
+   return program->entry_count - 1;
+}
+
+int cheevos_program_add_expr(cheevos_program_t* program,
+      const cheevos_expr_t* expr)
+{
+   unsigned i;
+   cheevos_entry_t* entry = cheevos_program_add_entry(program);
+
+   if (!entry)
+      return -1;
+
+   entry->compare_count   = expr->compare_count;
+
+   for (i = 0; expr->terms && i < expr->count; i++)
+   {
+      const cheevos_term_t* term = expr->terms + i;
+      cheevos_insn_t* insn;
+      int source = cheevos_program_add_operand(program, &term->var);
+
+      if (source < 0 || !cheevos_program_grow(
+               (void**)&program->multipliers, &program->multiplier_capacity,
+               program->multiplier_count, sizeof(double)))
+         return -1;
+
+      insn = cheevos_program_emit(program, CHEEVOS_OPCODE_TERM);
+
+      if (!insn)
+         return -1;
+
+      insn->op     = term->compare_next;
+      insn->source = source;
+      insn->target = program->multiplier_count;
+
+      program->multipliers[program->multiplier_count++] = term->multiplier;
+   }
+
+   entry->count = program->insn_count - entry->first;
+   return program->entry_count - 1;
+}
+
+cheevos_program_t* cheevos_program_new(void)
+{
+   return (cheevos_program_t*)calloc(1, sizeof(cheevos_program_t));
+}
+
+void cheevos_program_free(cheevos_program_t* program)
+{
+   if (!program)
+      return;
+
+   free(program->insns);
+   free(program->operands);
+   free(program->reads);
+   free(program->entries);
+   free(program->multipliers);
+   free(program->snapshot);
+   free(program->banks);
+   free(program->memory);
+   free(program);
+}
+
+/*****************************************************************************
+Evaluating
+*****************************************************************************/
+
+void cheevos_program_snapshot(cheevos_program_t* program)
+{
+   unsigned i;
+   const cheevos_read_t* read = program->reads;
+
+   program->executed = 0;
+
+   if (!program->snapshot)
+   {
+      program->snapshot = (unsigned*)calloc(
+            program->read_count ? program->read_count : 1, sizeof(unsigned));
+
+      if (!program->snapshot)
+         return;
+   }
+
+   /* Bank pointers can change between frames, but not within one. */
+   for (i = 0; i < program->bank_count; i++)
+      program->memory[i] = cheevos_var_get_bank(program->banks[i]);
+
+   for (i = 0; i < program->read_count; i++, read++)
+   {
+      const uint8_t* memory = program->memory[read->bank];
+      unsigned value        = 0;
+
+      if (memory)
+      {
+         memory += read->address;
+         value   = memory[0];
+
+         if (read->width >= 2)
+            value |= memory[1] << 8;
+
+         if (read->width == 4)
+         {
+            value |= memory[2] << 16;
+            value |= (unsigned)memory[3] << 24;
+         }
+      }
+
+      program->snapshot[i] = value;
+   }
+}
+
+static unsigned cheevos_program_get_value(const cheevos_program_t* program,
+      unsigned index)
+{
+   cheevos_operand_t* operand = program->operands + index;
+   unsigned value             = operand->value;
+
+   if (operand->type != CHEEVOS_OPERAND_CONST)
+   {
+      value = (program->snapshot[value] >> operand->shift) & operand->mask;
+
+      if (operand->type == CHEEVOS_OPERAND_DELTA)
+      {
+         unsigned previous = operand->previous;
+         operand->previous = value;
+         value             = previous;
+      }
+   }
+
+   if (operand->is_bcd)
+      return (((value >> 4) & 0xf) * 10) + (value & 0xf);
+   return value;
+}
+
+static int cheevos_program_compare(const cheevos_program_t* program,
+      const cheevos_insn_t* insn, int add_buffer)
+{
+   unsigned sval = cheevos_program_get_value(program, insn->source) +
+                   add_buffer;
+   unsigned tval = cheevos_program_get_value(program, insn->target);
+
+   switch (insn->op)
+   {
+      case CHEEVOS_COND_OP_EQUALS:
+         return (sval == tval);
+      case CHEEVOS_COND_OP_LESS_THAN:
+         return (sval < tval);
+      case CHEEVOS_COND_OP_LESS_THAN_OR_EQUAL:
+         return (sval <= tval);
+      case CHEEVOS_COND_OP_GREATER_THAN:
+         return (sval > tval);
+      case CHEEVOS_COND_OP_GREATER_THAN_OR_EQUAL:
+         return (sval >= tval);
+      case CHEEVOS_COND_OP_NOT_EQUAL_TO:
+         return (sval != tval);
+      default:
+         break;
+   }
+
+   return 1;
+}
+
+/* Tests either the pause group or the other conditions of a set. */
+static int cheevos_program_test_group(cheevos_program_t* program,
+      cheevos_insn_t* insn, const cheevos_insn_t* end,
+      int* dirty_conds, int* reset_conds)
+{
+   int cond_valid = 0;
+   int set_valid  = 1; /* must start true so AND logic works */
+   int add_buffer = 0;
+   int add_hits   = 0;
+
+   for (; insn < end; insn++)
+   {
+      program->executed++;
+
+      switch (insn->opcode)
+      {
+         case CHEEVOS_OPCODE_ADD_SOURCE:
+            add_buffer += cheevos_program_get_value(program, insn->source);
+            continue;
+
+         case CHEEVOS_OPCODE_SUB_SOURCE:
+            add_buffer -= cheevos_program_get_value(program, insn->source);
+            continue;
+
+         case CHEEVOS_OPCODE_ADD_HITS:
+            if (cheevos_program_compare(program, insn, add_buffer))
+            {
+               insn->curr_hits++;
+               *dirty_conds = 1;
+            }
+
+            add_hits += insn->curr_hits;
+            continue;
+
+         default:
+            break;
+      }
+
+      /* always evaluate the condition to ensure delta values get tracked correctly */
+      cond_valid = cheevos_program_compare(program, insn, add_buffer);
+
+      /* if the condition has a target hit count that has already been met,
+       * it's automatically true, even if not currently true. */
+      if (  (insn->req_hits != 0) &&
+            (insn->curr_hits + add_hits) >= insn->req_hits)
+         cond_valid = 1;
+      else if (cond_valid)
+      {
+         insn->curr_hits++;
+         *dirty_conds = 1;
+
+         /* HitCount target has not yet been met, condition is not yet valid. */
+         if (  (insn->req_hits != 0) &&
+               (insn->curr_hits + add_hits) < insn->req_hits)
+            cond_valid = 0;
+      }
+
+      add_buffer = 0;
+      add_hits   = 0;
+
+      if (insn->opcode == CHEEVOS_OPCODE_PAUSE_IF)
+      {
+         /* as soon as we find a PauseIf that evaluates to true,
+          * stop processing the rest of the group. */
+         if (cond_valid)
+            return 1;
+
+         set_valid = 0;
+
+         /* PauseIf didn't evaluate true, and doesn't have a HitCount,
+          * reset the HitCount to indicate the condition didn't match. */
+         if (insn->req_hits == 0 && insn->curr_hits != 0)
+         {
+            insn->curr_hits = 0;
+            *dirty_conds    = 1;
+         }
+      }
+      else if (insn->opcode == CHEEVOS_OPCODE_RESET_IF)
+      {
+         if (cond_valid)
+         {
+            *reset_conds = 1; /* Resets all hits found so far */
+            set_valid    = 0; /* Cannot be valid if we've hit a reset condition. */
+         }
+      }
+      else /* Sequential or non-sequential? */
+         set_valid &= cond_valid;
+   }
+
+   return set_valid;
+}
+
+static int cheevos_program_test_set(cheevos_program_t* program,
+      cheevos_insn_t* set, int* dirty_conds, int* reset_conds)
+{
+   cheevos_insn_t* pause = set + 1;
+   cheevos_insn_t* conds = pause + set->source;
+
+   /* if any of the Pause conditions is true, stop processing this group. */
+   if (set->source && cheevos_program_test_group(program,
+            pause, conds, dirty_conds, reset_conds))
+      return 0;
+
+   return cheevos_program_test_group(program,
+         conds, conds + set->target, dirty_conds, reset_conds);
+}
+
+int cheevos_program_test(cheevos_program_t* program, int entry, int* dirty)
+{
+   int dirty_conds            = 0;
+   int reset_conds            = 0;
+   int ret_val                = 0;
+   int ret_val_sub_cond       = 0;
+   const cheevos_entry_t* ent = NULL;
+   cheevos_insn_t* insn       = NULL;
+   const cheevos_insn_t* end  = NULL;
+
+   if (entry < 0 || !program->snapshot)
+      return 0;
+
+   ent                        = program->entries + entry;
+   insn                       = program->insns + ent->first;
+   end                        = insn + ent->count;
+   ret_val_sub_cond           = ent->compare_count == 1;
+
+   /* The first set must be true, and at least one of the others. */
+   if (insn < end)
+   {
+      ret_val = cheevos_program_test_set(program, insn,
+            &dirty_conds, &reset_conds);
+      insn   += 1 + insn->source + insn->target;
+   }
+
+   while (insn < end)
+   {
+      ret_val_sub_cond |= cheevos_program_test_set(program, insn,
+            &dirty_conds, &reset_conds);
+      insn             += 1 + insn->source + insn->target;
+   }
+
+   if (reset_conds && cheevos_program_reset(program, entry))
+      dirty_conds = 1;
+
+   if (dirty && dirty_conds)
+      *dirty = 1;
+
+   return (ret_val && ret_val_sub_cond);
+}
+
+int cheevos_program_reset(cheevos_program_t* program, int entry)
+{
+   int dirty                 = 0;
+   cheevos_insn_t* insn      = NULL;
+   const cheevos_insn_t* end = NULL;
+
+   if (entry < 0)
+      return 0;
+
+   insn = program->insns + program->entries[entry].first;
+   end  = insn + program->entries[entry].count;
+
+   for (; insn < end; insn++)
+   {
+      dirty          |= insn->curr_hits != 0;
+      insn->curr_hits = 0;
+   }
+
+   return dirty;
+}
+
+int cheevos_program_value(cheevos_program_t* program, int entry)
+{
+   int values[16];
+   /* Separate possible values with '$' operator, submit the largest */
+   unsigned current_value     = 0;
+   const cheevos_entry_t* ent = NULL;
+   const cheevos_insn_t* insn = NULL;
+   const cheevos_insn_t* end  = NULL;
+
+   if (entry < 0 || !program->snapshot)
+      return 0;
+
+   ent  = program->entries + entry;
+   insn = program->insns + ent->first;
+   end  = insn + ent->count;
+
+   if (insn == end)
+      return 0;
+
+   if (ent->compare_count >= ARRAY_SIZE(values))
+   {
+      CHEEVOS_ERR("[CHEEVOS]: too many values in the leaderboard expression: %u\n", ent->compare_count);
+      return 0;
+   }
+
+   memset(values, 0, sizeof values);
+   program->executed += ent->count;
+
+   for (; insn < end; insn++)
+   {
+      if (current_value >= ARRAY_SIZE(values))
+      {
+         CHEEVOS_ERR("[CHEEVOS]: too many values in the leaderboard expression: %u\n", current_value);
+         return 0;
+      }
+
+      values[current_value] +=
+         cheevos_program_get_value(program, insn->source) *
+         program->multipliers[insn->target];
+
+      if (insn->op)
+         current_value++;
+   }
+
+   if (ent->compare_count > 1)
+   {
+      unsigned j;
+      int maximum = values[0];
+
+      for (j = 1; j < ent->compare_count; j++)
+         maximum = values[j] > maximum ? values[j] : maximum;
+
+      return maximum;
+   }
+
+   return values[0];
+}
+
+void cheevos_program_get_stats(const cheevos_program_t* program,
+      cheevos_eval_stats_t* stats)
+{
+   stats->instructions = program->insn_count;
+   stats->addresses    = program->read_count;
+   stats->executed     = program->executed;
+}
@@ -0,0 +1,65 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2015-2018 - Andre Leiradella
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_CHEEVOS_PROGRAM_H
+#define __RARCH_CHEEVOS_PROGRAM_H
+
+#include "cond.h"
+#include "var.h"
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/*****************************************************************************
+A program holds the conditions of all achievements and leaderboards compiled
+into one flat array of instructions. Every memory location used by the
+program is read once per frame into a snapshot, and the instructions only
+ever look at the snapshot.
+
+Conditions and expressions are added once the addresses have been patched,
+each of them gets an entry number used to evaluate it afterwards.
+*****************************************************************************/
+
+typedef struct cheevos_program cheevos_program_t;
+
+cheevos_program_t* cheevos_program_new(void);
+void cheevos_program_free(cheevos_program_t* program);
+
+/* Return the entry number, or -1 when out of memory. */
+int cheevos_program_add_condition(cheevos_program_t* program,
+      cheevos_condition_t* condition);
+int cheevos_program_add_expr(cheevos_program_t* program,
+      const cheevos_expr_t* expr);
+
+/* Reads all memory locations used by the program, call once per frame
+ * before evaluating any entry. */
+void cheevos_program_snapshot(cheevos_program_t* program);
+
+/* Tests a condition, dirty is set when any hit count changed. */
+int cheevos_program_test(cheevos_program_t* program, int entry, int* dirty);
+
+/* Clears the hit counts of a condition, returns whether any was set. */
+int cheevos_program_reset(cheevos_program_t* program, int entry);
+
+/* Evaluates an expression. */
+int cheevos_program_value(cheevos_program_t* program, int entry);
+
+void cheevos_program_get_stats(const cheevos_program_t* program,
+      cheevos_eval_stats_t* stats);
+
+RETRO_END_DECLS
+
+#endif /* __RARCH_CHEEVOS_PROGRAM_H */
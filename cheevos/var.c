@@ -287,47 +287,81 @@ void cheevos_var_patch_addr(cheevos_var_t* var, cheevos_console_t console)
 Testing
 *****************************************************************************/
 
-uint8_t* cheevos_var_get_memory(const cheevos_var_t* var)
+uint8_t* cheevos_var_get_bank(int bank_id)
 {
-   uint8_t* memory = NULL;
+   rarch_system_info_t* system     = runloop_get_system_info();
+   retro_ctx_memory_info_t meminfo = {NULL, 0, 0};
+
+   if (bank_id < 0)
+      return NULL;
+
+   if (system->mmaps.num_descriptors != 0)
+      return (uint8_t*)system->mmaps.descriptors[bank_id].core.ptr;
 
-   if (var->bank_id >= 0)
+   switch (bank_id)
    {
-      rarch_system_info_t* system = runloop_get_system_info();
+      case 0:
+         meminfo.id = RETRO_MEMORY_SYSTEM_RAM;
+         break;
+      case 1:
+         meminfo.id = RETRO_MEMORY_SAVE_RAM;
+         break;
+      case 2:
+         meminfo.id = RETRO_MEMORY_VIDEO_RAM;
+         break;
+      case 3:
+         meminfo.id = RETRO_MEMORY_RTC;
+         break;
+      default:
+         CHEEVOS_ERR(CHEEVOS_TAG "invalid bank id: %d\n", bank_id);
+         break;
+   }
 
-      if (system->mmaps.num_descriptors != 0)
-         memory = (uint8_t*)system->mmaps.descriptors[var->bank_id].core.ptr;
-      else
-      {
-         retro_ctx_memory_info_t meminfo = {NULL, 0, 0};
+   core_get_memory(&meminfo);
+   return (uint8_t*)meminfo.data;
+}
 
-         switch (var->bank_id)
-         {
-            case 0:
-               meminfo.id = RETRO_MEMORY_SYSTEM_RAM;
-               break;
-            case 1:
-               meminfo.id = RETRO_MEMORY_SAVE_RAM;
-               break;
-            case 2:
-               meminfo.id = RETRO_MEMORY_VIDEO_RAM;
-               break;
-            case 3:
-               meminfo.id = RETRO_MEMORY_RTC;
-               break;
-            default:
-               CHEEVOS_ERR(CHEEVOS_TAG "invalid bank id: %s\n", var->bank_id);
-               break;
-         }
+size_t cheevos_var_get_bank_size(int bank_id)
+{
+   rarch_system_info_t* system     = runloop_get_system_info();
+   retro_ctx_memory_info_t meminfo = {NULL, 0, 0};
 
-         core_get_memory(&meminfo);
-         memory = (uint8_t*)meminfo.data;
-      }
+   if (bank_id < 0)
+      return 0;
 
-      if (memory)
-         memory += var->value;
+   if (system->mmaps.num_descriptors != 0)
+      return system->mmaps.descriptors[bank_id].core.offset
+         + system->mmaps.descriptors[bank_id].core.len;
+
+   switch (bank_id)
+   {
+      case 0:
+         meminfo.id = RETRO_MEMORY_SYSTEM_RAM;
+         break;
+      case 1:
+         meminfo.id = RETRO_MEMORY_SAVE_RAM;
+         break;
+      case 2:
+         meminfo.id = RETRO_MEMORY_VIDEO_RAM;
+         break;
+      case 3:
+         meminfo.id = RETRO_MEMORY_RTC;
+         break;
+      default:
+         return 0;
    }
 
+   core_get_memory(&meminfo);
+   return meminfo.size;
+}
+
+uint8_t* cheevos_var_get_memory(const cheevos_var_t* var)
+{
+   uint8_t* memory = cheevos_var_get_bank(var->bank_id);
+
+   if (memory)
+      memory += var->value;
+
    return memory;
 }
 
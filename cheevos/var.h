@@ -67,9 +67,25 @@ typedef struct
    unsigned           previous;
 } cheevos_var_t;
 
+typedef struct
+{
+   cheevos_var_t var;
+   double        multiplier;
+   bool          compare_next;
+} cheevos_term_t;
+
+typedef struct
+{
+   cheevos_term_t *terms;
+   unsigned        count;
+   unsigned        compare_count;
+} cheevos_expr_t;
+
 void cheevos_var_parse(cheevos_var_t* var, const char** memaddr);
 void cheevos_var_patch_addr(cheevos_var_t* var, cheevos_console_t console);
 
+uint8_t* cheevos_var_get_bank(int bank_id);
+size_t cheevos_var_get_bank_size(int bank_id);
 uint8_t* cheevos_var_get_memory(const cheevos_var_t* var);
 unsigned cheevos_var_get_value(cheevos_var_t* var);
 
@@ -21,6 +21,7 @@
 
 #include <compat/strl.h>
 #include <compat/posix_string.h>
+#include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <lists/dir_list.h>
 #include <string/stdstring.h>
@@ -66,6 +67,10 @@
 #include "network/netplay/netplay.h"
 #endif
 
+#ifdef HAVE_RUNAHEAD
+#include "runahead/run_ahead.h"
+#endif
+
 #include "command.h"
 
 #include "defaults.h"
@@ -185,6 +190,10 @@ static bool command_version(const char* arg)
 #if defined(HAVE_CHEEVOS)
 static bool command_read_ram(const char *arg);
 static bool command_write_ram(const char *arg);
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+static bool command_watch_ram(const char *arg);
+static bool command_unwatch_ram(const char *arg);
+#endif
 #endif
 
 static const struct cmd_action_map action_map[] = {
@@ -193,6 +202,10 @@ static const struct cmd_action_map action_map[] = {
 #if defined(HAVE_CHEEVOS)
    { "READ_CORE_RAM",   command_read_ram,    "<address> <number of bytes>" },
    { "WRITE_CORE_RAM",  command_write_ram,   "<address> <byte1> <byte2> ..." },
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+   { "WATCH_CORE_RAM",  command_watch_ram,   "<address> <number of bytes> (send again within 5 s to keep watching, 16384 bytes in total)" },
+   { "UNWATCH_CORE_RAM", command_unwatch_ram, "[address]" },
+#endif
 #endif
 };
 
@@ -369,7 +382,338 @@ static bool command_write_ram(const char *arg)
 
    return false;
 }
+
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+/* WATCH_CORE_RAM subscriptions. After every frame, the bytes of the
+ * watched ranges which changed are pushed to the client that asked
+ * for them as binary datagrams on the command socket:
+ *
+ *   "RAMD" <frame:u32> { <address:u32> <length:u16> <bytes> } ...
+ *
+ * Numbers are little-endian. Frames are counted from 1 since the
+ * client subscribed. The first datagram after a range is added
+ * carries all of its bytes, frames where nothing changed send
+ * nothing. Only one client is served at a time, a WATCH_CORE_RAM
+ * from another address replaces it.
+ *
+ * Nothing authenticates the client, so what one datagram can make
+ * us send is bounded: all ranges together cover at most
+ * COMMAND_WATCH_MAX_BYTES, and the subscription is dropped unless
+ * the client sends WATCH_CORE_RAM again, for a new or an already
+ * watched range, within COMMAND_WATCH_TIMEOUT. */
+#define COMMAND_WATCH_MAX_RANGES  64
+#define COMMAND_WATCH_MAX_BYTES   16384
+#define COMMAND_WATCH_TIMEOUT     5000000
+#define COMMAND_WATCH_PACKET_SIZE 1400
+/* Up to this many unchanged bytes between two changed ones are
+ * sent along instead of starting a new record. */
+#define COMMAND_WATCH_MAX_GAP     6
+
+struct command_watch_range
+{
+   unsigned address;
+   unsigned size;
+   bool primed;
+   uint8_t *shadow;
+#if !defined(HAVE_NEW_CHEEVOS)
+   cheevos_var_t var;
 #endif
+};
+
+static struct command_watch_range command_watch_ranges[COMMAND_WATCH_MAX_RANGES];
+static unsigned command_watch_count                = 0;
+static unsigned command_watch_bytes                = 0;
+static uint32_t command_watch_frame                = 0;
+static retro_time_t command_watch_renewed          = 0;
+static int command_watch_fd                        = -1;
+static struct sockaddr_storage command_watch_source;
+static socklen_t command_watch_source_len          = 0;
+static uint8_t command_watch_packet[COMMAND_WATCH_PACKET_SIZE];
+static size_t command_watch_packet_len             = 0;
+
+static void command_watch_ram_clear(void)
+{
+   unsigned i;
+
+   for (i = 0; i < command_watch_count; i++)
+      free(command_watch_ranges[i].shadow);
+
+   command_watch_count = 0;
+   command_watch_bytes = 0;
+   command_watch_frame = 0;
+   command_watch_fd    = -1;
+}
+
+/* Returns the number of bytes which can be read from @addr
+ * on, 0 if the address is not mapped. */
+static size_t command_watch_get_available(
+      const struct command_watch_range *range)
+{
+#if defined(HAVE_NEW_CHEEVOS)
+   size_t size = 0;
+   if (!cheevos_patch_address_size(range->address,
+            cheevos_get_console(), &size))
+      return 0;
+   return size;
+#else
+   size_t size = cheevos_var_get_bank_size(range->var.bank_id);
+   if (range->var.value >= size)
+      return 0;
+   return size - range->var.value;
+#endif
+}
+
+static const uint8_t *command_watch_get_memory(
+      const struct command_watch_range *range)
+{
+#if defined(HAVE_NEW_CHEEVOS)
+   return (const uint8_t*)cheevos_patch_address(range->address,
+         cheevos_get_console());
+#else
+   return cheevos_var_get_memory(&range->var);
+#endif
+}
+
+static void command_watch_put_u32(uint8_t *out, uint32_t value)
+{
+   out[0] = (uint8_t)(value >>  0);
+   out[1] = (uint8_t)(value >>  8);
+   out[2] = (uint8_t)(value >> 16);
+   out[3] = (uint8_t)(value >> 24);
+}
+
+static void command_watch_flush(void)
+{
+   if (command_watch_packet_len > 8)
+      sendto(command_watch_fd, (const char*)command_watch_packet,
+            command_watch_packet_len, 0,
+            (struct sockaddr*)&command_watch_source,
+            command_watch_source_len);
+
+   command_watch_packet_len = 0;
+}
+
+static void command_watch_emit(uint32_t address,
+      const uint8_t *data, unsigned len)
+{
+   while (len)
+   {
+      unsigned n;
+
+      if (command_watch_packet_len == 0)
+      {
+         memcpy(command_watch_packet, "RAMD", 4);
+         command_watch_put_u32(command_watch_packet + 4,
+               command_watch_frame);
+         command_watch_packet_len = 8;
+      }
+
+      /* Room for a record header and at least one byte. */
+      if (command_watch_packet_len + 7 > COMMAND_WATCH_PACKET_SIZE)
+      {
+         command_watch_flush();
+         continue;
+      }
+
+      n = (unsigned)(COMMAND_WATCH_PACKET_SIZE
+            - command_watch_packet_len - 6);
+      if (n > len)
+         n = len;
+
+      command_watch_put_u32(command_watch_packet
+            + command_watch_packet_len, address);
+      command_watch_packet[command_watch_packet_len + 4] = (uint8_t)(n >> 0);
+      command_watch_packet[command_watch_packet_len + 5] = (uint8_t)(n >> 8);
+      memcpy(command_watch_packet + command_watch_packet_len + 6, data, n);
+
+      command_watch_packet_len += 6 + n;
+      address                  += n;
+      data                     += n;
+      len                      -= n;
+   }
+}
+
+static bool command_watch_ram(const char *arg)
+{
+   char reply[256];
+   unsigned i;
+   struct command_watch_range *range = NULL;
+   size_t available                  = 0;
+   unsigned addr                     = 0;
+   unsigned nbytes                   = 0;
+
+   if (sscanf(arg, "%x %u", &addr, &nbytes) != 2)
+      return false;
+
+   snprintf(reply, sizeof(reply), "WATCH_CORE_RAM %x -1\n", addr);
+
+   /* Deltas can only be pushed back over the network. */
+   if (lastcmd_source != CMD_NETWORK)
+      return false;
+
+   if (command_watch_fd >= 0 &&
+         (     command_watch_source_len != lastcmd_net_source_len
+            || memcmp(&command_watch_source, &lastcmd_net_source,
+               lastcmd_net_source_len)))
+   {
+      RARCH_LOG("[Command]: Memory watch handed over to a new client.\n");
+      command_watch_ram_clear();
+   }
+
+   /* Asking for a range again only renews the subscription. */
+   for (i = 0; i < command_watch_count; i++)
+   {
+      if (command_watch_ranges[i].address == addr)
+      {
+         command_watch_renewed = cpu_features_get_time_usec();
+         snprintf(reply, sizeof(reply), "WATCH_CORE_RAM %x %u\n",
+               addr, command_watch_ranges[i].size);
+         goto end;
+      }
+   }
+
+   if (nbytes == 0 || nbytes > 0xffff
+         || command_watch_count == COMMAND_WATCH_MAX_RANGES
+         || command_watch_bytes >= COMMAND_WATCH_MAX_BYTES)
+      goto end;
+
+   if (nbytes > COMMAND_WATCH_MAX_BYTES - command_watch_bytes)
+      nbytes = COMMAND_WATCH_MAX_BYTES - command_watch_bytes;
+
+   range          = &command_watch_ranges[command_watch_count];
+   range->address = addr;
+   range->size    = nbytes;
+   range->primed  = false;
+#if !defined(HAVE_NEW_CHEEVOS)
+   memset(&range->var, 0, sizeof(range->var));
+   range->var.value = addr;
+   cheevos_var_patch_addr(&range->var, cheevos_get_console());
+#endif
+
+   if (!command_watch_get_memory(range))
+      goto end;
+
+   /* The range is read every frame, so it must not run past
+    * the end of the memory bank. Longer ranges are shortened,
+    * the reply tells the client how many bytes are watched. */
+   available = command_watch_get_available(range);
+   if (available == 0)
+      goto end;
+   if (nbytes > available)
+      nbytes = (unsigned)available;
+   range->size = nbytes;
+
+   if (!(range->shadow = (uint8_t*)malloc(nbytes)))
+      goto end;
+
+   command_watch_count++;
+   command_watch_bytes     += nbytes;
+   command_watch_renewed    = cpu_features_get_time_usec();
+   command_watch_fd         = lastcmd_net_fd;
+   command_watch_source     = lastcmd_net_source;
+   command_watch_source_len = lastcmd_net_source_len;
+
+   snprintf(reply, sizeof(reply), "WATCH_CORE_RAM %x %u\n", addr, nbytes);
+
+end:
+   command_reply(reply, strlen(reply));
+   return true;
+}
+
+static bool command_unwatch_ram(const char *arg)
+{
+   unsigned i    = 0;
+   unsigned addr = 0;
+
+   if (string_is_empty(arg))
+   {
+      command_watch_ram_clear();
+      return true;
+   }
+
+   addr = strtoul(arg, NULL, 16);
+
+   while (i < command_watch_count)
+   {
+      if (command_watch_ranges[i].address == addr)
+      {
+         free(command_watch_ranges[i].shadow);
+         command_watch_bytes -= command_watch_ranges[i].size;
+         command_watch_ranges[i] =
+            command_watch_ranges[--command_watch_count];
+      }
+      else
+         i++;
+   }
+
+   if (command_watch_count == 0)
+      command_watch_ram_clear();
+
+   return true;
+}
+#endif
+#endif
+
+void command_watch_ram_push(void)
+{
+#if defined(HAVE_COMMAND) && defined(HAVE_CHEEVOS) && defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+   unsigned i;
+
+   if (command_watch_count == 0)
+      return;
+
+   /* The client went away, or never was there. */
+   if (cpu_features_get_time_usec() - command_watch_renewed
+         > COMMAND_WATCH_TIMEOUT)
+   {
+      RARCH_LOG("[Command]: Memory watch expired.\n");
+      command_watch_ram_clear();
+      return;
+   }
+
+   command_watch_frame++;
+
+   for (i = 0; i < command_watch_count; i++)
+   {
+      unsigned j;
+      struct command_watch_range *range = &command_watch_ranges[i];
+      const uint8_t *data               = command_watch_get_memory(range);
+
+      if (!data)
+         continue;
+
+      j = 0;
+
+      while (j < range->size)
+      {
+         unsigned start, end;
+
+         if (range->primed && data[j] == range->shadow[j])
+         {
+            j++;
+            continue;
+         }
+
+         /* Grow the run over small gaps of unchanged bytes. */
+         start = j;
+         end   = j + 1;
+
+         for (j = end; j < range->size
+               && j - end < COMMAND_WATCH_MAX_GAP; j++)
+            if (!range->primed || data[j] != range->shadow[j])
+               end = j + 1;
+
+         memcpy(range->shadow + start, data + start, end - start);
+         command_watch_emit(range->address + start,
+               data + start, end - start);
+      }
+
+      range->primed = true;
+   }
+
+   command_watch_flush();
+#endif
+}
 
 #ifdef HAVE_COMMAND
 static bool command_get_arg(const char *tok,
@@ -401,7 +745,7 @@ static bool command_get_arg(const char *tok,
             return false;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = *argument ? argument + 1 : argument;
 
          if (index)
             *index = i;
@@ -732,6 +1076,9 @@ bool command_set(command_handle_t *handle)
 bool command_free(command_t *handle)
 {
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD) && defined(HAVE_COMMAND)
+#if defined(HAVE_CHEEVOS)
+   command_watch_ram_clear();
+#endif
    if (handle && handle->net_fd >= 0)
       socket_close(handle->net_fd);
 #endif
@@ -765,6 +1112,10 @@ static void command_event_disk_control_set_eject(bool new_state, bool print_log)
    if (!control || !control->get_num_images)
       return;
 
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
+
    if (control->set_eject_state(new_state))
       snprintf(msg, sizeof(msg), "%s %s",
             new_state ?
@@ -817,6 +1168,10 @@ static void command_event_disk_control_set_index(unsigned idx)
 
    num_disks = control->get_num_images();
 
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
+
    if (control->set_image_index(idx))
    {
       if (idx < num_disks)
@@ -1121,6 +1476,9 @@ static void command_event_deinit_core(bool reinit)
    core_unload_game();
    RARCH_LOG("Unloading core..\n");
    core_unload();
+#if defined(HAVE_COMMAND) && defined(HAVE_CHEEVOS) && defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+   command_watch_ram_clear();
+#endif
    RARCH_LOG("Unloading core symbols..\n");
    core_uninit_symbols();
 
@@ -2106,7 +2464,8 @@ TODO: Add a setting for these tweaks */
                if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
-                  state_manager_event_init((unsigned)settings->sizes.rewind_buffer_size);
+                  state_manager_event_init((unsigned)settings->sizes.rewind_buffer_size,
+                        settings->bools.rewind_block_dedup);
                }
             }
          }
@@ -2282,6 +2641,9 @@ TODO: Add a setting for these tweaks */
 
             command_event(CMD_EVENT_HISTORY_DEINIT, NULL);
 
+            playlist_set_compact_format(
+                  settings->bools.playlist_compact_format);
+
             if (!settings->bools.history_list_enable)
                return false;
 
@@ -2332,20 +2694,29 @@ TODO: Add a setting for these tweaks */
       case CMD_EVENT_CORE_INFO_INIT:
          {
             char ext_name[255];
+            char cache_path[PATH_MAX_LENGTH];
             settings_t *settings      = config_get_ptr();
 
             ext_name[0]               = '\0';
+            cache_path[0]             = '\0';
 
             command_event(CMD_EVENT_CORE_INFO_DEINIT, NULL);
 
             if (!frontend_driver_get_core_extension(ext_name, sizeof(ext_name)))
                return false;
 
+            fill_pathname_application_special(cache_path, sizeof(cache_path),
+                  APPLICATION_SPECIAL_DIRECTORY_CACHE);
+            if (!string_is_empty(cache_path))
+               fill_pathname_join(cache_path, cache_path,
+                     "core_info.cache", sizeof(cache_path));
+
             if (!string_is_empty(settings->paths.directory_libretro))
                core_info_init_list(settings->paths.path_libretro_info,
                      settings->paths.directory_libretro,
                      ext_name,
-                     settings->bools.show_hidden_files
+                     settings->bools.show_hidden_files,
+                     cache_path
                      );
          }
          break;
@@ -244,6 +244,10 @@ bool command_set_shader(const char *arg);
 
 bool command_network_send(const char *cmd_);
 
+/* Sends the changes to the memory watched with WATCH_CORE_RAM,
+ * called once per frame after the core ran. */
+void command_watch_ram_push(void);
+
 bool command_network_new(
       command_t *handle,
       bool stdin_enable,
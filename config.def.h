@@ -75,6 +75,7 @@ static const int crt_switch_center_adjust    = 0;
 static const bool def_history_list_enable    = true;
 static const bool def_playlist_entry_remove  = true;
 static const bool def_playlist_entry_rename  = true;
+static const bool def_playlist_compact_format = false;
 
 static const unsigned int def_user_language  = 0;
 
@@ -198,6 +199,10 @@ static const bool threaded_data_runloop_enable = true;
 static const bool threaded_data_runloop_enable = false;
 #endif
 
+/* Number of worker threads used for threaded tasks.
+ * 0 picks a number based on the amount of CPU cores. */
+static const unsigned threaded_data_runloop_workers = 0;
+
 /* Set to true if HW render cores should get their private context. */
 static const bool video_shared_context = false;
 
@@ -512,6 +517,9 @@ static const int out_latency = 64;
 /* Will sync audio. (recommended) */
 static const bool audio_sync = true;
 
+/* Run DSP, resampling and mixing on a separate thread. */
+static const bool audio_pipeline_enable = false;
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 static const bool rate_control = true;
@@ -552,6 +560,12 @@ static const bool framecount_show = true;
  * depending on the save state buffer. */
 static const bool rewind_enable = false;
 
+/* Cuts rewind states into blocks that are shared between frames
+ * and deduplicates them on a background thread instead of delta
+ * compressing every frame in the main loop. Recommended for cores
+ * with large savestates. */
+static const bool rewind_block_dedup = false;
+
 /* When set, any time a cheat is toggled it is immediately applied. */
 static const bool apply_cheats_after_toggle = false;
 
@@ -648,6 +662,11 @@ static const unsigned run_ahead_frames = 1;
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 static const bool run_ahead_secondary_instance = true;
 
+/* When using the Run Ahead feature without a secondary instance,
+ * keep the state of the last shown frame and reuse it while the
+ * input does not change, instead of running every frame ahead again. */
+static const bool run_ahead_state_pool = false;
+
 /* Hide warning messages when using the Run Ahead feature. */
 static const bool run_ahead_hide_warnings = false;
 
@@ -716,6 +735,13 @@ static const unsigned menu_thumbnails_default = 3;
 
 static const unsigned menu_left_thumbnails_default = 0;
 
+/* Megabytes of thumbnail textures kept around by the menu. */
+static const unsigned menu_thumbnail_cache_size = 32;
+
+/* Number of playlist entries above and below the selection
+ * whose thumbnails are loaded ahead of time. */
+static const unsigned menu_thumbnail_prefetch = 2;
+
 static const unsigned menu_timedate_style = 5;
 
 static const bool xmb_vertical_thumbnails = false;
@@ -1321,13 +1321,16 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("ui_menubar_enable",             &settings->bools.ui_menubar_enable, true, true, false);
    SETTING_BOOL("suspend_screensaver_enable",    &settings->bools.ui_suspend_screensaver_enable, true, true, false);
    SETTING_BOOL("rewind_enable",                 &settings->bools.rewind_enable, true, rewind_enable, false);
+   SETTING_BOOL("rewind_block_dedup",            &settings->bools.rewind_block_dedup, true, rewind_block_dedup, false);
    SETTING_BOOL("vrr_runloop_enable",            &settings->bools.vrr_runloop_enable, true, vrr_runloop_enable, false);
    SETTING_BOOL("apply_cheats_after_toggle",     &settings->bools.apply_cheats_after_toggle, true, apply_cheats_after_toggle, false);
    SETTING_BOOL("apply_cheats_after_load",       &settings->bools.apply_cheats_after_load, true, apply_cheats_after_load, false);
    SETTING_BOOL("run_ahead_enabled",             &settings->bools.run_ahead_enabled, true, false, false);
    SETTING_BOOL("run_ahead_secondary_instance",  &settings->bools.run_ahead_secondary_instance, true, false, false);
+   SETTING_BOOL("run_ahead_state_pool",          &settings->bools.run_ahead_state_pool, true, run_ahead_state_pool, false);
    SETTING_BOOL("run_ahead_hide_warnings",       &settings->bools.run_ahead_hide_warnings, true, false, false);
    SETTING_BOOL("audio_sync",                    &settings->bools.audio_sync, true, audio_sync, false);
+   SETTING_BOOL("audio_pipeline_enable",         &settings->bools.audio_pipeline_enable, true, audio_pipeline_enable, false);
    SETTING_BOOL("video_shader_enable",           &settings->bools.video_shader_enable, true, shader_enable, false);
    SETTING_BOOL("video_shader_watch_files",      &settings->bools.video_shader_watch_files, true, video_shader_watch_files, false);
 
@@ -1491,6 +1494,7 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("savestate_thumbnail_enable",   &settings->bools.savestate_thumbnail_enable, true, savestate_thumbnail_enable, false);
    SETTING_BOOL("history_list_enable",          &settings->bools.history_list_enable, true, def_history_list_enable, false);
    SETTING_BOOL("playlist_entry_remove",        &settings->bools.playlist_entry_remove, true, def_playlist_entry_remove, false);
+   SETTING_BOOL("playlist_compact_format",      &settings->bools.playlist_compact_format, true, def_playlist_compact_format, false);
    SETTING_BOOL("playlist_entry_rename",        &settings->bools.playlist_entry_rename, true, def_playlist_entry_rename, false);
    SETTING_BOOL("game_specific_options",        &settings->bools.game_specific_options, true, default_game_specific_options, false);
    SETTING_BOOL("auto_overrides_enable",        &settings->bools.auto_overrides_enable, true, default_auto_overrides_enable, false);
@@ -1604,6 +1608,8 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
 #ifdef HAVE_MENU
    SETTING_UINT("dpi_override_value",           &settings->uints.menu_dpi_override_value, true, menu_dpi_override_value, false);
    SETTING_UINT("menu_thumbnails",              &settings->uints.menu_thumbnails, true, menu_thumbnails_default, false);
+   SETTING_UINT("menu_thumbnail_cache_size",    &settings->uints.menu_thumbnail_cache_size, true, menu_thumbnail_cache_size, false);
+   SETTING_UINT("menu_thumbnail_prefetch",      &settings->uints.menu_thumbnail_prefetch, true, menu_thumbnail_prefetch, false);
    SETTING_UINT("menu_timedate_style", &settings->uints.menu_timedate_style, true, menu_timedate_style, false);
 #ifdef HAVE_LIBNX
    SETTING_UINT("split_joycon_p1", &settings->uints.input_split_joycon[0], true, 0, false);
@@ -1664,6 +1670,7 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
    SETTING_UINT("video_msg_bgcolor_blue",        &settings->uints.video_msg_bgcolor_blue, true, message_bgcolor_blue, false);
 
    SETTING_UINT("run_ahead_frames",           &settings->uints.run_ahead_frames, true, 1,  false);
+   SETTING_UINT("threaded_data_runloop_workers", &settings->uints.threaded_data_runloop_workers, true, threaded_data_runloop_workers, false);
 
    SETTING_UINT("midi_volume",                  &settings->uints.midi_volume, true, midi_volume, false);
 
@@ -2177,6 +2184,8 @@ void config_set_defaults(void)
 #ifdef HAVE_MENU
    first_initialized = false;
 #endif
+
+   settings->version++;
 }
 
 /**
@@ -3151,6 +3160,7 @@ end:
    if (size_settings)
       free(size_settings);
    free(tmp_str);
+   settings->version++;
    return ret;
 }
 
@@ -32,27 +32,38 @@
 #define configuration_set_float(settings, var, newvar) \
 { \
    settings->modified = true; \
+   settings->version++; \
    var = newvar; \
 }
 
 #define configuration_set_bool(settings, var, newvar) \
 { \
    settings->modified = true; \
+   settings->version++; \
    var = newvar; \
 }
 
 #define configuration_set_uint(settings, var, newvar) \
 { \
    settings->modified = true; \
+   settings->version++; \
    var = newvar; \
 }
 
 #define configuration_set_int(settings, var, newvar) \
 { \
    settings->modified = true; \
+   settings->version++; \
    var = newvar; \
 }
 
+/* For code which writes to the settings directly. */
+#define configuration_set_modified(settings) \
+{ \
+   settings->modified = true; \
+   settings->version++; \
+}
+
 enum crt_switch_type
 {
    CRT_SWITCH_NONE = 0,
@@ -110,6 +121,7 @@ typedef struct settings
       bool audio_enable;
       bool audio_enable_menu;
       bool audio_sync;
+      bool audio_pipeline_enable;
       bool audio_rate_control;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
@@ -251,13 +263,16 @@ typedef struct settings
       bool auto_screenshot_filename;
       bool history_list_enable;
       bool playlist_entry_remove;
+      bool playlist_compact_format;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_block_dedup;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_state_pool;
       bool run_ahead_hide_warnings;
       bool pause_nonactive;
       bool block_sram_overwrite;
@@ -399,6 +414,8 @@ typedef struct settings
       unsigned menu_timedate_style;
       unsigned menu_thumbnails;
       unsigned menu_left_thumbnails;
+      unsigned menu_thumbnail_cache_size;
+      unsigned menu_thumbnail_prefetch;
       unsigned menu_dpi_override_value;
       unsigned menu_entry_normal_color;
       unsigned menu_entry_hover_color;
@@ -436,6 +453,7 @@ typedef struct settings
       unsigned led_map[MAX_LEDS];
 
       unsigned run_ahead_frames;
+      unsigned threaded_data_runloop_workers;
 
       unsigned midi_volume;
       unsigned streaming_mode;
@@ -551,6 +569,10 @@ typedef struct settings
 
    bool modified;
 
+   /* Incremented on every change, lets state derived from the
+    * settings tell when it has to be rebuilt. */
+   unsigned version;
+
    video_viewport_t video_viewport_custom;
 
 } settings_t;
@@ -40,6 +40,8 @@
 #include "dynamic.h"
 #include "msg_hash.h"
 #include "managers/state_manager.h"
+#include "performance_counters.h"
+#include "retroarch.h"
 #include "verbosity.h"
 #include "gfx/video_driver.h"
 #include "audio/audio_driver.h"
@@ -47,6 +49,7 @@
 
 #ifdef HAVE_RUNAHEAD
 #include "runahead/copy_load_info.h"
+#include "runahead/run_ahead.h"
 #include "runahead/secondary_core.h"
 #endif
 
@@ -224,12 +227,18 @@ bool core_unset_netplay_callbacks(void)
 bool core_set_cheat(retro_ctx_cheat_info_t *info)
 {
    current_core.retro_cheat_set(info->index, info->enabled, info->code);
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
    return true;
 }
 
 bool core_reset_cheat(void)
 {
    current_core.retro_cheat_reset();
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
    return true;
 }
 
@@ -327,6 +336,10 @@ bool core_unserialize(retro_ctx_serialize_info_t *info)
    if (!info || !current_core.retro_unserialize(info->data_const, info->size))
       return false;
 
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
+
 #if HAVE_NETWORKING
    netplay_driver_ctl(RARCH_NETPLAY_CTL_LOAD_SAVESTATE, info);
 #endif
@@ -380,6 +393,9 @@ bool core_reset(void)
    video_driver_set_cached_frame_ptr(NULL);
 
    current_core.retro_reset();
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate_prediction();
+#endif
    return true;
 }
 
@@ -422,6 +438,9 @@ bool core_unload_game(void)
 
 bool core_run(void)
 {
+   static struct retro_perf_counter core_perf_run;
+   bool perfcnt = rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL);
+
 #ifdef HAVE_NETWORKING
    if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_PRE_FRAME, NULL))
    {
@@ -445,7 +464,11 @@ bool core_run(void)
          break;
    }
 
+   /* Includes the video, audio and input callbacks of the core. */
+   performance_counter_init(core_perf_run, "retro_run");
+   performance_counter_start_plus(perfcnt, core_perf_run);
    current_core.retro_run();
+   performance_counter_stop_plus(perfcnt, core_perf_run);
 
    if (current_core.poll_type == POLL_TYPE_LATE && !current_core.input_polled)
       input_poll();
@@ -15,7 +15,10 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <time.h>
+
 #include <compat/strl.h>
+#include <encodings/crc32.h>
 #include <string/stdstring.h>
 #include <file/config_file.h>
 #include <file/file_path.h>
@@ -78,104 +81,102 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+static void core_info_resolve_firmware(core_info_t *info,
+      config_file_t *config)
 {
-   size_t i;
    unsigned c;
+   unsigned count                  = 0;
+   core_info_firmware_t *firmware  = NULL;
 
-   for (i = 0; i < core_info_list->count; i++)
-   {
-      unsigned count                  = 0;
-      core_info_firmware_t *firmware  = NULL;
-      core_info_t *info               = (core_info_t*)&core_info_list->list[i];
-      config_file_t *config           = (config_file_t*)info->config_data;
-
-      if (!config || !config_get_uint(config, "firmware_count", &count))
-         continue;
+   if (!config_get_uint(config, "firmware_count", &count))
+      return;
 
-      firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
+   firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
 
-      if (!firmware)
-         continue;
+   if (!firmware)
+      return;
 
-      info->firmware = firmware;
+   info->firmware = firmware;
 
-      for (c = 0; c < count; c++)
+   for (c = 0; c < count; c++)
+   {
+      char path_key[64];
+      char desc_key[64];
+      char opt_key[64];
+      bool tmp_bool     = false;
+      char *tmp         = NULL;
+      path_key[0]       = desc_key[0] = opt_key[0] = '\0';
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
+
+      if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
       {
-         char path_key[64];
-         char desc_key[64];
-         char opt_key[64];
-         bool tmp_bool     = false;
-         char *tmp         = NULL;
-         path_key[0]       = desc_key[0] = opt_key[0] = '\0';
-
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
-
-         if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].path = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].desc = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (tmp)
-            free(tmp);
+         info->firmware[c].path = strdup(tmp);
+         free(tmp);
+         tmp = NULL;
+      }
+      if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
+      {
+         info->firmware[c].desc = strdup(tmp);
+         free(tmp);
          tmp = NULL;
-         if (config_get_bool(config, opt_key , &tmp_bool))
-            info->firmware[c].optional = tmp_bool;
       }
+      if (tmp)
+         free(tmp);
+      tmp = NULL;
+      if (config_get_bool(config, opt_key , &tmp_bool))
+         info->firmware[c].optional = tmp_bool;
    }
 }
 
-static void core_info_list_free(core_info_list_t *core_info_list)
+static void core_info_free(core_info_t *info)
 {
-   size_t i, j;
-
-   if (!core_info_list)
-      return;
-
-   for (i = 0; i < core_info_list->count; i++)
+   size_t j;
+
+   free(info->path);
+   free(info->core_name);
+   free(info->systemname);
+   free(info->system_id);
+   free(info->system_manufacturer);
+   free(info->display_name);
+   free(info->display_version);
+   free(info->supported_extensions);
+   free(info->authors);
+   free(info->permissions);
+   free(info->licenses);
+   free(info->categories);
+   free(info->databases);
+   free(info->notes);
+   string_list_free(info->supported_extensions_list);
+   string_list_free(info->authors_list);
+   string_list_free(info->note_list);
+   string_list_free(info->permissions_list);
+   string_list_free(info->licenses_list);
+   string_list_free(info->categories_list);
+   string_list_free(info->databases_list);
+
+   if (info->firmware)
    {
-      core_info_t *info = (core_info_t*)&core_info_list->list[i];
-
-      free(info->path);
-      free(info->core_name);
-      free(info->systemname);
-      free(info->system_id);
-      free(info->system_manufacturer);
-      free(info->display_name);
-      free(info->display_version);
-      free(info->supported_extensions);
-      free(info->authors);
-      free(info->permissions);
-      free(info->licenses);
-      free(info->categories);
-      free(info->databases);
-      free(info->notes);
-      string_list_free(info->supported_extensions_list);
-      string_list_free(info->authors_list);
-      string_list_free(info->note_list);
-      string_list_free(info->permissions_list);
-      string_list_free(info->licenses_list);
-      string_list_free(info->categories_list);
-      string_list_free(info->databases_list);
-      config_file_free((config_file_t*)info->config_data);
-
       for (j = 0; j < info->firmware_count; j++)
       {
          free(info->firmware[j].path);
          free(info->firmware[j].desc);
       }
-      free(info->firmware);
    }
+   free(info->firmware);
+}
+
+static void core_info_list_free(core_info_list_t *core_info_list)
+{
+   size_t i;
+
+   if (!core_info_list)
+      return;
+
+   for (i = 0; i < core_info_list->count; i++)
+      core_info_free(&core_info_list->list[i]);
 
    free(core_info_list->all_ext);
    free(core_info_list->list);
@@ -223,198 +224,642 @@ static bool core_info_list_iterate(
    return true;
 }
 
-static core_info_list_t *core_info_list_new(const char *path,
-      const char *libretro_info_dir,
-      const char *exts,
-      bool show_hidden_files)
+/* Splits the '|' separated values into lists. */
+static void core_info_split_lists(core_info_t *info)
+{
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+         string_split(info->supported_extensions, "|");
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+   if (info->databases)
+      info->databases_list   = string_split(info->databases, "|");
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+}
+
+static char *core_info_get_string(config_file_t *conf, const char *key)
+{
+   char *tmp = NULL;
+
+   if (config_get_string(conf, key, &tmp) && !string_is_empty(tmp))
+      return tmp;
+
+   free(tmp);
+   return NULL;
+}
+
+static void core_info_parse_config_file(core_info_t *info,
+      config_file_t *conf)
+{
+   bool tmp_bool                     = false;
+   unsigned count                    = 0;
+
+   info->display_name                = core_info_get_string(conf, "display_name");
+   info->display_version             = core_info_get_string(conf, "display_version");
+   info->core_name                   = core_info_get_string(conf, "corename");
+   info->systemname                  = core_info_get_string(conf, "systemname");
+   info->system_id                   = core_info_get_string(conf, "systemid");
+   info->system_manufacturer         = core_info_get_string(conf, "manufacturer");
+
+   config_get_uint(conf, "firmware_count", &count);
+
+   info->firmware_count              = count;
+
+   info->supported_extensions        = core_info_get_string(conf, "supported_extensions");
+   info->authors                     = core_info_get_string(conf, "authors");
+   info->permissions                 = core_info_get_string(conf, "permissions");
+   info->licenses                    = core_info_get_string(conf, "license");
+   info->categories                  = core_info_get_string(conf, "categories");
+   info->databases                   = core_info_get_string(conf, "database");
+   info->notes                       = core_info_get_string(conf, "notes");
+
+   if (config_get_bool(conf, "supports_no_game",
+            &tmp_bool))
+      info->supports_no_game = tmp_bool;
+
+   if (config_get_bool(conf, "database_match_archive_member",
+            &tmp_bool))
+      info->database_match_archive_member = tmp_bool;
+
+   info->has_info                    = true;
+
+   core_info_resolve_firmware(info, conf);
+}
+
+/* Core Info Cache
+ *
+ * The parsed info files of all cores are kept in one file, so
+ * that the info directory does not have to be read on every
+ * start. An entry is used as long as size and modification time
+ * of its info file did not change. While the core directory did
+ * not change either, the core list is taken from the cache
+ * instead of listing the directory. */
+#define CORE_INFO_CACHE_MAGIC      "RACINFO"
+#define CORE_INFO_CACHE_VERSION    1
+/* FAT file systems store modification times in 2s steps,
+ * a directory changed this close to writing the cache is
+ * listed again. */
+#define CORE_INFO_CACHE_MTIME_SLACK 2
+
+enum core_info_cache_flags
+{
+   CORE_INFO_CACHE_HAS_INFO            = (1 << 0),
+   CORE_INFO_CACHE_SUPPORTS_NO_GAME    = (1 << 1),
+   CORE_INFO_CACHE_MATCH_ARCHIVE       = (1 << 2)
+};
+
+typedef struct
+{
+   core_info_t info;
+   int64_t info_size;
+   int64_t info_mtime;
+} core_info_cache_entry_t;
+
+typedef struct
+{
+   core_info_cache_entry_t *entries;
+   size_t count;
+   int64_t dir_mtime;
+   int64_t write_time;
+} core_info_cache_t;
+
+typedef struct
+{
+   uint8_t *data;
+   size_t size;
+   size_t capacity;
+   bool error;
+} core_info_cache_writer_t;
+
+typedef struct
+{
+   const uint8_t *data;
+   size_t size;
+   size_t pos;
+   bool error;
+} core_info_cache_reader_t;
+
+static void core_info_cache_write(core_info_cache_writer_t *writer,
+      const void *data, size_t len)
+{
+   if (writer->error)
+      return;
+
+   if (writer->size + len > writer->capacity)
+   {
+      size_t capacity = (writer->size + len) * 2;
+      uint8_t *buf    = (uint8_t*)realloc(writer->data, capacity);
+
+      if (!buf)
+      {
+         writer->error = true;
+         return;
+      }
+
+      writer->data     = buf;
+      writer->capacity = capacity;
+   }
+
+   memcpy(writer->data + writer->size, data, len);
+   writer->size += len;
+}
+
+static void core_info_cache_write_le(core_info_cache_writer_t *writer,
+      uint64_t val, unsigned bytes)
+{
+   unsigned i;
+   uint8_t buf[8];
+
+   for (i = 0; i < bytes; i++)
+      buf[i] = (uint8_t)(val >> (i * 8));
+
+   core_info_cache_write(writer, buf, bytes);
+}
+
+/* NULL and empty strings are both stored with a length of 0. */
+static void core_info_cache_write_string(core_info_cache_writer_t *writer,
+      const char *str)
+{
+   size_t len = str ? strlen(str) : 0;
+
+   core_info_cache_write_le(writer, len, 4);
+   if (len)
+      core_info_cache_write(writer, str, len);
+}
+
+static uint64_t core_info_cache_read_le(core_info_cache_reader_t *reader,
+      unsigned bytes)
+{
+   unsigned i;
+   uint64_t val = 0;
+
+   if (reader->error || reader->pos + bytes > reader->size)
+   {
+      reader->error = true;
+      return 0;
+   }
+
+   for (i = 0; i < bytes; i++)
+      val |= (uint64_t)reader->data[reader->pos + i] << (i * 8);
+
+   reader->pos += bytes;
+   return val;
+}
+
+static char *core_info_cache_read_string(core_info_cache_reader_t *reader)
+{
+   char *str  = NULL;
+   size_t len = (size_t)core_info_cache_read_le(reader, 4);
+
+   if (!len || reader->error)
+      return NULL;
+
+   if (len > reader->size - reader->pos)
+   {
+      reader->error = true;
+      return NULL;
+   }
+
+   str = (char*)malloc(len + 1);
+   if (!str)
+   {
+      reader->error = true;
+      return NULL;
+   }
+
+   memcpy(str, reader->data + reader->pos, len);
+   str[len]     = '\0';
+   reader->pos += len;
+
+   return str;
+}
+
+static bool core_info_cache_read_matches(core_info_cache_reader_t *reader,
+      const char *expected)
+{
+   char *str = core_info_cache_read_string(reader);
+   bool ret  = string_is_equal(str ? str : "", expected ? expected : "");
+
+   free(str);
+   return ret;
+}
+
+static void core_info_cache_free(core_info_cache_t *cache)
 {
    size_t i;
-   core_info_t *core_info           = NULL;
-   core_info_list_t *core_info_list = NULL;
-   const char       *path_basedir   = libretro_info_dir;
-   struct string_list *contents     = dir_list_new(
-                                      path, exts,
-                                      false,
-                                      show_hidden_files,
-                                      false, false);
-   if (!contents)
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+      core_info_free(&cache->entries[i].info);
+
+   free(cache->entries);
+   free(cache);
+}
+
+static core_info_cache_t *core_info_cache_read(
+      const char *path, const char *dir_cores, const char *dir_info,
+      const char *exts, bool show_hidden_files)
+{
+   size_t i;
+   core_info_cache_reader_t reader;
+   void *data               = NULL;
+   int64_t len              = 0;
+   core_info_cache_t *cache = NULL;
+
+   if (!filestream_exists(path)
+         || !filestream_read_file(path, &data, &len)
+         || !data)
       return NULL;
 
-   core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
-   if (!core_info_list)
+   reader.data  = (const uint8_t*)data;
+   reader.size  = (size_t)len;
+   reader.pos   = 0;
+   reader.error = false;
+
+   if (len < 12
+         || memcmp(data, CORE_INFO_CACHE_MAGIC, 8)
+         || encoding_crc32(0, reader.data, reader.size - 4)
+            != (uint32_t)(reader.data[reader.size - 4]
+               | (reader.data[reader.size - 3] << 8)
+               | (reader.data[reader.size - 2] << 16)
+               | ((uint32_t)reader.data[reader.size - 1] << 24)))
       goto error;
 
-   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
-   if (!core_info)
+   reader.pos   = 8;
+   reader.size -= 4;
+
+   if (core_info_cache_read_le(&reader, 4) != CORE_INFO_CACHE_VERSION
+         || !core_info_cache_read_matches(&reader, dir_cores)
+         || !core_info_cache_read_matches(&reader, dir_info)
+         || !core_info_cache_read_matches(&reader, exts)
+         || core_info_cache_read_le(&reader, 1) != (show_hidden_files ? 1 : 0))
       goto error;
 
-   core_info_list->list  = core_info;
-   core_info_list->count = contents->size;
+   cache = (core_info_cache_t*)calloc(1, sizeof(*cache));
+   if (!cache)
+      goto error;
 
-   for (i = 0; i < contents->size; i++)
-   {
-      size_t info_path_size = PATH_MAX_LENGTH * sizeof(char);
-      char *info_path       = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+   cache->dir_mtime  = (int64_t)core_info_cache_read_le(&reader, 8);
+   cache->write_time = (int64_t)core_info_cache_read_le(&reader, 8);
+   cache->count      = (size_t)core_info_cache_read_le(&reader, 4);
 
-      info_path[0]          = '\0';
+   /* Every entry takes more than 64 bytes. */
+   if (reader.error || cache->count > reader.size / 64)
+      goto error;
 
-      if (
-            core_info_list_iterate(info_path, info_path_size,
-               path_basedir, contents, i)
-            && path_is_valid(info_path))
-      {
-         char *tmp           = NULL;
-         bool tmp_bool       = false;
-         unsigned count      = 0;
-         config_file_t *conf = config_file_new(info_path);
+   cache->entries    = (core_info_cache_entry_t*)
+      calloc(cache->count ? cache->count : 1, sizeof(*cache->entries));
 
-         free(info_path);
+   if (!cache->entries)
+      goto error;
 
-         if (!conf)
-            continue;
+   for (i = 0; i < cache->count && !reader.error; i++)
+   {
+      size_t j;
+      uint8_t flags;
+      core_info_cache_entry_t *entry = &cache->entries[i];
+      core_info_t *info              = &entry->info;
+
+      info->path                          = core_info_cache_read_string(&reader);
+      entry->info_size                    = (int64_t)core_info_cache_read_le(&reader, 8);
+      entry->info_mtime                   = (int64_t)core_info_cache_read_le(&reader, 8);
+      flags                               = (uint8_t)core_info_cache_read_le(&reader, 1);
+      info->has_info                      = (flags & CORE_INFO_CACHE_HAS_INFO) != 0;
+      info->supports_no_game              = (flags & CORE_INFO_CACHE_SUPPORTS_NO_GAME) != 0;
+      info->database_match_archive_member = (flags & CORE_INFO_CACHE_MATCH_ARCHIVE) != 0;
+      info->display_name                  = core_info_cache_read_string(&reader);
+      info->display_version               = core_info_cache_read_string(&reader);
+      info->core_name                     = core_info_cache_read_string(&reader);
+      info->systemname                    = core_info_cache_read_string(&reader);
+      info->system_id                     = core_info_cache_read_string(&reader);
+      info->system_manufacturer           = core_info_cache_read_string(&reader);
+      info->supported_extensions          = core_info_cache_read_string(&reader);
+      info->authors                       = core_info_cache_read_string(&reader);
+      info->permissions                   = core_info_cache_read_string(&reader);
+      info->licenses                      = core_info_cache_read_string(&reader);
+      info->categories                    = core_info_cache_read_string(&reader);
+      info->databases                     = core_info_cache_read_string(&reader);
+      info->notes                         = core_info_cache_read_string(&reader);
+      info->firmware_count                = (size_t)core_info_cache_read_le(&reader, 4);
+
+      /* An empty path can not be the file name of a core. */
+      if (!info->path
+            || info->firmware_count > (reader.size - reader.pos) / 9)
+      {
+         reader.error = true;
+         break;
+      }
 
-         if (config_get_string(conf, "display_name", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "display_version", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_version = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "corename", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].core_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
+      if (info->firmware_count)
+      {
+         info->firmware = (core_info_firmware_t*)
+            calloc(info->firmware_count, sizeof(*info->firmware));
 
-         if (config_get_string(conf, "systemname", &tmp)
-               && !string_is_empty(tmp))
+         if (!info->firmware)
          {
-            core_info[i].systemname = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
+            reader.error = true;
+            break;
          }
+      }
 
-         if (config_get_string(conf, "systemid", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].system_id = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
+      for (j = 0; j < info->firmware_count; j++)
+      {
+         info->firmware[j].path     = core_info_cache_read_string(&reader);
+         info->firmware[j].desc     = core_info_cache_read_string(&reader);
+         info->firmware[j].optional = core_info_cache_read_le(&reader, 1) != 0;
+      }
+   }
+
+   if (reader.error || reader.pos != reader.size)
+      goto error;
+
+   free(data);
+   return cache;
+
+error:
+   RARCH_WARN("[Core Info]: Ignoring invalid cache: %s\n", path);
+   free(data);
+   core_info_cache_free(cache);
+   return NULL;
+}
+
+static void core_info_cache_write_file(const char *path,
+      const core_info_list_t *list, const core_info_cache_entry_t *stats,
+      const char *dir_cores, const char *dir_info,
+      const char *exts, bool show_hidden_files, int64_t dir_mtime)
+{
+   size_t i, j;
+   uint32_t crc;
+   char tmp_path[PATH_MAX_LENGTH];
+   char dir[PATH_MAX_LENGTH];
+   core_info_cache_writer_t writer;
+
+   writer.data     = NULL;
+   writer.size     = 0;
+   writer.capacity = 0;
+   writer.error    = false;
+
+   core_info_cache_write(&writer, CORE_INFO_CACHE_MAGIC, 8);
+   core_info_cache_write_le(&writer, CORE_INFO_CACHE_VERSION, 4);
+   core_info_cache_write_string(&writer, dir_cores);
+   core_info_cache_write_string(&writer, dir_info);
+   core_info_cache_write_string(&writer, exts);
+   core_info_cache_write_le(&writer, show_hidden_files ? 1 : 0, 1);
+   core_info_cache_write_le(&writer, (uint64_t)dir_mtime, 8);
+   core_info_cache_write_le(&writer, (uint64_t)time(NULL), 8);
+   core_info_cache_write_le(&writer, list->count, 4);
 
-         if (config_get_string(conf, "manufacturer", &tmp)
-               && !string_is_empty(tmp))
+   for (i = 0; i < list->count; i++)
+   {
+      const core_info_t *info = &list->list[i];
+      uint8_t flags           = 0;
+
+      if (info->has_info)
+         flags |= CORE_INFO_CACHE_HAS_INFO;
+      if (info->supports_no_game)
+         flags |= CORE_INFO_CACHE_SUPPORTS_NO_GAME;
+      if (info->database_match_archive_member)
+         flags |= CORE_INFO_CACHE_MATCH_ARCHIVE;
+
+      core_info_cache_write_string(&writer, info->path);
+      core_info_cache_write_le(&writer, (uint64_t)stats[i].info_size, 8);
+      core_info_cache_write_le(&writer, (uint64_t)stats[i].info_mtime, 8);
+      core_info_cache_write_le(&writer, flags, 1);
+      core_info_cache_write_string(&writer, info->display_name);
+      core_info_cache_write_string(&writer, info->display_version);
+      core_info_cache_write_string(&writer, info->core_name);
+      core_info_cache_write_string(&writer, info->systemname);
+      core_info_cache_write_string(&writer, info->system_id);
+      core_info_cache_write_string(&writer, info->system_manufacturer);
+      core_info_cache_write_string(&writer, info->supported_extensions);
+      core_info_cache_write_string(&writer, info->authors);
+      core_info_cache_write_string(&writer, info->permissions);
+      core_info_cache_write_string(&writer, info->licenses);
+      core_info_cache_write_string(&writer, info->categories);
+      core_info_cache_write_string(&writer, info->databases);
+      core_info_cache_write_string(&writer, info->notes);
+      core_info_cache_write_le(&writer,
+            info->firmware ? info->firmware_count : 0, 4);
+
+      if (!info->firmware)
+         continue;
+
+      for (j = 0; j < info->firmware_count; j++)
+      {
+         core_info_cache_write_string(&writer, info->firmware[j].path);
+         core_info_cache_write_string(&writer, info->firmware[j].desc);
+         core_info_cache_write_le(&writer, info->firmware[j].optional, 1);
+      }
+   }
+
+   crc = encoding_crc32(0, writer.data, writer.size);
+   core_info_cache_write_le(&writer, crc, 4);
+
+   if (writer.error)
+   {
+      free(writer.data);
+      return;
+   }
+
+   /* Write to a temporary file first, a cache cut short
+    * by a crash must not be picked up on the next start. */
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   if (!string_is_empty(dir) && !path_is_directory(dir))
+      path_mkdir(dir);
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, writer.data, (int64_t)writer.size))
+   {
+      if (filestream_rename(tmp_path, path) != 0)
+      {
+         filestream_delete(path);
+         if (filestream_rename(tmp_path, path) != 0)
+            filestream_delete(tmp_path);
+      }
+   }
+
+   free(writer.data);
+}
+
+/* Moves the cached entry of @core_path into @info if its
+ * info file did not change. @hint is the position of the
+ * core in the last listing, usually still the same one.
+ * A missing info file has a size of -1. */
+static bool core_info_cache_take(core_info_cache_t *cache, size_t hint,
+      const char *core_path, int64_t info_size, int64_t info_mtime,
+      core_info_t *info)
+{
+   size_t i;
+   core_info_cache_entry_t *entry = NULL;
+
+   if (!cache)
+      return false;
+
+   if (hint < cache->count
+         && string_is_equal(cache->entries[hint].info.path, core_path))
+      entry = &cache->entries[hint];
+   else
+   {
+      for (i = 0; i < cache->count; i++)
+      {
+         if (string_is_equal(cache->entries[i].info.path, core_path))
          {
-            core_info[i].system_manufacturer = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
+            entry = &cache->entries[i];
+            break;
          }
+      }
+   }
 
-         config_get_uint(conf, "firmware_count", &count);
+   if (!entry
+         || entry->info_size  != info_size
+         || entry->info_mtime != info_mtime)
+      return false;
 
-         core_info[i].firmware_count = count;
+   *info = entry->info;
+   memset(&entry->info, 0, sizeof(entry->info));
 
-         if (config_get_string(conf, "supported_extensions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].supported_extensions      = strdup(tmp);
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
+   core_info_split_lists(info);
+   return true;
+}
 
-            free(tmp);
-            tmp = NULL;
-         }
+static core_info_list_t *core_info_list_new(const char *path,
+      const char *libretro_info_dir,
+      const char *exts,
+      bool show_hidden_files,
+      const char *path_cache)
+{
+   size_t i;
+   int64_t dir_mtime                = 0;
+   bool cache_dirty                 = false;
+   unsigned parsed                  = 0;
+   core_info_t *core_info           = NULL;
+   core_info_cache_entry_t *stats   = NULL;
+   core_info_cache_t *cache         = NULL;
+   core_info_list_t *core_info_list = NULL;
+   const char       *path_basedir   = libretro_info_dir;
+   struct string_list *contents     = NULL;
 
-         if (config_get_string(conf, "authors", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].authors      = strdup(tmp);
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
+   /* Without modification times nothing can be cached. */
+   if (!string_is_empty(path_cache)
+         && path_get_size_mtime(path, NULL, &dir_mtime))
+   {
+      cache = core_info_cache_read(path_cache, path, path_basedir,
+            exts, show_hidden_files);
+      if (!cache)
+         cache_dirty = true;
+   }
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (cache && cache->dir_mtime == dir_mtime
+         && dir_mtime + CORE_INFO_CACHE_MTIME_SLACK < cache->write_time)
+   {
+      union string_list_elem_attr attr;
 
-         if (config_get_string(conf, "permissions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].permissions      = strdup(tmp);
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
+      attr.i   = 0;
+      contents = string_list_new();
 
-            free(tmp);
-            tmp = NULL;
+      for (i = 0; contents && i < cache->count; i++)
+      {
+         if (!string_list_append(contents,
+                  cache->entries[i].info.path, attr))
+         {
+            string_list_free(contents);
+            contents = NULL;
          }
+      }
+   }
 
-         if (config_get_string(conf, "license", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].licenses      = strdup(tmp);
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
+   if (!contents)
+   {
+      contents = dir_list_new(
+            path, exts,
+            false,
+            show_hidden_files,
+            false, false);
+      if (cache)
+         cache_dirty = true;
+   }
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (!contents)
+      goto error;
 
-         if (config_get_string(conf, "categories", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].categories      = strdup(tmp);
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
+   core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
+   if (!core_info_list)
+      goto error;
 
-            free(tmp);
-            tmp = NULL;
-         }
+   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
+   if (!core_info)
+      goto error;
 
-         if (config_get_string(conf, "database", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].databases      = strdup(tmp);
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
+   core_info_list->list  = core_info;
+   core_info_list->count = contents->size;
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (cache || cache_dirty)
+      stats = (core_info_cache_entry_t*)
+         calloc(contents->size ? contents->size : 1, sizeof(*stats));
 
-         if (config_get_string(conf, "notes", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].notes     = strdup(tmp);
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
+   for (i = 0; i < contents->size; i++)
+   {
+      size_t info_path_size = PATH_MAX_LENGTH * sizeof(char);
+      char *info_path       = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+      bool info_exists      = false;
 
-            free(tmp);
-            tmp = NULL;
-         }
+      info_path[0]          = '\0';
 
-         if (tmp)
-            free(tmp);
-         tmp    = NULL;
+      if (!core_info_list_iterate(info_path, info_path_size,
+               path_basedir, contents, i))
+      {
+         free(info_path);
+         continue;
+      }
 
-         if (config_get_bool(conf, "supports_no_game",
-               &tmp_bool))
-            core_info[i].supports_no_game = tmp_bool;
+      if (stats)
+      {
+         info_exists = path_get_size_mtime(info_path,
+               &stats[i].info_size, &stats[i].info_mtime);
 
-         if (config_get_bool(conf, "database_match_archive_member",
-               &tmp_bool))
-            core_info[i].database_match_archive_member = tmp_bool;
+         if (!info_exists)
+         {
+            stats[i].info_size  = -1;
+            stats[i].info_mtime = 0;
+         }
 
-         core_info[i].config_data = conf;
+         if (core_info_cache_take(cache, i, contents->elems[i].data,
+               stats[i].info_size, stats[i].info_mtime, &core_info[i]))
+         {
+            free(info_path);
+            continue;
+         }
       }
       else
-         free(info_path);
+         info_exists = path_is_valid(info_path);
+
+      if (info_exists)
+      {
+         config_file_t *conf = config_file_new(info_path);
+
+         if (conf)
+         {
+            core_info_parse_config_file(&core_info[i], conf);
+            core_info_split_lists(&core_info[i]);
+            config_file_free(conf);
+            parsed++;
+         }
+      }
+
+      free(info_path);
+
+      cache_dirty = true;
 
       if (!string_is_empty(contents->elems[i].data))
          core_info[i].path = strdup(contents->elems[i].data);
@@ -424,18 +869,29 @@ static core_info_list_t *core_info_list_new(const char *path,
             strdup(path_basename(core_info[i].path));
    }
 
-   if (core_info_list)
+   if (cache && cache->count != contents->size)
+      cache_dirty = true;
+
+   if (stats && cache_dirty)
    {
-      core_info_list_resolve_all_extensions(core_info_list);
-      core_info_list_resolve_all_firmware(core_info_list);
+      core_info_cache_write_file(path_cache, core_info_list, stats,
+            path, path_basedir, exts, show_hidden_files, dir_mtime);
+      RARCH_LOG("[Core Info]: Parsed %u of %u info files, updated cache: %s\n",
+            parsed, (unsigned)contents->size, path_cache);
    }
 
-   dir_list_free(contents);
+   core_info_list_resolve_all_extensions(core_info_list);
+
+   free(stats);
+   core_info_cache_free(cache);
+   string_list_free(contents);
    return core_info_list;
 
 error:
+   free(stats);
+   core_info_cache_free(cache);
    if (contents)
-      dir_list_free(contents);
+      string_list_free(contents);
    core_info_list_free(core_info_list);
    return NULL;
 }
@@ -652,12 +1108,13 @@ void core_info_deinit_list(void)
 }
 
 bool core_info_init_list(const char *path_info, const char *dir_cores,
-      const char *exts, bool show_hidden_files)
+      const char *exts, bool show_hidden_files, const char *path_cache)
 {
    if (!(core_info_curr_list = core_info_list_new(dir_cores,
                !string_is_empty(path_info) ? path_info : dir_cores,
                exts,
-               show_hidden_files)))
+               show_hidden_files,
+               path_cache)))
       return false;
    return true;
 }
@@ -838,11 +1295,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-   {
-      config_file_t *conf = (config_file_t*)
-         core_info_list->list[i].config_data;
-      num += !!conf;
-   }
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -39,9 +39,10 @@ typedef struct
 {
    bool supports_no_game;
    bool database_match_archive_member;
+   /* An info file was found for this core. */
+   bool has_info;
    size_t firmware_count;
    char *path;
-   void *config_data;
    char *display_name;
    char *display_version;
    char *core_name;
@@ -113,8 +114,19 @@ bool core_info_get_current_core(core_info_t **core);
 
 void core_info_deinit_list(void);
 
+/**
+ * core_info_init_list:
+ * @path_info           : directory of the info files, @dir_cores if empty.
+ * @dir_cores           : directory of the cores.
+ * @exts                : extensions of the core files.
+ * @show_hidden_files   : list hidden cores.
+ * @path_cache          : binary cache of the parsed info files, can be NULL.
+ *
+ * Creates the list of installed cores. Info files that did not
+ * change since the cache was written are not parsed again.
+ **/
 bool core_info_init_list(const char *path_info, const char *dir_cores,
-      const char *exts, bool show_hidden_files);
+      const char *exts, bool show_hidden_files, const char *path_cache);
 
 bool core_info_get_list(core_info_list_t **core);
 
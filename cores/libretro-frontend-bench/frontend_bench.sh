@@ -0,0 +1,80 @@
+#!/bin/sh
+# Measures the time RetroArch spends per frame outside of the core.
+#
+# Runs the frontend_bench core headless (null video, audio and input
+# drivers) for a fixed number of frames and prints the performance
+# counters, including the per-frame percentiles of each stage.
+#
+# Everything is set through the environment, e.g.
+#    FRAMES=20000 WIDTH=640 HEIGHT=480 REWIND=1 ./frontend_bench.sh
+
+RETROARCH=${RETROARCH:-../../retroarch}
+CORE=${CORE:-./frontend_bench_libretro.so}
+FRAMES=${FRAMES:-10000}
+WIDTH=${WIDTH:-320}
+HEIGHT=${HEIGHT:-240}
+FORMAT=${FORMAT:-XRGB8888}
+AUDIO_BATCH=${AUDIO_BATCH:-735}
+STATE_KB=${STATE_KB:-64}
+REWIND=${REWIND:-0}
+RUNAHEAD=${RUNAHEAD:-0}
+
+if [ ! -x "$RETROARCH" ]; then
+   echo "$RETROARCH not found, set RETROARCH." >&2
+   exit 1
+fi
+
+if [ ! -f "$CORE" ]; then
+   echo "$CORE not found, run make first." >&2
+   exit 1
+fi
+
+dir=`mktemp -d`
+trap 'rm -rf "$dir"' EXIT
+
+if [ "$RUNAHEAD" -gt 0 ]; then
+   runahead_enabled=true
+else
+   runahead_enabled=false
+   RUNAHEAD=1
+fi
+
+if [ "$REWIND" -ne 0 ]; then
+   rewind_enabled=true
+else
+   rewind_enabled=false
+fi
+
+cat > "$dir/retroarch.cfg" <<CFG
+video_driver = "null"
+audio_driver = "null"
+input_driver = "null"
+input_joypad_driver = "null"
+config_save_on_exit = "false"
+perfcnt_enable = "true"
+fastforward_ratio = "0.000000"
+video_frame_delay = "0"
+rewind_enable = "$rewind_enabled"
+rewind_granularity = "1"
+run_ahead_enabled = "$runahead_enabled"
+run_ahead_frames = "$RUNAHEAD"
+run_ahead_secondary_instance = "false"
+game_specific_options = "false"
+core_options_path = "$dir/retroarch-core-options.cfg"
+savefile_directory = "$dir"
+savestate_directory = "$dir"
+system_directory = "$dir"
+CFG
+
+cat > "$dir/retroarch-core-options.cfg" <<OPT
+bench_width = "$WIDTH"
+bench_height = "$HEIGHT"
+bench_pixel_format = "$FORMAT"
+bench_audio_batch = "$AUDIO_BATCH"
+bench_state_size = "$STATE_KB"
+OPT
+
+echo "frames=$FRAMES size=${WIDTH}x$HEIGHT format=$FORMAT audio_batch=$AUDIO_BATCH state=${STATE_KB}KB rewind=$rewind_enabled runahead=$runahead_enabled ($RUNAHEAD)"
+
+"$RETROARCH" --config "$dir/retroarch.cfg" -L "$CORE" \
+   --max-frames="$FRAMES" --verbose 2>&1 | grep '\[PERF\]'
@@ -0,0 +1,348 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Synthetic core for measuring the time the frontend spends per frame.
+ *
+ * retro_run does next to no work of its own: it polls the input,
+ * reads the joypad, touches a small part of the video frame and of
+ * the savestate, and hands out one frame of audio. Anything measured
+ * around it is frontend overhead. Frame size, pixel format, audio
+ * batch size and savestate size are core options, see
+ * frontend_bench.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libretro.h>
+
+#define BENCH_FPS         60.0
+#define BENCH_SAMPLE_RATE 44100.0
+/* Audio frames per video frame. */
+#define BENCH_AUDIO_FRAMES 735
+
+static retro_environment_t environ_cb;
+static retro_video_refresh_t video_cb;
+static retro_audio_sample_t audio_cb;
+static retro_audio_sample_batch_t audio_batch_cb;
+static retro_input_poll_t input_poll_cb;
+static retro_input_state_t input_state_cb;
+
+static unsigned bench_width       = 320;
+static unsigned bench_height      = 240;
+static unsigned bench_bpp         = 4;
+static enum retro_pixel_format bench_format = RETRO_PIXEL_FORMAT_XRGB8888;
+static unsigned bench_audio_batch = BENCH_AUDIO_FRAMES;
+static size_t bench_state_size    = 64 * 1024;
+
+static uint8_t *bench_frame       = NULL;
+static uint8_t *bench_state       = NULL;
+static int16_t bench_audio[BENCH_AUDIO_FRAMES * 2];
+static unsigned bench_frame_count = 0;
+
+static const struct retro_variable bench_vars[] = {
+   { "bench_width", "Frame width; 320|256|512|640|1280|1920" },
+   { "bench_height", "Frame height; 240|224|480|720|1080" },
+   { "bench_pixel_format", "Pixel format; XRGB8888|RGB565|0RGB1555" },
+   { "bench_audio_batch", "Audio frames per batch; 735|1|16|64|256" },
+   { "bench_state_size", "Savestate size (KB); 64|16|256|1024|4096|16384" },
+   { NULL, NULL },
+};
+
+static const char *bench_get_var(const char *key)
+{
+   struct retro_variable var;
+
+   var.key   = key;
+   var.value = NULL;
+
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+      return NULL;
+
+   return var.value;
+}
+
+static void bench_check_variables(void)
+{
+   const char *value = NULL;
+
+   if ((value = bench_get_var("bench_width")))
+      bench_width = (unsigned)strtoul(value, NULL, 10);
+   if ((value = bench_get_var("bench_height")))
+      bench_height = (unsigned)strtoul(value, NULL, 10);
+
+   if ((value = bench_get_var("bench_pixel_format")))
+   {
+      if (!strcmp(value, "RGB565"))
+         bench_format = RETRO_PIXEL_FORMAT_RGB565;
+      else if (!strcmp(value, "0RGB1555"))
+         bench_format = RETRO_PIXEL_FORMAT_0RGB1555;
+      else
+         bench_format = RETRO_PIXEL_FORMAT_XRGB8888;
+   }
+
+   if ((value = bench_get_var("bench_audio_batch")))
+      bench_audio_batch = (unsigned)strtoul(value, NULL, 10);
+   if ((value = bench_get_var("bench_state_size")))
+      bench_state_size = (size_t)strtoul(value, NULL, 10) * 1024;
+
+   if (!bench_width)
+      bench_width = 320;
+   if (!bench_height)
+      bench_height = 240;
+   if (!bench_audio_batch || bench_audio_batch > BENCH_AUDIO_FRAMES)
+      bench_audio_batch = BENCH_AUDIO_FRAMES;
+   if (!bench_state_size)
+      bench_state_size = 1024;
+
+   bench_bpp = bench_format == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+}
+
+void retro_init(void)
+{
+}
+
+void retro_deinit(void)
+{
+}
+
+unsigned retro_api_version(void)
+{
+   return RETRO_API_VERSION;
+}
+
+void retro_set_controller_port_device(unsigned port, unsigned device)
+{
+   (void)port;
+   (void)device;
+}
+
+void retro_get_system_info(struct retro_system_info *info)
+{
+   memset(info, 0, sizeof(*info));
+   info->library_name     = "Frontend Bench";
+   info->library_version  = "1.0";
+   info->need_fullpath    = false;
+   info->valid_extensions = "";
+}
+
+void retro_get_system_av_info(struct retro_system_av_info *info)
+{
+   info->timing.fps            = BENCH_FPS;
+   info->timing.sample_rate    = BENCH_SAMPLE_RATE;
+
+   info->geometry.base_width   = bench_width;
+   info->geometry.base_height  = bench_height;
+   info->geometry.max_width    = bench_width;
+   info->geometry.max_height   = bench_height;
+   info->geometry.aspect_ratio = 0.0f;
+}
+
+void retro_set_environment(retro_environment_t cb)
+{
+   bool no_content = true;
+
+   environ_cb      = cb;
+
+   cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &no_content);
+   cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)bench_vars);
+}
+
+void retro_set_audio_sample(retro_audio_sample_t cb)
+{
+   audio_cb = cb;
+}
+
+void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb)
+{
+   audio_batch_cb = cb;
+}
+
+void retro_set_input_poll(retro_input_poll_t cb)
+{
+   input_poll_cb = cb;
+}
+
+void retro_set_input_state(retro_input_state_t cb)
+{
+   input_state_cb = cb;
+}
+
+void retro_set_video_refresh(retro_video_refresh_t cb)
+{
+   video_cb = cb;
+}
+
+void retro_reset(void)
+{
+   bench_frame_count = 0;
+}
+
+void retro_run(void)
+{
+   unsigned i;
+   uint16_t buttons = 0;
+   size_t pitch     = bench_width * bench_bpp;
+   unsigned row     = bench_frame_count % bench_height;
+   size_t window    = bench_state_size < 1024 ? bench_state_size : 1024;
+   size_t offset    = (bench_frame_count * window) % bench_state_size;
+
+   input_poll_cb();
+
+   for (i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++)
+      if (input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, i))
+         buttons |= 1 << i;
+
+   /* Change one line per frame, so that the frame is never a dupe. */
+   memset(bench_frame + row * pitch, (uint8_t)(bench_frame_count ^ buttons),
+         pitch);
+
+   /* Emulated memory changes a little on every frame. */
+   if (offset + window > bench_state_size)
+      offset = bench_state_size - window;
+   memset(bench_state + offset, (uint8_t)bench_frame_count, window);
+
+   video_cb(bench_frame, bench_width, bench_height, pitch);
+
+   if (bench_audio_batch == 1)
+   {
+      for (i = 0; i < BENCH_AUDIO_FRAMES; i++)
+         audio_cb(bench_audio[i * 2], bench_audio[i * 2 + 1]);
+   }
+   else
+   {
+      for (i = 0; i < BENCH_AUDIO_FRAMES; i += bench_audio_batch)
+      {
+         unsigned frames = BENCH_AUDIO_FRAMES - i;
+
+         if (frames > bench_audio_batch)
+            frames = bench_audio_batch;
+
+         audio_batch_cb(bench_audio + i * 2, frames);
+      }
+   }
+
+   bench_frame_count++;
+}
+
+bool retro_load_game(const struct retro_game_info *info)
+{
+   unsigned i;
+   (void)info;
+
+   bench_check_variables();
+
+   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &bench_format))
+      return false;
+
+   bench_frame = (uint8_t*)calloc(bench_height, bench_width * bench_bpp);
+   bench_state = (uint8_t*)calloc(1, bench_state_size);
+
+   if (!bench_frame || !bench_state)
+   {
+      retro_unload_game();
+      return false;
+   }
+
+   for (i = 0; i < BENCH_AUDIO_FRAMES; i++)
+   {
+      /* A square wave, only so that the samples are not all zero. */
+      int16_t sample         = (i / 50) & 1 ? 0x1000 : -0x1000;
+      bench_audio[i * 2]     = sample;
+      bench_audio[i * 2 + 1] = sample;
+   }
+
+   bench_frame_count = 0;
+
+   return true;
+}
+
+void retro_unload_game(void)
+{
+   free(bench_frame);
+   free(bench_state);
+   bench_frame = NULL;
+   bench_state = NULL;
+}
+
+unsigned retro_get_region(void)
+{
+   return RETRO_REGION_NTSC;
+}
+
+bool retro_load_game_special(unsigned type,
+      const struct retro_game_info *info, size_t num)
+{
+   (void)type;
+   (void)info;
+   (void)num;
+   return false;
+}
+
+size_t retro_serialize_size(void)
+{
+   return bench_state_size + sizeof(bench_frame_count);
+}
+
+bool retro_serialize(void *data, size_t size)
+{
+   uint8_t *out = (uint8_t*)data;
+
+   if (!bench_state || size < retro_serialize_size())
+      return false;
+
+   memcpy(out, &bench_frame_count, sizeof(bench_frame_count));
+   memcpy(out + sizeof(bench_frame_count), bench_state, bench_state_size);
+   return true;
+}
+
+bool retro_unserialize(const void *data, size_t size)
+{
+   const uint8_t *in = (const uint8_t*)data;
+
+   if (!bench_state || size < retro_serialize_size())
+      return false;
+
+   memcpy(&bench_frame_count, in, sizeof(bench_frame_count));
+   memcpy(bench_state, in + sizeof(bench_frame_count), bench_state_size);
+   return true;
+}
+
+void *retro_get_memory_data(unsigned id)
+{
+   if (id == RETRO_MEMORY_SYSTEM_RAM)
+      return bench_state;
+   return NULL;
+}
+
+size_t retro_get_memory_size(unsigned id)
+{
+   if (id == RETRO_MEMORY_SYSTEM_RAM)
+      return bench_state_size;
+   return 0;
+}
+
+void retro_cheat_reset(void)
+{
+}
+
+void retro_cheat_set(unsigned idx, bool enabled, const char *code)
+{
+   (void)idx;
+   (void)enabled;
+   (void)code;
+}
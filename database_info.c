@@ -303,45 +303,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    return 0;
 }
 
-static int database_cursor_open(libretrodb_t *db,
-      libretrodb_cursor_t *cur, const char *path, const char *query)
-{
-   const char *error     = NULL;
-   libretrodb_query_t *q = NULL;
-
-   if ((libretrodb_open(path, db)) != 0)
-      return -1;
-
-   if (query)
-      q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
-      strlen(query), &error);
-
-   if (error)
-      goto error;
-   if ((libretrodb_cursor_open(db, cur, q)) != 0)
-      goto error;
-
-   if (q)
-      libretrodb_query_free(q);
-
-   return 0;
-
-error:
-   if (q)
-      libretrodb_query_free(q);
-   libretrodb_close(db);
-
-   return -1;
-}
-
-static int database_cursor_close(libretrodb_t *db, libretrodb_cursor_t *cur)
-{
-   libretrodb_cursor_close(cur);
-   libretrodb_close(db);
-
-   return 0;
-}
-
 static bool type_is_prioritized(const char *path)
 {
    const char *ext = path_get_extension(path);
@@ -440,20 +401,108 @@ void database_info_free(database_info_handle_t *db)
    string_list_free(db->list);
 }
 
-database_info_list_t *database_info_list_new(
-      const char *rdb_path, const char *query)
+struct database_info_rdb_cache
+{
+   size_t count;
+   size_t capacity;
+   char **paths;
+   libretrodb_t **dbs;
+};
+
+database_info_rdb_cache_t *database_info_rdb_cache_new(void)
+{
+   return (database_info_rdb_cache_t*)calloc(1,
+         sizeof(database_info_rdb_cache_t));
+}
+
+void database_info_rdb_cache_free(database_info_rdb_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      libretrodb_close(cache->dbs[i]);
+      libretrodb_free(cache->dbs[i]);
+      free(cache->paths[i]);
+   }
+
+   free(cache->dbs);
+   free(cache->paths);
+   free(cache);
+}
+
+static libretrodb_t *database_info_rdb_cache_get(
+      database_info_rdb_cache_t *cache, const char *rdb_path)
+{
+   size_t i;
+   libretrodb_t *db = NULL;
+
+   for (i = 0; i < cache->count; i++)
+      if (string_is_equal(cache->paths[i], rdb_path))
+         return cache->dbs[i];
+
+   if (cache->count == cache->capacity)
+   {
+      size_t capacity     = cache->capacity ? cache->capacity * 2 : 16;
+      char **paths        = (char**)realloc(cache->paths,
+            capacity * sizeof(*paths));
+      libretrodb_t **dbs  = NULL;
+
+      if (!paths)
+         return NULL;
+      cache->paths        = paths;
+
+      dbs                 = (libretrodb_t**)realloc(cache->dbs,
+            capacity * sizeof(*dbs));
+      if (!dbs)
+         return NULL;
+      cache->dbs          = dbs;
+      cache->capacity     = capacity;
+   }
+
+   db = libretrodb_new();
+
+   if (!db)
+      return NULL;
+
+   if (libretrodb_open(rdb_path, db) != 0)
+   {
+      libretrodb_free(db);
+      return NULL;
+   }
+
+   cache->paths[cache->count] = strdup(rdb_path);
+   cache->dbs[cache->count]   = db;
+   cache->count++;
+
+   return db;
+}
+
+static database_info_list_t *database_info_list_new_db(
+      libretrodb_t *db, const char *query)
 {
    int ret                                  = 0;
    unsigned k                               = 0;
+   const char *error                        = NULL;
+   libretrodb_query_t *q                    = NULL;
    database_info_t *database_info           = NULL;
    database_info_list_t *database_info_list = NULL;
-   libretrodb_t *db                         = libretrodb_new();
    libretrodb_cursor_t *cur                 = libretrodb_cursor_new();
 
-   if (!db || !cur)
+   if (!cur)
       goto end;
 
-   if ((database_cursor_open(db, cur, rdb_path, query) != 0))
+   if (query)
+      q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
+            strlen(query), &error);
+
+   if (error)
+      goto end;
+
+   if ((libretrodb_cursor_open(db, cur, q)) != 0)
       goto end;
 
    database_info_list = (database_info_list_t*)
@@ -528,17 +577,50 @@ database_info_list_t *database_info_list_new(
    database_info_list->count = k;
 
 end:
-   if (db)
-   {
-      database_cursor_close(db, cur);
-      libretrodb_free(db);
-   }
    if (cur)
+   {
+      libretrodb_cursor_close(cur);
       libretrodb_cursor_free(cur);
+   }
+   if (q)
+      libretrodb_query_free(q);
 
    return database_info_list;
 }
 
+database_info_list_t *database_info_list_new(
+      const char *rdb_path, const char *query)
+{
+   database_info_list_t *database_info_list = NULL;
+   libretrodb_t *db                         = libretrodb_new();
+
+   if (!db)
+      return NULL;
+
+   if (libretrodb_open(rdb_path, db) == 0)
+      database_info_list = database_info_list_new_db(db, query);
+
+   libretrodb_close(db);
+   libretrodb_free(db);
+
+   return database_info_list;
+}
+
+database_info_list_t *database_info_list_new_cached(
+      database_info_rdb_cache_t *cache,
+      const char *rdb_path, const char *query)
+{
+   libretrodb_t *db = NULL;
+
+   if (!cache)
+      return database_info_list_new(rdb_path, query);
+
+   if (!(db = database_info_rdb_cache_get(cache, rdb_path)))
+      return NULL;
+
+   return database_info_list_new_db(db, query);
+}
+
 void database_info_list_free(database_info_list_t *database_info_list)
 {
    size_t i;
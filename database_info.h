@@ -120,9 +120,29 @@ typedef struct
    database_info_t *list;
 } database_info_list_t;
 
+typedef struct database_info_rdb_cache database_info_rdb_cache_t;
+
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+/**
+ * database_info_list_new_cached:
+ * @cache                : databases opened by previous calls.
+ * @rdb_path             : path of the database.
+ * @query                : query to run, NULL for all entries.
+ *
+ * Same as database_info_list_new(), but keeps the database
+ * opened, along with the indexes built to answer @query, in
+ * @cache for later lookups.
+ **/
+database_info_list_t *database_info_list_new_cached(
+      database_info_rdb_cache_t *cache,
+      const char *rdb_path, const char *query);
+
+database_info_rdb_cache_t *database_info_rdb_cache_new(void);
+
+void database_info_rdb_cache_free(database_info_rdb_cache_t *cache);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
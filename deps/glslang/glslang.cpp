@@ -334,6 +334,11 @@ SlangProcess::SlangProcess()
    }
 }
 
+const char *glslang::compiler_version()
+{
+   return GetGlslVersionString();
+}
+
 bool glslang::compile_spirv(const string &source, Stage stage, std::vector<uint32_t> *spirv)
 {
    static SlangProcess process;
@@ -18,6 +18,10 @@ namespace glslang
     };
 
     bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+
+    /* Identifies the compiler build, SPIR-V from different
+     * versions must not be mixed up in caches. */
+    const char *compiler_version();
 }
 
 #endif
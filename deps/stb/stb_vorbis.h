@@ -2,6 +2,7 @@
 #define STB_VORBIS_INCLUDE_STB_VORBIS_H
 
 #include <assert.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,6 +66,22 @@ extern stb_vorbis * stb_vorbis_open_memory(const unsigned char *data, int len,
 /* create an ogg vorbis decoder from an ogg vorbis stream in memory (note
  * this must be the entire stream!). on failure, returns NULL and sets *error */
 
+typedef struct
+{
+   /* returns the number of bytes actually read */
+   size_t (*read)(void *user, void *data, size_t size);
+   /* seeks to an absolute offset, returns 0 on failure */
+   int    (*seek)(void *user, unsigned int offset);
+   void    *user;
+} stb_vorbis_io;
+
+extern stb_vorbis * stb_vorbis_open_io(const stb_vorbis_io *io,
+                                  unsigned int len, int *error,
+                                  stb_vorbis_alloc *alloc_buffer);
+/* create an ogg vorbis decoder reading a stream of 'len' bytes through
+ * the given callbacks, starting at offset 0. only the data being decoded
+ * is pulled in, so the stream does not have to fit in memory. */
+
 extern int stb_vorbis_seek_frame(stb_vorbis *f, unsigned int sample_number);
 extern int stb_vorbis_seek(stb_vorbis *f, unsigned int sample_number);
 /* NOT WORKING YET
@@ -378,6 +395,10 @@ struct stb_vorbis
 
    uint32_t stream_len;
 
+   /* used instead of the memory pointers if io.read is set */
+   stb_vorbis_io io;
+   uint32_t io_offset;
+
    uint8_t  push_mode;
 
    uint32_t first_audio_page_offset;
@@ -877,6 +898,12 @@ static int STBV_CDECL point_compare(const void *p, const void *q)
 
 static uint8_t get8(vorb *z)
 {
+   if (z->io.read) {
+      uint8_t c;
+      if (z->io.read(z->io.user, &c, 1) != 1) { z->eof = TRUE; return 0; }
+      z->io_offset++;
+      return c;
+   }
    if (z->stream >= z->stream_end) { z->eof = TRUE; return 0; }
    return *z->stream++;
 }
@@ -893,14 +920,26 @@ static uint32_t get32(vorb *f)
 
 static int getn(vorb *z, uint8_t *data, int n)
 {
+   if (z->io.read) {
+      size_t got = z->io.read(z->io.user, data, n);
+      z->io_offset += (uint32_t)got;
+      if (got != (size_t)n) { z->eof = 1; return 0; }
+      return 1;
+   }
    if (z->stream+n > z->stream_end) { z->eof = 1; return 0; }
    memcpy(data, z->stream, n);
    z->stream += n;
    return 1;
 }
 
+static int set_file_offset(stb_vorbis *f, unsigned int loc);
+
 static void skip(vorb *z, int n)
 {
+   if (z->io.read) {
+      if (!set_file_offset(z, z->io_offset + n)) z->eof = 1;
+      return;
+   }
    z->stream += n;
    if (z->stream >= z->stream_end) z->eof = 1;
    return;
@@ -909,6 +948,15 @@ static void skip(vorb *z, int n)
 static int set_file_offset(stb_vorbis *f, unsigned int loc)
 {
    f->eof = 0;
+   if (f->io.read) {
+      if (loc >= f->stream_len || !f->io.seek(f->io.user, loc)) {
+         f->io_offset = f->stream_len;
+         f->eof = 1;
+         return 0;
+      }
+      f->io_offset = loc;
+      return 1;
+   }
    if (f->stream_start + loc >= f->stream_end || f->stream_start + loc < f->stream_start) {
       f->stream = f->stream_end;
       f->eof = 1;
@@ -3278,6 +3326,8 @@ static stb_vorbis * vorbis_alloc(stb_vorbis *f)
 
 unsigned int stb_vorbis_get_file_offset(stb_vorbis *f)
 {
+   if (f->io.read)
+      return f->io_offset;
    return (unsigned int)(f->stream - f->stream_start);
 }
 
@@ -3840,6 +3890,28 @@ stb_vorbis * stb_vorbis_open_memory(const unsigned char *data, int len, int *err
    return NULL;
 }
 
+stb_vorbis * stb_vorbis_open_io(const stb_vorbis_io *io, unsigned int len, int *error, stb_vorbis_alloc *alloc)
+{
+   stb_vorbis *f, p;
+   if (io == NULL || io->read == NULL || io->seek == NULL) return NULL;
+   vorbis_init(&p, alloc);
+   p.io = *io;
+   p.io_offset = 0;
+   p.stream_len = len;
+   p.push_mode = FALSE;
+   if (start_decoder(&p)) {
+      f = vorbis_alloc(&p);
+      if (f) {
+         *f = p;
+         vorbis_pump_first_frame(f);
+         return f;
+      }
+   }
+   if (error) *error = p.error;
+   vorbis_deinit(&p);
+   return NULL;
+}
+
 int stb_vorbis_get_samples_float_interleaved(stb_vorbis *f, int channels, float *buffer, int num_floats)
 {
    float **outputs;
@@ -160,6 +160,18 @@ void fill_pathname_application_special(char *s,
                fill_pathname_basedir(s, path_get(RARCH_PATH_CONFIG), len);
          }
          break;
+      case APPLICATION_SPECIAL_DIRECTORY_CACHE:
+         {
+            settings_t *settings     = config_get_ptr();
+
+            /* Try cache directory setting first,
+             * fallback to the location of the current configuration file. */
+            if (!string_is_empty(settings->paths.directory_cache))
+               strlcpy(s, settings->paths.directory_cache, len);
+            else if (!path_is_empty(RARCH_PATH_CONFIG))
+               fill_pathname_basedir(s, path_get(RARCH_PATH_CONFIG), len);
+         }
+         break;
       case APPLICATION_SPECIAL_DIRECTORY_ASSETS_ZARCH_ICONS:
 #ifdef HAVE_ZARCH
          {
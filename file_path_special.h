@@ -34,6 +34,7 @@ enum file_path_enum
    FILE_PATH_DETECT,
    FILE_PATH_NUL,
    FILE_PATH_LUTRO_PLAYLIST,
+   FILE_PATH_CONTENT_SCAN_CACHE,
    FILE_PATH_LOG_WARN,
    FILE_PATH_LOG_ERROR,
    FILE_PATH_LOG_INFO,
@@ -101,6 +102,7 @@ enum application_special_type
    APPLICATION_SPECIAL_NONE = 0,
    APPLICATION_SPECIAL_DIRECTORY_AUTOCONFIG,
    APPLICATION_SPECIAL_DIRECTORY_CONFIG,
+   APPLICATION_SPECIAL_DIRECTORY_CACHE,
    APPLICATION_SPECIAL_DIRECTORY_ASSETS_MATERIALUI,
    APPLICATION_SPECIAL_DIRECTORY_ASSETS_MATERIALUI_FONT,
    APPLICATION_SPECIAL_DIRECTORY_ASSETS_MATERIALUI_ICONS,
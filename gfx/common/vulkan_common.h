@@ -372,6 +372,9 @@ typedef struct vk
       VkDescriptorSetLayout set_layout;
       VkPipelineLayout layout;
       VkPipelineCache cache;
+      /* Pipeline cache data as loaded from disk. */
+      size_t cache_size;
+      uint32_t cache_crc;
    } pipelines;
 
    struct
@@ -20,6 +20,8 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -28,6 +30,8 @@
 #include <retro_math.h>
 #include <retro_assert.h>
 #include <libretro.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
@@ -43,6 +47,7 @@
 
 #include "../../driver.h"
 #include "../../configuration.h"
+#include "../../file_path_special.h"
 #include "../../record/record_driver.h"
 
 #include "../../retroarch.h"
@@ -853,10 +858,195 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+/* The pipeline cache is kept on disk between sessions, so that
+ * the driver does not have to compile the menu and shader
+ * pipelines again on every start. */
+
+#define VULKAN_PIPELINE_CACHE_VERSION 1
+
+/* Caches that grow larger are thrown away and started over. */
+#define VULKAN_PIPELINE_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+struct vulkan_pipeline_cache_header
+{
+   char magic[4];
+   uint32_t version;
+   uint32_t vendor_id;
+   uint32_t device_id;
+   uint32_t driver_version;
+   uint8_t uuid[VK_UUID_SIZE];
+   uint32_t size;
+   uint32_t crc;
+};
+
+static void vulkan_pipeline_cache_header_init(vk_t *vk,
+      struct vulkan_pipeline_cache_header *header)
+{
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   memset(header, 0, sizeof(*header));
+   memcpy(header->magic, "RAPC", sizeof(header->magic));
+   header->version        = VULKAN_PIPELINE_CACHE_VERSION;
+   header->vendor_id      = props->vendorID;
+   header->device_id      = props->deviceID;
+   header->driver_version = props->driverVersion;
+   memcpy(header->uuid, props->pipelineCacheUUID, sizeof(header->uuid));
+}
+
+static bool vulkan_pipeline_cache_path(vk_t *vk, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+   char name[64];
+
+   dir[0] = name[0] = '\0';
+
+   fill_pathname_application_special(dir, sizeof(dir),
+         APPLICATION_SPECIAL_DIRECTORY_CACHE);
+
+   if (string_is_empty(dir))
+      return false;
+
+   /* One file per GPU, so that switching between
+    * two of them does not throw the caches away. */
+   snprintf(name, sizeof(name), "vulkan_pipelines_%04x_%04x.cache",
+         (unsigned)vk->context->gpu_properties.vendorID,
+         (unsigned)vk->context->gpu_properties.deviceID);
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+/* Returns the file buffer, the pipeline cache data
+ * starts after the header. */
+static uint8_t *vulkan_load_pipeline_cache(vk_t *vk, size_t *size)
+{
+   char path[PATH_MAX_LENGTH];
+   struct vulkan_pipeline_cache_header expected;
+   struct vulkan_pipeline_cache_header header;
+   void *buf   = NULL;
+   int64_t len = 0;
+
+   path[0]     = '\0';
+
+   if (     !vulkan_pipeline_cache_path(vk, path, sizeof(path))
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return NULL;
+
+   if ((size_t)len < sizeof(header))
+      goto error;
+
+   memcpy(&header, buf, sizeof(header));
+   vulkan_pipeline_cache_header_init(vk, &expected);
+   expected.size = header.size;
+   expected.crc  = header.crc;
+
+   if (memcmp(&header, &expected, sizeof(header)))
+   {
+      RARCH_LOG("[Vulkan]: Pipeline cache was created by another driver version, discarding it.\n");
+      goto error;
+   }
+
+   if (     header.size > VULKAN_PIPELINE_CACHE_MAX_SIZE
+         || header.size != (size_t)len - sizeof(header)
+         || header.crc  != encoding_crc32(0,
+            (const uint8_t*)buf + sizeof(header), header.size))
+   {
+      RARCH_WARN("[Vulkan]: Pipeline cache \"%s\" is damaged, discarding it.\n",
+            path);
+      goto error;
+   }
+
+   vk->pipelines.cache_size = header.size;
+   vk->pipelines.cache_crc  = header.crc;
+   *size                    = header.size;
+
+   RARCH_LOG("[Vulkan]: Loaded pipeline cache (%u bytes) from \"%s\".\n",
+         (unsigned)header.size, path);
+
+   return (uint8_t*)buf;
+
+error:
+   free(buf);
+   return NULL;
+}
+
+static void vulkan_save_pipeline_cache(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp[PATH_MAX_LENGTH];
+   struct vulkan_pipeline_cache_header header;
+   uint8_t *buf = NULL;
+   size_t size  = 0;
+
+   path[0]      = tmp[0] = '\0';
+
+   if (     vk->pipelines.cache == VK_NULL_HANDLE
+         || !vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return;
+
+   if (     vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, NULL) != VK_SUCCESS
+         || !size)
+      return;
+
+   if (size > VULKAN_PIPELINE_CACHE_MAX_SIZE)
+   {
+      RARCH_WARN("[Vulkan]: Pipeline cache grew to %u bytes, starting over.\n",
+            (unsigned)size);
+      filestream_delete(path);
+      return;
+   }
+
+   if (!(buf = (uint8_t*)malloc(sizeof(header) + size)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, buf + sizeof(header)) != VK_SUCCESS)
+      goto end;
+
+   vulkan_pipeline_cache_header_init(vk, &header);
+   header.size = (uint32_t)size;
+   header.crc  = encoding_crc32(0, buf + sizeof(header), size);
+
+   /* Nothing new was compiled. */
+   if (     header.size == vk->pipelines.cache_size
+         && header.crc  == vk->pipelines.cache_crc)
+      goto end;
+
+   memcpy(buf, &header, sizeof(header));
+
+   fill_pathname_basedir(tmp, path, sizeof(tmp));
+   if (!path_is_directory(tmp))
+      path_mkdir(tmp);
+
+   strlcpy(tmp, path, sizeof(tmp));
+   strlcat(tmp, ".tmp", sizeof(tmp));
+
+   if (!filestream_write_file(tmp, buf, sizeof(header) + size))
+      goto end;
+
+   if (filestream_rename(tmp, path) != 0)
+   {
+      filestream_delete(path);
+      if (filestream_rename(tmp, path) != 0)
+      {
+         filestream_delete(tmp);
+         goto end;
+      }
+   }
+
+   RARCH_LOG("[Vulkan]: Saved pipeline cache (%u bytes, %u at startup) to \"%s\".\n",
+         (unsigned)size, (unsigned)vk->pipelines.cache_size, path);
+
+end:
+   free(buf);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
    uint32_t blank[4 * 4];
+   uint8_t *cache_file               = NULL;
    VkCommandPoolCreateInfo pool_info = {
       VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
@@ -868,8 +1058,28 @@ static void vulkan_init_static_resources(vk_t *vk)
    if (!vk->context)
       return;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   vk->pipelines.cache_size = 0;
+   vk->pipelines.cache_crc  = 0;
+
+   cache_file = vulkan_load_pipeline_cache(vk, &cache.initialDataSize);
+   if (cache_file)
+      cache.pInitialData = cache_file +
+         sizeof(struct vulkan_pipeline_cache_header);
+
+   if (vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS
+         && cache_file)
+   {
+      RARCH_WARN("[Vulkan]: Driver rejected the pipeline cache, starting over.\n");
+      cache.initialDataSize    = 0;
+      cache.pInitialData       = NULL;
+      vk->pipelines.cache_size = 0;
+      vk->pipelines.cache_crc  = 0;
+      vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache);
+   }
+
+   free(cache_file);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -887,6 +1097,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_save_pipeline_cache(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -51,6 +51,7 @@ typedef struct
    const font_renderer_driver_t *font_driver;
    void *font_data;
    struct font_atlas *atlas;
+   font_run_cache_t *runs;
 
    video_font_raster_block_t *block;
 } gl_raster_t;
@@ -62,6 +63,8 @@ static void gl_raster_font_free_font(void *data,
    if (!font)
       return;
 
+   font_run_cache_free(font->runs);
+
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
@@ -187,6 +190,8 @@ static void *gl_raster_font_init_font(void *data,
       return NULL;
    }
 
+   font->runs = font_run_cache_new(font->font_driver, font->font_data);
+
    if (is_threaded)
       video_context_driver_make_current(false);
 
@@ -198,7 +203,7 @@ static void *gl_raster_font_init_font(void *data,
    font->tex_width  = next_pow2(font->atlas->width);
    font->tex_height = next_pow2(font->atlas->height);
 
-   if (!gl_raster_font_upload_atlas(font))
+   if (!font->runs || !gl_raster_font_upload_atlas(font))
       goto error;
 
    font->atlas->dirty = false;
@@ -219,30 +224,11 @@ static int gl_get_message_width(void *data, const char *msg,
       unsigned msg_len, float scale)
 {
    gl_raster_t *font   = (gl_raster_t*)data;
-   const char* msg_end = msg + msg_len;
-   int delta_x         = 0;
 
-   if (     !font
-         || !font->font_driver
-         || !font->font_driver->get_glyph
-         || !font->font_data )
+   if (!font || !font->runs)
       return 0;
 
-   while (msg < msg_end)
-   {
-      unsigned code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph = font->font_driver->get_glyph(
-            font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-      if (!glyph)
-         continue;
-
-      delta_x += glyph->advance_x;
-   }
-
-   return delta_x * scale;
+   return font_run_cache_get_width(font->runs, msg, msg_len) * scale;
 }
 
 static void gl_raster_font_draw_vertices(gl_raster_t *font,
@@ -281,48 +267,49 @@ static void gl_raster_font_render_line(
    GLfloat font_color[4 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_lut_tex_coord[2 * 6 * MAX_MSG_LEN_CHUNK];
    gl_t      *gl        = font->gl;
-   const char* msg_end  = msg + msg_len;
+   const font_run_t *run = NULL;
+   const struct font_run_glyph *glyph = NULL;
+   const struct font_run_glyph *end   = NULL;
    int x                = roundf(pos_x * gl->vp.width);
    int y                = roundf(pos_y * gl->vp.height);
-   int delta_x          = 0;
-   int delta_y          = 0;
+   const int delta_x    = 0;
+   const int delta_y    = 0;
    float inv_tex_size_x = 1.0f / font->tex_width;
    float inv_tex_size_y = 1.0f / font->tex_height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
+   font_run_cache_lock(font->runs);
+
+   /* The run has the glyph positions already, only the vertices
+    * are generated here. */
+   if (!(run = font_run_cache_get(font->runs, msg, msg_len)))
+      goto end;
+
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
-         x -= gl_get_message_width(font, msg, msg_len, scale);
+         x -= run->width * scale;
          break;
       case TEXT_ALIGN_CENTER:
-         x -= gl_get_message_width(font, msg, msg_len, scale) / 2.0;
+         x -= run->width * scale / 2.0;
          break;
    }
 
-   while (msg < msg_end)
+   glyph = run->glyphs;
+   end   = run->glyphs + run->count;
+
+   while (glyph < end)
    {
       i = 0;
-      while ((i < MAX_MSG_LEN_CHUNK) && (msg < msg_end))
+      while ((i < MAX_MSG_LEN_CHUNK) && (glyph < end))
       {
-         int off_x, off_y, tex_x, tex_y, width, height;
-         unsigned                  code = utf8_walk(&msg);
-         const struct font_glyph *glyph = font->font_driver->get_glyph(
-               font->font_data, code);
-
-         if (!glyph) /* Do something smarter here ... */
-            glyph = font->font_driver->get_glyph(font->font_data, '?');
-
-         if (!glyph)
-            continue;
-
-         off_x  = glyph->draw_offset_x;
-         off_y  = glyph->draw_offset_y;
-         tex_x  = glyph->atlas_offset_x;
-         tex_y  = glyph->atlas_offset_y;
-         width  = glyph->width;
-         height = glyph->height;
+         int off_x  = glyph->x;
+         int off_y  = glyph->y;
+         int tex_x  = glyph->atlas_x;
+         int tex_y  = glyph->atlas_y;
+         int width  = glyph->width;
+         int height = glyph->height;
 
          gl_raster_font_emit(0, 0, 1); /* Bottom-left */
          gl_raster_font_emit(1, 1, 1); /* Bottom-right */
@@ -333,9 +320,7 @@ static void gl_raster_font_render_line(
          gl_raster_font_emit(5, 1, 1); /* Bottom-right */
 
          i++;
-
-         delta_x += glyph->advance_x;
-         delta_y -= glyph->advance_y;
+         glyph++;
       }
 
       coords.tex_coord     = font_tex_coords;
@@ -349,6 +334,9 @@ static void gl_raster_font_render_line(
       else
          gl_raster_font_draw_vertices(font, &coords, video_info);
    }
+
+end:
+   font_run_cache_unlock(font->runs);
 }
 
 static void gl_raster_font_render_message(
@@ -32,6 +32,7 @@
 #include "glslang_util.h"
 #if defined(HAVE_GLSLANG)
 #include <glslang.hpp>
+#include "slang_cache.h"
 #endif
 #include "../../verbosity.h"
 
@@ -381,9 +382,12 @@ bool glslang_parse_meta(const vector<string> &lines, glslang_meta *meta)
 #if defined(HAVE_GLSLANG)
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
+   string key;
    vector<string> lines;
-
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+   vector<uint8_t> cached;
+   slang_cache_writer writer;
+   string vertex_source;
+   string fragment_source;
 
    if (!glslang_read_shader_file(shader_path, &lines, true))
       return false;
@@ -391,20 +395,49 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    if (!glslang_parse_meta(lines, &output->meta))
       return false;
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "vertex"),
+   vertex_source   = build_stage_source(lines, "vertex");
+   fragment_source = build_stage_source(lines, "fragment");
+
+   /* The sources have all #includes resolved,
+    * so they are all the SPIR-V depends on. */
+   key             = slang_cache_key(string("spirv") + '\0'
+         + glslang::compiler_version() + '\0'
+         + vertex_source + '\0' + fragment_source);
+
+   if (slang_cache_load(key, "spv", &cached))
+   {
+      slang_cache_reader reader;
+      reader.data = cached.data();
+      reader.size = cached.size();
+
+      if (     reader.words(&output->vertex)
+            && reader.words(&output->fragment))
+      {
+         RARCH_LOG("[slang]: Using cached SPIR-V for \"%s\".\n", shader_path);
+         return true;
+      }
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
+   if (    !glslang::compile_spirv(vertex_source,
             glslang::StageVertex, &output->vertex))
    {
       RARCH_ERR("Failed to compile vertex shader stage.\n");
       return false;
    }
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "fragment"),
+   if (    !glslang::compile_spirv(fragment_source,
             glslang::StageFragment, &output->fragment))
    {
       RARCH_ERR("Failed to compile fragment shader stage.\n");
       return false;
    }
 
+   writer.words(output->vertex);
+   writer.words(output->fragment);
+   slang_cache_store(key, "spv", writer.data);
+
    return true;
 }
 #else
@@ -29,6 +29,7 @@
 #include <retro_miscellaneous.h>
 
 #include "slang_reflection.h"
+#include "slang_cache.h"
 
 #include "../video_driver.h"
 #include "../../verbosity.h"
@@ -1713,7 +1714,7 @@ bool Pass::build()
    reflection.texture_semantic_uniform_map = &common->texture_semantic_uniform_map;
    reflection.semantic_map                 = &semantic_map;
 
-   if (!slang_reflect_spirv(vertex_shader, fragment_shader, &reflection))
+   if (!slang_cache_reflect_spirv(vertex_shader, fragment_shader, &reflection))
       return false;
 
    // Filter out parameters which we will never use anyways.
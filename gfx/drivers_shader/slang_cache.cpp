@@ -0,0 +1,432 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2017 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <rhash.h>
+
+#include "slang_cache.h"
+#include "../video_shader_parse.h"
+
+#include "../../file_path_special.h"
+#include "../../verbosity.h"
+
+using namespace std;
+
+/* Bump whenever the layout of an entry changes. */
+#define SLANG_CACHE_VERSION 2
+
+static const uint8_t slang_cache_magic[4] = { 'R', 'A', 'S', 'C' };
+
+void slang_cache_writer::u32(uint32_t val)
+{
+   uint8_t buf[4];
+   buf[0] = (uint8_t)(val >>  0);
+   buf[1] = (uint8_t)(val >>  8);
+   buf[2] = (uint8_t)(val >> 16);
+   buf[3] = (uint8_t)(val >> 24);
+   data.insert(data.end(), buf, buf + 4);
+}
+
+void slang_cache_writer::str(const string &val)
+{
+   u32((uint32_t)val.size());
+   data.insert(data.end(), val.begin(), val.end());
+}
+
+void slang_cache_writer::words(const vector<uint32_t> &val)
+{
+   u32((uint32_t)val.size());
+   for (uint32_t word : val)
+      u32(word);
+}
+
+bool slang_cache_reader::u32(uint32_t *val)
+{
+   if (size - pos < 4)
+      return false;
+
+   *val = (uint32_t)data[pos + 0] <<  0
+        | (uint32_t)data[pos + 1] <<  8
+        | (uint32_t)data[pos + 2] << 16
+        | (uint32_t)data[pos + 3] << 24;
+   pos += 4;
+   return true;
+}
+
+bool slang_cache_reader::str(string *val)
+{
+   uint32_t len;
+
+   if (!u32(&len) || size - pos < len)
+      return false;
+
+   val->assign((const char*)data + pos, len);
+   pos += len;
+   return true;
+}
+
+bool slang_cache_reader::words(vector<uint32_t> *val)
+{
+   uint32_t i, count;
+
+   if (!u32(&count) || (size - pos) / 4 < count)
+      return false;
+
+   val->resize(count);
+   for (i = 0; i < count; i++)
+      u32(&(*val)[i]);
+   return true;
+}
+
+static bool slang_cache_get_dir(char *s, size_t len)
+{
+   *s = '\0';
+   fill_pathname_application_special(s, len,
+         APPLICATION_SPECIAL_DIRECTORY_CACHE);
+
+   if (string_is_empty(s))
+      return false;
+
+   fill_pathname_join(s, s, "slang", len);
+   return true;
+}
+
+string slang_cache_key(const string &material)
+{
+   char hash[65];
+
+   hash[0] = '\0';
+   sha256_hash(hash, (const uint8_t*)material.data(), material.size());
+   return hash;
+}
+
+bool slang_cache_load(const string &key, const char *ext,
+      vector<uint8_t> *data)
+{
+   char dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   slang_cache_reader reader;
+   uint32_t version, size, crc;
+   void *buf   = NULL;
+   int64_t len = 0;
+   bool ret    = false;
+
+   dir[0] = path[0] = '\0';
+
+   if (!slang_cache_get_dir(dir, sizeof(dir)))
+      return false;
+
+   fill_pathname_join(path, dir, key.c_str(), sizeof(path));
+   strlcat(path, ".", sizeof(path));
+   strlcat(path, ext, sizeof(path));
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   reader.data = (const uint8_t*)buf;
+   reader.size = (size_t)len;
+
+   if (     reader.size < sizeof(slang_cache_magic)
+         || memcmp(buf, slang_cache_magic, sizeof(slang_cache_magic)))
+      goto end;
+
+   reader.pos = sizeof(slang_cache_magic);
+
+   if (     !reader.u32(&version) || version != SLANG_CACHE_VERSION
+         || !reader.u32(&size)    || reader.size - reader.pos < size + 4)
+      goto end;
+
+   reader.pos += size;
+   reader.u32(&crc);
+
+   if (crc != encoding_crc32(0, reader.data + reader.pos - 4 - size, size))
+   {
+      RARCH_WARN("[slang]: Ignoring damaged cache entry \"%s\".\n", path);
+      goto end;
+   }
+
+   data->assign(reader.data + reader.pos - 4 - size,
+         reader.data + reader.pos - 4);
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+void slang_cache_store(const string &key, const char *ext,
+      const vector<uint8_t> &data)
+{
+   char dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   char tmp[PATH_MAX_LENGTH];
+   slang_cache_writer writer;
+
+   dir[0] = path[0] = tmp[0] = '\0';
+
+   if (!slang_cache_get_dir(dir, sizeof(dir)))
+      return;
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+   {
+      RARCH_WARN("[slang]: Could not create cache directory \"%s\".\n", dir);
+      return;
+   }
+
+   fill_pathname_join(path, dir, key.c_str(), sizeof(path));
+   strlcat(path, ".", sizeof(path));
+   strlcat(path, ext, sizeof(path));
+   strlcpy(tmp, path, sizeof(tmp));
+   strlcat(tmp, ".tmp", sizeof(tmp));
+
+   writer.data.assign(slang_cache_magic,
+         slang_cache_magic + sizeof(slang_cache_magic));
+   writer.u32(SLANG_CACHE_VERSION);
+   writer.u32((uint32_t)data.size());
+   writer.data.insert(writer.data.end(), data.begin(), data.end());
+   writer.u32(encoding_crc32(0, data.data(), data.size()));
+
+   /* Another instance may be loading the same entry,
+    * so it only appears once it is complete. */
+   if (!filestream_write_file(tmp, writer.data.data(), writer.data.size()))
+      return;
+
+   if (filestream_rename(tmp, path) != 0)
+   {
+      filestream_delete(path);
+      if (filestream_rename(tmp, path) != 0)
+         filestream_delete(tmp);
+   }
+}
+
+void slang_cache_key_words(string *material, const vector<uint32_t> &words)
+{
+   material->append(to_string(words.size()));
+   material->push_back('\0');
+   material->append((const char*)words.data(), words.size() * sizeof(uint32_t));
+}
+
+void slang_cache_key_spirv_cross(string *material)
+{
+   *material += string("spirv-cross ")
+      + SLANG_CACHE_SPIRV_CROSS_VERSION + '\0';
+}
+
+template <typename M>
+static void slang_cache_key_map(string *material, const char *name,
+      const unordered_map<string, M> *map)
+{
+   vector<string> entries;
+
+   material->append(name);
+   material->push_back('\0');
+
+   if (!map)
+      return;
+
+   /* The iteration order of the map is unspecified. */
+   for (auto &entry : *map)
+      entries.push_back(entry.first + "=" +
+            to_string((int)entry.second.semantic) + ":" +
+            to_string(entry.second.index));
+
+   sort(entries.begin(), entries.end());
+
+   for (auto &entry : entries)
+   {
+      material->append(entry);
+      material->push_back('\0');
+   }
+}
+
+void slang_cache_key_semantic_maps(string *material,
+      const slang_reflection &reflection)
+{
+   material->append("pass " + to_string(reflection.pass_number));
+   material->push_back('\0');
+   slang_cache_key_map(material, "textures",
+         reflection.texture_semantic_map);
+   slang_cache_key_map(material, "texture_uniforms",
+         reflection.texture_semantic_uniform_map);
+   slang_cache_key_map(material, "uniforms",
+         reflection.semantic_map);
+}
+
+static void slang_cache_put_meta(slang_cache_writer *writer,
+      const slang_semantic_meta &meta)
+{
+   writer->u32((uint32_t)meta.ubo_offset);
+   writer->u32((uint32_t)meta.push_constant_offset);
+   writer->u32(meta.num_components);
+   writer->u32((meta.uniform ? 1 : 0) | (meta.push_constant ? 2 : 0));
+}
+
+static bool slang_cache_get_meta(slang_cache_reader *reader,
+      slang_semantic_meta *meta)
+{
+   uint32_t ubo_offset, push_constant_offset, num_components, flags;
+
+   if (     !reader->u32(&ubo_offset)
+         || !reader->u32(&push_constant_offset)
+         || !reader->u32(&num_components)
+         || !reader->u32(&flags))
+      return false;
+
+   meta->ubo_offset           = ubo_offset;
+   meta->push_constant_offset = push_constant_offset;
+   meta->num_components       = num_components;
+   meta->uniform              = (flags & 1) != 0;
+   meta->push_constant        = (flags & 2) != 0;
+   return true;
+}
+
+void slang_cache_put_reflection(slang_cache_writer *writer,
+      const slang_reflection &reflection)
+{
+   unsigned i;
+
+   writer->u32((uint32_t)reflection.ubo_size);
+   writer->u32((uint32_t)reflection.push_constant_size);
+   writer->u32(reflection.ubo_binding);
+   writer->u32(reflection.ubo_stage_mask);
+   writer->u32(reflection.push_constant_stage_mask);
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      writer->u32((uint32_t)reflection.semantic_textures[i].size());
+
+      for (auto &meta : reflection.semantic_textures[i])
+      {
+         writer->u32((uint32_t)meta.ubo_offset);
+         writer->u32((uint32_t)meta.push_constant_offset);
+         writer->u32(meta.binding);
+         writer->u32(meta.stage_mask);
+         writer->u32((meta.texture ? 1 : 0) | (meta.uniform ? 2 : 0)
+               | (meta.push_constant ? 4 : 0));
+      }
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      slang_cache_put_meta(writer, reflection.semantics[i]);
+
+   writer->u32((uint32_t)reflection.semantic_float_parameters.size());
+   for (auto &meta : reflection.semantic_float_parameters)
+      slang_cache_put_meta(writer, meta);
+}
+
+bool slang_cache_get_reflection(slang_cache_reader *reader,
+      slang_reflection *reflection)
+{
+   unsigned i, j;
+   uint32_t ubo_size, push_constant_size, count;
+
+   if (     !reader->u32(&ubo_size)
+         || !reader->u32(&push_constant_size)
+         || !reader->u32(&reflection->ubo_binding)
+         || !reader->u32(&reflection->ubo_stage_mask)
+         || !reader->u32(&reflection->push_constant_stage_mask))
+      return false;
+
+   reflection->ubo_size           = ubo_size;
+   reflection->push_constant_size = push_constant_size;
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      if (!reader->u32(&count) || (reader->size - reader->pos) / 20 < count)
+         return false;
+
+      reflection->semantic_textures[i].resize(count);
+
+      for (j = 0; j < count; j++)
+      {
+         uint32_t ubo_offset, push_constant_offset, flags;
+         slang_texture_semantic_meta &meta =
+            reflection->semantic_textures[i][j];
+
+         if (     !reader->u32(&ubo_offset)
+               || !reader->u32(&push_constant_offset)
+               || !reader->u32(&meta.binding)
+               || !reader->u32(&meta.stage_mask)
+               || !reader->u32(&flags))
+            return false;
+
+         meta.ubo_offset           = ubo_offset;
+         meta.push_constant_offset = push_constant_offset;
+         meta.texture              = (flags & 1) != 0;
+         meta.uniform              = (flags & 2) != 0;
+         meta.push_constant        = (flags & 4) != 0;
+      }
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      if (!slang_cache_get_meta(reader, &reflection->semantics[i]))
+         return false;
+
+   if (!reader->u32(&count) || (reader->size - reader->pos) / 16 < count)
+      return false;
+
+   reflection->semantic_float_parameters.resize(count);
+   for (i = 0; i < count; i++)
+      if (!slang_cache_get_meta(reader,
+               &reflection->semantic_float_parameters[i]))
+         return false;
+
+   return true;
+}
+
+bool slang_cache_reflect_spirv(const vector<uint32_t> &vertex,
+      const vector<uint32_t> &fragment,
+      slang_reflection *reflection)
+{
+   string key;
+   vector<uint8_t> cached;
+   slang_cache_writer writer;
+   string material = string("reflect") + '\0';
+
+   slang_cache_key_spirv_cross(&material);
+   slang_cache_key_words(&material, vertex);
+   slang_cache_key_words(&material, fragment);
+   slang_cache_key_semantic_maps(&material, *reflection);
+   key = slang_cache_key(material);
+
+   if (slang_cache_load(key, "refl", &cached))
+   {
+      slang_cache_reader reader;
+      slang_reflection loaded = *reflection;
+
+      reader.data = cached.data();
+      reader.size = cached.size();
+
+      if (slang_cache_get_reflection(&reader, &loaded))
+      {
+         *reflection = loaded;
+         return true;
+      }
+   }
+
+   if (!slang_reflect_spirv(vertex, fragment, reflection))
+      return false;
+
+   slang_cache_put_reflection(&writer, *reflection);
+   slang_cache_store(key, "refl", writer.data);
+   return true;
+}
@@ -0,0 +1,104 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2017 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLANG_CACHE_H
+#define SLANG_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "slang_reflection.h"
+
+/* The bundled SPIRV-Cross has no version of its own.
+ * Bump this whenever deps/SPIRV-Cross is updated, so that
+ * cross-compiled code and reflection are redone. */
+#define SLANG_CACHE_SPIRV_CROSS_VERSION "2018.1"
+
+/* Disk cache for compiled slang passes.
+ *
+ * Each entry is a file in the "slang" folder of the cache
+ * directory, named after the SHA-256 of everything its contents
+ * depend on. A changed source or compiler leads to a different
+ * name, so entries never have to be invalidated. */
+
+struct slang_cache_writer
+{
+   std::vector<uint8_t> data;
+
+   void u32(uint32_t val);
+   void str(const std::string &val);
+   void words(const std::vector<uint32_t> &val);
+};
+
+struct slang_cache_reader
+{
+   const uint8_t *data = nullptr;
+   size_t size         = 0;
+   size_t pos          = 0;
+
+   bool u32(uint32_t *val);
+   bool str(std::string *val);
+   bool words(std::vector<uint32_t> *val);
+};
+
+/**
+ * slang_cache_key:
+ * @material             : everything the entry depends on.
+ *
+ * Returns: name of the entry as a hex string.
+ **/
+std::string slang_cache_key(const std::string &material);
+
+/**
+ * slang_cache_load:
+ * @key                  : name returned by slang_cache_key().
+ * @ext                  : kind of entry, used as the file extension.
+ * @data                 : receives the payload of the entry.
+ *
+ * Returns: true if the entry exists and is intact.
+ **/
+bool slang_cache_load(const std::string &key, const char *ext,
+      std::vector<uint8_t> *data);
+
+void slang_cache_store(const std::string &key, const char *ext,
+      const std::vector<uint8_t> &data);
+
+void slang_cache_key_words(std::string *material,
+      const std::vector<uint32_t> &words);
+
+/* Appends the SPIRV-Cross version, for entries it produced. */
+void slang_cache_key_spirv_cross(std::string *material);
+
+/* Appends the semantic maps of @reflection to the key material.
+ * The result of reflection depends on them, not only on the SPIR-V. */
+void slang_cache_key_semantic_maps(std::string *material,
+      const slang_reflection &reflection);
+
+void slang_cache_put_reflection(slang_cache_writer *writer,
+      const slang_reflection &reflection);
+
+/* Only fills in the results of reflection, the
+ * semantic maps of @reflection are left alone. */
+bool slang_cache_get_reflection(slang_cache_reader *reader,
+      slang_reflection *reflection);
+
+/* slang_reflect_spirv(), with the results kept in the cache. */
+bool slang_cache_reflect_spirv(const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      slang_reflection *reflection);
+
+#endif
@@ -13,6 +13,7 @@
 #include "slang_preprocess.h"
 #include "slang_reflection.h"
 #include "slang_process.h"
+#include "slang_cache.h"
 
 #include "../../verbosity.h"
 
@@ -94,22 +95,28 @@ static string get_size_semantic_name(
    return get_semantic_name(reflection.texture_semantic_uniform_map, semantic, index);
 }
 
-static bool slang_process_reflection(
-      const Compiler*        vs_compiler,
-      const Compiler*        ps_compiler,
-      const ShaderResources& vs_resources,
-      const ShaderResources& ps_resources,
-      video_shader*          shader_info,
-      unsigned               pass_number,
-      const semantics_map_t* map,
-      pass_semantics_t*      out)
+/* Semantic names the reflection of a pass resolves
+ * besides the built-in ones. */
+struct slang_process_maps
 {
-   int semantic;
-   unsigned i;
-   vector<texture_sem_t> textures;
-   vector<uniform_sem_t> uniforms[SLANG_CBUFFER_MAX];
    unordered_map<string, slang_texture_semantic_map> texture_semantic_map;
    unordered_map<string, slang_texture_semantic_map> texture_semantic_uniform_map;
+   unordered_map<string, slang_semantic_map> uniform_semantic_map;
+};
+
+static bool slang_process_init_maps(
+      video_shader*       shader_info,
+      unsigned            pass_number,
+      slang_process_maps* maps,
+      slang_reflection*   sl_reflection)
+{
+   unsigned i;
+   unordered_map<string, slang_texture_semantic_map>& texture_semantic_map =
+      maps->texture_semantic_map;
+   unordered_map<string, slang_texture_semantic_map>& texture_semantic_uniform_map =
+      maps->texture_semantic_uniform_map;
+   unordered_map<string, slang_semantic_map>& uniform_semantic_map =
+      maps->uniform_semantic_map;
 
    for (i = 0; i <= pass_number; i++)
    {
@@ -159,8 +166,6 @@ static bool slang_process_reflection(
          return false;
    }
 
-   unordered_map<string, slang_semantic_map> uniform_semantic_map;
-
    for (i = 0; i < shader_info->num_parameters; i++)
    {
       if (!set_unique_map(
@@ -169,20 +174,25 @@ static bool slang_process_reflection(
          return false;
    }
 
-   slang_reflection sl_reflection;
-   sl_reflection.pass_number                  = pass_number;
-   sl_reflection.texture_semantic_map         = &texture_semantic_map;
-   sl_reflection.texture_semantic_uniform_map = &texture_semantic_uniform_map;
-   sl_reflection.semantic_map                 = &uniform_semantic_map;
+   sl_reflection->pass_number                  = pass_number;
+   sl_reflection->texture_semantic_map         = &texture_semantic_map;
+   sl_reflection->texture_semantic_uniform_map = &texture_semantic_uniform_map;
+   sl_reflection->semantic_map                 = &uniform_semantic_map;
 
-   if (!slang_reflect(*vs_compiler, *ps_compiler,
-            vs_resources, ps_resources, &sl_reflection))
-   {
-      RARCH_ERR("[slang]: Failed to reflect SPIR-V."
-            " Resource usage is inconsistent with "
-                "expectations.\n");
-      return false;
-   }
+   return true;
+}
+
+static bool slang_process_reflection(
+      slang_reflection&       sl_reflection,
+      video_shader*           shader_info,
+      unsigned                pass_number,
+      const semantics_map_t*  map,
+      pass_semantics_t*       out)
+{
+   int semantic;
+   unsigned i;
+   vector<texture_sem_t> textures;
+   vector<uniform_sem_t> uniforms[SLANG_CBUFFER_MAX];
 
    out->cbuffers[SLANG_CBUFFER_UBO].stage_mask = sl_reflection.ubo_stage_mask;
    out->cbuffers[SLANG_CBUFFER_UBO].binding    = sl_reflection.ubo_binding;
@@ -343,49 +353,23 @@ static bool slang_process_reflection(
    return true;
 }
 
-bool slang_process(
+static bool slang_process_compile(
+      const glslang_output&  output,
       video_shader*          shader_info,
-      unsigned               pass_number,
       enum rarch_shader_type dst_type,
       unsigned               version,
-      const semantics_map_t* semantics_map,
-      pass_semantics_t*      out)
+      slang_reflection*      sl_reflection,
+      string*                vs_code,
+      string*                ps_code)
 {
-   glslang_output     output;
+   bool               ret         = false;
    Compiler*          vs_compiler = NULL;
    Compiler*          ps_compiler = NULL;
-   video_shader_pass& pass        = shader_info->pass[pass_number];
-
-   if (!glslang_compile_shader(pass.source.path, &output))
-      return false;
-
-   if (!slang_preprocess_parse_parameters(output.meta, shader_info))
-      return false;
-
-   if (!*pass.alias && !output.meta.name.empty())
-      strlcpy(pass.alias, output.meta.name.c_str(), sizeof(pass.alias) - 1);
-
-   out->format = output.meta.rt_format;
-
-   if (out->format == SLANG_FORMAT_UNKNOWN)
-   {
-      if (pass.fbo.srgb_fbo)
-         out->format = SLANG_FORMAT_R8G8B8A8_SRGB;
-      else if (pass.fbo.fp_fbo)
-         out->format = SLANG_FORMAT_R16G16B16A16_SFLOAT;
-      else
-         out->format = SLANG_FORMAT_R8G8B8A8_UNORM;
-   }
-
-   pass.source.string.vertex   = NULL;
-   pass.source.string.fragment = NULL;
 
    try
    {
       ShaderResources vs_resources;
       ShaderResources ps_resources;
-      string          vs_code;
-      string          ps_code;
 
       switch (dst_type)
       {
@@ -461,8 +445,8 @@ bool slang_process(
             }
          }
 
-         vs_code = vs->compile();
-         ps_code = ps->compile(ps_attrib_remap);
+         *vs_code = vs->compile();
+         *ps_code = ps->compile(ps_attrib_remap);
       }
       else
 #endif
@@ -483,8 +467,8 @@ bool slang_process(
             std::string name = vs->get_name(resource.id);
          }
 
-         vs_code = vs->compile();
-         ps_code = ps->compile();
+         *vs_code = vs->compile();
+         *ps_code = ps->compile();
       }
       else if (shader_info->type == RARCH_SHADER_GLSL)
       {
@@ -495,42 +479,129 @@ bool slang_process(
          ps->set_common_options(options);
          vs->set_common_options(options);
 
-         vs_code = vs->compile();
-         ps_code = ps->compile();
+         *vs_code = vs->compile();
+         *ps_code = ps->compile();
       }
       else
-         goto error;
+         goto end;
 
-      pass.source.string.vertex   = strdup(vs_code.c_str());
-      pass.source.string.fragment = strdup(ps_code.c_str());
-
-      if (!slang_process_reflection(
-                vs_compiler, ps_compiler,
-                vs_resources, ps_resources, shader_info, pass_number,
-                semantics_map, out))
-         goto error;
+      if (!slang_reflect(*vs_compiler, *ps_compiler,
+               vs_resources, ps_resources, sl_reflection))
+      {
+         RARCH_ERR("[slang]: Failed to reflect SPIR-V."
+               " Resource usage is inconsistent with "
+               "expectations.\n");
+         goto end;
+      }
 
+      ret = true;
    }
    catch (const std::exception& e)
    {
       RARCH_ERR("[slang]: SPIRV-Cross threw exception: %s.\n", e.what());
-      goto error;
    }
 
+end:
    delete vs_compiler;
    delete ps_compiler;
 
-   return true;
+   return ret;
+}
+
+bool slang_process(
+      video_shader*          shader_info,
+      unsigned               pass_number,
+      enum rarch_shader_type dst_type,
+      unsigned               version,
+      const semantics_map_t* semantics_map,
+      pass_semantics_t*      out)
+{
+   string             key;
+   string             vs_code;
+   string             ps_code;
+   vector<uint8_t>    cached;
+   glslang_output     output;
+   slang_process_maps maps;
+   slang_reflection   sl_reflection;
+   bool               loaded      = false;
+   video_shader_pass& pass        = shader_info->pass[pass_number];
+   string             material    = string("cross") + '\0';
+
+   if (!glslang_compile_shader(pass.source.path, &output))
+      return false;
+
+   if (!slang_preprocess_parse_parameters(output.meta, shader_info))
+      return false;
+
+   if (!*pass.alias && !output.meta.name.empty())
+      strlcpy(pass.alias, output.meta.name.c_str(), sizeof(pass.alias) - 1);
 
-error:
-   free(pass.source.string.vertex);
-   free(pass.source.string.fragment);
+   out->format = output.meta.rt_format;
+
+   if (out->format == SLANG_FORMAT_UNKNOWN)
+   {
+      if (pass.fbo.srgb_fbo)
+         out->format = SLANG_FORMAT_R8G8B8A8_SRGB;
+      else if (pass.fbo.fp_fbo)
+         out->format = SLANG_FORMAT_R16G16B16A16_SFLOAT;
+      else
+         out->format = SLANG_FORMAT_R8G8B8A8_UNORM;
+   }
 
    pass.source.string.vertex   = NULL;
    pass.source.string.fragment = NULL;
 
-   delete vs_compiler;
-   delete ps_compiler;
+   if (!slang_process_init_maps(shader_info, pass_number,
+            &maps, &sl_reflection))
+      return false;
+
+   /* The cross-compiled code and the reflection only depend on
+    * the SPIR-V, the target and the semantic names in use. */
+   slang_cache_key_spirv_cross(&material);
+   slang_cache_key_words(&material, output.vertex);
+   slang_cache_key_words(&material, output.fragment);
+   material += to_string((int)dst_type) + ' ' + to_string(version)
+      + ' ' + to_string((int)shader_info->type) + '\0';
+   slang_cache_key_semantic_maps(&material, sl_reflection);
+   key = slang_cache_key(material);
+
+   if (slang_cache_load(key, "cross", &cached))
+   {
+      slang_cache_reader reader;
+      slang_reflection   cached_reflection = sl_reflection;
+
+      reader.data = cached.data();
+      reader.size = cached.size();
 
-   return false;
+      if (     reader.str(&vs_code)
+            && reader.str(&ps_code)
+            && slang_cache_get_reflection(&reader, &cached_reflection))
+      {
+         sl_reflection = cached_reflection;
+         loaded        = true;
+      }
+   }
+
+   if (!loaded)
+   {
+      slang_cache_writer writer;
+
+      if (!slang_process_compile(output, shader_info, dst_type, version,
+               &sl_reflection, &vs_code, &ps_code))
+         return false;
+
+      writer.str(vs_code);
+      writer.str(ps_code);
+      slang_cache_put_reflection(&writer, sl_reflection);
+      slang_cache_store(key, "cross", writer.data);
+   }
+
+   if (!slang_process_reflection(sl_reflection, shader_info,
+            pass_number, semantics_map, out))
+      return false;
+
+   pass.source.string.vertex   = strdup(vs_code.c_str());
+   pass.source.string.fragment = strdup(ps_code.c_str());
+
+   return true;
 }
@@ -15,11 +15,18 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+
+#include <encodings/utf.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "font_driver.h"
 #include "video_thread_wrapper.h"
 
@@ -915,6 +922,18 @@ static char* font_driver_reshape_msg(const char* msg)
 
    return (char*)buffer;
 }
+
+/* Reshaping leaves strings without right-to-left text as they are. */
+static bool font_driver_has_rtl(const char *msg)
+{
+   const unsigned char *src = (const unsigned char*)msg;
+
+   for (; *src; src++)
+      if (IS_RTL(src))
+         return true;
+
+   return false;
+}
 #endif
 
 void font_driver_render_msg(
@@ -929,7 +948,8 @@ void font_driver_render_msg(
    if (msg && *msg && font && font->renderer && font->renderer->render_msg)
    {
 #ifdef HAVE_LANGEXTRA
-      char *new_msg = font_driver_reshape_msg(msg);
+      bool reshape  = font_driver_has_rtl(msg);
+      char *new_msg = reshape ? font_driver_reshape_msg(msg) : (char*)msg;
 #else
       char *new_msg = (char*)msg;
 #endif
@@ -937,7 +957,8 @@ void font_driver_render_msg(
       font->renderer->render_msg(video_info,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
-      free(new_msg);
+      if (reshape)
+         free(new_msg);
 #endif
    }
 }
@@ -1049,3 +1070,259 @@ void font_driver_free_osd(void)
 
    video_font_driver = NULL;
 }
+
+#define FONT_RUN_CACHE_BUCKETS     256
+#define FONT_RUN_CACHE_MAX_ENTRIES 1024
+
+struct font_run_entry
+{
+   struct font_run_entry *next;
+   uint32_t hash;
+   unsigned len;
+   unsigned generation;
+   font_run_t run;
+   char msg[1];
+};
+
+struct font_run_cache
+{
+   const font_renderer_driver_t *font_driver;
+   void *font_data;
+   struct font_run_entry *buckets[FONT_RUN_CACHE_BUCKETS];
+   unsigned count;
+   unsigned generation;
+   unsigned atlas_generation;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+};
+
+static uint32_t font_run_cache_hash(const char *msg, unsigned len)
+{
+   unsigned i;
+   uint32_t hash = 5381;
+
+   for (i = 0; i < len; i++)
+      hash = (hash << 5) + hash + (unsigned char)msg[i];
+
+   return hash;
+}
+
+/* Drops the entries which were not used since the last sweep, or
+ * all of them when 'all' is set. */
+static void font_run_cache_sweep(font_run_cache_t *cache, bool all)
+{
+   unsigned i;
+
+   for (i = 0; i < FONT_RUN_CACHE_BUCKETS; i++)
+   {
+      struct font_run_entry **prev = &cache->buckets[i];
+
+      while (*prev)
+      {
+         struct font_run_entry *entry = *prev;
+
+         if (!all && entry->generation == cache->generation)
+         {
+            prev = &entry->next;
+            continue;
+         }
+
+         *prev = entry->next;
+         free(entry->run.glyphs);
+         free(entry);
+         cache->count--;
+      }
+   }
+
+   cache->generation++;
+}
+
+static bool font_run_cache_layout(font_run_cache_t *cache,
+      font_run_t *run, const char *msg, unsigned len)
+{
+   const char *msg_end = msg + len;
+   int x               = 0;
+   int y               = 0;
+
+   run->count  = 0;
+   run->width  = 0;
+   run->height = 0;
+   /* Never more glyphs than bytes. */
+   run->glyphs = (struct font_run_glyph*)
+      malloc((len ? len : 1) * sizeof(*run->glyphs));
+
+   if (!run->glyphs)
+      return false;
+
+   while (msg < msg_end)
+   {
+      struct font_run_glyph *out     = NULL;
+      unsigned code                  = utf8_walk(&msg);
+      const struct font_glyph *glyph = cache->font_driver->get_glyph(
+            cache->font_data, code);
+
+      if (!glyph) /* Do something smarter here ... */
+         glyph = cache->font_driver->get_glyph(cache->font_data, '?');
+      if (!glyph)
+         continue;
+
+      out          = &run->glyphs[run->count++];
+      out->x       = x + glyph->draw_offset_x;
+      out->y       = y + glyph->draw_offset_y;
+      out->width   = glyph->width;
+      out->height  = glyph->height;
+      out->atlas_x = glyph->atlas_offset_x;
+      out->atlas_y = glyph->atlas_offset_y;
+
+      x           += glyph->advance_x;
+      y           += glyph->advance_y;
+   }
+
+   run->width  = x;
+   run->height = y;
+
+   return true;
+}
+
+font_run_cache_t *font_run_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data)
+{
+   font_run_cache_t *cache = NULL;
+
+   if (!font_driver || !font_driver->get_glyph || !font_data)
+      return NULL;
+
+   cache = (font_run_cache_t*)calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   cache->font_driver = font_driver;
+   cache->font_data   = font_data;
+
+   if (font_driver->get_atlas)
+      cache->atlas_generation =
+         font_driver->get_atlas(font_data)->generation;
+
+#ifdef HAVE_THREADS
+   cache->lock        = slock_new();
+#endif
+
+   return cache;
+}
+
+void font_run_cache_free(font_run_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   font_run_cache_sweep(cache, true);
+#ifdef HAVE_THREADS
+   slock_free(cache->lock);
+#endif
+   free(cache);
+}
+
+void font_run_cache_lock(font_run_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_lock(cache->lock);
+#endif
+}
+
+void font_run_cache_unlock(font_run_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(cache->lock);
+#endif
+}
+
+const font_run_t *font_run_cache_get(font_run_cache_t *cache,
+      const char *msg, unsigned len)
+{
+   struct font_run_entry *entry = NULL;
+   uint32_t hash                = font_run_cache_hash(msg, len);
+   unsigned bucket              = hash & (FONT_RUN_CACHE_BUCKETS - 1);
+
+   if (cache->font_driver->get_atlas)
+   {
+      unsigned generation =
+         cache->font_driver->get_atlas(cache->font_data)->generation;
+
+      if (generation != cache->atlas_generation)
+      {
+         font_run_cache_sweep(cache, true);
+         cache->atlas_generation = generation;
+      }
+   }
+
+   for (entry = cache->buckets[bucket]; entry; entry = entry->next)
+   {
+      if (     entry->hash == hash
+            && entry->len  == len
+            && !memcmp(entry->msg, msg, len))
+      {
+         entry->generation = cache->generation;
+         return &entry->run;
+      }
+   }
+
+   if (cache->count >= FONT_RUN_CACHE_MAX_ENTRIES)
+   {
+      font_run_cache_sweep(cache, false);
+
+      /* Everything is in use, start over. */
+      if (cache->count >= FONT_RUN_CACHE_MAX_ENTRIES / 2)
+         font_run_cache_sweep(cache, true);
+   }
+
+   entry = (struct font_run_entry*)malloc(sizeof(*entry) + len);
+
+   if (!entry)
+      return NULL;
+
+   if (!font_run_cache_layout(cache, &entry->run, msg, len))
+   {
+      free(entry);
+      return NULL;
+   }
+
+   /* Laying out may have reused atlas slots for new glyphs. */
+   if (cache->font_driver->get_atlas)
+   {
+      unsigned generation =
+         cache->font_driver->get_atlas(cache->font_data)->generation;
+
+      if (generation != cache->atlas_generation)
+      {
+         font_run_cache_sweep(cache, true);
+         cache->atlas_generation = generation;
+      }
+   }
+
+   memcpy(entry->msg, msg, len);
+   entry->msg[len]          = '\0';
+   entry->hash              = hash;
+   entry->len               = len;
+   entry->generation        = cache->generation;
+   entry->next              = cache->buckets[bucket];
+   cache->buckets[bucket]   = entry;
+   cache->count++;
+
+   return &entry->run;
+}
+
+int font_run_cache_get_width(font_run_cache_t *cache,
+      const char *msg, unsigned len)
+{
+   int width            = 0;
+   const font_run_t *run = NULL;
+
+   font_run_cache_lock(cache);
+   if ((run = font_run_cache_get(cache, msg, len)))
+      width = run->width;
+   font_run_cache_unlock(cache);
+
+   return width;
+}
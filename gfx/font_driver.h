@@ -59,6 +59,9 @@ struct font_atlas
    unsigned width;
    unsigned height;
    bool dirty;
+   /* Bumped whenever a glyph slot is reused, glyphs returned
+    * before may have moved. */
+   unsigned generation;
 };
 
 struct font_params
@@ -123,6 +126,53 @@ typedef struct
    float size;
 } font_data_t;
 
+/* A glyph of a laid out run, in unscaled font pixels relative to
+ * the pen position at the start of the run. */
+struct font_run_glyph
+{
+   int x;
+   int y;
+   unsigned width;
+   unsigned height;
+   unsigned atlas_x;
+   unsigned atlas_y;
+};
+
+typedef struct font_run
+{
+   struct font_run_glyph *glyphs;
+   unsigned count;
+   /* Sum of the glyph advances. */
+   int width;
+   int height;
+} font_run_t;
+
+typedef struct font_run_cache font_run_cache_t;
+
+/* Caches the glyph runs of the strings drawn with a font renderer,
+ * so that text which did not change is not decoded and looked up
+ * glyph by glyph again on every frame. Runs are dropped when the
+ * atlas reuses a glyph slot, and entries which were not used since
+ * the last sweep are dropped when the cache fills up. */
+font_run_cache_t *font_run_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data);
+
+void font_run_cache_free(font_run_cache_t *cache);
+
+/* Locks the cache, runs returned by font_run_cache_get stay valid
+ * until it is unlocked. Fonts can be measured and drawn from
+ * different threads when video is threaded. */
+void font_run_cache_lock(font_run_cache_t *cache);
+
+void font_run_cache_unlock(font_run_cache_t *cache);
+
+const font_run_t *font_run_cache_get(font_run_cache_t *cache,
+      const char *msg, unsigned len);
+
+/* Width of a string in unscaled font pixels. */
+int font_run_cache_get_width(font_run_cache_t *cache,
+      const char *msg, unsigned len);
+
 /* font_path can be NULL for default font. */
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
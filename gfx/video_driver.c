@@ -65,6 +65,7 @@
 #include "../core.h"
 #include "../command.h"
 #include "../msg_hash.h"
+#include "../performance_counters.h"
 #include "../verbosity.h"
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
@@ -234,6 +235,11 @@ static bool video_started_fullscreen                     = false;
 static shader_backend_t *current_shader                  = NULL;
 static void *current_shader_data                         = NULL;
 
+/* Settings part of video_frame_info, see video_driver_build_info. */
+static video_frame_info_t video_driver_info_cache;
+static unsigned video_driver_info_cache_version          = 0;
+static bool video_driver_info_cache_valid                = false;
+
 struct aspect_ratio_elem aspectratio_lut[ASPECT_RATIO_END] = {
    { "4:3",           1.3333f },
    { "16:9",          1.7778f },
@@ -948,6 +954,8 @@ static bool video_driver_init_internal(bool *video_is_threaded)
    settings_t *settings                   = config_get_ptr();
    struct retro_game_geometry *geom       = &video_driver_av_info.geometry;
 
+   video_driver_info_cache_valid          = false;
+
    if (!string_is_empty(settings->paths.path_softfilter_plugin))
       video_driver_init_filter(video_driver_pix_fmt);
 
@@ -2401,20 +2409,27 @@ void video_driver_frame(const void *data, unsigned width,
 {
    static char video_driver_msg[256];
    static char title[256];
+   static char fps_text[128];
+   static struct retro_perf_counter video_perf_frame;
    video_frame_info_t video_info;
    static retro_time_t curr_time;
    static retro_time_t fps_time;
-   static float last_fps, frame_time;
+   static float last_fps, frame_time, fps_text_value;
    unsigned output_width                             = 0;
    unsigned output_height                            = 0;
    unsigned output_pitch                             = 0;
    const char *msg                                   = NULL;
+   bool perfcnt                                      = false;
    retro_time_t        new_time                      =
       cpu_features_get_time_usec();
 
    if (!video_driver_active)
       return;
 
+   perfcnt = rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL);
+   performance_counter_init(video_perf_frame, "video_driver_frame");
+   performance_counter_start_plus(perfcnt, video_perf_frame);
+
    if (video_driver_scaler_ptr && data &&
          (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555) &&
          (data != RETRO_HW_FRAME_BUFFER_VALID))
@@ -2492,11 +2507,15 @@ void video_driver_frame(const void *data, unsigned width,
                   msg_hash_to_str(MSG_FRAMES),
                   (uint64_t)video_driver_frame_count);
          else
-            snprintf(
-                  video_info.fps_text,
-                  sizeof(video_info.fps_text),
-                  "FPS: %6.1f",
-                  last_fps);
+         {
+            /* Only changes every FPS_UPDATE_INTERVAL frames. */
+            if (last_fps != fps_text_value || !*fps_text)
+            {
+               snprintf(fps_text, sizeof(fps_text), "FPS: %6.1f", last_fps);
+               fps_text_value = last_fps;
+            }
+            strlcpy(video_info.fps_text, fps_text, sizeof(video_info.fps_text));
+         }
       }
    }
    else
@@ -2647,6 +2666,8 @@ void video_driver_frame(const void *data, unsigned width,
       video_driver_crt_switching_active = false;
 
    /* trigger set resolution*/
+
+   performance_counter_stop_plus(perfcnt, video_perf_frame);
 }
 
 void video_driver_display_type_set(enum rarch_display_type type)
@@ -2722,22 +2743,11 @@ static bool video_driver_cb_set_coords(void *handle_data,
    return true;
 }
 
-void video_driver_build_info(video_frame_info_t *video_info)
+/* Copies the settings used by the video drivers into the
+ * cached video_frame_info, see video_driver_build_info. */
+static void video_driver_build_info_settings(video_frame_info_t *video_info,
+      settings_t *settings)
 {
-   bool is_perfcnt_enable            = false;
-   bool is_paused                    = false;
-   bool is_idle                      = false;
-   bool is_slowmotion                = false;
-   settings_t *settings              = NULL;
-   video_viewport_t *custom_vp       = NULL;
-   struct retro_hw_render_callback *hwr =
-      video_driver_get_hw_context();
-#ifdef HAVE_THREADS
-   bool is_threaded                  = video_driver_is_threaded_internal();
-   video_driver_threaded_lock(is_threaded);
-#endif
-   settings                          = config_get_ptr();
-   custom_vp                         = &settings->video_viewport_custom;
    video_info->refresh_rate          = settings->floats.video_refresh_rate;
    video_info->crt_switch_resolution = settings->uints.crt_switch_resolution;
    video_info->crt_switch_resolution_super = settings->uints.crt_switch_resolution_super;
@@ -2754,12 +2764,7 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->input_menu_swap_ok_cancel_buttons    = settings->bools.input_menu_swap_ok_cancel_buttons;
    video_info->max_swapchain_images  = settings->uints.video_max_swapchain_images;
    video_info->windowed_fullscreen   = settings->bools.video_windowed_fullscreen;
-   video_info->fullscreen            = settings->bools.video_fullscreen || retroarch_is_forced_fullscreen();
    video_info->monitor_index         = settings->uints.video_monitor_index;
-   video_info->shared_context        = settings->bools.video_shared_context;
-
-   if (libretro_get_shared_context() && hwr && hwr->context_type != RETRO_HW_CONTEXT_NONE)
-      video_info->shared_context     = true;
 
    video_info->font_enable           = settings->bools.video_font_enable;
    video_info->font_msg_pos_x        = settings->floats.video_msg_pos_x;
@@ -2767,25 +2772,10 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->font_msg_color_r      = settings->floats.video_msg_color_r;
    video_info->font_msg_color_g      = settings->floats.video_msg_color_g;
    video_info->font_msg_color_b      = settings->floats.video_msg_color_b;
-   video_info->custom_vp_x           = custom_vp->x;
-   video_info->custom_vp_y           = custom_vp->y;
-   video_info->custom_vp_width       = custom_vp->width;
-   video_info->custom_vp_height      = custom_vp->height;
-   video_info->custom_vp_full_width  = custom_vp->full_width;
-   video_info->custom_vp_full_height = custom_vp->full_height;
-
-   video_info->fps_text[0]           = '\0';
 
-   video_info->width                 = video_driver_width;
-   video_info->height                = video_driver_height;
-
-   video_info->use_rgba              = video_driver_use_rgba;
-
-   video_info->libretro_running       = false;
    video_info->msg_bgcolor_enable     = settings->bools.video_msg_bgcolor_enable;
 
 #ifdef HAVE_MENU
-   video_info->menu_is_alive          = menu_driver_is_alive();
    video_info->menu_footer_opacity    = settings->floats.menu_footer_opacity;
    video_info->menu_header_opacity    = settings->floats.menu_header_opacity;
    video_info->materialui_color_theme = settings->uints.menu_materialui_color_theme;
@@ -2799,10 +2789,7 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->xmb_alpha_factor       = settings->uints.menu_xmb_alpha_factor;
    video_info->menu_wallpaper_opacity   = settings->floats.menu_wallpaper_opacity;
    video_info->menu_framebuffer_opacity = settings->floats.menu_framebuffer_opacity;
-
-   video_info->libretro_running       = core_is_game_loaded();
 #else
-   video_info->menu_is_alive          = false;
    video_info->menu_footer_opacity    = 0.0f;
    video_info->menu_header_opacity    = 0.0f;
    video_info->materialui_color_theme = 0;
@@ -2816,6 +2803,71 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->menu_framebuffer_opacity = 0.0f;
    video_info->menu_wallpaper_opacity = 0.0f;
 #endif
+}
+
+/**
+ * video_driver_build_info:
+ * @video_info                     : Frame info to fill in.
+ *
+ * The fields taken from the settings are only copied again when
+ * settings->version has changed since the last call, everything
+ * else is refreshed on every call.
+ **/
+void video_driver_build_info(video_frame_info_t *video_info)
+{
+   bool is_perfcnt_enable            = false;
+   bool is_paused                    = false;
+   bool is_idle                      = false;
+   bool is_slowmotion                = false;
+   settings_t *settings              = NULL;
+   video_viewport_t *custom_vp       = NULL;
+   struct retro_hw_render_callback *hwr =
+      video_driver_get_hw_context();
+#ifdef HAVE_THREADS
+   bool is_threaded                  = video_driver_is_threaded_internal();
+   video_driver_threaded_lock(is_threaded);
+#endif
+   settings                          = config_get_ptr();
+
+   if (     !video_driver_info_cache_valid
+         || settings->version != video_driver_info_cache_version)
+   {
+      video_driver_build_info_settings(&video_driver_info_cache, settings);
+      video_driver_info_cache_valid   = true;
+      video_driver_info_cache_version = settings->version;
+   }
+
+   *video_info                       = video_driver_info_cache;
+
+   custom_vp                         = &settings->video_viewport_custom;
+   video_info->fullscreen            = settings->bools.video_fullscreen || retroarch_is_forced_fullscreen();
+   video_info->shared_context        = settings->bools.video_shared_context;
+
+   if (libretro_get_shared_context() && hwr && hwr->context_type != RETRO_HW_CONTEXT_NONE)
+      video_info->shared_context     = true;
+
+   /* The custom viewport is edited in place. */
+   video_info->custom_vp_x           = custom_vp->x;
+   video_info->custom_vp_y           = custom_vp->y;
+   video_info->custom_vp_width       = custom_vp->width;
+   video_info->custom_vp_height      = custom_vp->height;
+   video_info->custom_vp_full_width  = custom_vp->full_width;
+   video_info->custom_vp_full_height = custom_vp->full_height;
+
+   video_info->fps_text[0]           = '\0';
+
+   video_info->width                 = video_driver_width;
+   video_info->height                = video_driver_height;
+
+   video_info->use_rgba              = video_driver_use_rgba;
+
+#ifdef HAVE_MENU
+   video_info->menu_is_alive          = menu_driver_is_alive();
+   video_info->libretro_running       = core_is_game_loaded();
+#else
+   video_info->menu_is_alive          = false;
+   video_info->libretro_running       = false;
+#endif
 
    runloop_get_status(&is_paused, &is_idle, &is_slowmotion, &is_perfcnt_enable);
 
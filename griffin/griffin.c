@@ -174,6 +174,7 @@ ACHIEVEMENTS
 #include "../cheevos/badges.c"
 #include "../cheevos/cond.c"
 #include "../cheevos/var.c"
+#include "../cheevos/program.c"
 #endif
 
 #endif
@@ -694,6 +695,7 @@ STATE TRACKER
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -872,6 +874,7 @@ FILTERS
 #include "../libretro-common/audio/dsp_filters/echo.c"
 #include "../libretro-common/audio/dsp_filters/eq.c"
 #include "../libretro-common/audio/dsp_filters/chorus.c"
+#include "../libretro-common/audio/dsp_filters/convolution.c"
 #include "../libretro-common/audio/dsp_filters/iir.c"
 #include "../libretro-common/audio/dsp_filters/panning.c"
 #include "../libretro-common/audio/dsp_filters/phaser.c"
@@ -940,6 +943,7 @@ CONFIGURATION
 STATE MANAGER
 ============================================================ */
 #include "../managers/state_manager.c"
+#include "../managers/state_diff.c"
 
 /*============================================================
 FRONTEND
@@ -1150,6 +1154,7 @@ DATA RUNLOOP
 #ifdef HAVE_LIBRETRODB
 #include "../tasks/task_database.c"
 #include "../tasks/task_database_cue.c"
+#include "../tasks/task_database_cache.c"
 #endif
 
 /*============================================================
@@ -1201,6 +1206,7 @@ MENU
 #include "../menu/menu_shader.c"
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_animation.c"
+#include "../menu/menu_thumbnail_cache.c"
 
 #include "../menu/drivers/null.c"
 #include "../menu/drivers/menu_generic.c"
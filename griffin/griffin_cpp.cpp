@@ -86,6 +86,7 @@ VIDEO DRIVER
 #include "../gfx/drivers_shader/slang_preprocess.cpp"
 #include "../gfx/drivers_shader/slang_process.cpp"
 #include "../gfx/drivers_shader/slang_reflection.cpp"
+#include "../gfx/drivers_shader/slang_cache.cpp"
 #endif
 #endif
 
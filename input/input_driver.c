@@ -57,6 +57,7 @@
 #include "../file_path_special.h"
 #include "../driver.h"
 #include "../retroarch.h"
+#include "../performance_counters.h"
 #include "../movie.h"
 #include "../list_special.h"
 #include "../verbosity.h"
@@ -591,8 +592,13 @@ float input_sensor_get_input(unsigned port, unsigned id)
 void input_poll(void)
 {
    size_t i;
+   static struct retro_perf_counter input_perf_poll;
    settings_t *settings           = config_get_ptr();
    uint8_t max_users              = (uint8_t)input_driver_max_users;
+   bool perfcnt                   = rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL);
+
+   performance_counter_init(input_perf_poll, "input_poll");
+   performance_counter_start_plus(perfcnt, input_perf_poll);
 
    current_input->poll(current_input_data);
 
@@ -602,9 +608,7 @@ void input_poll(void)
       input_driver_turbo_btns.frame_enable[i] = 0;
 
    if (input_driver_block_libretro_input)
-      return;
-
-
+      goto end;
 
    for (i = 0; i < max_users; i++)
    {
@@ -642,6 +646,9 @@ void input_poll(void)
    if (input_driver_remote)
       input_remote_poll(input_driver_remote, max_users);
 #endif
+
+end:
+   performance_counter_stop_plus(perfcnt, input_perf_poll);
 }
 
 /**
@@ -60,6 +60,8 @@ MSG_HASH(MENU_ENUM_LABEL_AUDIO_SETTINGS,
       "audio_settings")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_SYNC,
       "audio_sync")
+MSG_HASH(MENU_ENUM_LABEL_AUDIO_PIPELINE_ENABLE,
+      "audio_pipeline_enable")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_VOLUME,
       "audio_volume")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE,
@@ -201,6 +203,8 @@ MSG_HASH(MENU_ENUM_LABEL_CONTENT_HISTORY_SIZE,
       "content_history_size")
 MSG_HASH(MENU_ENUM_LABEL_PLAYLIST_ENTRY_REMOVE,
       "playlist_entry_remove")
+MSG_HASH(MENU_ENUM_LABEL_PLAYLIST_COMPACT_FORMAT,
+      "playlist_compact_format")
 MSG_HASH(MENU_ENUM_LABEL_CONTENT_SETTINGS,
       "quick_menu")
 MSG_HASH(MENU_ENUM_LABEL_CORE_ASSETS_DIRECTORY,
@@ -975,6 +979,8 @@ MSG_HASH(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,
       "rewind_buffer_size")
 MSG_HASH(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
       "rewind_buffer_size_step")
+MSG_HASH(MENU_ENUM_LABEL_REWIND_BLOCK_DEDUP,
+      "rewind_block_dedup")
 MSG_HASH(MENU_ENUM_LABEL_REWIND_SETTINGS,
       "rewind_settings")
 MSG_HASH(MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,
@@ -1061,6 +1067,8 @@ MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,
       "run_ahead_enabled")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,
       "run_ahead_secondary_instance")
+MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_STATE_POOL,
+      "run_ahead_state_pool")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
       "run_ahead_hide_warnings")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
@@ -1103,10 +1111,16 @@ MSG_HASH(MENU_ENUM_LABEL_TAKE_SCREENSHOT,
       "take_screenshot")
 MSG_HASH(MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_ENABLE,
       "threaded_data_runloop_enable")
+MSG_HASH(MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_WORKERS,
+      "threaded_data_runloop_workers")
 MSG_HASH(MENU_ENUM_LABEL_THUMBNAILS,
       "thumbnails")
 MSG_HASH(MENU_ENUM_LABEL_LEFT_THUMBNAILS,
       "left thumbnails")
+MSG_HASH(MENU_ENUM_LABEL_THUMBNAIL_CACHE_SIZE,
+      "menu_thumbnail_cache_size")
+MSG_HASH(MENU_ENUM_LABEL_THUMBNAIL_PREFETCH,
+      "menu_thumbnail_prefetch")
 MSG_HASH(MENU_ENUM_LABEL_XMB_VERTICAL_THUMBNAILS,
       "xmb_vertical_thumbnails")
 MSG_HASH(MENU_ENUM_LABEL_THUMBNAILS_DIRECTORY,
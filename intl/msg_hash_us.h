@@ -339,6 +339,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_SYNC,
     "Audio Sync"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_AUDIO_PIPELINE_ENABLE,
+    "Threaded Audio Processing"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_VOLUME,
     "Audio Volume Level (dB)"
@@ -595,6 +599,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_PLAYLIST_ENTRY_REMOVE,
     "Allow to remove entries"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_PLAYLIST_COMPACT_FORMAT,
+    "Compact Playlist Format"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_CONTENT_SETTINGS,
     "Quick Menu"
@@ -2306,6 +2314,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_REWIND_BUFFER_SIZE_STEP,
     "Rewind Buffer Size Step (MB)"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_REWIND_BLOCK_DEDUP,
+    "Rewind Block Deduplication"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_REWIND_SETTINGS,
     "Rewind"
@@ -2506,6 +2518,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_INSTANCE,
     "RunAhead Use Second Instance"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_STATE_POOL,
+    "RunAhead Reuse Predicted Frames"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_RUN_AHEAD_HIDE_WARNINGS,
     "RunAhead Hide Warnings"
@@ -2874,6 +2890,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_THREADED_DATA_RUNLOOP_ENABLE,
     "Threaded tasks"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_THREADED_DATA_RUNLOOP_WORKERS,
+    "Threaded tasks workers"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_THUMBNAILS,
     "Thumbnails"
@@ -2882,6 +2902,14 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_LEFT_THUMBNAILS,
     "Left Thumbnails"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_THUMBNAIL_CACHE_SIZE,
+    "Thumbnail Cache Size (MB)"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_THUMBNAIL_PREFETCH,
+    "Thumbnail Prefetch"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_XMB_VERTICAL_THUMBNAILS,
     "Thumbnails Vertical Disposition"
@@ -4582,6 +4610,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_AUDIO_SYNC,
     "Synchronize audio. Recommended."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_AUDIO_PIPELINE_ENABLE,
+    "Run DSP filters, resampling and mixing on a separate thread. Frees up time on the emulation thread at the cost of a little added latency."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD,
     "How far an axis must be tilted to result in a button press."
@@ -4984,6 +5016,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE,
     "Use a second instance of the RetroArch core to run ahead. Prevents audio problems due to loading state."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_RUN_AHEAD_STATE_POOL,
+    "Keep the state of the last shown frame and reuse it while input does not change. Only one frame is run ahead per frame instead of all of them."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
     "Hides the warning message that appears when using RunAhead and the core does not support savestates."
@@ -5024,6 +5060,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
     "Each time you increase or decrease the rewind buffer size value via this UI it will change by this amount"
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_REWIND_BLOCK_DEDUP,
+    "Store rewind states as blocks shared between frames, processed on a background thread. Lowers the per-frame cost for cores with large savestates."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_CHEAT_IDX,
     "Index position in list."
@@ -5305,6 +5345,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_LEFT_THUMBNAILS,
     "Type of thumbnail to display at the left."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_THUMBNAIL_CACHE_SIZE,
+    "Amount of video memory used to keep recently shown thumbnails loaded."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_THUMBNAIL_PREFETCH,
+    "Number of playlist entries above and below the selection whose thumbnails are loaded ahead of time."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_XMB_VERTICAL_THUMBNAILS,
     "Display the left thumbnail under the right one, on the right side of the screen."
@@ -5517,10 +5565,18 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_ENABLE,
     "Perform tasks on a separate thread."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_WORKERS,
+    "Number of threads performing tasks. 0 picks one based on the number of CPU cores."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_REMOVE,
     "Allow the user to remove entries from collections."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_PLAYLIST_COMPACT_FORMAT,
+    "Save playlists in a binary format which loads faster. Other programs might not be able to read it."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_SYSTEM_DIRECTORY,
     "Sets the System directory. Cores can query for this directory to load BIOSes, system-specific configs, etc."
@@ -25,6 +25,8 @@
 
 #include <formats/rwav.h>
 #include <memalign.h>
+#include <queues/spsc_queue.h>
+#include <streams/file_stream.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -65,10 +67,24 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Streamed sounds: bytes read from the file at once, and
+ * decoded samples kept ready per voice (about 0.35s at 48kHz). */
+#define AUDIO_MIXER_STREAM_READ_SIZE  (16 * 1024)
+#define AUDIO_MIXER_STREAM_BUFFER     (32 * 1024)
+#define AUDIO_MIXER_STREAM_MIN_WRITE  (AUDIO_MIXER_TEMP_BUFFER / 2)
+/* A voice starts playing once this many samples are decoded. */
+#define AUDIO_MIXER_STREAM_START      AUDIO_MIXER_TEMP_BUFFER
+#define AUDIO_MIXER_STREAM_EVENTS     16
+#define AUDIO_MIXER_STREAM_POLL_US    10000
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
 
+   /* Set if the sound is decoded from the file while
+    * it plays instead of being held in memory. */
+   char *path;
+
    union
    {
       struct
@@ -116,6 +132,85 @@ struct audio_mixer_sound
    } types;
 };
 
+typedef struct audio_mixer_event
+{
+   uint64_t position;
+   unsigned reason;
+} audio_mixer_event_t;
+
+typedef struct audio_mixer_source audio_mixer_source_t;
+
+/* Decoder for a streamed sound. The decoder thread (or, without
+ * threads, audio_mixer_play() and audio_mixer_mix() themselves)
+ * opens the file, reads it in chunks, decodes and resamples into
+ * the pcm queue. audio_mixer_mix() only ever copies already
+ * decoded samples out of it. */
+struct audio_mixer_source
+{
+   enum audio_mixer_type type;
+   bool repeat;
+
+   /* Decoder side, the file is opened by the first step. */
+   char *path;
+   bool opened;
+   RFILE *file;
+   int64_t file_size;
+   uint8_t *read_buf;
+   /* File offset of read_buf[0]. */
+   int64_t read_offset;
+   size_t read_pos;
+   size_t read_len;
+
+   union
+   {
+#ifdef HAVE_STB_VORBIS
+      stb_vorbis *ogg;
+#endif
+#ifdef HAVE_DR_FLAC
+      drflac *flac;
+#endif
+#ifdef HAVE_DR_MP3
+      drmp3 mp3;
+#endif
+      void *dummy;
+   } decoder;
+   bool decoder_open;
+
+   float ratio;
+   void *resampler_data;
+   const retro_resampler_t *resampler;
+   float *decode_buf;
+   float *resample_buf;
+
+   /* Written by the decoder, read by the mixer. The events
+    * tell at which sample the track started over or ended. */
+   spsc_queue_t *pcm;
+   spsc_queue_t *events;
+
+   /* Decoder side. */
+   uint64_t written;
+   uint64_t loop_start;
+   bool finished;
+
+   /* Mixer side. */
+   uint64_t consumed;
+   audio_mixer_event_t event;
+   bool has_event;
+   bool started;
+
+#ifdef HAVE_THREADS
+   /* Protected by s_source_lock. */
+   bool released;
+   audio_mixer_source_t *next;
+#endif
+};
+
+typedef struct audio_mixer_finished
+{
+   audio_mixer_stop_cb_t stop_cb;
+   audio_mixer_sound_t *sound;
+} audio_mixer_finished_t;
+
 struct audio_mixer_voice
 {
    bool     repeat;
@@ -123,6 +218,8 @@ struct audio_mixer_voice
    float    volume;
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
+   /* Non-NULL if the sound is streamed. */
+   audio_mixer_source_t *source;
 
    union
    {
@@ -189,8 +286,19 @@ struct audio_mixer_voice
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES];
 static unsigned s_rate = 0;
 
+/* Stop callbacks of voices that finished during audio_mixer_mix(),
+ * called once the voices are unlocked again. */
+static audio_mixer_finished_t s_finished[AUDIO_MIXER_MAX_VOICES];
+static unsigned s_finished_count = 0;
+
 #ifdef HAVE_THREADS
 static slock_t* s_locker = NULL;
+
+static sthread_t *s_source_thread          = NULL;
+static slock_t *s_source_lock              = NULL;
+static scond_t *s_source_cond              = NULL;
+static audio_mixer_source_t *s_sources     = NULL;
+static bool s_source_quit                  = false;
 #endif
 
 static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
@@ -306,6 +414,570 @@ static bool one_shot_resample(const float* in, size_t samples_in,
    return true;
 }
 
+static void audio_mixer_source_free(audio_mixer_source_t *source)
+{
+   if (source->decoder_open)
+   {
+      switch (source->type)
+      {
+         case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+            stb_vorbis_close(source->decoder.ogg);
+#endif
+            break;
+         case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+            drflac_close(source->decoder.flac);
+#endif
+            break;
+         case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+            drmp3_uninit(&source->decoder.mp3);
+#endif
+            break;
+         default:
+            break;
+      }
+   }
+
+   if (source->resampler && source->resampler_data)
+      source->resampler->free(source->resampler_data);
+
+   memalign_free(source->decode_buf);
+   memalign_free(source->resample_buf);
+   spsc_free(source->pcm);
+   spsc_free(source->events);
+   free(source->read_buf);
+
+   if (source->file)
+      filestream_close(source->file);
+
+   free(source->path);
+   free(source);
+}
+
+/* The decoders read the file through a small buffer.
+ * The file position is always read_offset + read_len. */
+static size_t audio_mixer_source_read(void *data, void *out, size_t size)
+{
+   audio_mixer_source_t *source = (audio_mixer_source_t*)data;
+   uint8_t *out_buf             = (uint8_t*)out;
+   size_t total                 = 0;
+
+   while (size)
+   {
+      int64_t got;
+      size_t avail = source->read_len - source->read_pos;
+
+      if (avail)
+      {
+         size_t len = avail < size ? avail : size;
+
+         memcpy(out_buf, source->read_buf + source->read_pos, len);
+         source->read_pos += len;
+         out_buf          += len;
+         total            += len;
+         size             -= len;
+         continue;
+      }
+
+      source->read_offset += source->read_len;
+      source->read_pos     = 0;
+      source->read_len     = 0;
+
+      /* Large reads go straight to the caller. */
+      if (size >= AUDIO_MIXER_STREAM_READ_SIZE)
+      {
+         got = filestream_read(source->file, out_buf, (int64_t)size);
+         if (got <= 0)
+            break;
+
+         source->read_offset += got;
+         out_buf             += got;
+         total               += (size_t)got;
+         size                -= (size_t)got;
+         continue;
+      }
+
+      got = filestream_read(source->file, source->read_buf,
+            AUDIO_MIXER_STREAM_READ_SIZE);
+      if (got <= 0)
+         break;
+
+      source->read_len = (size_t)got;
+   }
+
+   return total;
+}
+
+static bool audio_mixer_source_seek(audio_mixer_source_t *source,
+      int64_t offset)
+{
+   if (     offset >= source->read_offset
+         && offset <= source->read_offset + (int64_t)source->read_len)
+   {
+      source->read_pos = (size_t)(offset - source->read_offset);
+      return true;
+   }
+
+   if (offset < 0 || offset > source->file_size)
+      return false;
+
+   if (filestream_seek(source->file, offset,
+            RETRO_VFS_SEEK_POSITION_START) == -1)
+      return false;
+
+   source->read_offset = offset;
+   source->read_pos    = 0;
+   source->read_len    = 0;
+   return true;
+}
+
+static int64_t audio_mixer_source_tell(audio_mixer_source_t *source)
+{
+   return source->read_offset + (int64_t)source->read_pos;
+}
+
+#ifdef HAVE_STB_VORBIS
+static int audio_mixer_source_seek_ogg(void *data, unsigned int offset)
+{
+   return audio_mixer_source_seek((audio_mixer_source_t*)data, offset);
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static drflac_bool32 audio_mixer_source_seek_flac(void *data,
+      int offset, drflac_seek_origin origin)
+{
+   audio_mixer_source_t *source = (audio_mixer_source_t*)data;
+
+   if (origin == drflac_seek_origin_current)
+      return audio_mixer_source_seek(source,
+            audio_mixer_source_tell(source) + offset);
+   return audio_mixer_source_seek(source, offset);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static drmp3_bool32 audio_mixer_source_seek_mp3(void *data,
+      int offset, drmp3_seek_origin origin)
+{
+   audio_mixer_source_t *source = (audio_mixer_source_t*)data;
+
+   if (origin == drmp3_seek_origin_current)
+      return audio_mixer_source_seek(source,
+            audio_mixer_source_tell(source) + offset);
+   return audio_mixer_source_seek(source, offset);
+}
+#endif
+
+/* Only allocates the queues, the file is opened by
+ * audio_mixer_source_open() on the decoder side. */
+static audio_mixer_source_t *audio_mixer_source_new(
+      const audio_mixer_sound_t *sound, bool repeat)
+{
+   audio_mixer_source_t *source = (audio_mixer_source_t*)
+      calloc(1, sizeof(*source));
+
+   if (!source)
+      return NULL;
+
+   source->type   = sound->type;
+   source->repeat = repeat;
+   source->ratio  = 1.0f;
+   /* The sound can be destroyed while the file is opened. */
+   source->path   = strdup(sound->path);
+   source->pcm    = spsc_new(AUDIO_MIXER_STREAM_BUFFER * sizeof(float));
+   source->events = spsc_new(AUDIO_MIXER_STREAM_EVENTS
+         * sizeof(audio_mixer_event_t));
+
+   if (!source->path || !source->pcm || !source->events)
+   {
+      audio_mixer_source_free(source);
+      return NULL;
+   }
+
+   return source;
+}
+
+static bool audio_mixer_source_open(audio_mixer_source_t *source)
+{
+   unsigned rate  = 0;
+
+   source->opened = true;
+   source->file   = filestream_open(source->path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!source->file)
+      return false;
+
+   source->file_size = filestream_get_size(source->file);
+   source->read_buf  = (uint8_t*)malloc(AUDIO_MIXER_STREAM_READ_SIZE);
+
+   if (!source->read_buf)
+      return false;
+
+   switch (source->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         {
+            stb_vorbis_io io;
+            int res = 0;
+
+            if (source->file_size > 0xFFFFFFFF)
+               return false;
+
+            io.read  = audio_mixer_source_read;
+            io.seek  = audio_mixer_source_seek_ogg;
+            io.user  = source;
+
+            source->decoder.ogg = stb_vorbis_open_io(&io,
+                  (unsigned)source->file_size, &res, NULL);
+            if (!source->decoder.ogg)
+               return false;
+
+            rate = stb_vorbis_get_info(source->decoder.ogg).sample_rate;
+         }
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         source->decoder.flac = drflac_open(audio_mixer_source_read,
+               audio_mixer_source_seek_flac, source);
+         if (!source->decoder.flac)
+            return false;
+
+         rate = source->decoder.flac->sampleRate;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         if (!drmp3_init(&source->decoder.mp3, audio_mixer_source_read,
+                  audio_mixer_source_seek_mp3, source, NULL))
+            return false;
+
+         rate = source->decoder.mp3.sampleRate;
+#endif
+         break;
+      default:
+         break;
+   }
+
+   if (!rate)
+      return false;
+
+   source->decoder_open = true;
+
+   if (rate != s_rate)
+   {
+      source->ratio = (double)s_rate / (double)rate;
+
+      if (!retro_resampler_realloc(&source->resampler_data,
+               &source->resampler, NULL, RESAMPLER_QUALITY_DONTCARE,
+               source->ratio))
+         return false;
+
+      /* One step never writes more than the queue can hold. */
+      source->resample_buf = (float*)memalign_alloc(16,
+            AUDIO_MIXER_STREAM_BUFFER * sizeof(float));
+      if (!source->resample_buf)
+         return false;
+   }
+
+   source->decode_buf = (float*)memalign_alloc(16,
+         AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
+
+   return source->decode_buf != NULL;
+}
+
+static bool audio_mixer_source_rewind(audio_mixer_source_t *source)
+{
+   switch (source->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_seek_start(source->decoder.ogg);
+         return true;
+#else
+         break;
+#endif
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         return drflac_seek_to_sample(source->decoder.flac, 0);
+#else
+         break;
+#endif
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         return drmp3_seek_to_frame(&source->decoder.mp3, 0);
+#else
+         break;
+#endif
+      default:
+         break;
+   }
+
+   return false;
+}
+
+/* Decodes the next chunk of a streamed sound into its queue.
+ * Returns false if the queue is full or the sound has ended. */
+static bool audio_mixer_source_step(audio_mixer_source_t *source)
+{
+   size_t space;
+   size_t out_samples;
+   const float *out        = NULL;
+   unsigned in_samples     = 0;
+   unsigned temp_samples   = 0;
+
+   if (source->finished)
+      return false;
+
+   if (spsc_write_avail(source->events) < sizeof(audio_mixer_event_t))
+      return false;
+
+   /* A track that can not be opened ends right away. */
+   if (!source->opened && !audio_mixer_source_open(source))
+   {
+      audio_mixer_event_t event;
+
+      event.position   = 0;
+      event.reason     = AUDIO_MIXER_SOUND_FINISHED;
+      source->finished = true;
+
+      spsc_write(source->events, &event, sizeof(event));
+      return false;
+   }
+
+   space = spsc_write_avail(source->pcm) / sizeof(float);
+
+   if (space < AUDIO_MIXER_STREAM_MIN_WRITE)
+      return false;
+
+   /* Leave some room for the resampler rounding up. */
+   in_samples = (unsigned)((space - 16) / source->ratio) & ~1;
+   if (in_samples > AUDIO_MIXER_TEMP_BUFFER)
+      in_samples = AUDIO_MIXER_TEMP_BUFFER;
+
+   switch (source->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         temp_samples = stb_vorbis_get_samples_float_interleaved(
+               source->decoder.ogg, 2, source->decode_buf, in_samples) * 2;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         temp_samples = (unsigned)drflac_read_f32(source->decoder.flac,
+               in_samples, source->decode_buf);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         temp_samples = (unsigned)drmp3_read_f32(&source->decoder.mp3,
+               in_samples / 2, source->decode_buf) * 2;
+#endif
+         break;
+      default:
+         break;
+   }
+
+   if (temp_samples == 0)
+   {
+      audio_mixer_event_t event;
+
+      event.position = source->written;
+
+      /* A loop that produced no samples would spin forever. */
+      if (     source->repeat
+            && source->written != source->loop_start
+            && audio_mixer_source_rewind(source))
+      {
+         event.reason       = AUDIO_MIXER_SOUND_REPEATED;
+         source->loop_start = source->written;
+      }
+      else
+      {
+         event.reason       = AUDIO_MIXER_SOUND_FINISHED;
+         source->finished   = true;
+      }
+
+      spsc_write(source->events, &event, sizeof(event));
+      return true;
+   }
+
+   if (source->resampler)
+   {
+      struct resampler_data info;
+
+      info.data_in       = source->decode_buf;
+      info.data_out      = source->resample_buf;
+      info.input_frames  = temp_samples / 2;
+      info.output_frames = 0;
+      info.ratio         = source->ratio;
+
+      source->resampler->process(source->resampler_data, &info);
+
+      out         = source->resample_buf;
+      out_samples = info.output_frames * 2;
+   }
+   else
+   {
+      out         = source->decode_buf;
+      out_samples = temp_samples;
+   }
+
+   if (out_samples > space)
+      out_samples = space;
+
+   spsc_write(source->pcm, out, out_samples * sizeof(float));
+   source->written += out_samples;
+
+   return true;
+}
+
+#ifdef HAVE_THREADS
+static void audio_mixer_source_thread(void *data)
+{
+   (void)data;
+
+   slock_lock(s_source_lock);
+
+   while (!s_source_quit)
+   {
+      audio_mixer_source_t *source   = NULL;
+      audio_mixer_source_t *released = NULL;
+      audio_mixer_source_t **link    = &s_sources;
+      bool busy                      = false;
+
+      while (*link)
+      {
+         source = *link;
+
+         if (source->released)
+         {
+            *link          = source->next;
+            source->next   = released;
+            released       = source;
+         }
+         else
+            link = &source->next;
+      }
+
+      if (released)
+      {
+         slock_unlock(s_source_lock);
+
+         while (released)
+         {
+            source   = released->next;
+            audio_mixer_source_free(released);
+            released = source;
+         }
+
+         slock_lock(s_source_lock);
+         continue;
+      }
+
+      /* Only this thread unlinks sources, so the list
+       * can be walked without holding the lock while
+       * decoding. */
+      for (source = s_sources; source; source = source->next)
+      {
+         slock_unlock(s_source_lock);
+         if (audio_mixer_source_step(source))
+            busy = true;
+         slock_lock(s_source_lock);
+      }
+
+      if (busy || s_source_quit)
+         continue;
+
+      if (s_sources)
+         scond_wait_timeout(s_source_cond, s_source_lock,
+               AUDIO_MIXER_STREAM_POLL_US);
+      else
+         scond_wait(s_source_cond, s_source_lock);
+   }
+
+   slock_unlock(s_source_lock);
+}
+#endif
+
+static audio_mixer_source_t *audio_mixer_play_source(
+      const audio_mixer_sound_t *sound, bool repeat)
+{
+   audio_mixer_source_t *source = audio_mixer_source_new(sound, repeat);
+
+   if (!source)
+      return NULL;
+
+#ifdef HAVE_THREADS
+   /* The decoder thread opens the file, so that starting the next
+    * track from a stop callback does not stall the mixer. */
+   if (s_source_thread)
+   {
+      slock_lock(s_source_lock);
+      source->next = s_sources;
+      s_sources    = source;
+      scond_signal(s_source_cond);
+      slock_unlock(s_source_lock);
+      return source;
+   }
+#endif
+
+   if (!audio_mixer_source_open(source))
+   {
+      audio_mixer_source_free(source);
+      return NULL;
+   }
+
+   /* Have the first samples ready when the voice starts. */
+   audio_mixer_source_step(source);
+
+   return source;
+}
+
+static void audio_mixer_release_source(audio_mixer_source_t *source)
+{
+#ifdef HAVE_THREADS
+   /* The decoder thread might be in the middle of a step. */
+   if (s_source_thread)
+   {
+      slock_lock(s_source_lock);
+      source->released = true;
+      scond_signal(s_source_cond);
+      slock_unlock(s_source_lock);
+      return;
+   }
+#endif
+
+   audio_mixer_source_free(source);
+}
+
+/* Must be called with the voices locked. The stop callback
+ * is called by audio_mixer_mix() once they are unlocked, so
+ * that it can start another sound. */
+static void audio_mixer_voice_finished(audio_mixer_voice_t *voice)
+{
+   if (voice->stop_cb && s_finished_count < AUDIO_MIXER_MAX_VOICES)
+   {
+      s_finished[s_finished_count].stop_cb = voice->stop_cb;
+      s_finished[s_finished_count].sound   = voice->sound;
+      s_finished_count++;
+   }
+
+   voice->type = AUDIO_MIXER_TYPE_NONE;
+
+   if (voice->source)
+   {
+      audio_mixer_release_source(voice->source);
+      voice->source = NULL;
+   }
+}
+
 void audio_mixer_init(unsigned rate)
 {
    unsigned i;
@@ -313,10 +985,25 @@ void audio_mixer_init(unsigned rate)
    s_rate = rate;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      s_voices[i].type   = AUDIO_MIXER_TYPE_NONE;
+      s_voices[i].source = NULL;
+   }
+
+   s_finished_count = 0;
 
 #ifdef HAVE_THREADS
-   s_locker = slock_new();
+   s_locker         = slock_new();
+
+   s_sources        = NULL;
+   s_source_quit    = false;
+   s_source_lock    = slock_new();
+   s_source_cond    = scond_new();
+
+   /* Without the thread, streamed sounds are decoded
+    * by audio_mixer_mix() itself. */
+   if (s_source_lock && s_source_cond)
+      s_source_thread = sthread_create(audio_mixer_source_thread, NULL);
 #endif
 }
 
@@ -325,13 +1012,88 @@ void audio_mixer_done(void)
    unsigned i;
 
 #ifdef HAVE_THREADS
+   if (s_source_thread)
+   {
+      slock_lock(s_source_lock);
+      s_source_quit = true;
+      scond_signal(s_source_cond);
+      slock_unlock(s_source_lock);
+
+      sthread_join(s_source_thread);
+      s_source_thread = NULL;
+
+      /* Every source that was played is still on the list. */
+      while (s_sources)
+      {
+         audio_mixer_source_t *next = s_sources->next;
+         audio_mixer_source_free(s_sources);
+         s_sources = next;
+      }
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+         s_voices[i].source = NULL;
+   }
+
+   if (s_source_cond)
+      scond_free(s_source_cond);
+   if (s_source_lock)
+      slock_free(s_source_lock);
+   s_source_cond = NULL;
+   s_source_lock = NULL;
+
    /* Dont call audio mixer functions after this point */
    slock_free(s_locker);
    s_locker = NULL;
 #endif
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      if (s_voices[i].source)
+         audio_mixer_source_free(s_voices[i].source);
+      s_voices[i].source = NULL;
+      s_voices[i].type   = AUDIO_MIXER_TYPE_NONE;
+   }
+}
+
+audio_mixer_sound_t* audio_mixer_load_file(const char *path,
+      enum audio_mixer_type type)
+{
+   audio_mixer_sound_t* sound = NULL;
+
+   if (!path)
+      return NULL;
+
+   switch (type)
+   {
+#ifdef HAVE_STB_VORBIS
+      case AUDIO_MIXER_TYPE_OGG:
+#endif
+#ifdef HAVE_DR_FLAC
+      case AUDIO_MIXER_TYPE_FLAC:
+#endif
+#ifdef HAVE_DR_MP3
+      case AUDIO_MIXER_TYPE_MP3:
+#endif
+         break;
+      default:
+         return NULL;
+   }
+
+   sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
+
+   if (!sound)
+      return NULL;
+
+   sound->type = type;
+   sound->path = strdup(path);
+
+   if (!sound->path)
+   {
+      free(sound);
+      return NULL;
+   }
+
+   return sound;
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
@@ -500,6 +1262,7 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
          break;
    }
 
+   free(sound->path);
    free(sound);
 }
 
@@ -751,12 +1514,22 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       float volume, audio_mixer_stop_cb_t stop_cb)
 {
    unsigned i;
-   bool res                   = false;
-   audio_mixer_voice_t* voice = s_voices;
+   bool res                     = false;
+   audio_mixer_voice_t* voice   = s_voices;
+   audio_mixer_source_t *source = NULL;
 
    if (!sound)
       return NULL;
 
+   /* Set up the source before locking the voices,
+    * the mixer must not wait for it. */
+   if (sound->path)
+   {
+      source = audio_mixer_play_source(sound, repeat);
+      if (!source)
+         return NULL;
+   }
+
 #ifdef HAVE_THREADS
    slock_lock(s_locker);
 #endif
@@ -766,6 +1539,12 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       if (voice->type != AUDIO_MIXER_TYPE_NONE)
          continue;
 
+      if (source)
+      {
+         res = true;
+         break;
+      }
+
       switch (sound->type)
       {
          case AUDIO_MIXER_TYPE_WAV:
@@ -805,6 +1584,7 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       voice->volume   = volume;
       voice->sound    = sound;
       voice->stop_cb  = stop_cb;
+      voice->source   = source;
    }
    else
       voice = NULL;
@@ -813,6 +1593,9 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
    slock_unlock(s_locker);
 #endif
 
+   if (!voice && source)
+      audio_mixer_release_source(source);
+
    return voice;
 }
 
@@ -820,6 +1603,7 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
 {
    audio_mixer_stop_cb_t stop_cb = NULL;
    audio_mixer_sound_t* sound    = NULL;
+   audio_mixer_source_t *source  = NULL;
 
    if (voice)
    {
@@ -830,12 +1614,17 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       slock_lock(s_locker);
 #endif
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      voice->type   = AUDIO_MIXER_TYPE_NONE;
+      source        = voice->source;
+      voice->source = NULL;
 
 #ifdef HAVE_THREADS
       slock_unlock(s_locker);
 #endif
 
+      if (source)
+         audio_mixer_release_source(source);
+
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
    }
@@ -871,10 +1660,7 @@ again:
          goto again;
       }
 
-      if (voice->stop_cb)
-         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      audio_mixer_voice_finished(voice);
    }
    else
    {
@@ -916,10 +1702,7 @@ again:
          }
          else
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
+            audio_mixer_voice_finished(voice);
             return;
          }
       }
@@ -992,10 +1775,7 @@ again:
          }
          else
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
+            audio_mixer_voice_finished(voice);
             return;
          }
       }
@@ -1063,10 +1843,7 @@ again:
          }
          else
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
+            audio_mixer_voice_finished(voice);
             return;
          }
       }
@@ -1136,10 +1913,7 @@ again:
          }
          else
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
+            audio_mixer_voice_finished(voice);
             return;
          }
       }
@@ -1180,12 +1954,92 @@ again:
 }
 #endif
 
+static void audio_mixer_mix_source(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice,
+      float volume)
+{
+   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER];
+   audio_mixer_source_t *source = voice->source;
+   size_t buf_free              = num_frames * 2;
+
+#ifdef HAVE_THREADS
+   if (!s_source_thread)
+#endif
+      while (audio_mixer_source_step(source));
+
+   /* Stay silent until enough is decoded to play on without
+    * running dry, or the track ended before that. */
+   if (!source->started)
+   {
+      if (     spsc_read_avail(source->pcm)
+               < AUDIO_MIXER_STREAM_START * sizeof(float)
+            && spsc_read_avail(source->events) == 0)
+         return;
+      source->started = true;
+   }
+
+   while (buf_free)
+   {
+      size_t i;
+      /* Check the samples before the events: all samples in
+       * front of an event are queued before the event is. */
+      size_t avail = spsc_read_avail(source->pcm) / sizeof(float);
+
+      if (     !source->has_event
+            && spsc_read_avail(source->events) >= sizeof(audio_mixer_event_t))
+      {
+         spsc_read(source->events, &source->event, sizeof(source->event));
+         source->has_event = true;
+      }
+
+      if (source->has_event)
+      {
+         if (source->event.position <= source->consumed)
+         {
+            source->has_event = false;
+
+            if (source->event.reason == AUDIO_MIXER_SOUND_FINISHED)
+            {
+               audio_mixer_voice_finished(voice);
+               return;
+            }
+
+            if (voice->stop_cb)
+               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
+            continue;
+         }
+
+         if (avail > source->event.position - source->consumed)
+            avail = (size_t)(source->event.position - source->consumed);
+      }
+
+      if (avail > buf_free)
+         avail = buf_free;
+      if (avail > AUDIO_MIXER_TEMP_BUFFER)
+         avail = AUDIO_MIXER_TEMP_BUFFER;
+
+      /* The decoder fell behind, the rest stays silent. */
+      if (!avail)
+         break;
+
+      spsc_read(source->pcm, temp_buffer, avail * sizeof(float));
+
+      for (i = 0; i < avail; i++)
+         *buffer++ += temp_buffer[i] * volume;
+
+      source->consumed += avail;
+      buf_free         -= avail;
+   }
+}
+
 void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override)
 {
    unsigned i;
    size_t j                   = 0;
    float* sample              = NULL;
    audio_mixer_voice_t* voice = s_voices;
+   unsigned finished_count    = 0;
+   audio_mixer_finished_t finished[AUDIO_MIXER_MAX_VOICES];
 
 #ifdef HAVE_THREADS
    slock_lock(s_locker);
@@ -1195,6 +2049,12 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
    {
       float volume = (override) ? volume_override : voice->volume;
 
+      if (voice->source)
+      {
+         audio_mixer_mix_source(buffer, num_frames, voice, volume);
+         continue;
+      }
+
       switch (voice->type)
       {
          case AUDIO_MIXER_TYPE_WAV:
@@ -1225,10 +2085,17 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
       }
    }
 
+   finished_count   = s_finished_count;
+   memcpy(finished, s_finished, finished_count * sizeof(*finished));
+   s_finished_count = 0;
+
 #ifdef HAVE_THREADS
    slock_unlock(s_locker);
 #endif
 
+   for (i = 0; i < finished_count; i++)
+      finished[i].stop_cb(finished[i].sound, AUDIO_MIXER_SOUND_FINISHED);
+
    for (j = 0, sample = buffer; j < num_frames; j++, sample++)
    {
       if (*sample < -1.0f)
@@ -0,0 +1,20 @@
+filters = 1
+filter0 = convolution
+
+# Convolves the audio with an impulse response, e.g. one
+# recorded in a room or of a speaker cabinet.
+# WAV files with 16/24/32-bit PCM or 32-bit float samples
+# are supported, mono or stereo. Responses are cut at 10 seconds.
+# convolution_impulse_response = "/path/to/response.wav"
+
+# Without an impulse response, a room is simulated.
+# Time in seconds for it to decay by 60 dB.
+# convolution_decay = 1.5
+
+# Defaults.
+# convolution_wet = 0.25
+# convolution_dry = 1.0
+
+# The response is processed in blocks of 2^block_size_log2 frames,
+# which is also the added latency. Larger blocks cost less CPU.
+# convolution_block_size_log2 = 8
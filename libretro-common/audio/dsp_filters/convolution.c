@@ -0,0 +1,724 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (convolution.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <libretro_dspfilter.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/* The AVX version is compiled with a per-function target
+ * attribute and only used if the CPU reports support. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+   && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define CONVOLUTION_AVX
+#define CONVOLUTION_AVX_TARGET __attribute__((target("avx")))
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CONVOLUTION_NEON
+#include <arm_neon.h>
+#endif
+
+/* Uniformly partitioned convolution (overlap-save).
+ *
+ * The impulse response is cut into partitions of block_size
+ * frames which are transformed once, with an FFT of twice that
+ * size. Every block of input is transformed once as well and kept
+ * in a ring of input spectra. The output block is the inverse FFT
+ * of the sum of each partition times the input spectrum of as many
+ * blocks ago, so the latency stays at one block however long the
+ * response is.
+ *
+ * Both channels share one complex FFT, left as the real and right
+ * as the imaginary part. As the response is real, this keeps them
+ * apart. A stereo response needs a second set of partitions and a
+ * second inverse FFT. */
+
+#define CONVOLUTION_MAX_SECONDS 10
+
+typedef void (*convolution_mac_t)(float *y_re, float *y_im,
+      const float *x_re, const float *x_im,
+      const float *h_re, const float *h_im, unsigned n);
+
+struct convolution_fft
+{
+   unsigned size;
+   unsigned *bitrev;
+   float *cos_lut;
+   float *sin_lut;
+};
+
+struct convolution_data
+{
+   struct convolution_fft fft;
+   convolution_mac_t mac;
+
+   unsigned block_size;
+   unsigned fft_size;
+   unsigned partitions;
+   unsigned ir_channels;
+
+   /* Partition spectra, real parts followed by imaginary
+    * parts, for each channel and partition. */
+   float *ir;
+   /* Spectra of the last input blocks, same layout. */
+   float *fdl;
+   unsigned fdl_pos;
+   /* Spectra being accumulated, one per response channel. */
+   float *acc;
+
+   /* The previous and the current input block. */
+   float *window_l;
+   float *window_r;
+   unsigned block_ptr;
+
+   float wet;
+   float dry;
+
+   float *out;
+   unsigned out_frames;
+};
+
+static dspfilter_simd_mask_t convolution_simd_mask;
+
+static void convolution_mac_c(float *y_re, float *y_im,
+      const float *x_re, const float *x_im,
+      const float *h_re, const float *h_im, unsigned n)
+{
+   unsigned i;
+   for (i = 0; i < n; i++)
+   {
+      y_re[i] += x_re[i] * h_re[i] - x_im[i] * h_im[i];
+      y_im[i] += x_re[i] * h_im[i] + x_im[i] * h_re[i];
+   }
+}
+
+#if defined(__SSE__)
+static void convolution_mac_sse(float *y_re, float *y_im,
+      const float *x_re, const float *x_im,
+      const float *h_re, const float *h_im, unsigned n)
+{
+   unsigned i;
+   for (i = 0; i < n; i += 4)
+   {
+      __m128 xr = _mm_loadu_ps(x_re + i);
+      __m128 xi = _mm_loadu_ps(x_im + i);
+      __m128 hr = _mm_loadu_ps(h_re + i);
+      __m128 hi = _mm_loadu_ps(h_im + i);
+
+      _mm_storeu_ps(y_re + i, _mm_add_ps(_mm_loadu_ps(y_re + i),
+               _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi))));
+      _mm_storeu_ps(y_im + i, _mm_add_ps(_mm_loadu_ps(y_im + i),
+               _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr))));
+   }
+}
+#endif
+
+#if defined(CONVOLUTION_AVX)
+CONVOLUTION_AVX_TARGET
+static void convolution_mac_avx(float *y_re, float *y_im,
+      const float *x_re, const float *x_im,
+      const float *h_re, const float *h_im, unsigned n)
+{
+   unsigned i;
+   for (i = 0; i < n; i += 8)
+   {
+      __m256 xr = _mm256_loadu_ps(x_re + i);
+      __m256 xi = _mm256_loadu_ps(x_im + i);
+      __m256 hr = _mm256_loadu_ps(h_re + i);
+      __m256 hi = _mm256_loadu_ps(h_im + i);
+
+      _mm256_storeu_ps(y_re + i, _mm256_add_ps(_mm256_loadu_ps(y_re + i),
+               _mm256_sub_ps(_mm256_mul_ps(xr, hr), _mm256_mul_ps(xi, hi))));
+      _mm256_storeu_ps(y_im + i, _mm256_add_ps(_mm256_loadu_ps(y_im + i),
+               _mm256_add_ps(_mm256_mul_ps(xr, hi), _mm256_mul_ps(xi, hr))));
+   }
+}
+#endif
+
+#if defined(CONVOLUTION_NEON)
+static void convolution_mac_neon(float *y_re, float *y_im,
+      const float *x_re, const float *x_im,
+      const float *h_re, const float *h_im, unsigned n)
+{
+   unsigned i;
+   for (i = 0; i < n; i += 4)
+   {
+      float32x4_t xr = vld1q_f32(x_re + i);
+      float32x4_t xi = vld1q_f32(x_im + i);
+      float32x4_t hr = vld1q_f32(h_re + i);
+      float32x4_t hi = vld1q_f32(h_im + i);
+
+      vst1q_f32(y_re + i,
+            vmlsq_f32(vmlaq_f32(vld1q_f32(y_re + i), xr, hr), xi, hi));
+      vst1q_f32(y_im + i,
+            vmlaq_f32(vmlaq_f32(vld1q_f32(y_im + i), xr, hi), xi, hr));
+   }
+}
+#endif
+
+static bool convolution_fft_init(struct convolution_fft *fft, unsigned size)
+{
+   unsigned i, bits = 0;
+
+   while ((1u << bits) < size)
+      bits++;
+
+   fft->size    = size;
+   fft->bitrev  = (unsigned*)calloc(size, sizeof(*fft->bitrev));
+   fft->cos_lut = (float*)calloc(size / 2, sizeof(*fft->cos_lut));
+   fft->sin_lut = (float*)calloc(size / 2, sizeof(*fft->sin_lut));
+
+   if (!fft->bitrev || !fft->cos_lut || !fft->sin_lut)
+      return false;
+
+   for (i = 0; i < size; i++)
+   {
+      unsigned b, rev = 0;
+      for (b = 0; b < bits; b++)
+         rev |= ((i >> b) & 1) << (bits - b - 1);
+      fft->bitrev[i] = rev;
+   }
+
+   for (i = 0; i < size / 2; i++)
+   {
+      fft->cos_lut[i] = (float)cos(2.0 * M_PI * i / size);
+      fft->sin_lut[i] = (float)sin(2.0 * M_PI * i / size);
+   }
+
+   return true;
+}
+
+static void convolution_fft_free(struct convolution_fft *fft)
+{
+   free(fft->bitrev);
+   free(fft->cos_lut);
+   free(fft->sin_lut);
+}
+
+/* In-place radix-2 FFT. The inverse is not scaled. */
+static void convolution_fft_process(const struct convolution_fft *fft,
+      float *re, float *im, bool inverse)
+{
+   unsigned i, len;
+   unsigned n = fft->size;
+   float sign = inverse ? 1.0f : -1.0f;
+
+   for (i = 0; i < n; i++)
+   {
+      unsigned j = fft->bitrev[i];
+      if (j > i)
+      {
+         float tmp;
+         tmp = re[i]; re[i] = re[j]; re[j] = tmp;
+         tmp = im[i]; im[i] = im[j]; im[j] = tmp;
+      }
+   }
+
+   for (len = 2; len <= n; len <<= 1)
+   {
+      unsigned j;
+      unsigned half = len >> 1;
+      unsigned step = n / len;
+
+      for (j = 0; j < half; j++)
+      {
+         unsigned k;
+         float wr = fft->cos_lut[j * step];
+         float wi = sign * fft->sin_lut[j * step];
+
+         for (k = j; k < n; k += len)
+         {
+            unsigned l = k + half;
+            float tr   = re[l] * wr - im[l] * wi;
+            float ti   = re[l] * wi + im[l] * wr;
+
+            re[l]      = re[k] - tr;
+            im[l]      = im[k] - ti;
+            re[k]     += tr;
+            im[k]     += ti;
+         }
+      }
+   }
+}
+
+static uint32_t convolution_read_le(const uint8_t *data, unsigned bytes)
+{
+   unsigned i;
+   uint32_t val = 0;
+   for (i = 0; i < bytes; i++)
+      val |= (uint32_t)data[i] << (i * 8);
+   return val;
+}
+
+/* Loads 16/24/32-bit PCM or 32-bit float WAV files.
+ * Returns deinterleaved samples for up to two channels. */
+static float *convolution_load_wav(const char *path,
+      unsigned *out_frames, unsigned *out_channels, unsigned *out_rate)
+{
+   long len;
+   size_t pos;
+   unsigned i, c;
+   unsigned format     = 0;
+   unsigned channels   = 0;
+   unsigned rate       = 0;
+   unsigned bits       = 0;
+   unsigned frames     = 0;
+   const uint8_t *pcm  = NULL;
+   uint8_t *data       = NULL;
+   float *samples      = NULL;
+   FILE *file          = fopen(path, "rb");
+
+   if (!file)
+      return NULL;
+
+   fseek(file, 0, SEEK_END);
+   len = ftell(file);
+   fseek(file, 0, SEEK_SET);
+
+   if (len < 12 || !(data = (uint8_t*)malloc(len)))
+      goto end;
+
+   if (fread(data, 1, len, file) != (size_t)len)
+      goto end;
+
+   if (memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+      goto end;
+
+   for (pos = 12; pos + 8 <= (size_t)len; )
+   {
+      size_t size = convolution_read_le(data + pos + 4, 4);
+
+      if (size > (size_t)len - pos - 8)
+         size = (size_t)len - pos - 8;
+
+      if (!memcmp(data + pos, "fmt ", 4) && size >= 16)
+      {
+         format   = convolution_read_le(data + pos + 8, 2);
+         channels = convolution_read_le(data + pos + 10, 2);
+         rate     = convolution_read_le(data + pos + 12, 4);
+         bits     = convolution_read_le(data + pos + 22, 2);
+
+         /* WAVE_FORMAT_EXTENSIBLE, the format is in the sub-type. */
+         if (format == 0xFFFE && size >= 26)
+            format = convolution_read_le(data + pos + 32, 2);
+      }
+      else if (!memcmp(data + pos, "data", 4) && channels && bits >= 8)
+      {
+         pcm    = data + pos + 8;
+         frames = (unsigned)(size / (channels * (bits / 8)));
+         break;
+      }
+
+      pos += 8 + size + (size & 1);
+   }
+
+   if (!pcm || !frames || !rate)
+      goto end;
+
+   if (!(format == 1 && (bits == 16 || bits == 24 || bits == 32))
+         && !(format == 3 && bits == 32))
+      goto end;
+
+   *out_channels = channels > 1 ? 2 : 1;
+   samples       = (float*)malloc(frames * *out_channels * sizeof(float));
+   if (!samples)
+      goto end;
+
+   for (i = 0; i < frames; i++)
+   {
+      for (c = 0; c < *out_channels; c++)
+      {
+         const uint8_t *s = pcm + (i * channels + c) * (bits / 8);
+         uint32_t raw     = convolution_read_le(s, bits / 8);
+         float val;
+
+         if (format == 3)
+            memcpy(&val, &raw, sizeof(val));
+         else if (bits == 16)
+            val = (int16_t)raw / 32768.0f;
+         else if (bits == 24)
+            val = (int32_t)(raw << 8) / 2147483648.0f;
+         else
+            val = (int32_t)raw / 2147483648.0f;
+
+         samples[c * frames + i] = val;
+      }
+   }
+
+   *out_frames = frames;
+   *out_rate   = rate;
+
+end:
+   free(data);
+   fclose(file);
+   return samples;
+}
+
+/* Decaying noise, which sounds like a diffuse room.
+ * The decay is the time it takes to fall by 60 dB. */
+static float *convolution_generate(float rate, float decay,
+      unsigned *out_frames)
+{
+   unsigned i, c;
+   uint32_t seed   = 0x12345678;
+   unsigned frames = (unsigned)(rate * decay);
+   float *samples  = NULL;
+
+   if (!frames)
+      frames = 1;
+
+   samples = (float*)malloc(frames * 2 * sizeof(float));
+   if (!samples)
+      return NULL;
+
+   for (c = 0; c < 2; c++)
+   {
+      double energy = 0.0;
+
+      for (i = 0; i < frames; i++)
+      {
+         float noise, env;
+
+         seed  = seed * 1664525u + 1013904223u;
+         noise = (float)(int32_t)seed / 2147483648.0f;
+         env   = (float)exp(-6.907755 * i / frames);
+
+         samples[c * frames + i] = noise * env;
+         energy += (double)samples[c * frames + i] * samples[c * frames + i];
+      }
+
+      /* Unit energy, so that the wet level is about
+       * the same whatever the decay. */
+      if (energy > 0.0)
+         for (i = 0; i < frames; i++)
+            samples[c * frames + i] *= (float)(1.0 / sqrt(energy));
+   }
+
+   *out_frames = frames;
+   return samples;
+}
+
+static void convolution_free(void *data)
+{
+   struct convolution_data *conv = (struct convolution_data*)data;
+
+   if (!conv)
+      return;
+
+   convolution_fft_free(&conv->fft);
+   free(conv->ir);
+   free(conv->fdl);
+   free(conv->acc);
+   free(conv->window_l);
+   free(conv->window_r);
+   free(conv->out);
+   free(conv);
+}
+
+static void convolution_block(struct convolution_data *conv, float *out)
+{
+   unsigned i, c, p;
+   unsigned n        = conv->fft_size;
+   unsigned b        = conv->block_size;
+   float *x_re       = conv->fdl + conv->fdl_pos * 2 * n;
+   float *x_im       = x_re + n;
+   const float *left = NULL;
+   const float *right= NULL;
+
+   memcpy(x_re, conv->window_l, n * sizeof(float));
+   memcpy(x_im, conv->window_r, n * sizeof(float));
+   convolution_fft_process(&conv->fft, x_re, x_im, false);
+
+   for (c = 0; c < conv->ir_channels; c++)
+   {
+      float *acc_re = conv->acc + c * 2 * n;
+      float *acc_im = acc_re + n;
+
+      memset(acc_re, 0, 2 * n * sizeof(float));
+
+      for (p = 0; p < conv->partitions; p++)
+      {
+         unsigned slot   = (conv->fdl_pos + conv->partitions - p)
+            % conv->partitions;
+         const float *xr = conv->fdl + slot * 2 * n;
+         const float *hr = conv->ir + (c * conv->partitions + p) * 2 * n;
+
+         conv->mac(acc_re, acc_im, xr, xr + n, hr, hr + n, n);
+      }
+
+      convolution_fft_process(&conv->fft, acc_re, acc_im, true);
+   }
+
+   /* Overlap-save: only the second half is valid. */
+   left  = conv->acc + b;
+   right = conv->acc + (conv->ir_channels - 1) * 2 * n + n + b;
+
+   for (i = 0; i < b; i++)
+   {
+      out[2 * i + 0] = conv->dry * conv->window_l[b + i] + conv->wet * left[i];
+      out[2 * i + 1] = conv->dry * conv->window_r[b + i] + conv->wet * right[i];
+   }
+
+   memcpy(conv->window_l, conv->window_l + b, b * sizeof(float));
+   memcpy(conv->window_r, conv->window_r + b, b * sizeof(float));
+
+   conv->fdl_pos = (conv->fdl_pos + 1) % conv->partitions;
+}
+
+static void convolution_process(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   unsigned frames;
+   const float *in               = input->samples;
+   unsigned input_frames         = input->frames;
+   struct convolution_data *conv = (struct convolution_data*)data;
+   unsigned max_frames           = conv->block_ptr + input_frames;
+
+   output->samples               = conv->out;
+   output->frames                = 0;
+
+   if (max_frames > conv->out_frames)
+   {
+      float *out = (float*)realloc(conv->out, max_frames * 2 * sizeof(float));
+      if (!out)
+         return;
+      conv->out        = out;
+      conv->out_frames = max_frames;
+      output->samples  = out;
+   }
+
+   while (input_frames)
+   {
+      unsigned i;
+      unsigned offset = conv->block_size + conv->block_ptr;
+
+      frames = conv->block_size - conv->block_ptr;
+      if (frames > input_frames)
+         frames = input_frames;
+
+      for (i = 0; i < frames; i++, in += 2)
+      {
+         conv->window_l[offset + i] = in[0];
+         conv->window_r[offset + i] = in[1];
+      }
+
+      input_frames    -= frames;
+      conv->block_ptr += frames;
+
+      if (conv->block_ptr == conv->block_size)
+      {
+         convolution_block(conv, conv->out + output->frames * 2);
+         output->frames  += conv->block_size;
+         conv->block_ptr  = 0;
+      }
+   }
+}
+
+static float *convolution_resample(const float *in, unsigned in_frames,
+      unsigned channels, double ratio, unsigned *out_frames)
+{
+   unsigned i, c;
+   unsigned frames = (unsigned)(in_frames * ratio);
+   float *out      = NULL;
+
+   if (!frames)
+      frames = 1;
+
+   if (!(out = (float*)malloc(frames * channels * sizeof(float))))
+      return NULL;
+
+   /* Linear interpolation is good enough for a response
+    * recorded at a different rate. */
+   for (c = 0; c < channels; c++)
+   {
+      const float *src = in + c * in_frames;
+      for (i = 0; i < frames; i++)
+      {
+         double pos   = i / ratio;
+         unsigned idx = (unsigned)pos;
+         float frac   = (float)(pos - idx);
+         float a      = src[idx < in_frames ? idx : in_frames - 1];
+         float b      = src[idx + 1 < in_frames ? idx + 1 : in_frames - 1];
+         out[c * frames + i] = a + (b - a) * frac;
+      }
+   }
+
+   *out_frames = frames;
+   return out;
+}
+
+static void *convolution_init(const struct dspfilter_info *info,
+      const struct dspfilter_config *config, void *userdata)
+{
+   float decay;
+   int block_size_log2;
+   unsigned c, p, n;
+   char *path                    = NULL;
+   float *response               = NULL;
+   unsigned frames               = 0;
+   unsigned rate                 = 0;
+   struct convolution_data *conv = (struct convolution_data*)
+      calloc(1, sizeof(*conv));
+
+   if (!conv)
+      return NULL;
+
+   config->get_float(userdata, "wet", &conv->wet, 0.25f);
+   config->get_float(userdata, "dry", &conv->dry, 1.0f);
+   config->get_float(userdata, "decay", &decay, 1.5f);
+   config->get_int(userdata, "block_size_log2", &block_size_log2, 8);
+   config->get_string(userdata, "impulse_response", &path, "");
+
+   if (block_size_log2 < 4)
+      block_size_log2 = 4;
+   else if (block_size_log2 > 13)
+      block_size_log2 = 13;
+
+   conv->block_size = 1u << block_size_log2;
+   conv->fft_size   = conv->block_size * 2;
+   n                = conv->fft_size;
+
+   if (path && *path)
+   {
+      response = convolution_load_wav(path, &frames,
+            &conv->ir_channels, &rate);
+
+      if (response && rate != (unsigned)info->input_rate)
+      {
+         float *resampled = convolution_resample(response, frames,
+               conv->ir_channels, info->input_rate / rate, &frames);
+         free(response);
+         response = resampled;
+      }
+   }
+
+   if (!response)
+   {
+      if (path && *path)
+         fprintf(stderr, "[Convolution]: Could not load %s.\n", path);
+
+      if (decay > CONVOLUTION_MAX_SECONDS)
+         decay = CONVOLUTION_MAX_SECONDS;
+      response          = convolution_generate(info->input_rate,
+            decay, &frames);
+      conv->ir_channels = 2;
+   }
+
+   config->free(path);
+
+   if (!response)
+      goto error;
+
+   if (frames > info->input_rate * CONVOLUTION_MAX_SECONDS)
+      frames = (unsigned)(info->input_rate * CONVOLUTION_MAX_SECONDS);
+
+   conv->partitions = (frames + conv->block_size - 1) / conv->block_size;
+
+   conv->ir       = (float*)calloc(conv->ir_channels * conv->partitions * 2 * n,
+         sizeof(float));
+   conv->fdl      = (float*)calloc(conv->partitions * 2 * n, sizeof(float));
+   conv->acc      = (float*)calloc(conv->ir_channels * 2 * n, sizeof(float));
+   conv->window_l = (float*)calloc(n, sizeof(float));
+   conv->window_r = (float*)calloc(n, sizeof(float));
+
+   if (     !conv->ir || !conv->fdl || !conv->acc
+         || !conv->window_l || !conv->window_r
+         || !convolution_fft_init(&conv->fft, n))
+      goto error;
+
+   /* Zero-padded partitions, with the 1 / n scale of
+    * the inverse transform folded in. */
+   for (c = 0; c < conv->ir_channels; c++)
+   {
+      const float *src = response + c * frames;
+
+      for (p = 0; p < conv->partitions; p++)
+      {
+         unsigned i;
+         float *h_re    = conv->ir + (c * conv->partitions + p) * 2 * n;
+         float *h_im    = h_re + n;
+         unsigned start = p * conv->block_size;
+         unsigned len   = MIN(conv->block_size, frames - start);
+
+         for (i = 0; i < len; i++)
+            h_re[i] = src[start + i] / n;
+
+         convolution_fft_process(&conv->fft, h_re, h_im, false);
+      }
+   }
+
+   free(response);
+
+   conv->mac = convolution_mac_c;
+#if defined(__SSE__)
+   if (convolution_simd_mask & DSPFILTER_SIMD_SSE)
+      conv->mac = convolution_mac_sse;
+#endif
+#if defined(CONVOLUTION_AVX)
+   if (convolution_simd_mask & DSPFILTER_SIMD_AVX)
+      conv->mac = convolution_mac_avx;
+#endif
+#if defined(CONVOLUTION_NEON)
+   if (convolution_simd_mask & DSPFILTER_SIMD_NEON)
+      conv->mac = convolution_mac_neon;
+#endif
+
+   return conv;
+
+error:
+   free(response);
+   convolution_free(conv);
+   return NULL;
+}
+
+static const struct dspfilter_implementation convolution_plug = {
+   convolution_init,
+   convolution_process,
+   convolution_free,
+
+   DSPFILTER_API_VERSION,
+   "Convolution",
+   "convolution",
+};
+
+#ifdef HAVE_FILTERS_BUILTIN
+#define dspfilter_get_implementation convolution_dspfilter_get_implementation
+#endif
+
+const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
+{
+   convolution_simd_mask = mask;
+   return &convolution_plug;
+}
+
+#undef dspfilter_get_implementation
@@ -24,56 +24,38 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define REVERB_NEON
+#include <arm_neon.h>
+#endif
+
+/* Both channels use the same delay lengths and settings,
+ * so their delay lines are interleaved (LRLR...) and always
+ * share the same position. This lets the SIMD versions run
+ * both channels, and pairs of combs, side by side. */
+
 struct comb
 {
    float *buffer;
    unsigned bufsize;
    unsigned bufidx;
-
-   float feedback;
-   float filterstore;
-   float damp1, damp2;
 };
 
 struct allpass
 {
    float *buffer;
-   float feedback;
    unsigned bufsize;
    unsigned bufidx;
 };
 
-static INLINE float comb_process(struct comb *c, float input)
-{
-   float output         = c->buffer[c->bufidx];
-   c->filterstore       = (output * c->damp2) + (c->filterstore * c->damp1);
-
-   c->buffer[c->bufidx] = input + (c->filterstore * c->feedback);
-
-   c->bufidx++;
-   if (c->bufidx >= c->bufsize)
-      c->bufidx = 0;
-
-   return output;
-}
-
-
-static INLINE float allpass_process(struct allpass *a, float input)
-{
-   float bufout         = a->buffer[a->bufidx];
-   float output         = -input + bufout;
-   a->buffer[a->bufidx] = input + bufout * a->feedback;
-
-   a->bufidx++;
-   if (a->bufidx >= a->bufsize)
-      a->bufidx = 0;
-
-   return output;
-}
-
 #define numcombs 8
 #define numallpasses 4
 static const float muted = 0;
@@ -90,43 +72,221 @@ static const float initialdry = 0;
 static const float initialwidth = 1;
 static const float initialmode = 0;
 static const float freezemode = 0.5f;
+static const float allpassfeedback = 0.5f;
 
 struct revmodel
 {
-   struct comb combL[numcombs];
-   struct allpass allpassL[numallpasses];
+   struct comb comb[numcombs];
+   struct allpass allpass[numallpasses];
+
+   /* Left and right for each comb. */
+   float filterstore[numcombs * 2];
 
-   float *bufcomb[numcombs];
-   float *bufallpass[numallpasses];
+   float feedback;
+   float damp1, damp2;
 
    float gain;
    float roomsize, roomsize1;
-   float damp, damp1;
+   float damp;
    float wet, wet1, wet2;
    float dry;
    float width;
    float mode;
 };
 
-static float revmodel_process(struct revmodel *rev, float in)
+static INLINE void comb_advance(struct comb *c)
+{
+   if (++c->bufidx >= c->bufsize)
+      c->bufidx = 0;
+}
+
+static INLINE void allpass_advance(struct allpass *a)
 {
-   int i;
-   float mono_out = 0.0f;
-   float mono_in  = in;
-   float input    = mono_in * rev->gain;
+   if (++a->bufidx >= a->bufsize)
+      a->bufidx = 0;
+}
+
+static void revmodel_process(struct revmodel *rev, float *frame)
+{
+   unsigned i, c;
+   float out[2]   = { 0.0f, 0.0f };
+   float input[2] = { frame[0] * rev->gain, frame[1] * rev->gain };
 
    for (i = 0; i < numcombs; i++)
-      mono_out += comb_process(&rev->combL[i], input);
+   {
+      struct comb *comb = &rev->comb[i];
+      float *buf        = comb->buffer + comb->bufidx * 2;
+      float *store      = rev->filterstore + i * 2;
+
+      for (c = 0; c < 2; c++)
+      {
+         float output = buf[c];
+         store[c]     = (output * rev->damp2) + (store[c] * rev->damp1);
+         buf[c]       = input[c] + (store[c] * rev->feedback);
+         out[c]      += output;
+      }
+
+      comb_advance(comb);
+   }
 
    for (i = 0; i < numallpasses; i++)
-      mono_out = allpass_process(&rev->allpassL[i], mono_out);
+   {
+      struct allpass *allpass = &rev->allpass[i];
+      float *buf              = allpass->buffer + allpass->bufidx * 2;
+
+      for (c = 0; c < 2; c++)
+      {
+         float bufout = buf[c];
+         buf[c]       = out[c] + bufout * allpassfeedback;
+         out[c]       = -out[c] + bufout;
+      }
+
+      allpass_advance(allpass);
+   }
 
-   return mono_in * rev->dry + mono_out * rev->wet1;
+   frame[0] = frame[0] * rev->dry + out[0] * rev->wet1;
+   frame[1] = frame[1] * rev->dry + out[1] * rev->wet1;
 }
 
+#if defined(__SSE__)
+static void revmodel_process_sse(struct revmodel *rev,
+      float *frames, unsigned num_frames)
+{
+   unsigned i, n;
+   __m128 store[numcombs / 2];
+   const __m128 zero     = _mm_setzero_ps();
+   const __m128 gain     = _mm_set1_ps(rev->gain);
+   const __m128 damp1    = _mm_set1_ps(rev->damp1);
+   const __m128 damp2    = _mm_set1_ps(rev->damp2);
+   const __m128 feedback = _mm_set1_ps(rev->feedback);
+   const __m128 apfb     = _mm_set1_ps(allpassfeedback);
+   const __m128 dry      = _mm_set1_ps(rev->dry);
+   const __m128 wet      = _mm_set1_ps(rev->wet1);
+
+   for (i = 0; i < numcombs / 2; i++)
+      store[i] = _mm_loadu_ps(rev->filterstore + i * 4);
+
+   for (n = 0; n < num_frames; n++, frames += 2)
+   {
+      __m128 in    = _mm_loadl_pi(zero, (const __m64*)frames);
+      __m128 input = _mm_mul_ps(_mm_movelh_ps(in, in), gain);
+      __m128 out   = zero;
+
+      /* Two combs at a time: L0 R0 L1 R1. */
+      for (i = 0; i < numcombs / 2; i++)
+      {
+         struct comb *c0 = &rev->comb[i * 2 + 0];
+         struct comb *c1 = &rev->comb[i * 2 + 1];
+         float *buf0     = c0->buffer + c0->bufidx * 2;
+         float *buf1     = c1->buffer + c1->bufidx * 2;
+         __m128 output   = _mm_loadh_pi(
+               _mm_loadl_pi(zero, (const __m64*)buf0), (const __m64*)buf1);
+         __m128 write;
+
+         store[i]        = _mm_add_ps(_mm_mul_ps(output, damp2),
+               _mm_mul_ps(store[i], damp1));
+         write           = _mm_add_ps(input, _mm_mul_ps(store[i], feedback));
+
+         _mm_storel_pi((__m64*)buf0, write);
+         _mm_storeh_pi((__m64*)buf1, write);
+
+         comb_advance(c0);
+         comb_advance(c1);
+
+         out = _mm_add_ps(out, output);
+      }
+
+      out = _mm_add_ps(out, _mm_movehl_ps(out, out));
+
+      for (i = 0; i < numallpasses; i++)
+      {
+         struct allpass *allpass = &rev->allpass[i];
+         float *buf              = allpass->buffer + allpass->bufidx * 2;
+         __m128 bufout           = _mm_loadl_pi(zero, (const __m64*)buf);
+
+         _mm_storel_pi((__m64*)buf,
+               _mm_add_ps(out, _mm_mul_ps(bufout, apfb)));
+         out = _mm_sub_ps(bufout, out);
+
+         allpass_advance(allpass);
+      }
+
+      _mm_storel_pi((__m64*)frames,
+            _mm_add_ps(_mm_mul_ps(in, dry), _mm_mul_ps(out, wet)));
+   }
+
+   for (i = 0; i < numcombs / 2; i++)
+      _mm_storeu_ps(rev->filterstore + i * 4, store[i]);
+}
+#endif
+
+#if defined(REVERB_NEON)
+static void revmodel_process_neon(struct revmodel *rev,
+      float *frames, unsigned num_frames)
+{
+   unsigned i, n;
+   float32x4_t store[numcombs / 2];
+   const float32x2_t apfb  = vdup_n_f32(allpassfeedback);
+   const float32x2_t dry   = vdup_n_f32(rev->dry);
+   const float32x2_t wet   = vdup_n_f32(rev->wet1);
+
+   for (i = 0; i < numcombs / 2; i++)
+      store[i] = vld1q_f32(rev->filterstore + i * 4);
+
+   for (n = 0; n < num_frames; n++, frames += 2)
+   {
+      float32x2_t in       = vld1_f32(frames);
+      float32x2_t in_gain  = vmul_n_f32(in, rev->gain);
+      float32x4_t input    = vcombine_f32(in_gain, in_gain);
+      float32x4_t out4     = vdupq_n_f32(0.0f);
+      float32x2_t out;
+
+      for (i = 0; i < numcombs / 2; i++)
+      {
+         struct comb *c0     = &rev->comb[i * 2 + 0];
+         struct comb *c1     = &rev->comb[i * 2 + 1];
+         float *buf0         = c0->buffer + c0->bufidx * 2;
+         float *buf1         = c1->buffer + c1->bufidx * 2;
+         float32x4_t output  = vcombine_f32(vld1_f32(buf0), vld1_f32(buf1));
+         float32x4_t write;
+
+         store[i]            = vmlaq_n_f32(
+               vmulq_n_f32(output, rev->damp2), store[i], rev->damp1);
+         write               = vmlaq_n_f32(input, store[i], rev->feedback);
+
+         vst1_f32(buf0, vget_low_f32(write));
+         vst1_f32(buf1, vget_high_f32(write));
+
+         comb_advance(c0);
+         comb_advance(c1);
+
+         out4 = vaddq_f32(out4, output);
+      }
+
+      out = vadd_f32(vget_low_f32(out4), vget_high_f32(out4));
+
+      for (i = 0; i < numallpasses; i++)
+      {
+         struct allpass *allpass = &rev->allpass[i];
+         float *buf              = allpass->buffer + allpass->bufidx * 2;
+         float32x2_t bufout      = vld1_f32(buf);
+
+         vst1_f32(buf, vmla_f32(out, bufout, apfb));
+         out = vsub_f32(bufout, out);
+
+         allpass_advance(allpass);
+      }
+
+      vst1_f32(frames, vmla_f32(vmul_f32(in, dry), out, wet));
+   }
+
+   for (i = 0; i < numcombs / 2; i++)
+      vst1q_f32(rev->filterstore + i * 4, store[i]);
+}
+#endif
+
 static void revmodel_update(struct revmodel *rev)
 {
-   int i;
    rev->wet1 = rev->wet * (rev->width / 2.0f + 0.5f);
 
    if (rev->mode >= freezemode)
@@ -142,12 +302,8 @@ static void revmodel_update(struct revmodel *rev)
       rev->gain = fixedgain;
    }
 
-   for (i = 0; i < numcombs; i++)
-   {
-      rev->combL[i].feedback = rev->roomsize1;
-      rev->combL[i].damp1 = rev->damp1;
-      rev->combL[i].damp2 = 1.0f - rev->damp1;
-   }
+   rev->feedback = rev->roomsize1;
+   rev->damp2    = 1.0f - rev->damp1;
 }
 
 static void revmodel_setroomsize(struct revmodel *rev, float value)
@@ -186,30 +342,30 @@ static void revmodel_setmode(struct revmodel *rev, float value)
    revmodel_update(rev);
 }
 
-static void revmodel_init(struct revmodel *rev,int srate)
+static bool revmodel_init(struct revmodel *rev, int srate)
 {
-
-  static const int comb_lengths[8] = { 1116,1188,1277,1356,1422,1491,1557,1617 };
-  static const int allpass_lengths[4] = { 225,341,441,556 };
-  double r = srate * (1 / 44100.0);
-  unsigned c;
+   static const int comb_lengths[8] = { 1116,1188,1277,1356,1422,1491,1557,1617 };
+   static const int allpass_lengths[4] = { 225,341,441,556 };
+   double r = srate * (1 / 44100.0);
+   unsigned c;
 
    for (c = 0; c < numcombs; ++c)
    {
-	   rev->bufcomb[c] = malloc(r*comb_lengths[c]*sizeof(float));
-	   rev->combL[c].buffer  =  rev->bufcomb[c];
-         memset(rev->combL[c].buffer,0,r*comb_lengths[c]*sizeof(float));
-         rev->combL[c].bufsize=r*comb_lengths[c];
-  }
+      unsigned size         = (unsigned)(r * comb_lengths[c]);
+      rev->comb[c].buffer   = (float*)calloc(size ? size : 1, 2 * sizeof(float));
+      rev->comb[c].bufsize  = size ? size : 1;
+      if (!rev->comb[c].buffer)
+         return false;
+   }
 
    for (c = 0; c < numallpasses; ++c)
    {
-	   rev->bufallpass[c] = malloc(r*allpass_lengths[c]*sizeof(float));
-	   rev->allpassL[c].buffer  =  rev->bufallpass[c];
-         memset(rev->allpassL[c].buffer,0,r*allpass_lengths[c]*sizeof(float));
-         rev->allpassL[c].bufsize=r*allpass_lengths[c];
-         rev->allpassL[c].feedback = 0.5f;
-  }
+      unsigned size           = (unsigned)(r * allpass_lengths[c]);
+      rev->allpass[c].buffer  = (float*)calloc(size ? size : 1, 2 * sizeof(float));
+      rev->allpass[c].bufsize = size ? size : 1;
+      if (!rev->allpass[c].buffer)
+         return false;
+   }
 
    revmodel_setwet(rev, initialwet);
    revmodel_setroomsize(rev, initialroom);
@@ -217,11 +373,13 @@ static void revmodel_init(struct revmodel *rev,int srate)
    revmodel_setdamp(rev, initialdamp);
    revmodel_setwidth(rev, initialwidth);
    revmodel_setmode(rev, initialmode);
+
+   return true;
 }
 
 struct reverb_data
 {
-   struct revmodel left, right;
+   struct revmodel model;
 };
 
 static void reverb_free(void *data)
@@ -229,15 +387,12 @@ static void reverb_free(void *data)
    struct reverb_data *rev = (struct reverb_data*)data;
    unsigned i;
 
-   for (i = 0; i < numcombs; i++) {
-   free(rev->left.bufcomb[i]);
-   free(rev->right.bufcomb[i]);
-   }
+   for (i = 0; i < numcombs; i++)
+      free(rev->model.comb[i].buffer);
+
+   for (i = 0; i < numallpasses; i++)
+      free(rev->model.allpass[i].buffer);
 
-   for (i = 0; i < numallpasses; i++) {
-   free(rev->left.bufallpass[i]);
-   free(rev->right.bufallpass[i]);
-   }
    free(data);
 }
 
@@ -253,13 +408,34 @@ static void reverb_process(void *data, struct dspfilter_output *output,
    out                     = output->samples;
 
    for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
+      revmodel_process(&rev->model, out);
+}
 
-      out[0] = revmodel_process(&rev->left, in[0]);
-      out[1] = revmodel_process(&rev->right, in[1]);
-   }
+#if defined(__SSE__)
+static void reverb_process_sse(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   struct reverb_data *rev = (struct reverb_data*)data;
+
+   output->samples         = input->samples;
+   output->frames          = input->frames;
+
+   revmodel_process_sse(&rev->model, output->samples, output->frames);
+}
+#endif
+
+#if defined(REVERB_NEON)
+static void reverb_process_neon(void *data, struct dspfilter_output *output,
+      const struct dspfilter_input *input)
+{
+   struct reverb_data *rev = (struct reverb_data*)data;
+
+   output->samples         = input->samples;
+   output->frames          = input->frames;
+
+   revmodel_process_neon(&rev->model, output->samples, output->frames);
 }
+#endif
 
 static void *reverb_init(const struct dspfilter_info *info,
       const struct dspfilter_config *config, void *userdata)
@@ -276,20 +452,17 @@ static void *reverb_init(const struct dspfilter_info *info,
    config->get_float(userdata, "roomwidth", &roomwidth, 0.56f);
    config->get_float(userdata, "roomsize", &roomsize, 0.56f);
 
-   revmodel_init(&rev->left,info->input_rate);
-   revmodel_init(&rev->right,info->input_rate);
-
-   revmodel_setdamp(&rev->left, damping);
-   revmodel_setdry(&rev->left, drytime);
-   revmodel_setwet(&rev->left, wettime);
-   revmodel_setwidth(&rev->left, roomwidth);
-   revmodel_setroomsize(&rev->left, roomsize);
+   if (!revmodel_init(&rev->model, info->input_rate))
+   {
+      reverb_free(rev);
+      return NULL;
+   }
 
-   revmodel_setdamp(&rev->right, damping);
-   revmodel_setdry(&rev->right, drytime);
-   revmodel_setwet(&rev->right, wettime);
-   revmodel_setwidth(&rev->right, roomwidth);
-   revmodel_setroomsize(&rev->right, roomsize);
+   revmodel_setdamp(&rev->model, damping);
+   revmodel_setdry(&rev->model, drytime);
+   revmodel_setwet(&rev->model, wettime);
+   revmodel_setwidth(&rev->model, roomwidth);
+   revmodel_setroomsize(&rev->model, roomsize);
 
    return rev;
 }
@@ -304,16 +477,46 @@ static const struct dspfilter_implementation reverb_plug = {
    "reverb",
 };
 
+#if defined(__SSE__)
+static const struct dspfilter_implementation reverb_plug_sse = {
+   reverb_init,
+   reverb_process_sse,
+   reverb_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb",
+   "reverb",
+};
+#endif
+
+#if defined(REVERB_NEON)
+static const struct dspfilter_implementation reverb_plug_neon = {
+   reverb_init,
+   reverb_process_neon,
+   reverb_free,
+
+   DSPFILTER_API_VERSION,
+   "Reverb",
+   "reverb",
+};
+#endif
+
 #ifdef HAVE_FILTERS_BUILTIN
 #define dspfilter_get_implementation reverb_dspfilter_get_implementation
 #endif
 
 const struct dspfilter_implementation *dspfilter_get_implementation(dspfilter_simd_mask_t mask)
 {
+#if defined(__SSE__)
+   if (mask & DSPFILTER_SIMD_SSE)
+      return &reverb_plug_sse;
+#endif
+#if defined(REVERB_NEON)
+   if (mask & DSPFILTER_SIMD_NEON)
+      return &reverb_plug_neon;
+#endif
    (void)mask;
    return &reverb_plug;
 }
 
 #undef dspfilter_get_implementation
-
-
@@ -736,7 +736,8 @@ uint64_t cpu_features_get(void)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
       cpu |= RETRO_SIMD_AVX;
 
-   if (max_flag >= 7)
+   /* AVX2 needs the same OS support for YMM state as AVX. */
+   if ((cpu & RETRO_SIMD_AVX) && max_flag >= 7)
    {
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
@@ -771,9 +772,12 @@ uint64_t cpu_features_get(void)
    if (check_arm_cpu_feature("asimd"))
    {
       cpu |= RETRO_SIMD_ASIMD;
-#ifdef __ARM_NEON__
+#if defined(__ARM_NEON__)
       cpu |= RETRO_SIMD_NEON;
       arm_enable_runfast_mode();
+#elif defined(__aarch64__)
+      /* Advanced SIMD is what NEON is called on AArch64. */
+      cpu |= RETRO_SIMD_NEON;
 #endif
    }
 
@@ -793,6 +797,9 @@ uint64_t cpu_features_get(void)
 #elif defined(__ARM_NEON__)
    cpu |= RETRO_SIMD_NEON;
    arm_enable_runfast_mode();
+#elif defined(__aarch64__)
+   cpu |= RETRO_SIMD_NEON;
+   cpu |= RETRO_SIMD_ASIMD;
 #elif defined(__ALTIVEC__)
    cpu |= RETRO_SIMD_VMX;
 #elif defined(XBOX360)
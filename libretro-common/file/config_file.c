@@ -42,20 +42,30 @@
 #include <compat/msvc.h>
 #include <file/config_file.h>
 #include <file/file_path.h>
-#include <lists/string_list.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Arena blocks are at least this large, bigger
+ * allocations get a block of their own. */
+#define CONFIG_ARENA_BLOCK_SIZE 0x4000
+#define CONFIG_ARENA_ALIGN      sizeof(void*)
+
+/* Smallest number of buckets in the entry index. */
+#define CONFIG_MAP_MIN_SIZE     64
+
 struct config_entry_list
 {
    /* If we got this from an #include,
     * do not allow overwrite. */
    bool readonly;
 
+   uint32_t hash;
    char *key;
    char *value;
+   /* Bytes available at value, including the terminator. */
+   size_t value_size;
    struct config_entry_list *next;
 };
 
@@ -65,9 +75,261 @@ struct config_include_list
    struct config_include_list *next;
 };
 
+struct config_arena_block
+{
+   struct config_arena_block *next;
+   size_t size;
+   size_t used;
+};
+
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth, config_file_cb_t *cb);
 
+static void *config_arena_alloc(config_file_t *conf, size_t size)
+{
+   struct config_arena_block *block = conf->arena;
+   uint8_t                   *ptr   = NULL;
+
+   size = (size + CONFIG_ARENA_ALIGN - 1) & ~(CONFIG_ARENA_ALIGN - 1);
+
+   if (!block || block->used + size > block->size)
+   {
+      size_t block_size = size > CONFIG_ARENA_BLOCK_SIZE / 4
+         ? size : CONFIG_ARENA_BLOCK_SIZE;
+
+      block = (struct config_arena_block*)
+         malloc(sizeof(*block) + block_size);
+
+      if (!block)
+         return NULL;
+
+      block->size = block_size;
+      block->used = 0;
+
+      /* Keep filling the current block when this
+       * allocation got a block of its own. */
+      if (block_size == size && conf->arena)
+      {
+         block->next       = conf->arena->next;
+         conf->arena->next = block;
+      }
+      else
+      {
+         block->next       = conf->arena;
+         conf->arena       = block;
+      }
+   }
+
+   ptr          = (uint8_t*)(block + 1) + block->used;
+   block->used += size;
+
+   return ptr;
+}
+
+/* Moves all arena blocks of @child over to @parent. */
+static void config_arena_pilfer(config_file_t *parent, config_file_t *child)
+{
+   struct config_arena_block *last = child->arena;
+
+   if (!last)
+      return;
+
+   while (last->next)
+      last = last->next;
+
+   if (parent->arena)
+   {
+      last->next          = parent->arena->next;
+      parent->arena->next = child->arena;
+   }
+   else
+      parent->arena       = child->arena;
+
+   child->arena = NULL;
+}
+
+static uint32_t config_hash(const char *key)
+{
+   uint32_t hash = 5381;
+
+   while (*key)
+      hash = (hash << 5) + hash + (uint8_t)*key++;
+
+   return hash;
+}
+
+/* Returns the bucket holding @key, or the empty
+ * bucket where it would have to go. */
+static size_t config_map_slot(const config_file_t *conf,
+      const char *key, uint32_t hash)
+{
+   size_t mask = conf->entries_map_size - 1;
+   size_t slot = hash & mask;
+
+   for (;;)
+   {
+      const struct config_entry_list *entry = conf->entries_map[slot];
+
+      if (!entry)
+         break;
+      if (entry->hash == hash && string_is_equal(entry->key, key))
+         break;
+
+      slot = (slot + 1) & mask;
+   }
+
+   return slot;
+}
+
+/* Indexes @entry unless an entry with the same key is already
+ * indexed. Callers add entries in list order so that the index
+ * always points at the first entry with a given key. */
+static void config_map_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t slot;
+
+   if (!entry->key || !conf->entries_map)
+      return;
+
+   slot = config_map_slot(conf, entry->key, entry->hash);
+
+   if (!conf->entries_map[slot])
+   {
+      conf->entries_map[slot] = entry;
+      conf->entries_map_count++;
+   }
+}
+
+/* Indexes the whole list again. */
+static bool config_map_rebuild(config_file_t *conf, size_t min_size)
+{
+   size_t size                    = CONFIG_MAP_MIN_SIZE;
+   struct config_entry_list *list = NULL;
+
+   while (size < min_size)
+      size <<= 1;
+
+   free(conf->entries_map);
+
+   conf->entries_map       = (struct config_entry_list**)
+      calloc(size, sizeof(*conf->entries_map));
+   conf->entries_map_size  = conf->entries_map ? size : 0;
+   conf->entries_map_count = 0;
+
+   if (!conf->entries_map)
+      return false;
+
+   for (list = conf->entries; list; list = list->next)
+      config_map_add(conf, list);
+
+   return true;
+}
+
+static void config_map_insert(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   /* Stays at most half full. */
+   if ((conf->entries_map_count + 1) * 2 > conf->entries_map_size)
+      config_map_rebuild(conf, conf->entries_map_size * 2);
+   else
+      config_map_add(conf, entry);
+}
+
+/* Drops the index entry of @entry and makes the next entry
+ * in the list with the same key visible instead. */
+static void config_map_remove(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t mask;
+   size_t slot;
+   struct config_entry_list *next = NULL;
+
+   if (!conf->entries_map_size)
+      return;
+
+   slot = config_map_slot(conf, entry->key, entry->hash);
+
+   if (conf->entries_map[slot] != entry)
+      return;
+
+   for (next = entry->next; next; next = next->next)
+      if (next->hash == entry->hash && string_is_equal(next->key, entry->key))
+         break;
+
+   if (next)
+   {
+      conf->entries_map[slot] = next;
+      return;
+   }
+
+   /* Everything behind the removed bucket up to the
+    * next empty one has to be placed again. */
+   mask                    = conf->entries_map_size - 1;
+   conf->entries_map[slot] = NULL;
+   conf->entries_map_count--;
+
+   for (slot = (slot + 1) & mask; conf->entries_map[slot];
+         slot = (slot + 1) & mask)
+   {
+      struct config_entry_list *moved = conf->entries_map[slot];
+
+      conf->entries_map[slot] = NULL;
+      conf->entries_map_count--;
+      config_map_add(conf, moved);
+   }
+}
+
+static struct config_entry_list *config_get_entry(const config_file_t *conf,
+      const char *key)
+{
+   if (!key || !conf->entries_map_size)
+      return NULL;
+
+   return conf->entries_map[
+      config_map_slot(conf, key, config_hash(key))];
+}
+
+/* Allocates an entry with room for its key and value,
+ * the entry is not added to the list yet. */
+static struct config_entry_list *config_new_entry(config_file_t *conf,
+      const char *key, size_t key_len, const char *value)
+{
+   size_t value_len                = strlen(value);
+   struct config_entry_list *entry = (struct config_entry_list*)
+      config_arena_alloc(conf, sizeof(*entry) + key_len + value_len + 2);
+
+   if (!entry)
+      return NULL;
+
+   entry->readonly   = false;
+   entry->key        = (char*)(entry + 1);
+   entry->value      = entry->key + key_len + 1;
+   entry->value_size = value_len + 1;
+   entry->next       = NULL;
+
+   memcpy(entry->key, key, key_len);
+   entry->key[key_len] = '\0';
+   memcpy(entry->value, value, value_len + 1);
+
+   entry->hash     = config_hash(entry->key);
+
+   return entry;
+}
+
+static void config_add_entry(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   if (conf->tail)
+      conf->tail->next = entry;
+   else
+      conf->entries    = entry;
+
+   conf->tail          = entry;
+
+   config_map_insert(conf, entry);
+}
+
 static int config_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
 {
@@ -80,7 +342,10 @@ static int config_sort_compare_func(struct config_entry_list *a,
    return strcasecmp(a_key, b_key);
 }
 
-/* https://stackoverflow.com/questions/7685/merge-sort-a-linked-list */
+/* https://stackoverflow.com/questions/7685/merge-sort-a-linked-list
+ *
+ * Entries with equal keys keep their order, the first one of them
+ * is still the one returned by lookups. */
 static struct config_entry_list* merge_sort_linked_list(struct config_entry_list *list, int (*compare)(struct config_entry_list *one,struct config_entry_list *two))
 {
    struct config_entry_list
@@ -124,7 +389,7 @@ static struct config_entry_list* merge_sort_linked_list(struct config_entry_list
          next = right;
          right = right->next;
       }
-      else if (compare(list, right) < 0)
+      else if (compare(list, right) <= 0)
       {
          next = list;
          list = list->next;
@@ -184,6 +449,7 @@ static char *strip_comment(char *str)
    return str;
 }
 
+/* Returns the value inside @line, which gets terminated in place. */
 static char *extract_value(char *line, bool is_value)
 {
    char *save = NULL;
@@ -218,7 +484,7 @@ static char *extract_value(char *line, bool is_value)
       tok = strtok_r(line, " \n\t\f\r\v", &save);
 
    if (tok && *tok)
-      return strdup(tok);
+      return tok;
    return NULL;
 }
 
@@ -226,45 +492,25 @@ static char *extract_value(char *line, bool is_value)
 static void add_child_list(config_file_t *parent, config_file_t *child)
 {
    struct config_entry_list *list = child->entries;
-   if (parent->entries)
-   {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
 
-      /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      head->next        = child->entries;
-   }
+   if (parent->tail)
+      parent->tail->next = list;
    else
+      parent->entries    = list;
+
+   /* set list readonly */
+   while (list)
    {
-      /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      parent->entries   = child->entries;
+      list->readonly = true;
+      parent->tail   = list;
+      config_map_insert(parent, list);
+      list           = list->next;
    }
 
    child->entries = NULL;
+   child->tail    = NULL;
 
-   /* Rebase tail. */
-   if (parent->entries)
-   {
-      struct config_entry_list *head =
-         (struct config_entry_list*)parent->entries;
-
-      while (head->next)
-         head = head->next;
-      parent->tail = head;
-   }
-   else
-      parent->tail = NULL;
+   config_arena_pilfer(parent, child);
 }
 
 static void add_sub_conf(config_file_t *conf, char *path, config_file_cb_t *cb)
@@ -323,19 +569,13 @@ static void add_sub_conf(config_file_t *conf, char *path, config_file_cb_t *cb)
    config_file_free(sub_conf);
 }
 
-static bool parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line, config_file_cb_t *cb)
+static bool parse_line(config_file_t *conf, char *line, config_file_cb_t *cb)
 {
-   char *comment   = NULL;
-   char *key_tmp   = NULL;
-   size_t cur_size = 8;
-   size_t idx      = 0;
-   char *key       = (char*)malloc(9);
-
-   if (!key)
-      return false;
-
-   comment = strip_comment(line);
+   size_t key_len                  = 0;
+   char *key                       = NULL;
+   char *value                     = NULL;
+   char *comment                   = strip_comment(line);
+   struct config_entry_list *entry = NULL;
 
    /* Starting line with #include includes config files. */
    if (comment == line)
@@ -352,9 +592,8 @@ static bool parse_line(config_file_t *conf,
                fprintf(stderr, "!!! #include depth exceeded for config. Might be a cycle.\n");
             else
                add_sub_conf(conf, path, cb);
-            free(path);
          }
-         goto error;
+         return false;
       }
    }
 
@@ -362,43 +601,56 @@ static bool parse_line(config_file_t *conf,
    while (isspace((int)*line))
       line++;
 
+   key = line;
    while (isgraph((int)*line))
-   {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp = (char*)realloc(key, cur_size + 1);
+      line++;
+   key_len = line - key;
 
-         if (!key_tmp)
-            goto error;
+   value   = extract_value(line, true);
+   if (!value)
+      return false;
 
-         key = key_tmp;
-      }
+   entry   = config_new_entry(conf, key, key_len, value);
+   if (!entry)
+      return false;
 
-      key[idx++] = *line++;
-   }
-   key[idx]      = '\0';
-   list->key     = key;
+   config_add_entry(conf, entry);
 
-   list->value   = extract_value(line, true);
+   if (cb)
+      cb->config_file_new_entry_cb(entry->key, entry->value);
 
-   if (!list->value)
+   return true;
+}
+
+/* Parses @buf line by line, @buf gets modified. */
+static void config_file_parse(config_file_t *conf,
+      char *buf, size_t len, config_file_cb_t *cb)
+{
+   char *end  = buf + len;
+   char *line = buf;
+
+   while (line < end)
    {
-      list->key = NULL;
-      goto error;
-   }
+      char *next    = end;
+      char *newline = (char*)memchr(line, '\n', end - line);
 
-   return true;
+      if (newline)
+      {
+         *newline   = '\0';
+         next       = newline + 1;
+      }
+      else
+         *end       = '\0';
 
-error:
-   free(key);
-   return false;
+      if (*line)
+         parse_line(conf, line, cb);
+
+      line = next;
+   }
 }
 
-static config_file_t *config_file_new_internal(
-      const char *path, unsigned depth, config_file_cb_t *cb)
+static config_file_t *config_file_new_empty(void)
 {
-   RFILE              *file = NULL;
    struct config_file *conf = (struct config_file*)malloc(sizeof(*conf));
    if (!conf)
       return NULL;
@@ -407,9 +659,26 @@ static config_file_t *config_file_new_internal(
    conf->entries                  = NULL;
    conf->tail                     = NULL;
    conf->last                     = NULL;
+   conf->guaranteed_no_duplicates = false;
+   conf->entries_map              = NULL;
+   conf->entries_map_size         = 0;
+   conf->entries_map_count        = 0;
+   conf->arena                    = NULL;
    conf->includes                 = NULL;
    conf->include_depth            = 0;
-   conf->guaranteed_no_duplicates = false ;
+
+   return conf;
+}
+
+static config_file_t *config_file_new_internal(
+      const char *path, unsigned depth, config_file_cb_t *cb)
+{
+   int64_t size             = 0;
+   char *buf                = NULL;
+   RFILE              *file = NULL;
+   struct config_file *conf = config_file_new_empty();
+   if (!conf)
+      return NULL;
 
    if (!path || !*path)
       return conf;
@@ -427,61 +696,31 @@ static config_file_t *config_file_new_internal(
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
    if (!file)
-   {
-      free(conf->path);
       goto error;
-   }
-
-   while (!filestream_eof(file))
-   {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)malloc(sizeof(*list));
-
-      if (!list)
-      {
-         config_file_free(conf);
-         filestream_close(file);
-         return NULL;
-      }
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      line            = filestream_getline(file);
-
-      if (!line)
-      {
-         free(list);
-         continue;
-      }
-
-      if (*line && parse_line(conf, list, line, cb))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries = list;
 
-         conf->tail = list;
+   /* Read the whole file at once, lines are parsed in place. */
+   size = filestream_get_size(file);
+   if (size >= 0)
+      buf = (char*)malloc((size_t)size + 1);
 
-         if (cb != NULL && list->key != NULL && list->value != NULL)
-            cb->config_file_new_entry_cb(list->key, list->value) ;
-      }
-
-      free(line);
-
-      if (list != conf->tail)
-         free(list);
+   if (!buf)
+   {
+      filestream_close(file);
+      goto error;
    }
 
+   size = filestream_read(file, buf, size);
    filestream_close(file);
 
+   if (size > 0)
+      config_file_parse(conf, buf, (size_t)size, cb);
+
+   free(buf);
+
    return conf;
 
 error:
-   free(conf);
+   config_file_free(conf);
 
    return NULL;
 }
@@ -489,27 +728,16 @@ error:
 void config_file_free(config_file_t *conf)
 {
    struct config_include_list *inc_tmp = NULL;
-   struct config_entry_list *tmp       = NULL;
+   struct config_arena_block *block    = NULL;
    if (!conf)
       return;
 
-   tmp = conf->entries;
-   while (tmp)
+   block = conf->arena;
+   while (block)
    {
-      struct config_entry_list *hold = NULL;
-      if (tmp->key)
-         free(tmp->key);
-      if (tmp->value)
-         free(tmp->value);
-
-      tmp->value = NULL;
-      tmp->key   = NULL;
-
-      hold       = tmp;
-      tmp        = tmp->next;
-
-      if (hold)
-         free(hold);
+      struct config_arena_block *hold = block;
+      block = block->next;
+      free(hold);
    }
 
    inc_tmp = (struct config_include_list*)conf->includes;
@@ -522,6 +750,7 @@ void config_file_free(config_file_t *conf)
       free(hold);
    }
 
+   free(conf->entries_map);
    if (conf->path)
       free(conf->path);
    free(conf);
@@ -529,6 +758,7 @@ void config_file_free(config_file_t *conf)
 
 bool config_append_file(config_file_t *conf, const char *path)
 {
+   size_t count            = 0;
    config_file_t *new_conf = config_file_new(path);
    if (!new_conf)
       return false;
@@ -537,7 +767,16 @@ bool config_append_file(config_file_t *conf, const char *path)
    {
       new_conf->tail->next = conf->entries;
       conf->entries        = new_conf->entries; /* Pilfer. */
+      if (!conf->tail)
+         conf->tail        = new_conf->tail;
       new_conf->entries    = NULL;
+      new_conf->tail       = NULL;
+
+      config_arena_pilfer(conf, new_conf);
+
+      /* The new entries come first now. */
+      count = conf->entries_map_count + new_conf->entries_map_count;
+      config_map_rebuild(conf, count * 2);
    }
 
    config_file_free(new_conf);
@@ -547,62 +786,23 @@ bool config_append_file(config_file_t *conf, const char *path)
 
 config_file_t *config_file_new_from_string(const char *from_string)
 {
-   size_t i;
-   struct string_list *lines = NULL;
-   struct config_file *conf = (struct config_file*)malloc(sizeof(*conf));
+   size_t len          = 0;
+   char *buf           = NULL;
+   config_file_t *conf = config_file_new_empty();
    if (!conf)
       return NULL;
 
    if (!from_string)
       return conf;
 
-   conf->path                     = NULL;
-   conf->entries                  = NULL;
-   conf->tail                     = NULL;
-   conf->last                     = NULL;
-   conf->includes                 = NULL;
-   conf->include_depth            = 0;
-   conf->guaranteed_no_duplicates = false ;
-
-   lines = string_split(from_string, "\n");
-   if (!lines)
+   len = strlen(from_string);
+   buf = (char*)malloc(len + 1);
+   if (!buf)
       return conf;
 
-   for (i = 0; i < lines->size; i++)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)malloc(sizeof(*list));
-      char                    *line  = lines->elems[i].data;
-
-      if (!list)
-      {
-         string_list_free(lines);
-         config_file_free(conf);
-         return NULL;
-      }
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      if (line && conf)
-      {
-         if (*line && parse_line(conf, list, line, NULL))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
-   }
-
-   string_list_free(lines);
+   memcpy(buf, from_string, len + 1);
+   config_file_parse(conf, buf, len, NULL);
+   free(buf);
 
    return conf;
 }
@@ -616,29 +816,9 @@ config_file_t *config_file_new(const char *path)
    return config_file_new_internal(path, 0, NULL);
 }
 
-static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
-{
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
-
-   for (entry = conf->entries; entry; entry = entry->next)
-   {
-      if (string_is_equal(key, entry->key))
-         return entry;
-
-      previous = entry;
-   }
-
-   if (prev)
-      *prev = previous;
-
-   return NULL;
-}
-
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -651,7 +831,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -664,7 +844,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -683,7 +863,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -702,7 +882,7 @@ bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 #if defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -721,7 +901,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -740,7 +920,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -759,7 +939,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -775,7 +955,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -796,7 +976,7 @@ bool config_get_config_path(config_file_t *conf, char *s, size_t len)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -810,7 +990,7 @@ bool config_get_path(config_file_t *conf, const char *key,
    if (config_get_array(conf, key, buf, size))
       return true;
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -823,7 +1003,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -844,49 +1024,60 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = (conf->guaranteed_no_duplicates && conf->last) ? conf->last : conf->entries;
-   struct config_entry_list *entry = conf->guaranteed_no_duplicates?NULL:config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = NULL;
+
+   if (!key || !val)
+      return;
+
+   entry = config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
-      free(entry->value);
-      entry->value = strdup(val);
-      return;
-   }
+      size_t len = strlen(val);
 
-   if (!val)
-      return;
+      /* Reuse the old slot if the new value fits. */
+      if (len < entry->value_size)
+         memmove(entry->value, val, len + 1);
+      else
+      {
+         /* The arena only gets released with the config, grow
+          * geometrically so that a value which keeps changing
+          * does not take a new slot every time. */
+         size_t size = entry->value_size * 2;
+         char *value = NULL;
 
-   entry = (struct config_entry_list*)malloc(sizeof(*entry));
-   if (!entry)
-      return;
+         if (size < len + 1)
+            size = len + 1;
 
-   entry->readonly  = false;
-   entry->key       = strdup(key);
-   entry->value     = strdup(val);
-   entry->next      = NULL;
+         if (!(value = (char*)config_arena_alloc(conf, size)))
+            return;
 
-   if (last)
-      last->next    = entry;
-   else
-      conf->entries = entry;
+         memcpy(value, val, len + 1);
+         entry->value      = value;
+         entry->value_size = size;
+      }
+      return;
+   }
 
-   conf->last = entry ;
+   /* Values from an #include stay in front of the new entry. */
+   entry = config_new_entry(conf, key, strlen(key), val);
+   if (!entry)
+      return;
 
+   config_add_entry(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (!entry)
       return;
 
+   config_map_remove(conf, entry);
+
    entry->key   = NULL;
    entry->value = NULL;
-   free(entry->key);
-   free(entry->value);
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -1014,27 +1205,27 @@ void config_file_dump(config_file_t *conf, FILE *file)
 
    list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
    conf->entries = list;
+   conf->tail    = NULL;
 
    while (list)
    {
       if (!list->readonly && list->key)
-         fprintf(file, "%s = \"%s\"\n", list->key, list->value);
-      list = list->next;
+      {
+         fputs(list->key, file);
+         fputs(" = \"", file);
+         fputs(list->value, file);
+         fputs("\"\n", file);
+      }
+      /* Sorting reorders the list, so the append
+       * pointer has to follow the new last node */
+      conf->tail = list;
+      list       = list->next;
    }
 }
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (string_is_equal(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -248,6 +248,35 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+bool path_get_size_mtime(const char *path, int64_t *size, int64_t *mtime)
+{
+#if defined(VITA) || defined(PSP) || defined(PS2) || defined(__CELLOS_LV2__) || defined(_XBOX) || defined(LEGACY_WIN32)
+   /* No reliable modification time */
+   return false;
+#else
+#if defined(_WIN32)
+   struct _stat64 buf;
+   wchar_t *path_wide = utf8_to_utf16_string_alloc(path);
+   int rv             = path_wide ? _wstat64(path_wide, &buf) : -1;
+
+   free(path_wide);
+
+   if (rv != 0)
+      return false;
+#else
+   struct stat buf;
+   if (stat(path, &buf) != 0)
+      return false;
+#endif
+
+   if (size)
+      *size  = (int64_t)buf.st_size;
+   if (mtime)
+      *mtime = (int64_t)buf.st_mtime;
+   return true;
+#endif
+}
+
 static bool path_mkdir_error(int ret)
 {
 #if defined(VITA)
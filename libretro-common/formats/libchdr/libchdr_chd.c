@@ -61,6 +61,9 @@
 
 #include <retro_inline.h>
 #include <streams/file_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #define TRUE 1
 #define FALSE 0
@@ -190,6 +193,10 @@ struct _metadata_entry
 	UINT8					flags;			/* flag bits */
 };
 
+#ifdef HAVE_THREADS
+typedef struct _chd_thread_pool chd_thread_pool;
+#endif
+
 /* internal representation of an open CHD file */
 struct _chd_file
 {
@@ -229,7 +236,40 @@ struct _chd_file
 	UINT32					maxhunk;		/* maximum hunk accessed */
 #endif
    UINT8 *              file_cache; /* cache of underlying file */
+
+#ifdef HAVE_THREADS
+	slock_t *				io_lock;		/* serializes file access once hunks are decoded on several threads */
+	chd_thread_pool *		pool;			/* decoding threads for chd_read_hunks(), or NULL */
+#endif
+};
+
+#ifdef HAVE_THREADS
+/* a decoding thread, working on a shallow copy of the CHD
+   with its own codecs and compressed data buffer */
+typedef struct _chd_worker chd_worker;
+struct _chd_worker
+{
+	chd_file				chd;			/* copy of the owning CHD */
+	chd_thread_pool *		pool;			/* pool the worker belongs to */
+	sthread_t *				thread;			/* thread running the worker */
+};
+
+struct _chd_thread_pool
+{
+	slock_t *				lock;			/* protects everything below */
+	scond_t *				cond;			/* signalled when a job starts, a hunk is done or on quit */
+	chd_worker *			workers;		/* array of workers */
+	unsigned				count;			/* number of running workers */
+	int						quit;			/* tells the workers to exit */
+
+	UINT8 *					buffer;			/* destination of the current job */
+	UINT32					first;			/* first hunk of the current job */
+	UINT32					total;			/* number of hunks in the current job */
+	UINT32					next;			/* next hunk to hand out, relative to first */
+	UINT32					done;			/* number of hunks finished */
+	chd_error				err;			/* first error of the current job */
 };
+#endif
 
 /***************************************************************************
     GLOBAL VARIABLES
@@ -255,6 +295,11 @@ static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *des
 /* internal map access */
 static chd_error map_read(chd_file *chd);
 
+#ifdef HAVE_THREADS
+/* decoding threads */
+static void thread_pool_free(chd_file *chd);
+#endif
+
 /* metadata management */
 static chd_error metadata_find_entry(chd_file *chd, UINT32 metatag, UINT32 metaindex, metadata_entry *metaentry);
 
@@ -747,6 +792,138 @@ static INLINE void map_extract_old(const UINT8 *base, map_entry *entry, UINT32 h
     CHD FILE MANAGEMENT
 ***************************************************************************/
 
+/*-------------------------------------------------
+    codecs_init - find the codec interfaces and
+    initialize the codecs of a CHD
+-------------------------------------------------*/
+
+static chd_error codecs_init(chd_file *chd)
+{
+	chd_error err = CHDERR_NONE;
+	int intfnum;
+
+	if (chd->header.version < 5)
+	{
+		for (intfnum = 0; intfnum < ARRAY_SIZE(codec_interfaces); intfnum++)
+			if (codec_interfaces[intfnum].compression == chd->header.compression[0])
+			{
+				chd->codecintf[0] = &codec_interfaces[intfnum];
+				break;
+			}
+		if (intfnum == ARRAY_SIZE(codec_interfaces))
+			return CHDERR_UNSUPPORTED_FORMAT;
+
+#ifdef HAVE_ZLIB
+		/* initialize the codec */
+		if (chd->codecintf[0]->init != NULL)
+      {
+         err = (*chd->codecintf[0]->init)(&chd->zlib_codec_data, chd->header.hunkbytes);
+         (void)err;
+      }
+#endif
+	}
+	else
+	{
+		int i, decompnum;
+		/* verify the compression types and initialize the codecs */
+		for (decompnum = 0; decompnum < ARRAY_SIZE(chd->header.compression); decompnum++)
+		{
+			for (i = 0 ; i < ARRAY_SIZE(codec_interfaces) ; i++)
+			{
+				if (codec_interfaces[i].compression == chd->header.compression[decompnum])
+				{
+					chd->codecintf[decompnum] = &codec_interfaces[i];
+					if (chd->codecintf[decompnum] == NULL && chd->header.compression[decompnum] != 0)
+                    {
+						err = CHDERR_UNSUPPORTED_FORMAT;
+                        (void)err;
+                    }
+
+					/* initialize the codec */
+					if (chd->codecintf[decompnum]->init != NULL)
+					{
+						void* codec = NULL;
+						switch (chd->header.compression[decompnum])
+						{
+							case CHD_CODEC_CD_ZLIB:
+#ifdef HAVE_ZLIB
+								codec = &chd->cdzl_codec_data;
+#endif
+								break;
+
+							case CHD_CODEC_CD_LZMA:
+#ifdef HAVE_7ZIP
+								codec = &chd->cdlz_codec_data;
+#endif
+								break;
+
+							case CHD_CODEC_CD_FLAC:
+#ifdef HAVE_FLAC
+								codec = &chd->cdfl_codec_data;
+#endif
+								break;
+						}
+						if (codec != NULL)
+                        {
+							err = (*chd->codecintf[decompnum]->init)(codec, chd->header.hunkbytes);
+                            (void)err;
+                        }
+					}
+
+				}
+			}
+		}
+	}
+
+	return CHDERR_NONE;
+}
+
+/*-------------------------------------------------
+    codecs_free - free the codecs of a CHD
+-------------------------------------------------*/
+
+static void codecs_free(chd_file *chd)
+{
+	if (chd->header.version < 5)
+	{
+#ifdef HAVE_ZLIB
+		if (chd->codecintf[0] != NULL && chd->codecintf[0]->free != NULL)
+			(*chd->codecintf[0]->free)(&chd->zlib_codec_data);
+#endif
+	}
+	else
+	{
+		int i;
+		/* Free the codecs */
+		for (i = 0 ; i < 4 ; i++)
+      {
+         void* codec = NULL;
+         switch (chd->codecintf[i]->compression)
+         {
+            case CHD_CODEC_CD_LZMA:
+#ifdef HAVE_7ZIP
+               codec = &chd->cdlz_codec_data;
+#endif
+               break;
+
+            case CHD_CODEC_CD_ZLIB:
+#ifdef HAVE_ZLIB
+               codec = &chd->cdzl_codec_data;
+#endif
+               break;
+
+            case CHD_CODEC_CD_FLAC:
+#ifdef HAVE_FLAC
+               codec = &chd->cdfl_codec_data;
+#endif
+               break;
+         }
+         if (codec)
+            (*chd->codecintf[i]->free)(codec);
+      }
+	}
+}
+
 /*-------------------------------------------------
     chd_open_file - open a CHD file for access
 -------------------------------------------------*/
@@ -755,7 +932,6 @@ chd_error chd_open_file(RFILE *file, int mode, chd_file *parent, chd_file **chd)
 {
 	chd_file *newchd = NULL;
 	chd_error err;
-	int intfnum;
 
 	/* verify parameters */
 	if (file == NULL)
@@ -841,78 +1017,9 @@ chd_error chd_open_file(RFILE *file, int mode, chd_file *parent, chd_file **chd)
 		EARLY_EXIT(err = CHDERR_OUT_OF_MEMORY);
 
 	/* find the codec interface */
-	if (newchd->header.version < 5)
-	{
-		for (intfnum = 0; intfnum < ARRAY_SIZE(codec_interfaces); intfnum++)
-			if (codec_interfaces[intfnum].compression == newchd->header.compression[0])
-			{
-				newchd->codecintf[0] = &codec_interfaces[intfnum];
-				break;
-			}
-		if (intfnum == ARRAY_SIZE(codec_interfaces))
-			EARLY_EXIT(err = CHDERR_UNSUPPORTED_FORMAT);
-
-#ifdef HAVE_ZLIB
-		/* initialize the codec */
-		if (newchd->codecintf[0]->init != NULL)
-      {
-         err = (*newchd->codecintf[0]->init)(&newchd->zlib_codec_data, newchd->header.hunkbytes);
-         (void)err;
-      }
-#endif
-	}
-	else
-	{
-		int i, decompnum;
-		/* verify the compression types and initialize the codecs */
-		for (decompnum = 0; decompnum < ARRAY_SIZE(newchd->header.compression); decompnum++)
-		{
-			for (i = 0 ; i < ARRAY_SIZE(codec_interfaces) ; i++)
-			{
-				if (codec_interfaces[i].compression == newchd->header.compression[decompnum])
-				{
-					newchd->codecintf[decompnum] = &codec_interfaces[i];
-					if (newchd->codecintf[decompnum] == NULL && newchd->header.compression[decompnum] != 0)
-                    {
-						err = CHDERR_UNSUPPORTED_FORMAT;
-                        (void)err;
-                    }
-
-					/* initialize the codec */
-					if (newchd->codecintf[decompnum]->init != NULL)
-					{
-						void* codec = NULL;
-						switch (newchd->header.compression[decompnum])
-						{
-							case CHD_CODEC_CD_ZLIB:
-#ifdef HAVE_ZLIB
-								codec = &newchd->cdzl_codec_data;
-#endif
-								break;
-
-							case CHD_CODEC_CD_LZMA:
-#ifdef HAVE_7ZIP
-								codec = &newchd->cdlz_codec_data;
-#endif
-								break;
-
-							case CHD_CODEC_CD_FLAC:
-#ifdef HAVE_FLAC
-								codec = &newchd->cdfl_codec_data;
-#endif
-								break;
-						}
-						if (codec != NULL)
-                        {
-							err = (*newchd->codecintf[decompnum]->init)(codec, newchd->header.hunkbytes);
-                            (void)err;
-                        }
-					}
-
-				}
-			}
-		}
-	}
+	err = codecs_init(newchd);
+	if (err != CHDERR_NONE)
+		EARLY_EXIT(err);
 
 #if 0
 	/* HACK */
@@ -1012,49 +1119,19 @@ void chd_close(chd_file *chd)
 	if (chd == NULL || chd->cookie != COOKIE_VALUE)
 		return;
 
-	/* deinit the codec */
-	if (chd->header.version < 5)
-	{
-#ifdef HAVE_ZLIB
-		if (chd->codecintf[0] != NULL && chd->codecintf[0]->free != NULL)
-			(*chd->codecintf[0]->free)(&chd->zlib_codec_data);
+#ifdef HAVE_THREADS
+	/* stop the decoding threads */
+	thread_pool_free(chd);
+	if (chd->io_lock != NULL)
+		slock_free(chd->io_lock);
 #endif
-	}
-	else
-	{
-		int i;
-		/* Free the codecs */
-		for (i = 0 ; i < 4 ; i++)
-      {
-         void* codec = NULL;
-         switch (chd->codecintf[i]->compression)
-         {
-            case CHD_CODEC_CD_LZMA:
-#ifdef HAVE_7ZIP
-               codec = &chd->cdlz_codec_data;
-#endif
-               break;
-
-            case CHD_CODEC_CD_ZLIB:
-#ifdef HAVE_ZLIB
-               codec = &chd->cdzl_codec_data;
-#endif
-               break;
 
-            case CHD_CODEC_CD_FLAC:
-#ifdef HAVE_FLAC
-               codec = &chd->cdfl_codec_data;
-#endif
-               break;
-         }
-         if (codec)
-            (*chd->codecintf[i]->free)(codec);
-      }
+	/* deinit the codec */
+	codecs_free(chd);
 
-		/* Free the raw map */
-		if (chd->header.rawmap != NULL)
-			free(chd->header.rawmap);
-	}
+	/* Free the raw map */
+	if (chd->header.version >= 5 && chd->header.rawmap != NULL)
+		free(chd->header.rawmap);
 
 	/* free the compressed data buffer */
 	if (chd->compressed != NULL)
@@ -1175,6 +1252,235 @@ chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer)
 	return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
 }
 
+#ifdef HAVE_THREADS
+/*-------------------------------------------------
+    thread_pool_take - decode the next hunk of the
+    current job, called with the pool locked
+-------------------------------------------------*/
+
+static void thread_pool_take(chd_thread_pool *pool, chd_file *chd)
+{
+	chd_error err;
+	UINT32 index = pool->next++;
+
+	slock_unlock(pool->lock);
+	err = hunk_read_into_memory(chd, pool->first + index,
+			pool->buffer + (size_t)index * chd->header.hunkbytes);
+	slock_lock(pool->lock);
+
+	if (err != CHDERR_NONE && pool->err == CHDERR_NONE)
+		pool->err = err;
+
+	if (++pool->done == pool->total)
+		scond_broadcast(pool->cond);
+}
+
+static void thread_pool_worker(void *data)
+{
+	chd_worker *worker    = (chd_worker *)data;
+	chd_thread_pool *pool = worker->pool;
+
+	slock_lock(pool->lock);
+
+	while (!pool->quit)
+	{
+		if (pool->next < pool->total)
+			thread_pool_take(pool, &worker->chd);
+		else
+			scond_wait(pool->cond, pool->lock);
+	}
+
+	slock_unlock(pool->lock);
+}
+
+/*-------------------------------------------------
+    thread_pool_free - stop the decoding threads
+    of a CHD
+-------------------------------------------------*/
+
+static void thread_pool_free(chd_file *chd)
+{
+	chd_thread_pool *pool = chd->pool;
+	unsigned i;
+
+	if (pool == NULL)
+		return;
+
+	slock_lock(pool->lock);
+	pool->quit = TRUE;
+	scond_broadcast(pool->cond);
+	slock_unlock(pool->lock);
+
+	for (i = 0; i < pool->count; i++)
+	{
+		sthread_join(pool->workers[i].thread);
+		codecs_free(&pool->workers[i].chd);
+		free(pool->workers[i].chd.compressed);
+	}
+
+	free(pool->workers);
+	scond_free(pool->cond);
+	slock_free(pool->lock);
+	free(pool);
+
+	chd->pool = NULL;
+}
+
+/*-------------------------------------------------
+    thread_pool_new - start 'count' decoding
+    threads for a CHD
+-------------------------------------------------*/
+
+static chd_error thread_pool_new(chd_file *chd, unsigned count)
+{
+	chd_thread_pool *pool = (chd_thread_pool *)calloc(1, sizeof(*pool));
+	unsigned i;
+
+	if (pool == NULL)
+		return CHDERR_OUT_OF_MEMORY;
+
+	chd->pool     = pool;
+	pool->lock    = slock_new();
+	pool->cond    = scond_new();
+	pool->workers = (chd_worker *)calloc(count, sizeof(*pool->workers));
+	if (chd->io_lock == NULL)
+		chd->io_lock = slock_new();
+
+	if (pool->lock == NULL || pool->cond == NULL || pool->workers == NULL || chd->io_lock == NULL)
+		goto cleanup;
+
+	for (i = 0; i < count; i++)
+	{
+		chd_worker *worker = &pool->workers[i];
+
+		/* share the header, map and file, but nothing the
+		   decoders write to */
+		memcpy(&worker->chd, chd, sizeof(*chd));
+		worker->chd.pool = NULL;
+		worker->pool     = pool;
+#ifdef HAVE_ZLIB
+		memset(&worker->chd.zlib_codec_data, 0, sizeof(worker->chd.zlib_codec_data));
+		memset(&worker->chd.cdzl_codec_data, 0, sizeof(worker->chd.cdzl_codec_data));
+#endif
+#ifdef HAVE_7ZIP
+		memset(&worker->chd.cdlz_codec_data, 0, sizeof(worker->chd.cdlz_codec_data));
+#endif
+#ifdef HAVE_FLAC
+		memset(&worker->chd.cdfl_codec_data, 0, sizeof(worker->chd.cdfl_codec_data));
+#endif
+
+		worker->chd.compressed = (UINT8 *)malloc(chd->header.hunkbytes);
+		if (worker->chd.compressed == NULL)
+			goto cleanup;
+
+		if (codecs_init(&worker->chd) != CHDERR_NONE)
+		{
+			codecs_free(&worker->chd);
+			free(worker->chd.compressed);
+			goto cleanup;
+		}
+
+		worker->thread = sthread_create(thread_pool_worker, worker);
+		if (worker->thread == NULL)
+		{
+			codecs_free(&worker->chd);
+			free(worker->chd.compressed);
+			goto cleanup;
+		}
+
+		pool->count++;
+	}
+
+	return CHDERR_NONE;
+
+cleanup:
+	if (pool->lock == NULL || pool->cond == NULL)
+	{
+		if (pool->lock)
+			slock_free(pool->lock);
+		if (pool->cond)
+			scond_free(pool->cond);
+		free(pool->workers);
+		free(pool);
+		chd->pool = NULL;
+	}
+	else
+		thread_pool_free(chd);
+	return CHDERR_OUT_OF_MEMORY;
+}
+#endif
+
+/*-------------------------------------------------
+    chd_read_hunks - read consecutive hunks from
+    the CHD file, decoding them on several threads
+-------------------------------------------------*/
+
+chd_error chd_read_hunks(chd_file *chd, UINT32 hunknum, UINT32 count, void *buffer, unsigned threads)
+{
+	UINT8 *dest = (UINT8 *)buffer;
+	UINT32 i;
+
+	/* punt if NULL or invalid */
+	if (chd == NULL || chd->cookie != COOKIE_VALUE || buffer == NULL)
+		return CHDERR_INVALID_PARAMETER;
+
+	if (hunknum >= chd->header.totalhunks || count > chd->header.totalhunks - hunknum)
+		return CHDERR_HUNK_OUT_OF_RANGE;
+
+#ifdef HAVE_THREADS
+	if (threads > count)
+		threads = count;
+
+	/* parent files are read without the lock, keep those on one thread */
+	if (threads > 1 && chd->parent == NULL)
+	{
+		chd_thread_pool *pool = chd->pool;
+		chd_error err;
+
+		/* the calling thread decodes too */
+		if (pool != NULL && pool->count != threads - 1)
+			thread_pool_free(chd);
+
+		if (chd->pool == NULL && thread_pool_new(chd, threads - 1) != CHDERR_NONE)
+			goto serial;
+
+		pool = chd->pool;
+		slock_lock(pool->lock);
+
+		pool->buffer = dest;
+		pool->first  = hunknum;
+		pool->total  = count;
+		pool->next   = 0;
+		pool->done   = 0;
+		pool->err    = CHDERR_NONE;
+		scond_broadcast(pool->cond);
+
+		while (pool->next < pool->total)
+			thread_pool_take(pool, chd);
+
+		while (pool->done < pool->total)
+			scond_wait(pool->cond, pool->lock);
+
+		err          = pool->err;
+		pool->total  = 0;
+		pool->next   = 0;
+
+		slock_unlock(pool->lock);
+		return err;
+	}
+
+serial:
+#endif
+	for (i = 0; i < count; i++)
+	{
+		chd_error err = hunk_read_into_memory(chd, hunknum + i, dest + (size_t)i * chd->header.hunkbytes);
+		if (err != CHDERR_NONE)
+			return err;
+	}
+
+	return CHDERR_NONE;
+}
+
 /***************************************************************************
     METADATA MANAGEMENT
 ***************************************************************************/
@@ -1518,13 +1824,30 @@ static chd_error hunk_read_into_cache(chd_file *chd, UINT32 hunknum)
 }
 #endif
 
+/* reads from the file, the file position is shared by all
+   threads decoding hunks of the CHD */
+static int64_t read_file(chd_file *chd, UINT64 offset, size_t size, UINT8 *dest)
+{
+   int64_t bytes;
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_lock(chd->io_lock);
+#endif
+   filestream_seek(chd->file, offset, SEEK_SET);
+   bytes = filestream_read(chd->file, dest, size);
+#ifdef HAVE_THREADS
+   if (chd->io_lock)
+      slock_unlock(chd->io_lock);
+#endif
+   return bytes;
+}
+
 static UINT8* read_compressed(chd_file *chd, UINT64 offset, size_t size)
 {
    int64_t bytes;
    if (chd->file_cache)
       return chd->file_cache + offset;
-   filestream_seek(chd->file, offset, SEEK_SET);
-   bytes = filestream_read(chd->file, chd->compressed, size);
+   bytes = read_file(chd, offset, size, chd->compressed);
    if (bytes != size)
       return NULL;
    return chd->compressed;
@@ -1538,8 +1861,7 @@ static chd_error read_uncompressed(chd_file *chd, UINT64 offset, size_t size, UI
       memcpy(dest, chd->file_cache + offset, size);
       return CHDERR_NONE;
    }
-   filestream_seek(chd->file, offset, SEEK_SET);
-   bytes = filestream_read(chd->file, dest, size);
+   bytes = read_file(chd, offset, size, dest);
    if (bytes != size)
       return CHDERR_READ_ERROR;
    return CHDERR_NONE;
@@ -1589,7 +1911,7 @@ static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *des
                err   = CHDERR_NONE;
                codec = &chd->zlib_codec_data;
                if (chd->codecintf[0]->decompress != NULL)
-                  err = (*chd->codecintf[0]->decompress)(codec, chd->compressed, entry->length, dest, chd->header.hunkbytes);
+                  err = (*chd->codecintf[0]->decompress)(codec, bytes, entry->length, dest, chd->header.hunkbytes);
                if (err != CHDERR_NONE)
                   return err;
 #endif
@@ -1693,7 +2015,7 @@ static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *des
 				}
 				if (codec==NULL)
 					return CHDERR_CODEC_ERROR;
-				err = (*chd->codecintf[rawmap[0]]->decompress)(codec, chd->compressed, blocklen, dest, chd->header.hunkbytes);
+				err = (*chd->codecintf[rawmap[0]]->decompress)(codec, bytes, blocklen, dest, chd->header.hunkbytes);
 				if (err != CHDERR_NONE)
 					return err;
 #ifdef VERIFY_BLOCK_CRC
@@ -66,6 +66,11 @@ audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_flac(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mp3(void *buffer, int32_t size);
 
+/* OGG, FLAC and MP3 sounds can be decoded from the file
+ * while they play instead of being loaded into memory. */
+audio_mixer_sound_t* audio_mixer_load_file(const char *path,
+      enum audio_mixer_type type);
+
 void audio_mixer_destroy(audio_mixer_sound_t* sound);
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
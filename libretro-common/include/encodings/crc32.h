@@ -30,7 +30,40 @@
 
 RETRO_BEGIN_DECLS
 
+typedef uint32_t (*encoding_crc32_func_t)(uint32_t crc,
+      const uint8_t *buf, size_t len);
+
+typedef struct encoding_crc32_impl
+{
+   const char *ident;
+   encoding_crc32_func_t func;
+} encoding_crc32_impl_t;
+
+/**
+ * encoding_crc32:
+ * @crc                  : CRC32 of the preceding data, 0 to start.
+ * @buf                  : data to hash.
+ * @len                  : size of @buf in bytes.
+ *
+ * Standard (zlib compatible) CRC32. Uses the fastest
+ * implementation the CPU supports, see encoding_crc32_get_impls().
+ *
+ * Returns: the CRC32 of the preceding data followed by @buf.
+ **/
 uint32_t encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * encoding_crc32_get_impls:
+ * @count                : number of entries in the returned array.
+ *
+ * Lists the implementations usable on this CPU, fastest first.
+ * The first entry is the one encoding_crc32() uses, the last one
+ * is the reference byte-at-a-time version.
+ *
+ * Returns: array of implementations.
+ **/
+const encoding_crc32_impl_t *encoding_crc32_get_impls(unsigned *count);
+
 uint32_t file_crc32(uint32_t crc, const char *path);
 
 RETRO_END_DECLS
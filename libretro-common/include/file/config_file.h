@@ -55,13 +55,25 @@ RETRO_BEGIN_DECLS
 struct config_file
 {
    char *path;
+   /* Entries in the order they were read or added. */
    struct config_entry_list *entries;
    struct config_entry_list *tail;
+   /* Deprecated, unused since lookups go through entries_map. */
    struct config_entry_list *last;
    unsigned include_depth;
+   /* Deprecated, unused since lookups go through entries_map. */
    bool guaranteed_no_duplicates;
 
    struct config_include_list *includes;
+
+   /* Hash index over the entries, open addressing.
+    * Points at the first entry of the list for every key. */
+   struct config_entry_list **entries_map;
+   size_t entries_map_size;
+   size_t entries_map_count;
+   /* Entries, keys and values are allocated from here
+    * and are all released together with the config. */
+   struct config_arena_block *arena;
 };
 
 
@@ -490,6 +490,17 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_size_mtime:
+ * @path               : path
+ * @size               : size of the file, can be NULL.
+ * @mtime              : modification time of the file, can be NULL.
+ *
+ * Returns: false if @path does not exist or if the platform
+ * has no reliable modification time.
+ */
+bool path_get_size_mtime(const char *path, int64_t *size, int64_t *mtime);
+
 RETRO_END_DECLS
 
 #endif
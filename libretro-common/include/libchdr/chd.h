@@ -379,6 +379,11 @@ const chd_header *chd_get_header(chd_file *chd);
 /* read one hunk from the CHD file */
 chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer);
 
+/* read 'count' consecutive hunks into one buffer, decoding them on up to
+   'threads' threads (the caller included) with one set of codecs each;
+   the threads stay around until the CHD is closed */
+chd_error chd_read_hunks(chd_file *chd, UINT32 hunknum, UINT32 count, void *buffer, unsigned threads);
+
 
 
 /* ----- metadata management ----- */
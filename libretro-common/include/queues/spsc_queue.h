@@ -0,0 +1,77 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Byte queue with one writer thread and one reader thread.
+ *
+ * Neither side takes a lock: the writer only ever advances the
+ * write position and the reader only ever advances the read
+ * position. spsc_write_avail() may only be called by the writer,
+ * spsc_read_avail() may only be called by the reader.
+ *
+ * Calls to spsc_write()/spsc_read() have to be preceded by a
+ * check that enough space/data is available. */
+
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * spsc_new:
+ * @size                 : minimum capacity in bytes.
+ *
+ * The capacity is rounded up to the next power of two.
+ *
+ * Returns: new queue, NULL on error.
+ **/
+spsc_queue_t *spsc_new(size_t size);
+
+void spsc_free(spsc_queue_t *queue);
+
+size_t spsc_capacity(const spsc_queue_t *queue);
+
+size_t spsc_read_avail(spsc_queue_t *queue);
+
+size_t spsc_write_avail(spsc_queue_t *queue);
+
+void spsc_write(spsc_queue_t *queue, const void *in_buf, size_t size);
+
+void spsc_read(spsc_queue_t *queue, void *out_buf, size_t size);
+
+/**
+ * spsc_clear:
+ *
+ * Drops all queued data. Must only be called while neither
+ * the reader nor the writer are using the queue.
+ **/
+void spsc_clear(spsc_queue_t *queue);
+
+RETRO_END_DECLS
+
+#endif
@@ -42,6 +42,20 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* Order in which queued tasks are picked up by the workers.
+ * A task only runs when no task of a more urgent class is
+ * waiting on the same worker. */
+enum task_priority
+{
+   /* Default class, e.g. downloads. */
+   TASK_PRIORITY_BACKGROUND = 0,
+   /* Work the user is waiting on, e.g. thumbnails or savestates. */
+   TASK_PRIORITY_INTERACTIVE,
+   /* Long running work, e.g. content scanning. */
+   TASK_PRIORITY_BULK,
+   TASK_PRIORITY_COUNT
+};
+
 
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(void *task_data,
@@ -110,8 +124,11 @@ struct retro_task
 
    enum task_type type;
 
+   enum task_priority priority;
+
    /* don't touch this. */
    retro_task_t *next;
+   int64_t queued_usec;
 };
 
 typedef struct task_finder_data
@@ -134,6 +151,33 @@ typedef struct task_retriever_data
    task_retriever_info_t *list;
 } task_retriever_data_t;
 
+typedef struct task_queue_stats
+{
+   /* Tasks currently queued or running. */
+   unsigned depth;
+   unsigned max_depth;
+   /* Handler invocations and finished tasks. */
+   uint64_t runs;
+   uint64_t completed;
+   /* Time spent queued before the handler ran, in microseconds. */
+   int64_t wait_usec;
+   int64_t max_wait_usec;
+   /* Time spent inside the handler, in microseconds. */
+   int64_t run_usec;
+   int64_t max_run_usec;
+} task_queue_stats_t;
+
+/* Number of task types statistics are kept for. */
+#define TASK_QUEUE_MAX_STATS 32
+
+typedef struct task_queue_handler_stats
+{
+   retro_task_handler_t handler;
+   /* Title of the first task pushed with this handler. */
+   char label[64];
+   task_queue_stats_t stats;
+} task_queue_handler_stats_t;
+
 void *task_queue_retriever_info_next(task_retriever_info_t **link);
 
 void task_queue_retriever_info_free(task_retriever_info_t *list);
@@ -173,6 +217,28 @@ char* task_get_title(retro_task_t *task);
 
 void* task_get_data(retro_task_t *task);
 
+/* Number of worker threads used by the threaded task queue,
+ * 0 picks one based on the number of CPU cores.
+ * Takes effect on the next call to task_queue_check(). */
+void task_queue_set_workers(unsigned workers);
+
+unsigned task_queue_get_workers(void);
+
+/* Statistics for all tasks run with @handler,
+ * i.e. for one type of task. Returns false if no
+ * such task was ever pushed. */
+bool task_queue_get_stats(retro_task_handler_t handler,
+      task_queue_stats_t *stats);
+
+/* Copies the statistics of up to @max types of task
+ * pushed so far into @stats, returns how many. */
+unsigned task_queue_get_all_stats(task_queue_handler_stats_t *stats,
+      unsigned max);
+
+/* Statistics for all tasks of one priority class. */
+void task_queue_get_priority_stats(enum task_priority priority,
+      task_queue_stats_t *stats);
+
 void task_queue_set_threaded(void);
 
 void task_queue_unset_threaded(void);
@@ -39,6 +39,21 @@ typedef struct chdstream chdstream_t;
 /* Primary (largest) data track, used for CRC identification purposes */
 #define CHDSTREAM_TRACK_PRIMARY (-3)
 
+/* Memory a stream may spend on decompressed hunks by default */
+#define CHDSTREAM_CACHE_SIZE_DEFAULT (1024 * 1024)
+
+typedef struct chdstream_stats
+{
+   /* Hunks found decompressed already */
+   uint64_t hits;
+   /* Hunks the reader had to decompress itself */
+   uint64_t misses;
+   /* Hunks decompressed by the read-ahead */
+   uint64_t prefetched;
+   /* Hits on hunks decompressed by the read-ahead */
+   uint64_t prefetch_hits;
+} chdstream_stats_t;
+
 chdstream_t *chdstream_open(const char *path, int32_t track);
 
 void chdstream_close(chdstream_t *stream);
@@ -57,6 +72,29 @@ int64_t chdstream_seek(chdstream_t *stream, int64_t offset, int whence);
 
 ssize_t chdstream_get_size(chdstream_t *stream);
 
+/**
+ * chdstream_set_cache_size:
+ * @stream             : CHD stream.
+ * @bytes              : Memory budget for decompressed hunks.
+ *
+ * Replaces the hunk cache, which keeps the most recently read
+ * hunks around. At least two hunks are kept whatever the budget.
+ **/
+void chdstream_set_cache_size(chdstream_t *stream, size_t bytes);
+
+/**
+ * chdstream_set_readahead:
+ * @stream             : CHD stream.
+ * @hunks              : Number of hunks to decompress ahead, 0 disables.
+ *
+ * Once the stream is read sequentially, the hunks following the
+ * read cursor get decompressed on a separate thread. Limited by
+ * the size of the hunk cache, does nothing without HAVE_THREADS.
+ **/
+void chdstream_set_readahead(chdstream_t *stream, unsigned hunks);
+
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,196 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/spsc_queue.h>
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define SPSC_ATOMIC_GCC
+#elif defined(_MSC_VER) && !defined(_XBOX)
+#define SPSC_ATOMIC_MSVC
+#include <windows.h>
+#elif defined(HAVE_THREADS)
+#define SPSC_ATOMIC_LOCK
+#include <rthreads/rthreads.h>
+#endif
+
+struct spsc_queue
+{
+   uint8_t *buffer;
+   size_t mask;
+#ifdef SPSC_ATOMIC_LOCK
+   slock_t *lock;
+#endif
+   /* Both positions only ever increase and wrap around
+    * at SIZE_MAX, the buffer offset is (pos & mask).
+    * Kept on separate cache lines so that the reader and
+    * the writer do not keep stealing each other's line. */
+   uint8_t pad0[64];
+   volatile size_t write_pos;
+   uint8_t pad1[64];
+   volatile size_t read_pos;
+   uint8_t pad2[64];
+};
+
+/* Load with acquire semantics: data written before the
+ * matching store is visible once the new value is seen. */
+static size_t spsc_load(spsc_queue_t *queue, volatile size_t *pos)
+{
+#if defined(SPSC_ATOMIC_GCC)
+   (void)queue;
+   return __atomic_load_n(pos, __ATOMIC_ACQUIRE);
+#elif defined(SPSC_ATOMIC_MSVC)
+   size_t val = *pos;
+   (void)queue;
+   MemoryBarrier();
+   return val;
+#elif defined(SPSC_ATOMIC_LOCK)
+   size_t val;
+   slock_lock(queue->lock);
+   val = *pos;
+   slock_unlock(queue->lock);
+   return val;
+#else
+   (void)queue;
+   return *pos;
+#endif
+}
+
+/* Store with release semantics. */
+static void spsc_store(spsc_queue_t *queue, volatile size_t *pos, size_t val)
+{
+#if defined(SPSC_ATOMIC_GCC)
+   (void)queue;
+   __atomic_store_n(pos, val, __ATOMIC_RELEASE);
+#elif defined(SPSC_ATOMIC_MSVC)
+   (void)queue;
+   MemoryBarrier();
+   *pos = val;
+#elif defined(SPSC_ATOMIC_LOCK)
+   slock_lock(queue->lock);
+   *pos = val;
+   slock_unlock(queue->lock);
+#else
+   (void)queue;
+   *pos = val;
+#endif
+}
+
+spsc_queue_t *spsc_new(size_t size)
+{
+   size_t capacity     = 1;
+   spsc_queue_t *queue = (spsc_queue_t*)calloc(1, sizeof(*queue));
+
+   if (!queue)
+      return NULL;
+
+   while (capacity < size)
+      capacity <<= 1;
+
+   queue->buffer = (uint8_t*)malloc(capacity);
+   if (!queue->buffer)
+      goto error;
+
+#ifdef SPSC_ATOMIC_LOCK
+   queue->lock   = slock_new();
+   if (!queue->lock)
+      goto error;
+#endif
+
+   queue->mask   = capacity - 1;
+
+   return queue;
+
+error:
+   spsc_free(queue);
+   return NULL;
+}
+
+void spsc_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+#ifdef SPSC_ATOMIC_LOCK
+   if (queue->lock)
+      slock_free(queue->lock);
+#endif
+   free(queue->buffer);
+   free(queue);
+}
+
+size_t spsc_capacity(const spsc_queue_t *queue)
+{
+   return queue->mask + 1;
+}
+
+size_t spsc_read_avail(spsc_queue_t *queue)
+{
+   /* read_pos is only modified by the reader itself. */
+   return spsc_load(queue, &queue->write_pos) - queue->read_pos;
+}
+
+size_t spsc_write_avail(spsc_queue_t *queue)
+{
+   return (queue->mask + 1) -
+      (queue->write_pos - spsc_load(queue, &queue->read_pos));
+}
+
+void spsc_write(spsc_queue_t *queue, const void *in_buf, size_t size)
+{
+   size_t pos         = queue->write_pos;
+   size_t offset      = pos & queue->mask;
+   size_t first_write = size;
+
+   if (offset + size > queue->mask + 1)
+      first_write = (queue->mask + 1) - offset;
+
+   memcpy(queue->buffer + offset, in_buf, first_write);
+   memcpy(queue->buffer, (const uint8_t*)in_buf + first_write,
+         size - first_write);
+
+   spsc_store(queue, &queue->write_pos, pos + size);
+}
+
+void spsc_read(spsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t pos        = queue->read_pos;
+   size_t offset     = pos & queue->mask;
+   size_t first_read = size;
+
+   if (offset + size > queue->mask + 1)
+      first_read = (queue->mask + 1) - offset;
+
+   memcpy(out_buf, queue->buffer + offset, first_read);
+   memcpy((uint8_t*)out_buf + first_read, queue->buffer,
+         size - first_read);
+
+   spsc_store(queue, &queue->read_pos, pos + size);
+}
+
+void spsc_clear(spsc_queue_t *queue)
+{
+   queue->write_pos = 0;
+   queue->read_pos  = 0;
+}
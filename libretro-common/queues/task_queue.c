@@ -23,8 +23,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <queues/task_queue.h>
+#include <features/features_cpu.h>
+#include <compat/strl.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -35,6 +38,8 @@
 #define SLOCK_UNLOCK(x)
 #endif
 
+#define TASK_QUEUE_MAX_WORKERS 8
+
 typedef struct
 {
    retro_task_t *front;
@@ -59,8 +64,17 @@ static retro_task_queue_msg_t msg_push_bak;
 static task_queue_t tasks_running  = {NULL, NULL};
 static task_queue_t tasks_finished = {NULL, NULL};
 
+static task_queue_handler_stats_t task_stats[TASK_QUEUE_MAX_STATS];
+static unsigned task_stats_count   = 0;
+static task_queue_stats_t task_priority_stats[TASK_PRIORITY_COUNT];
+
 static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
+static unsigned task_workers_wanted         = 0;
+
+#ifdef HAVE_THREADS
+static slock_t *stats_lock                  = NULL;
+#endif
 
 static void task_queue_msg_push(retro_task_t *task,
       unsigned prio, unsigned duration,
@@ -130,12 +144,115 @@ static retro_task_t *task_queue_get(task_queue_t *queue)
    return task;
 }
 
+/* Statistics
+ *
+ * Kept per handler, which identifies the type of a task,
+ * and per priority class. Must be called with stats_lock held. */
+static task_queue_stats_t *task_queue_stats_find(
+      retro_task_t *task, bool create)
+{
+   unsigned i;
+   task_queue_handler_stats_t *entry = NULL;
+
+   for (i = 0; i < task_stats_count; i++)
+      if (task_stats[i].handler == task->handler)
+         return &task_stats[i].stats;
+
+   if (!create || task_stats_count >= TASK_QUEUE_MAX_STATS)
+      return NULL;
+
+   entry           = &task_stats[task_stats_count++];
+   entry->handler  = task->handler;
+   entry->label[0] = '\0';
+   if (task->title)
+      strlcpy(entry->label, task->title, sizeof(entry->label));
+   memset(&entry->stats, 0, sizeof(entry->stats));
+
+   return &entry->stats;
+}
+
+static void task_queue_stats_pushed(retro_task_t *task)
+{
+   task_queue_stats_t *stats[2];
+   unsigned i;
+
+   SLOCK_LOCK(stats_lock);
+   stats[0] = &task_priority_stats[task->priority];
+   stats[1] = task_queue_stats_find(task, true);
+
+   for (i = 0; i < 2; i++)
+   {
+      if (!stats[i])
+         continue;
+      if (++stats[i]->depth > stats[i]->max_depth)
+         stats[i]->max_depth = stats[i]->depth;
+   }
+   SLOCK_UNLOCK(stats_lock);
+}
+
+static void task_queue_stats_ran(retro_task_t *task,
+      int64_t start_usec, int64_t end_usec)
+{
+   task_queue_stats_t *stats[2];
+   unsigned i;
+   int64_t wait_usec = start_usec - task->queued_usec;
+   int64_t run_usec  = end_usec - start_usec;
+
+   SLOCK_LOCK(stats_lock);
+   stats[0] = &task_priority_stats[task->priority];
+   stats[1] = task_queue_stats_find(task, false);
+
+   for (i = 0; i < 2; i++)
+   {
+      if (!stats[i])
+         continue;
+      stats[i]->runs++;
+      stats[i]->wait_usec += wait_usec;
+      stats[i]->run_usec  += run_usec;
+      if (wait_usec > stats[i]->max_wait_usec)
+         stats[i]->max_wait_usec = wait_usec;
+      if (run_usec > stats[i]->max_run_usec)
+         stats[i]->max_run_usec = run_usec;
+   }
+   SLOCK_UNLOCK(stats_lock);
+}
+
+static void task_queue_stats_finished(retro_task_t *task)
+{
+   task_queue_stats_t *stats[2];
+   unsigned i;
+
+   SLOCK_LOCK(stats_lock);
+   stats[0] = &task_priority_stats[task->priority];
+   stats[1] = task_queue_stats_find(task, false);
+
+   for (i = 0; i < 2; i++)
+   {
+      if (!stats[i])
+         continue;
+      if (stats[i]->depth)
+         stats[i]->depth--;
+      stats[i]->completed++;
+   }
+   SLOCK_UNLOCK(stats_lock);
+}
+
+static void task_queue_run_handler(retro_task_t *task)
+{
+   int64_t start_usec = cpu_features_get_time_usec();
+
+   task->handler(task);
+
+   task_queue_stats_ran(task, start_usec, cpu_features_get_time_usec());
+}
+
 static void retro_task_internal_gather(void)
 {
    retro_task_t *task = NULL;
    while ((task = task_queue_get(&tasks_finished)) != NULL)
    {
       task_queue_push_progress(task);
+      task_queue_stats_finished(task);
 
       if (task->callback)
          task->callback(task->task_data, task->user_data, task->error);
@@ -153,8 +270,50 @@ static void retro_task_internal_gather(void)
    }
 }
 
+static bool task_queue_retrieve_task(task_retriever_data_t *data,
+      retro_task_t *task, task_retriever_info_t **tail)
+{
+   task_retriever_info_t *info = NULL;
+
+   if (task->handler != data->handler)
+      return false;
+
+   /* Create new link */
+   info       = (task_retriever_info_t*)malloc(sizeof(task_retriever_info_t));
+   info->data = malloc(data->element_size);
+   info->next = NULL;
+
+   /* Call retriever function and fill info-specific data */
+   if (!data->func(task, info->data))
+   {
+      free(info->data);
+      free(info);
+      return false;
+   }
+
+   /* Add link to list */
+   if (data->list)
+   {
+      if (*tail)
+      {
+         (*tail)->next = info;
+         *tail         = (*tail)->next;
+      }
+      else
+         *tail         = info;
+   }
+   else
+   {
+      data->list    = info;
+      *tail         = data->list;
+   }
+
+   return true;
+}
+
 static void retro_task_regular_push_running(retro_task_t *task)
 {
+   task->queued_usec = cpu_features_get_time_usec();
    task_queue_put(&tasks_running, task);
 }
 
@@ -179,7 +338,7 @@ static void retro_task_regular_gather(void)
    for (task = queue; task; task = next)
    {
       next = task->next;
-      task->handler(task);
+      task_queue_run_handler(task);
 
       task_queue_push_progress(task);
 
@@ -234,41 +393,7 @@ static void retro_task_regular_retrieve(task_retriever_data_t *data)
 
    /* Parse all running tasks and handle matching handlers */
    for (task = tasks_running.front; task != NULL; task = task->next)
-   {
-      task_retriever_info_t *info = NULL;
-      if (task->handler != data->handler)
-         continue;
-
-      /* Create new link */
-      info       = (task_retriever_info_t*)malloc(sizeof(task_retriever_info_t));
-      info->data = malloc(data->element_size);
-      info->next = NULL;
-
-      /* Call retriever function and fill info-specific data */
-      if (!data->func(task, info->data))
-      {
-         free(info->data);
-         free(info);
-         continue;
-      }
-
-      /* Add link to list */
-      if (data->list)
-      {
-         if (tail)
-         {
-            tail->next = info;
-            tail       = tail->next;
-         }
-         else
-            tail       = info;
-      }
-      else
-      {
-         data->list    = info;
-         tail          = data->list;
-      }
-   }
+      task_queue_retrieve_task(data, task, &tail);
 }
 
 static struct retro_task_impl impl_regular = {
@@ -285,90 +410,293 @@ static struct retro_task_impl impl_regular = {
 };
 
 #ifdef HAVE_THREADS
+/* Threaded Task Queue
+ *
+ * Every worker owns one queue per priority class and always
+ * runs the most urgent task it has. Tasks that are not finished
+ * yet go back to the queue of the worker that ran them, idle
+ * workers steal queued tasks from the others.
+ *
+ * When two worker locks are held at once they are always taken
+ * in ascending worker order. */
+typedef struct
+{
+   slock_t *lock;
+   sthread_t *thread;
+   task_queue_t queues[TASK_PRIORITY_COUNT];
+   /* task being run by this worker, if any */
+   retro_task_t *current;
+   /* number of tasks in queues */
+   unsigned depth;
+   unsigned id;
+} task_worker_t;
+
+typedef struct
+{
+   retro_task_finder_t func;
+   void *user_data;
+} task_find_state_t;
+
+typedef struct
+{
+   task_retriever_data_t *data;
+   task_retriever_info_t *tail;
+} task_retrieve_state_t;
+
+/* Order in which the priority classes are served. */
+static const enum task_priority task_priority_order[TASK_PRIORITY_COUNT] = {
+   TASK_PRIORITY_INTERACTIVE,
+   TASK_PRIORITY_BACKGROUND,
+   TASK_PRIORITY_BULK
+};
+
+static task_worker_t task_workers[TASK_QUEUE_MAX_WORKERS];
+static unsigned task_workers_count = 0;
+
 static slock_t *running_lock    = NULL;
 static slock_t *finished_lock   = NULL;
 static slock_t *property_lock   = NULL;
-static slock_t *queue_lock      = NULL;
+static slock_t *worker_lock     = NULL;
 static scond_t *worker_cond     = NULL;
-static sthread_t *worker_thread = NULL;
-static bool worker_continue     = true; /* use running_lock when touching it */
+/* use worker_lock when touching these */
+static bool worker_continue     = true;
+static unsigned tasks_queued    = 0;
+static unsigned tasks_in_flight = 0;
 
-static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
+static unsigned task_workers_default(void)
 {
-   retro_task_t     *t = NULL;
-   retro_task_t *front = NULL;
+   unsigned cores = cpu_features_get_core_amount();
 
-   slock_lock(queue_lock);
-   front = queue->front;
-   slock_unlock(queue_lock);
+   /* Leave a core to the main thread */
+   if (cores > 1)
+      cores--;
 
-   /* Remove first element if needed */
-   if (task == front)
-   {
-      slock_lock(queue_lock);
-      queue->front = task->next;
-      slock_unlock(queue_lock);
-      task->next   = NULL;
+   if (cores > 4)
+      cores = 4;
 
-      return;
+   return cores;
+}
+
+/* Number of workers the pool should run with, always
+ * clamped so that it can be compared to task_workers_count. */
+static unsigned task_workers_target(void)
+{
+   unsigned workers = task_workers_wanted
+      ? task_workers_wanted : task_workers_default();
+
+   if (workers > TASK_QUEUE_MAX_WORKERS)
+      workers = TASK_QUEUE_MAX_WORKERS;
+
+   return workers;
+}
+
+static void task_worker_put(task_worker_t *worker,
+      retro_task_t *task, bool requeue)
+{
+   bool wake         = true;
+
+   task->queued_usec = cpu_features_get_time_usec();
+
+   slock_lock(worker->lock);
+   if (requeue)
+   {
+      worker->current = NULL;
+      /* Only ask for help when this worker has more
+       * than the task it is already working on. */
+      wake            = worker->depth > 0;
    }
+   task_queue_put(&worker->queues[task->priority], task);
+   worker->depth++;
+   slock_unlock(worker->lock);
+
+   slock_lock(worker_lock);
+   tasks_queued++;
+   if (wake)
+      scond_signal(worker_cond);
+   slock_unlock(worker_lock);
+}
+
+/* Must be called with the lock of @worker held. */
+static retro_task_t *task_worker_get(task_worker_t *worker)
+{
+   unsigned i;
+   retro_task_t *task = NULL;
+
+   if (!worker->depth)
+      return NULL;
+
+   for (i = 0; i < TASK_PRIORITY_COUNT && !task; i++)
+      task = task_queue_get(&worker->queues[task_priority_order[i]]);
+
+   if (task)
+      worker->depth--;
+
+   return task;
+}
 
-   /* Parse queue */
-   t = front;
+static retro_task_t *task_worker_steal(task_worker_t *thief)
+{
+   unsigned i;
 
-   while (t && t->next)
+   for (i = 1; i < task_workers_count; i++)
    {
-      /* Remove task and update queue */
-      if (t->next == task)
-      {
-         t->next    = task->next;
-         task->next = NULL;
-         break;
-      }
+      retro_task_t *task     = NULL;
+      task_worker_t *victim  = &task_workers[
+         (thief->id + i) % task_workers_count];
+      task_worker_t *first   = victim->id < thief->id ? victim : thief;
+      task_worker_t *second  = victim->id < thief->id ? thief  : victim;
+
+      slock_lock(first->lock);
+      slock_lock(second->lock);
+      task = task_worker_get(victim);
+      if (task)
+         thief->current = task;
+      slock_unlock(second->lock);
+      slock_unlock(first->lock);
+
+      if (task)
+         return task;
+   }
+
+   return NULL;
+}
 
-      /* Update iterator */
-      t = t->next;
+static retro_task_t *task_worker_next(task_worker_t *worker)
+{
+   retro_task_t *task = NULL;
+
+   slock_lock(worker->lock);
+   task = task_worker_get(worker);
+   if (task)
+      worker->current = task;
+   slock_unlock(worker->lock);
+
+   if (!task)
+      task = task_worker_steal(worker);
+
+   if (task)
+   {
+      slock_lock(worker_lock);
+      tasks_queued--;
+      slock_unlock(worker_lock);
    }
+
+   return task;
 }
 
-static void retro_task_threaded_push_running(retro_task_t *task)
+static task_worker_t *task_worker_least_loaded(void)
 {
-   slock_lock(running_lock);
-   slock_lock(queue_lock);
-   task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
-   slock_unlock(queue_lock);
-   slock_unlock(running_lock);
+   unsigned i;
+   task_worker_t *best = &task_workers[0];
+   unsigned best_depth = (unsigned)-1;
+
+   for (i = 0; i < task_workers_count; i++)
+   {
+      unsigned depth;
+
+      slock_lock(task_workers[i].lock);
+      depth = task_workers[i].depth + (task_workers[i].current ? 1 : 0);
+      slock_unlock(task_workers[i].lock);
+
+      if (depth < best_depth)
+      {
+         best       = &task_workers[i];
+         best_depth = depth;
+      }
+   }
+
+   return best;
 }
 
-static void retro_task_threaded_cancel(void *task)
+/* Calls @visit for every queued or running task until it
+ * returns true. All worker locks are held meanwhile. */
+static bool task_workers_visit(
+      bool (*visit)(retro_task_t *task, void *data), void *data)
 {
-   retro_task_t *t;
+   unsigned i, j;
+   bool done = false;
 
-   slock_lock(running_lock);
+   for (i = 0; i < task_workers_count; i++)
+      slock_lock(task_workers[i].lock);
 
-   for (t = tasks_running.front; t; t = t->next)
+   for (i = 0; i < task_workers_count && !done; i++)
    {
-      if (t == task)
+      task_worker_t *worker = &task_workers[i];
+
+      if (worker->current)
+         done = visit(worker->current, data);
+
+      for (j = 0; j < TASK_PRIORITY_COUNT && !done; j++)
       {
-        t->cancelled = true;
-        break;
+         retro_task_t *task = worker->queues[j].front;
+
+         for (; task && !done; task = task->next)
+            done = visit(task, data);
       }
    }
 
-   slock_unlock(running_lock);
+   for (i = task_workers_count; i-- > 0; )
+      slock_unlock(task_workers[i].lock);
+
+   return done;
 }
 
-static void retro_task_threaded_gather(void)
+static bool task_visit_cancel(retro_task_t *task, void *data)
 {
-   retro_task_t *task = NULL;
+   if (task != data)
+      return false;
 
-   slock_lock(property_lock);
    slock_lock(running_lock);
-   for (task = tasks_running.front; task; task = task->next)
-      task_queue_push_progress(task);
+   task->cancelled = true;
+   slock_unlock(running_lock);
+   return true;
+}
 
+static bool task_visit_reset(retro_task_t *task, void *data)
+{
+   slock_lock(running_lock);
+   task->cancelled = true;
    slock_unlock(running_lock);
+   return false;
+}
+
+static bool task_visit_progress(retro_task_t *task, void *data)
+{
+   task_queue_push_progress(task);
+   return false;
+}
+
+static bool task_visit_find(retro_task_t *task, void *data)
+{
+   task_find_state_t *state = (task_find_state_t*)data;
+   return state->func(task, state->user_data);
+}
+
+static bool task_visit_retrieve(retro_task_t *task, void *data)
+{
+   task_retrieve_state_t *state = (task_retrieve_state_t*)data;
+   task_queue_retrieve_task(state->data, task, &state->tail);
+   return false;
+}
+
+static void retro_task_threaded_push_running(retro_task_t *task)
+{
+   slock_lock(worker_lock);
+   tasks_in_flight++;
+   slock_unlock(worker_lock);
+
+   task_worker_put(task_worker_least_loaded(), task, false);
+}
+
+static void retro_task_threaded_cancel(void *task)
+{
+   task_workers_visit(task_visit_cancel, task);
+}
+
+static void retro_task_threaded_gather(void)
+{
+   slock_lock(property_lock);
+   task_workers_visit(task_visit_progress, NULL);
 
    slock_lock(finished_lock);
    retro_task_internal_gather();
@@ -384,143 +712,177 @@ static void retro_task_threaded_wait(retro_task_condition_fn_t cond, void* data)
    {
       retro_task_threaded_gather();
 
-      slock_lock(running_lock);
-      wait = (tasks_running.front != NULL) &&
-             (!cond || cond(data));
-      slock_unlock(running_lock);
+      slock_lock(worker_lock);
+      wait = tasks_in_flight > 0;
+      slock_unlock(worker_lock);
+
+      wait = wait && (!cond || cond(data));
    } while (wait);
 }
 
 static void retro_task_threaded_reset(void)
 {
-   retro_task_t *task = NULL;
-
-   slock_lock(running_lock);
-   for (task = tasks_running.front; task; task = task->next)
-      task->cancelled = true;
-   slock_unlock(running_lock);
+   task_workers_visit(task_visit_reset, NULL);
 }
 
-
 static bool retro_task_threaded_find(
       retro_task_finder_t func, void *user_data)
 {
-   retro_task_t *task = NULL;
-   bool result = false;
+   task_find_state_t state;
 
-   slock_lock(running_lock);
-   for (task = tasks_running.front; task; task = task->next)
-   {
-      if (func(task, user_data))
-      {
-         result = true;
-         break;
-      }
-   }
-   slock_unlock(running_lock);
+   state.func      = func;
+   state.user_data = user_data;
 
-   return result;
+   return task_workers_visit(task_visit_find, &state);
 }
 
 static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 {
-   /* Protect access to running tasks */
-   slock_lock(running_lock);
+   task_retrieve_state_t state;
 
-   /* Call regular retrieve function */
-   retro_task_regular_retrieve(data);
+   state.data = data;
+   state.tail = NULL;
 
-   /* Release access to running tasks */
-   slock_unlock(running_lock);
+   task_workers_visit(task_visit_retrieve, &state);
 }
 
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   task_worker_t *worker = (task_worker_t*)userdata;
 
    for (;;)
    {
       retro_task_t *task  = NULL;
-      bool finished = false;
+      bool finished       = false;
+      bool cont           = false;
+
+      slock_lock(worker_lock);
+      cont = worker_continue;
+      slock_unlock(worker_lock);
 
-      if (!worker_continue)
+      if (!cont)
          break; /* should we keep running until all tasks finished? */
 
-      slock_lock(running_lock);
+      task = task_worker_next(worker);
 
-      /* Get first task to run */
-      task = tasks_running.front;
-      if (task == NULL)
+      if (!task)
       {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
+         slock_lock(worker_lock);
+         while (worker_continue && !tasks_queued)
+            scond_wait(worker_cond, worker_lock);
+         slock_unlock(worker_lock);
          continue;
       }
 
-      slock_unlock(running_lock);
-
-      task->handler(task);
+      task_queue_run_handler(task);
 
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
 
-      slock_lock(running_lock);
-      task_queue_remove(&tasks_running, task);
-      slock_unlock(running_lock);
-
       /* Update queue */
       if (!finished)
       {
-         /* Re-add task to running queue */
-         retro_task_threaded_push_running(task);
-      }
-      else
-      {
-         /* Add task to finished queue */
-         slock_lock(finished_lock);
-         task_queue_put(&tasks_finished, task);
-         slock_unlock(finished_lock);
+         /* Re-add task to this worker's queue */
+         task_worker_put(worker, task, true);
+         continue;
       }
+
+      slock_lock(worker->lock);
+      worker->current = NULL;
+      slock_unlock(worker->lock);
+
+      /* Add task to finished queue */
+      slock_lock(finished_lock);
+      task_queue_put(&tasks_finished, task);
+      slock_unlock(finished_lock);
+
+      slock_lock(worker_lock);
+      tasks_in_flight--;
+      slock_unlock(worker_lock);
    }
 }
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   retro_task_t *task = NULL;
+
    running_lock  = slock_new();
    finished_lock = slock_new();
    property_lock = slock_new();
-   queue_lock    = slock_new();
+   worker_lock   = slock_new();
+   stats_lock    = slock_new();
    worker_cond   = scond_new();
 
-   slock_lock(running_lock);
+   task_workers_count = task_workers_target();
+
+   slock_lock(worker_lock);
    worker_continue = true;
-   slock_unlock(running_lock);
+   tasks_queued    = 0;
+   tasks_in_flight = 0;
+   slock_unlock(worker_lock);
+
+   for (i = 0; i < task_workers_count; i++)
+   {
+      memset(&task_workers[i], 0, sizeof(task_workers[i]));
+      task_workers[i].id   = i;
+      task_workers[i].lock = slock_new();
+   }
 
-   worker_thread = sthread_create(threaded_worker, NULL);
+   /* Resume the tasks that were put on hold */
+   for (i = 0; (task = task_queue_get(&tasks_running)) != NULL; i++)
+   {
+      tasks_in_flight++;
+      task_worker_put(&task_workers[i % task_workers_count], task, false);
+   }
+
+   for (i = 0; i < task_workers_count; i++)
+      task_workers[i].thread = sthread_create(threaded_worker,
+            &task_workers[i]);
 }
 
 static void retro_task_threaded_deinit(void)
 {
-   slock_lock(running_lock);
+   unsigned i, j;
+   retro_task_t *task = NULL;
+
+   slock_lock(worker_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
-   slock_unlock(running_lock);
+   scond_broadcast(worker_cond);
+   slock_unlock(worker_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < task_workers_count; i++)
+   {
+      if (task_workers[i].thread)
+         sthread_join(task_workers[i].thread);
+   }
+
+   /* Put unfinished tasks on hold */
+   for (i = 0; i < task_workers_count; i++)
+   {
+      for (j = 0; j < TASK_PRIORITY_COUNT; j++)
+         while ((task = task_queue_get(&task_workers[i].queues[j])) != NULL)
+            task_queue_put(&tasks_running, task);
+
+      slock_free(task_workers[i].lock);
+      memset(&task_workers[i], 0, sizeof(task_workers[i]));
+   }
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
-   slock_free(queue_lock);
-
-   worker_thread = NULL;
-   worker_cond   = NULL;
-   running_lock  = NULL;
-   finished_lock = NULL;
-   property_lock = NULL;
-   queue_lock = NULL;
+   slock_free(worker_lock);
+   slock_free(stats_lock);
+
+   task_workers_count = 0;
+   worker_cond        = NULL;
+   running_lock       = NULL;
+   finished_lock      = NULL;
+   property_lock      = NULL;
+   worker_lock        = NULL;
+   stats_lock         = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -566,6 +928,68 @@ void task_queue_init(bool threaded, retro_task_queue_msg_t msg_push)
    impl_current->init();
 }
 
+void task_queue_set_workers(unsigned workers)
+{
+   task_workers_wanted = workers;
+}
+
+unsigned task_queue_get_workers(void)
+{
+#ifdef HAVE_THREADS
+   if (impl_current == &impl_threaded)
+      return task_workers_count;
+#endif
+   return 0;
+}
+
+bool task_queue_get_stats(retro_task_handler_t handler,
+      task_queue_stats_t *stats)
+{
+   unsigned i;
+   bool found = false;
+
+   SLOCK_LOCK(stats_lock);
+   for (i = 0; i < task_stats_count; i++)
+   {
+      if (task_stats[i].handler == handler)
+      {
+         *stats = task_stats[i].stats;
+         found  = true;
+         break;
+      }
+   }
+   SLOCK_UNLOCK(stats_lock);
+
+   return found;
+}
+
+unsigned task_queue_get_all_stats(task_queue_handler_stats_t *stats,
+      unsigned max)
+{
+   unsigned count = 0;
+
+   SLOCK_LOCK(stats_lock);
+   count = task_stats_count < max ? task_stats_count : max;
+   memcpy(stats, task_stats, count * sizeof(*stats));
+   SLOCK_UNLOCK(stats_lock);
+
+   return count;
+}
+
+void task_queue_get_priority_stats(enum task_priority priority,
+      task_queue_stats_t *stats)
+{
+   if (priority >= TASK_PRIORITY_COUNT)
+   {
+      memset(stats, 0, sizeof(*stats));
+      return;
+   }
+
+   SLOCK_LOCK(stats_lock);
+   *stats = task_priority_stats[priority];
+   SLOCK_UNLOCK(stats_lock);
+}
+
 void task_queue_set_threaded(void)
 {
    task_threaded_enable = true;
@@ -601,6 +1025,8 @@ void task_queue_check(void)
 
    if (want_threaded != current_threaded)
       task_queue_deinit();
+   else if (current_threaded && task_workers_count != task_workers_target())
+      task_queue_deinit();
 
    if (!impl_current)
       task_queue_init(want_threaded, msg_push_bak);
@@ -609,33 +1035,26 @@ void task_queue_check(void)
    impl_current->gather();
 }
 
+static bool task_queue_find_blocking(retro_task_t *task, void *user_data)
+{
+   return task->type == TASK_TYPE_BLOCKING;
+}
+
 void task_queue_push(retro_task_t *task)
 {
    /* Ignore this task if a related one is already running */
    if (task->type == TASK_TYPE_BLOCKING)
    {
-      retro_task_t *running = NULL;
-      bool found = false;
-
-      SLOCK_LOCK(queue_lock);
-      running = tasks_running.front;
-
-      for (; running; running = running->next)
-      {
-         if (running->type == TASK_TYPE_BLOCKING)
-         {
-            found = true;
-            break;
-         }
-      }
-
-      SLOCK_UNLOCK(queue_lock);
-
       /* skip this task, user must try again later */
-      if (found)
+      if (impl_current->find(task_queue_find_blocking, NULL))
          return;
    }
 
+   if (task->priority >= TASK_PRIORITY_COUNT)
+      task->priority = TASK_PRIORITY_BACKGROUND;
+
+   task_queue_stats_pushed(task);
+
    /* The lack of NULL checks in the following functions
     * is proposital to ensure correct control flow by the users. */
    impl_current->push_running(task);
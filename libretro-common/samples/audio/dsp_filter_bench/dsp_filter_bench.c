@@ -0,0 +1,269 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (dsp_filter_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Runs every DSP filter once with the plain C code and once with
+ * the SIMD paths the CPU supports, checks that both give the same
+ * output and reports the time spent per frame.
+ *
+ * Presets given on the command line are run through the filter
+ * graph the same way the audio driver does, "make bench" runs all
+ * of the presets in audio/dsp_filters. Presets using filters which
+ * are not built in are skipped. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libretro_dspfilter.h>
+#include <audio/dsp_filter.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+
+#define BENCH_RATE   48000.0f
+#define BENCH_FRAMES (48000 * 10)
+#define BENCH_CHUNK  512
+
+extern const struct dspfilter_implementation *chorus_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *convolution_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *echo_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *eq_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *iir_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *panning_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *phaser_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *reverb_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+extern const struct dspfilter_implementation *wahwah_dspfilter_get_implementation(dspfilter_simd_mask_t mask);
+
+static const dspfilter_get_implementation_t filters[] = {
+   chorus_dspfilter_get_implementation,
+   convolution_dspfilter_get_implementation,
+   echo_dspfilter_get_implementation,
+   eq_dspfilter_get_implementation,
+   iir_dspfilter_get_implementation,
+   panning_dspfilter_get_implementation,
+   phaser_dspfilter_get_implementation,
+   reverb_dspfilter_get_implementation,
+   wahwah_dspfilter_get_implementation,
+};
+
+/* Every filter runs with its defaults. */
+static int config_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int config_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int config_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   *values         = (float*)malloc(num_default_values * sizeof(float));
+   *out_num_values = num_default_values;
+   if (num_default_values)
+      memcpy(*values, default_values, num_default_values * sizeof(float));
+   return 0;
+}
+
+static int config_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   *values         = (int*)malloc(num_default_values * sizeof(int));
+   *out_num_values = num_default_values;
+   if (num_default_values)
+      memcpy(*values, default_values, num_default_values * sizeof(int));
+   return 0;
+}
+
+static int config_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   *output = strdup(default_output);
+   return 0;
+}
+
+static void config_free(void *ptr)
+{
+   free(ptr);
+}
+
+static const struct dspfilter_config config = {
+   config_get_float,
+   config_get_int,
+   config_get_float_array,
+   config_get_int_array,
+   config_get_string,
+   config_free,
+};
+
+/* Returns the time spent in the filter in microseconds, or -1. */
+static retro_time_t run_filter(dspfilter_get_implementation_t get_impl,
+      dspfilter_simd_mask_t mask, const float *input,
+      float *output, unsigned *out_frames)
+{
+   unsigned i;
+   void *data                                  = NULL;
+   retro_time_t total                          = 0;
+   float *chunk                                = (float*)
+      malloc(BENCH_CHUNK * 2 * sizeof(float));
+   const struct dspfilter_implementation *impl = get_impl(mask);
+   struct dspfilter_info info                  = { BENCH_RATE };
+
+   *out_frames = 0;
+
+   if (!chunk || !(data = impl->init(&info, &config, NULL)))
+   {
+      free(chunk);
+      return -1;
+   }
+
+   for (i = 0; i + BENCH_CHUNK <= BENCH_FRAMES; i += BENCH_CHUNK)
+   {
+      retro_time_t start;
+      struct dspfilter_input in;
+      struct dspfilter_output out;
+
+      /* Filters may work in place, so every run gets its own copy. */
+      memcpy(chunk, input + i * 2, BENCH_CHUNK * 2 * sizeof(float));
+      in.samples  = chunk;
+      in.frames   = BENCH_CHUNK;
+      out.samples = chunk;
+      out.frames  = BENCH_CHUNK;
+
+      start       = cpu_features_get_time_usec();
+      impl->process(data, &out, &in);
+      total      += cpu_features_get_time_usec() - start;
+
+      memcpy(output + *out_frames * 2, out.samples,
+            out.frames * 2 * sizeof(float));
+      *out_frames += out.frames;
+   }
+
+   impl->free(data);
+   free(chunk);
+   return total;
+}
+
+static void run_preset(const char *path, const float *input, float *chunk)
+{
+   unsigned i;
+   retro_time_t total      = 0;
+   retro_dsp_filter_t *dsp = retro_dsp_filter_new(path, NULL, BENCH_RATE);
+
+   if (!dsp)
+   {
+      printf("%-24s %12s\n", path_basename(path), "skipped");
+      return;
+   }
+
+   for (i = 0; i + BENCH_CHUNK <= BENCH_FRAMES; i += BENCH_CHUNK)
+   {
+      retro_time_t start;
+      struct retro_dsp_data data;
+
+      memcpy(chunk, input + i * 2, BENCH_CHUNK * 2 * sizeof(float));
+      data.input        = chunk;
+      data.input_frames = BENCH_CHUNK;
+
+      start             = cpu_features_get_time_usec();
+      retro_dsp_filter_process(dsp, &data);
+      total            += cpu_features_get_time_usec() - start;
+   }
+
+   printf("%-24s %12.2f\n", path_basename(path),
+         total * 1000.0 / BENCH_FRAMES);
+
+   retro_dsp_filter_free(dsp);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   uint32_t seed              = 1;
+   int ret                    = 0;
+   dspfilter_simd_mask_t mask = (dspfilter_simd_mask_t)cpu_features_get();
+   float *input               = (float*)malloc(BENCH_FRAMES * 2 * sizeof(float));
+   float *ref                 = (float*)malloc(BENCH_FRAMES * 2 * sizeof(float));
+   float *simd                = (float*)malloc(BENCH_FRAMES * 2 * sizeof(float));
+
+   if (!input || !ref || !simd)
+      return 1;
+
+   for (i = 0; i < BENCH_FRAMES * 2; i++)
+   {
+      seed     = seed * 1664525u + 1013904223u;
+      input[i] = (int32_t)seed / 2147483648.0f * 0.5f;
+   }
+
+   printf("%-12s %12s %12s %12s\n", "filter", "C ns/frame",
+         "SIMD ns/frame", "max diff");
+
+   for (i = 0; i < sizeof(filters) / sizeof(filters[0]); i++)
+   {
+      unsigned j, ref_frames, simd_frames;
+      float diff            = 0.0f;
+      retro_time_t ref_time = run_filter(filters[i], 0,
+            input, ref, &ref_frames);
+      retro_time_t simd_time = run_filter(filters[i], mask,
+            input, simd, &simd_frames);
+
+      if (ref_time < 0 || simd_time < 0 || ref_frames != simd_frames)
+      {
+         printf("%-12s failed\n", filters[i](0)->short_ident);
+         ret = 1;
+         continue;
+      }
+
+      for (j = 0; j < ref_frames * 2; j++)
+      {
+         float d = fabsf(ref[j] - simd[j]);
+         if (d > diff || d != d)
+            diff = d;
+      }
+
+      /* Only the summation order differs between the two. */
+      if (!(diff <= 1e-4f))
+         ret = 1;
+
+      printf("%-12s %12.2f %12.2f %12g\n", filters[i](0)->short_ident,
+            ref_time * 1000.0 / BENCH_FRAMES,
+            simd_time * 1000.0 / BENCH_FRAMES, diff);
+   }
+
+   if (argc > 1)
+      printf("\n%-24s %12s\n", "preset", "ns/frame");
+
+   for (i = 1; i < (unsigned)argc; i++)
+      run_preset(argv[i], input, simd);
+
+   free(input);
+   free(ref);
+   free(simd);
+   return ret;
+}
@@ -0,0 +1,161 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (crc32_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks every CRC32 implementation the CPU supports against known
+ * vectors and against each other for all small lengths, alignments
+ * and split points, then reports the throughput of each. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+
+struct crc32_vector
+{
+   const char *data;
+   uint32_t crc;
+};
+
+static const struct crc32_vector vectors[] = {
+   { "",                                            0x00000000 },
+   { "a",                                           0xe8b7be43 },
+   { "abc",                                         0x352441c2 },
+   { "123456789",                                   0xcbf43926 },
+   { "message digest",                              0x20159d7f },
+   { "abcdefghijklmnopqrstuvwxyz",                  0x4c2750bd },
+   { "The quick brown fox jumps over the lazy dog", 0x414fa339 },
+   { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+                                                    0x1fc2e6d2 },
+   { "12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+                                                    0x7ca94a72 },
+};
+
+static int check_vectors(const encoding_crc32_impl_t *impl)
+{
+   unsigned i;
+   int ret = 0;
+
+   for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+   {
+      uint32_t crc = impl->func(0,
+            (const uint8_t*)vectors[i].data, strlen(vectors[i].data));
+
+      if (crc != vectors[i].crc)
+      {
+         printf("  %-8s vector %u: got %08x, expected %08x\n",
+               impl->ident, i, (unsigned)crc, (unsigned)vectors[i].crc);
+         ret = 1;
+      }
+   }
+
+   return ret;
+}
+
+/* Compares against the reference for every length up to @max at
+ * every alignment, and chained over a split point. */
+static int check_reference(const encoding_crc32_impl_t *impl,
+      const encoding_crc32_impl_t *ref, const uint8_t *buf, size_t max)
+{
+   size_t len, align;
+
+   for (align = 0; align < 16; align++)
+   {
+      for (len = 0; len <= max; len++)
+      {
+         const uint8_t *p = buf + align;
+         size_t split     = len ? (len * 7 + align) % len : 0;
+         uint32_t want    = ref->func(0, p, len);
+
+         if (impl->func(0, p, len) != want
+               || impl->func(impl->func(0, p, split),
+                  p + split, len - split) != want)
+         {
+            printf("  %-8s mismatch at length %u, alignment %u\n",
+                  impl->ident, (unsigned)len, (unsigned)align);
+            return 1;
+         }
+      }
+   }
+
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, count;
+   size_t size                        = 16 * 1024 * 1024;
+   unsigned iterations                = 20;
+   const encoding_crc32_impl_t *impls = encoding_crc32_get_impls(&count);
+   const encoding_crc32_impl_t *ref   = &impls[count - 1];
+   uint8_t *buf                       = NULL;
+   int ret                            = 0;
+
+   if (argc > 1)
+      size = (size_t)strtoul(argv[1], NULL, 0) * 1024;
+   if (argc > 2)
+      iterations = (unsigned)strtoul(argv[2], NULL, 0);
+
+   if (size < 4096 || !iterations)
+   {
+      fprintf(stderr, "Usage: %s [buffer size in KiB, >= 4] [iterations]\n",
+            argv[0]);
+      return 1;
+   }
+
+   buf = (uint8_t*)malloc(size + 16);
+   if (!buf)
+      return 1;
+
+   srand(1);
+   for (i = 0; i < size + 16; i++)
+      buf[i] = (uint8_t)rand();
+
+   printf("Buffer: %u KiB, iterations: %u, selected: %s\n",
+         (unsigned)(size / 1024), iterations, impls[0].ident);
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned it;
+      uint32_t crc = 0;
+      retro_time_t start, elapsed;
+
+      if (check_vectors(&impls[i]) ||
+            check_reference(&impls[i], ref, buf, 1024))
+      {
+         ret = 1;
+         continue;
+      }
+
+      start = cpu_features_get_time_usec();
+      for (it = 0; it < iterations; it++)
+         crc = impls[i].func(crc, buf, size);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      printf("  %-8s %8.2f GB/s (%08x)\n", impls[i].ident,
+            elapsed ? (double)size * iterations / (elapsed * 1000.0) : 0.0,
+            (unsigned)crc);
+   }
+
+   free(buf);
+   return ret;
+}
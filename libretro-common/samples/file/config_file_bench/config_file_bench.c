@@ -0,0 +1,272 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (config_file_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Times the config file operations the frontend does on start
+ * up and on exit: loading a config, reading every key, setting
+ * every key and writing the result back.
+ *
+ * Without arguments a config with the size of a typical
+ * retroarch.cfg is generated, a config given on the command line
+ * is used as is. A few lookups with duplicate keys, appended
+ * files and unset keys are checked before timing. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <file/config_file.h>
+#include <features/features_cpu.h>
+#include <string/stdstring.h>
+
+#define BENCH_KEYS       3000
+#define BENCH_ITERATIONS 20
+
+static const char *bench_path = "config_file_bench.cfg";
+static const char *bench_out  = "config_file_bench_out.cfg";
+
+static int failures           = 0;
+
+static void check_string(config_file_t *conf, const char *key,
+      const char *expected)
+{
+   char buf[256];
+   bool found = config_get_array(conf, key, buf, sizeof(buf));
+
+   if (!expected && !found)
+      return;
+
+   if (expected && found && string_is_equal(buf, expected))
+      return;
+
+   printf("FAIL: %s = \"%s\", expected \"%s\"\n", key,
+         found ? buf : "(unset)", expected ? expected : "(unset)");
+   failures++;
+}
+
+static void write_text(const char *path, const char *text)
+{
+   FILE *file = fopen(path, "wb");
+   if (!file)
+      return;
+   fputs(text, file);
+   fclose(file);
+}
+
+static void check_semantics(void)
+{
+   config_file_t *conf = config_file_new_from_string(
+         "a = \"1\"\n"
+         "b = 2\n"
+         "a = \"3\"\n"
+         "# c = 4\n"
+         "d = \"five # six\"\n");
+
+   if (!conf)
+   {
+      printf("FAIL: config_file_new_from_string\n");
+      failures++;
+      return;
+   }
+
+   /* The first of several entries with the same key wins. */
+   check_string(conf, "a", "1");
+   check_string(conf, "b", "2");
+   check_string(conf, "c", NULL);
+   check_string(conf, "d", "five # six");
+
+   /* Unsetting a key exposes the next entry with that key. */
+   config_unset(conf, "a");
+   check_string(conf, "a", "3");
+   config_unset(conf, "a");
+   check_string(conf, "a", NULL);
+
+   config_set_string(conf, "a", "7");
+   config_set_string(conf, "e", "8");
+   config_set_string(conf, "b", "a much longer value than before");
+   check_string(conf, "a", "7");
+   check_string(conf, "b", "a much longer value than before");
+   check_string(conf, "e", "8");
+   if (!config_entry_exists(conf, "e") || config_entry_exists(conf, "f"))
+   {
+      printf("FAIL: config_entry_exists\n");
+      failures++;
+   }
+
+   /* Appended files take priority. */
+   write_text(bench_out, "b = \"9\"\nf = \"10\"\n");
+   config_append_file(conf, bench_out);
+   check_string(conf, "b", "9");
+   check_string(conf, "e", "8");
+   check_string(conf, "f", "10");
+
+   /* Writing sorts the entries, lookups are not affected. */
+   config_file_write(conf, bench_out);
+   check_string(conf, "b", "9");
+   config_file_free(conf);
+
+   /* Values from an #include can not be changed, newer
+    * entries are added behind them. */
+   write_text(bench_out, "g = \"11\"\n");
+   write_text(bench_path, "#include \"config_file_bench_out.cfg\"\nh = 12\n");
+   conf = config_file_new(bench_path);
+   if (conf)
+   {
+      config_set_string(conf, "g", "13");
+      check_string(conf, "g", "11");
+      check_string(conf, "h", "12");
+      config_file_free(conf);
+   }
+
+   /* Keys set after a write are still written by the next one. */
+   write_text(bench_path, "zeta = \"1\"\nalpha = \"2\"\n");
+   conf = config_file_new(bench_path);
+   if (conf)
+   {
+      config_set_string(conf, "mid", "3");
+      config_file_write(conf, bench_out);
+      config_set_string(conf, "newkey", "4");
+      config_file_write(conf, bench_out);
+      config_file_free(conf);
+   }
+
+   conf = config_file_new(bench_out);
+   if (!conf)
+   {
+      printf("FAIL: config_file_new after repeated writes\n");
+      failures++;
+      return;
+   }
+   check_string(conf, "alpha",  "2");
+   check_string(conf, "mid",    "3");
+   check_string(conf, "newkey", "4");
+   check_string(conf, "zeta",   "1");
+   config_file_free(conf);
+}
+
+static void generate_config(const char *path, unsigned count)
+{
+   unsigned i;
+   FILE *file = fopen(path, "wb");
+
+   if (!file)
+      return;
+
+   for (i = 0; i < count; i++)
+      fprintf(file, "setting_group_%u_value_%u = \"%u\"\n",
+            i % 37, i, i * 7);
+
+   fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, keys;
+   struct config_file_entry entry;
+   char **names                = NULL;
+   char buf[256];
+   retro_time_t start          = 0;
+   retro_time_t load_time      = 0;
+   retro_time_t get_time       = 0;
+   retro_time_t set_time       = 0;
+   retro_time_t write_time     = 0;
+   const char *path            = argc > 1 ? argv[1] : bench_path;
+   config_file_t *conf         = NULL;
+
+   check_semantics();
+
+   if (argc <= 1)
+      generate_config(bench_path, BENCH_KEYS);
+
+   /* Collect the key names once so that only the lookups are timed. */
+   conf = config_file_new(path);
+   if (!conf)
+   {
+      fprintf(stderr, "Could not load %s\n", path);
+      return 1;
+   }
+
+   keys = 0;
+   if (config_get_entry_list_head(conf, &entry))
+   {
+      do
+      {
+         keys++;
+      } while (config_get_entry_list_next(&entry));
+   }
+
+   names = (char**)calloc(keys ? keys : 1, sizeof(*names));
+   i     = 0;
+   if (names && config_get_entry_list_head(conf, &entry))
+   {
+      do
+      {
+         names[i++] = strdup(entry.key);
+      } while (config_get_entry_list_next(&entry));
+   }
+   config_file_free(conf);
+
+   for (i = 0; i < BENCH_ITERATIONS; i++)
+   {
+      unsigned j;
+
+      start      = cpu_features_get_time_usec();
+      conf       = config_file_new(path);
+      load_time += cpu_features_get_time_usec() - start;
+
+      if (!conf)
+         break;
+
+      start      = cpu_features_get_time_usec();
+      for (j = 0; j < keys; j++)
+         config_get_array(conf, names[j], buf, sizeof(buf));
+      get_time  += cpu_features_get_time_usec() - start;
+
+      start      = cpu_features_get_time_usec();
+      for (j = 0; j < keys; j++)
+         config_set_string(conf, names[j], "updated");
+      set_time  += cpu_features_get_time_usec() - start;
+
+      start      = cpu_features_get_time_usec();
+      config_file_write(conf, bench_out);
+      write_time += cpu_features_get_time_usec() - start;
+
+      config_file_free(conf);
+   }
+
+   printf("%u keys, %u iterations\n", keys, BENCH_ITERATIONS);
+   printf("load:  %8.1f us\n", (double)load_time  / BENCH_ITERATIONS);
+   printf("get:   %8.1f us\n", (double)get_time   / BENCH_ITERATIONS);
+   printf("set:   %8.1f us\n", (double)set_time   / BENCH_ITERATIONS);
+   printf("write: %8.1f us\n", (double)write_time / BENCH_ITERATIONS);
+
+   for (i = 0; i < keys; i++)
+      free(names[i]);
+   free(names);
+
+   remove(bench_out);
+   if (argc <= 1)
+      remove(bench_path);
+
+   if (failures)
+      printf("%d checks failed\n", failures);
+
+   return failures ? 1 : 0;
+}
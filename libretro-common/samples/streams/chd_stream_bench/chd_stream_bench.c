@@ -0,0 +1,461 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (chd_stream_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Times reads through a CHD stream the way the frontend does them:
+ * a sequential scan computing the CRC of a whole track, as done by
+ * the database scanner, and scattered sector reads revisiting a
+ * small set of hunks, as done by cores reading a file system.
+ * Decoding the whole image with chd_read_hunks() is timed for a
+ * growing number of threads.
+ *
+ * Without arguments a zlib compressed (V4) CD image is generated
+ * and every read is checked against the data written into it. A
+ * CHD given on the command line is only timed. The generator uses
+ * the system zlib, libchdr only comes with the decompressor. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <boolean.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <libchdr/chd.h>
+#include <streams/chd_stream.h>
+
+#define BENCH_FRAMES          16000
+#define BENCH_FRAMES_PER_HUNK 8
+#define BENCH_SECTOR_SIZE     2352
+#define BENCH_FRAME_SIZE      (BENCH_SECTOR_SIZE + 96)
+#define BENCH_HUNK_SIZE       (BENCH_FRAMES_PER_HUNK * BENCH_FRAME_SIZE)
+#define BENCH_SCAN_SECTORS    16
+#define BENCH_SEEKS           20000
+#define BENCH_SEEK_HUNKS      24
+#define BENCH_BATCH_HUNKS     64
+
+static const char *bench_path = "chd_stream_bench.chd";
+
+static int failures           = 0;
+
+/* Sector data compresses to roughly half its size, like
+ * most game data does. */
+static void fill_sector(uint8_t *data, uint32_t frame)
+{
+   unsigned i;
+   uint32_t state = frame * 747796405u + 1;
+
+   for (i = 0; i < BENCH_SECTOR_SIZE; i++)
+   {
+      state   = state * 1664525u + 1013904223u;
+      data[i] = 'A' + ((state >> 24) & 15);
+   }
+}
+
+static void put_be32(uint8_t *data, uint32_t val)
+{
+   data[0] = (uint8_t)(val >> 24);
+   data[1] = (uint8_t)(val >> 16);
+   data[2] = (uint8_t)(val >>  8);
+   data[3] = (uint8_t)(val >>  0);
+}
+
+static void put_be64(uint8_t *data, uint64_t val)
+{
+   put_be32(data,     (uint32_t)(val >> 32));
+   put_be32(data + 4, (uint32_t)val);
+}
+
+static bool compress_hunk(const uint8_t *in, uint8_t *out, uLong *out_len)
+{
+   z_stream strm;
+   int ret;
+
+   memset(&strm, 0, sizeof(strm));
+
+   /* libchdr expects raw deflate without a zlib header. */
+   if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return false;
+
+   strm.next_in   = (Bytef*)in;
+   strm.avail_in  = BENCH_HUNK_SIZE;
+   strm.next_out  = out;
+   strm.avail_out = BENCH_HUNK_SIZE;
+
+   ret            = deflate(&strm, Z_FINISH);
+   *out_len       = strm.total_out;
+   deflateEnd(&strm);
+
+   return ret == Z_STREAM_END;
+}
+
+/* Writes a single track CD image: header, hunk map, track
+ * metadata and the compressed hunks. */
+static bool write_chd(const char *path, unsigned frames)
+{
+   char meta[256];
+   uint8_t header[108];
+   uint8_t entry[16];
+   unsigned i, j;
+   size_t meta_len;
+   uint64_t offset;
+   unsigned hunks   = frames / BENCH_FRAMES_PER_HUNK;
+   uint8_t *hunk    = (uint8_t*)calloc(1, BENCH_HUNK_SIZE);
+   uint8_t *packed  = (uint8_t*)malloc(BENCH_HUNK_SIZE);
+   uint8_t *map     = (uint8_t*)calloc(hunks + 1, sizeof(entry));
+   FILE *file       = fopen(path, "wb");
+   bool ret         = false;
+
+   if (!hunk || !packed || !map || !file)
+      goto end;
+
+   meta_len = snprintf(meta, sizeof(meta),
+         "TRACK:1 TYPE:MODE1_RAW SUBTYPE:NONE FRAMES:%u PREGAP:0 "
+         "PGTYPE:MODE1 PGSUB:RW POSTGAP:0", frames) + 1;
+
+   memset(header, 0, sizeof(header));
+   memcpy(header, "MComprHD", 8);
+   put_be32(header +  8, sizeof(header));
+   put_be32(header + 12, 4);
+   put_be32(header + 20, 1); /* zlib */
+   put_be32(header + 24, hunks);
+   put_be64(header + 28, (uint64_t)hunks * BENCH_HUNK_SIZE);
+   put_be64(header + 36, sizeof(header) + (hunks + 1) * sizeof(entry));
+   put_be32(header + 44, BENCH_HUNK_SIZE);
+
+   /* Hunks follow the metadata, the map is written last. */
+   offset = sizeof(header) + (hunks + 1) * sizeof(entry) + 16 + meta_len;
+   if (fseek(file, (long)offset, SEEK_SET) != 0)
+      goto end;
+
+   for (i = 0; i < hunks; i++)
+   {
+      uLong len;
+
+      for (j = 0; j < BENCH_FRAMES_PER_HUNK; j++)
+         fill_sector(hunk + j * BENCH_FRAME_SIZE,
+               i * BENCH_FRAMES_PER_HUNK + j);
+
+      if (!compress_hunk(hunk, packed, &len))
+         goto end;
+
+      put_be64(map + i * sizeof(entry), offset);
+      put_be32(map + i * sizeof(entry) + 8,
+            encoding_crc32(0, hunk, BENCH_HUNK_SIZE));
+      map[i * sizeof(entry) + 12] = (uint8_t)(len >> 8);
+      map[i * sizeof(entry) + 13] = (uint8_t)len;
+      map[i * sizeof(entry) + 14] = (uint8_t)(len >> 16);
+      map[i * sizeof(entry) + 15] = 1; /* compressed */
+
+      if (fwrite(packed, 1, len, file) != len)
+         goto end;
+      offset += len;
+   }
+
+   memcpy(map + hunks * sizeof(entry), "EndOfListCookie", 16);
+
+   /* CHT2 metadata, the only entry in the list. */
+   memset(entry, 0, sizeof(entry));
+   put_be32(entry,     0x43485432);
+   put_be32(entry + 4, (uint32_t)meta_len);
+
+   rewind(file);
+   ret = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+      && fwrite(map, sizeof(entry), hunks + 1, file) == hunks + 1
+      && fwrite(entry, 1, sizeof(entry), file) == sizeof(entry)
+      && fwrite(meta, 1, meta_len, file) == meta_len;
+
+end:
+   if (file)
+      fclose(file);
+   free(hunk);
+   free(packed);
+   free(map);
+   return ret;
+}
+
+static void print_stats(const char *name, chdstream_t *stream,
+      retro_time_t time)
+{
+   chdstream_stats_t stats;
+   uint64_t lookups;
+
+   chdstream_get_stats(stream, &stats);
+   lookups = stats.hits + stats.misses;
+
+   printf("%-22s %9.1f ms  hits %6u  misses %6u  prefetched %6u  hit rate %5.1f%%\n",
+         name, time / 1000.0, (unsigned)stats.hits, (unsigned)stats.misses,
+         (unsigned)stats.prefetched,
+         lookups ? 100.0 * stats.hits / lookups : 0.0);
+}
+
+/* Reads the whole track in order and returns its CRC. */
+static uint32_t bench_scan(const char *path, const char *name,
+      unsigned readahead)
+{
+   uint8_t buf[BENCH_SECTOR_SIZE * BENCH_SCAN_SECTORS];
+   ssize_t len;
+   retro_time_t start;
+   uint32_t crc        = 0;
+   chdstream_t *stream = chdstream_open(path, CHDSTREAM_TRACK_PRIMARY);
+
+   if (!stream)
+   {
+      printf("FAIL: could not open %s\n", path);
+      failures++;
+      return 0;
+   }
+
+   chdstream_set_readahead(stream, readahead);
+
+   start = cpu_features_get_time_usec();
+   while ((len = chdstream_read(stream, buf, sizeof(buf))) > 0)
+      crc = encoding_crc32(crc, buf, len);
+   if (len < 0)
+   {
+      printf("FAIL: %s: read error\n", name);
+      failures++;
+   }
+   print_stats(name, stream, cpu_features_get_time_usec() - start);
+
+   chdstream_close(stream);
+   return crc;
+}
+
+/* Reads single sectors out of a few hunks spread over the track. */
+static void bench_seek(const char *path, const char *name,
+      size_t cache_size, bool verify)
+{
+   unsigned i;
+   uint32_t hunks[BENCH_SEEK_HUNKS];
+   uint8_t buf[BENCH_SECTOR_SIZE];
+   uint8_t expected[BENCH_SECTOR_SIZE];
+   retro_time_t start;
+   uint32_t state      = 12345;
+   ssize_t sectors     = 0;
+   chdstream_t *stream = chdstream_open(path, CHDSTREAM_TRACK_PRIMARY);
+
+   if (!stream)
+   {
+      printf("FAIL: could not open %s\n", path);
+      failures++;
+      return;
+   }
+
+   chdstream_set_cache_size(stream, cache_size);
+   sectors = chdstream_get_size(stream) / BENCH_SECTOR_SIZE;
+
+   for (i = 0; i < BENCH_SEEK_HUNKS; i++)
+   {
+      state    = state * 1664525u + 1013904223u;
+      hunks[i] = (state >> 8) % (sectors / BENCH_FRAMES_PER_HUNK);
+   }
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < BENCH_SEEKS; i++)
+   {
+      uint32_t sector;
+
+      state  = state * 1664525u + 1013904223u;
+      sector = hunks[(state >> 8) % BENCH_SEEK_HUNKS]
+         * BENCH_FRAMES_PER_HUNK + (state >> 24) % BENCH_FRAMES_PER_HUNK;
+
+      chdstream_seek(stream, (int64_t)sector * BENCH_SECTOR_SIZE, SEEK_SET);
+      if (chdstream_read(stream, buf, sizeof(buf)) != sizeof(buf))
+      {
+         printf("FAIL: %s: short read at sector %u\n", name, sector);
+         failures++;
+         break;
+      }
+
+      if (verify)
+      {
+         fill_sector(expected, sector);
+         if (memcmp(buf, expected, sizeof(buf)))
+         {
+            printf("FAIL: %s: wrong data at sector %u\n", name, sector);
+            failures++;
+            break;
+         }
+      }
+   }
+   print_stats(name, stream, cpu_features_get_time_usec() - start);
+
+   chdstream_close(stream);
+}
+
+/* Decodes every hunk of the image, one at a time without threads
+ * and in batches otherwise. Returns the CRC of all hunks. */
+static uint32_t bench_hunks(const char *path, unsigned threads)
+{
+   char name[64];
+   UINT32 i;
+   retro_time_t start, time;
+   uint8_t *buf         = NULL;
+   chd_file *chd        = NULL;
+   const chd_header *hd = NULL;
+   uint32_t crc         = 0;
+
+   if (chd_open(path, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE)
+   {
+      printf("FAIL: could not open %s\n", path);
+      failures++;
+      return 0;
+   }
+
+   hd  = chd_get_header(chd);
+   buf = (uint8_t*)malloc((size_t)BENCH_BATCH_HUNKS * hd->hunkbytes);
+   if (!buf)
+   {
+      chd_close(chd);
+      return 0;
+   }
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < hd->totalhunks; i += BENCH_BATCH_HUNKS)
+   {
+      chd_error err;
+      UINT32 count = hd->totalhunks - i;
+
+      if (count > BENCH_BATCH_HUNKS)
+         count = BENCH_BATCH_HUNKS;
+
+      if (threads)
+         err = chd_read_hunks(chd, i, count, buf, threads);
+      else
+      {
+         UINT32 j;
+         err = CHDERR_NONE;
+         for (j = 0; j < count && err == CHDERR_NONE; j++)
+            err = chd_read(chd, i + j, buf + (size_t)j * hd->hunkbytes);
+      }
+
+      if (err != CHDERR_NONE)
+      {
+         printf("FAIL: could not read hunks %u-%u: %s\n",
+               i, i + count - 1, chd_error_string(err));
+         failures++;
+         break;
+      }
+
+      crc = encoding_crc32(crc, buf, (size_t)count * hd->hunkbytes);
+   }
+   time = cpu_features_get_time_usec() - start;
+
+   if (threads)
+      snprintf(name, sizeof(name), "hunks, %u thread%s",
+            threads, threads > 1 ? "s" : "");
+   else
+      snprintf(name, sizeof(name), "hunks, chd_read");
+
+   printf("%-22s %9.1f ms  %7.1f MB/s\n", name, time / 1000.0,
+         time ? (double)hd->totalhunks * hd->hunkbytes / time : 0.0);
+
+   free(buf);
+   chd_close(chd);
+   return crc;
+}
+
+int main(int argc, char *argv[])
+{
+   uint32_t crc_plain, crc_ahead;
+   const char *path = argc > 1 ? argv[1] : bench_path;
+   bool generated   = argc <= 1;
+
+   if (generated)
+   {
+      uint8_t sector[BENCH_SECTOR_SIZE];
+      unsigned i;
+      uint32_t crc = 0;
+
+      if (!write_chd(bench_path, BENCH_FRAMES))
+      {
+         fprintf(stderr, "Could not write %s\n", bench_path);
+         return 1;
+      }
+
+      for (i = 0; i < BENCH_FRAMES; i++)
+      {
+         fill_sector(sector, i);
+         crc = encoding_crc32(crc, sector, sizeof(sector));
+      }
+
+      printf("%u frames, %u byte hunks\n", BENCH_FRAMES, BENCH_HUNK_SIZE);
+
+      crc_plain = bench_scan(path, "scan", 0);
+      crc_ahead = bench_scan(path, "scan, read-ahead", 8);
+
+      if (crc_plain != crc || crc_ahead != crc)
+      {
+         printf("FAIL: track CRC %08x/%08x, expected %08x\n",
+               crc_plain, crc_ahead, crc);
+         failures++;
+      }
+   }
+   else
+   {
+      crc_plain = bench_scan(path, "scan", 0);
+      crc_ahead = bench_scan(path, "scan, read-ahead", 8);
+
+      if (crc_plain != crc_ahead)
+      {
+         printf("FAIL: track CRC %08x/%08x\n", crc_plain, crc_ahead);
+         failures++;
+      }
+   }
+
+   bench_seek(path, "seek, 2 hunks",
+         2 * BENCH_HUNK_SIZE, generated);
+   bench_seek(path, "seek, default cache",
+         CHDSTREAM_CACHE_SIZE_DEFAULT, generated);
+
+   {
+      unsigned threads;
+      unsigned cores = cpu_features_get_core_amount();
+      uint32_t crc   = bench_hunks(path, 0);
+
+      if (cores < 4)
+         cores = 4;
+
+      for (threads = 1; threads <= cores; threads *= 2)
+      {
+         uint32_t crc_threads = bench_hunks(path, threads);
+
+         if (crc_threads != crc)
+         {
+            printf("FAIL: %u threads: CRC %08x, expected %08x\n",
+                  threads, crc_threads, crc);
+            failures++;
+         }
+      }
+   }
+
+   if (generated)
+      remove(bench_path);
+
+   if (failures)
+      printf("%d checks failed\n", failures);
+
+   return failures ? 1 : 0;
+}
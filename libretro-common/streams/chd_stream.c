@@ -29,11 +29,38 @@
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
 #include <libchdr/chd.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
+#endif
 
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+#define CHDSTREAM_READAHEAD_DEFAULT 16
+/* Most hunks the read-ahead decodes in one go */
+#define CHDSTREAM_BATCH_MAX 16
+
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   CHDSTREAM_HUNK_READY,
+   /* Being decompressed outside of the lock */
+   CHDSTREAM_HUNK_LOADING
+};
+
+struct chdstream_hunk
+{
+   /* Allocated on first use */
+   uint8_t *mem;
+   uint64_t last_use;
+   uint32_t hunknum;
+   enum chdstream_hunk_state state;
+   /* Decompressed by the read-ahead and not read yet */
+   bool prefetched;
+};
+
 struct chdstream
 {
    chd_file *chd;
@@ -53,10 +80,37 @@ struct chdstream
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Size of a decompressed hunk */
+   uint32_t hunkbytes;
+   /* Last hunk holding data of the track */
+   uint32_t last_hunk;
+   /* Hunk read before the current one, to detect sequential reads */
+   int64_t prev_hunknum;
+   /* Decompressed hunks, the least recently used one gets replaced */
+   struct chdstream_hunk *hunks;
+   unsigned hunk_count;
+   /* Slot of the hunk read last, never replaced by the read-ahead */
+   int current;
+   uint64_t use_count;
+   /* Number of hunks to decompress ahead of the read cursor */
+   unsigned readahead;
+   chdstream_stats_t stats;
+#ifdef HAVE_THREADS
+   /* The read-ahead thread decodes with its own chd_file */
+   char *path;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Hunks the read-ahead should have ready, end is exclusive */
+   uint32_t ahead_begin;
+   uint32_t ahead_end;
+   /* Threads decoding a batch of read-ahead hunks */
+   unsigned decode_threads;
+   /* Decoded batch, only used by the read-ahead thread */
+   uint8_t *batch;
+   bool quit;
+   bool thread_failed;
+#endif
 };
 
 typedef struct metadata {
@@ -199,6 +253,317 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
    return chdstream_find_track_number(fd, track, meta);
 }
 
+static void chdstream_lock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_lock(stream->lock);
+#endif
+}
+
+static void chdstream_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_unlock(stream->lock);
+#endif
+}
+
+/* Wakes up the read-ahead and anyone waiting for a hunk. */
+static void chdstream_signal(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->cond)
+      scond_broadcast(stream->cond);
+#endif
+}
+
+static void chdstream_free_hunks(chdstream_t *stream)
+{
+   unsigned i;
+
+   if (!stream->hunks)
+      return;
+
+   for (i = 0; i < stream->hunk_count; i++)
+      free(stream->hunks[i].mem);
+
+   free(stream->hunks);
+   stream->hunks      = NULL;
+   stream->hunk_count = 0;
+   stream->current    = -1;
+}
+
+static bool chdstream_alloc_hunks(chdstream_t *stream, size_t bytes)
+{
+   unsigned count = (unsigned)(bytes / stream->hunkbytes);
+
+   /* One slot to read from and one to decompress into. */
+   if (count < 2)
+      count = 2;
+
+   stream->hunks      = (struct chdstream_hunk*)
+      calloc(count, sizeof(*stream->hunks));
+   if (!stream->hunks)
+      return false;
+
+   stream->hunk_count = count;
+   stream->current    = -1;
+   return true;
+}
+
+/* Returns the slot holding or loading @hunknum, or -1. */
+static int chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned i;
+
+   for (i = 0; i < stream->hunk_count; i++)
+   {
+      const struct chdstream_hunk *hunk = &stream->hunks[i];
+      if (hunk->state != CHDSTREAM_HUNK_EMPTY && hunk->hunknum == hunknum)
+         return (int)i;
+   }
+
+   return -1;
+}
+
+/* Returns the slot to replace, empty slots first and then the
+ * least recently used one. The read-ahead keeps its hands off
+ * the current slot and off the hunks it was asked to prepare. */
+static int chdstream_find_victim(chdstream_t *stream, bool readahead)
+{
+   unsigned i;
+   int victim = -1;
+
+   for (i = 0; i < stream->hunk_count; i++)
+   {
+      const struct chdstream_hunk *hunk = &stream->hunks[i];
+
+      if (hunk->state == CHDSTREAM_HUNK_LOADING)
+         continue;
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return (int)i;
+
+#ifdef HAVE_THREADS
+      if (readahead)
+      {
+         if ((int)i == stream->current)
+            continue;
+         if (hunk->hunknum >= stream->ahead_begin &&
+               hunk->hunknum < stream->ahead_end)
+            continue;
+      }
+#endif
+
+      if (victim < 0 || hunk->last_use < stream->hunks[victim].last_use)
+         victim = (int)i;
+   }
+
+   return victim;
+}
+
+static void chdstream_swab(chdstream_t *stream, uint8_t *mem)
+{
+   uint32_t i;
+   uint32_t count  = stream->hunkbytes / 2;
+   uint16_t *array = (uint16_t*)mem;
+
+   for (i = 0; i < count; ++i)
+      array[i] = SWAP16(array[i]);
+}
+
+static bool chdstream_decompress(chdstream_t *stream, chd_file *chd,
+      uint32_t hunknum, struct chdstream_hunk *hunk)
+{
+   if (!hunk->mem)
+      hunk->mem = (uint8_t*)malloc(stream->hunkbytes);
+   if (!hunk->mem)
+      return false;
+
+   if (chd_read(chd, hunknum, hunk->mem) != CHDERR_NONE)
+      return false;
+
+   if (stream->swab)
+      chdstream_swab(stream, hunk->mem);
+
+   return true;
+}
+
+#ifdef HAVE_THREADS
+/* Decodes consecutive hunks on all decode threads at once. */
+static bool chdstream_decompress_batch(chdstream_t *stream, chd_file *chd,
+      uint32_t hunknum, struct chdstream_hunk **hunks, unsigned count)
+{
+   unsigned i;
+
+   if (count == 1)
+      return chdstream_decompress(stream, chd, hunknum, hunks[0]);
+
+   if (!stream->batch)
+      stream->batch = (uint8_t*)malloc(
+            (size_t)CHDSTREAM_BATCH_MAX * stream->hunkbytes);
+   if (!stream->batch)
+      return false;
+
+   if (chd_read_hunks(chd, hunknum, count, stream->batch,
+            stream->decode_threads) != CHDERR_NONE)
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      struct chdstream_hunk *hunk = hunks[i];
+
+      if (!hunk->mem)
+         hunk->mem = (uint8_t*)malloc(stream->hunkbytes);
+      if (!hunk->mem)
+         return false;
+
+      memcpy(hunk->mem, stream->batch + (size_t)i * stream->hunkbytes,
+            stream->hunkbytes);
+      if (stream->swab)
+         chdstream_swab(stream, hunk->mem);
+   }
+
+   return true;
+}
+
+static void chdstream_readahead_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+   chd_file *chd       = NULL;
+
+   if (chd_open(stream->path, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE)
+   {
+      slock_lock(stream->lock);
+      stream->thread_failed = true;
+      slock_unlock(stream->lock);
+      return;
+   }
+
+   slock_lock(stream->lock);
+
+   while (!stream->quit)
+   {
+      bool loaded;
+      unsigned i;
+      struct chdstream_hunk *hunks[CHDSTREAM_BATCH_MAX];
+      unsigned count   = 0;
+      uint32_t hunknum = stream->ahead_begin;
+
+      while (hunknum < stream->ahead_end &&
+            chdstream_find_hunk(stream, hunknum) >= 0)
+         hunknum++;
+
+      /* Claim a slot for each missing hunk in a row. */
+      while (count < CHDSTREAM_BATCH_MAX &&
+            hunknum + count < stream->ahead_end &&
+            chdstream_find_hunk(stream, hunknum + count) < 0)
+      {
+         struct chdstream_hunk *hunk = NULL;
+         int slot                    = chdstream_find_victim(stream, true);
+
+         if (slot < 0)
+            break;
+
+         hunk             = &stream->hunks[slot];
+         hunk->state      = CHDSTREAM_HUNK_LOADING;
+         hunk->hunknum    = hunknum + count;
+         hunk->prefetched = false;
+         hunks[count++]   = hunk;
+      }
+
+      if (!count)
+      {
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      slock_unlock(stream->lock);
+      loaded = chdstream_decompress_batch(stream, chd, hunknum, hunks, count);
+      slock_lock(stream->lock);
+
+      for (i = 0; i < count; i++)
+      {
+         hunks[i]->state      = loaded
+            ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+         hunks[i]->prefetched = loaded;
+         hunks[i]->last_use   = ++stream->use_count;
+      }
+
+      scond_broadcast(stream->cond);
+
+      /* Leave broken hunks to the reader, which reports the error. */
+      if (!loaded)
+      {
+         stream->thread_failed = true;
+         break;
+      }
+
+      stream->stats.prefetched += count;
+   }
+
+   slock_unlock(stream->lock);
+
+   chd_close(chd);
+}
+
+/* Asks the read-ahead for the hunks behind @hunknum, the thread
+ * is only started once the stream is read sequentially. Called
+ * with the lock held. */
+static void chdstream_request_readahead(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned readahead = stream->readahead;
+
+   if (readahead > stream->hunk_count - 1)
+      readahead = stream->hunk_count - 1;
+
+   if (!readahead || stream->thread_failed || !stream->lock)
+      return;
+
+   if (!stream->thread)
+   {
+      if (stream->prev_hunknum != (int64_t)hunknum - 1)
+         return;
+
+      stream->thread = sthread_create(chdstream_readahead_thread, stream);
+      if (!stream->thread)
+      {
+         stream->thread_failed = true;
+         return;
+      }
+   }
+
+   stream->ahead_begin = hunknum + 1;
+   stream->ahead_end   = hunknum + 1 + readahead;
+   if (stream->ahead_end > stream->last_hunk + 1)
+      stream->ahead_end = stream->last_hunk + 1;
+
+   scond_broadcast(stream->cond);
+}
+
+/* Stops the read-ahead from touching any slot, called with the
+ * lock held. */
+static void chdstream_wait_readahead(chdstream_t *stream)
+{
+   stream->ahead_end = stream->ahead_begin;
+
+   for (;;)
+   {
+      unsigned i;
+      bool loading = false;
+
+      for (i = 0; i < stream->hunk_count; i++)
+         if (stream->hunks[i].state == CHDSTREAM_HUNK_LOADING)
+            loading = true;
+
+      if (!loading)
+         break;
+
+      scond_wait(stream->cond, stream->lock);
+   }
+}
+#endif
+
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
@@ -218,11 +583,21 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!stream)
       goto error;
 
-   hd              = chd_get_header(chd);
-   stream->hunkmem = (uint8_t*)malloc(hd->hunkbytes);
-   if (!stream->hunkmem)
+   hd                = chd_get_header(chd);
+   stream->hunkbytes = hd->hunkbytes;
+   if (!chdstream_alloc_hunks(stream, CHDSTREAM_CACHE_SIZE_DEFAULT))
       goto error;
 
+#ifdef HAVE_THREADS
+   stream->path      = strdup(path);
+   stream->lock      = slock_new();
+   stream->cond      = scond_new();
+
+   /* Without these the stream still works, just without read-ahead. */
+   if (!stream->path || !stream->lock || !stream->cond)
+      stream->thread_failed = true;
+#endif
+
    if (!strcmp(meta.type, "MODE1_RAW"))
    {
       stream->frame_size = SECTOR_SIZE;
@@ -259,7 +634,20 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->track_end       = stream->track_start +
       (size_t) meta.frames * stream->frame_size;
    stream->offset          = 0;
-   stream->hunknum         = -1;
+   stream->prev_hunknum    = -1;
+#ifdef HAVE_THREADS
+   /* Only pays off with a core to spare for decompression,
+    * the reader keeps one core busy. */
+   stream->decode_threads  = cpu_features_get_core_amount();
+   if (stream->decode_threads > 1)
+      stream->readahead    = CHDSTREAM_READAHEAD_DEFAULT;
+   if (stream->decode_threads > 1)
+      stream->decode_threads--;
+#endif
+   stream->last_hunk       = (stream->track_frame +
+         (meta.frames ? meta.frames - 1 : 0)) / stream->frames_per_hunk;
+   if (stream->last_hunk >= hd->totalhunks)
+      stream->last_hunk = hd->totalhunks - 1;
 
    return stream;
 
@@ -277,39 +665,120 @@ void chdstream_close(chdstream_t *stream)
 {
    if (stream)
    {
-      if (stream->hunkmem)
-         free(stream->hunkmem);
+#ifdef HAVE_THREADS
+      if (stream->thread)
+      {
+         slock_lock(stream->lock);
+         stream->quit = true;
+         scond_broadcast(stream->cond);
+         slock_unlock(stream->lock);
+
+         sthread_join(stream->thread);
+      }
+      if (stream->cond)
+         scond_free(stream->cond);
+      if (stream->lock)
+         slock_free(stream->lock);
+      free(stream->batch);
+      free(stream->path);
+#endif
+      chdstream_free_hunks(stream);
       if (stream->chd)
          chd_close(stream->chd);
       free(stream);
    }
 }
 
-static bool
+static const uint8_t *
 chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
 {
-   chd_error err;
-   uint16_t *array;
-   uint32_t i;
-   uint32_t count;
+   struct chdstream_hunk *hunk = NULL;
+   int slot                    = stream->current;
 
-   if (hunknum == stream->hunknum)
-      return true;
+   /* The read-ahead never touches the current slot, no need to lock. */
+   if (slot >= 0 && stream->hunks[slot].hunknum == hunknum)
+      return stream->hunks[slot].mem;
 
-   err = chd_read(stream->chd, hunknum, stream->hunkmem);
-   if (err != CHDERR_NONE)
-      return false;
+   chdstream_lock(stream);
 
-   if (stream->swab)
+   slot = chdstream_find_hunk(stream, hunknum);
+
+#ifdef HAVE_THREADS
+   /* Already being decompressed by the read-ahead. */
+   while (slot >= 0 && stream->hunks[slot].state == CHDSTREAM_HUNK_LOADING)
    {
-      count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array = (uint16_t*) stream->hunkmem;
-      for (i = 0; i < count; ++i)
-         array[i] = SWAP16(array[i]);
+      scond_wait(stream->cond, stream->lock);
+      slot = chdstream_find_hunk(stream, hunknum);
    }
+#endif
 
-   stream->hunknum = hunknum;
-   return true;
+   if (slot >= 0)
+   {
+      hunk = &stream->hunks[slot];
+
+      stream->stats.hits++;
+      if (hunk->prefetched)
+         stream->stats.prefetch_hits++;
+
+#ifdef HAVE_THREADS
+      chdstream_request_readahead(stream, hunknum);
+#endif
+   }
+   else
+   {
+      bool loaded;
+
+      slot = chdstream_find_victim(stream, false);
+#ifdef HAVE_THREADS
+      while (slot < 0 && stream->hunk_count)
+      {
+         scond_wait(stream->cond, stream->lock);
+         slot = chdstream_find_victim(stream, false);
+      }
+#endif
+
+      if (slot < 0)
+      {
+         chdstream_unlock(stream);
+         return NULL;
+      }
+
+      hunk            = &stream->hunks[slot];
+      hunk->state     = CHDSTREAM_HUNK_LOADING;
+      hunk->hunknum   = hunknum;
+      stream->current = -1;
+
+#ifdef HAVE_THREADS
+      /* Let the read-ahead get going while this one decompresses. */
+      chdstream_request_readahead(stream, hunknum);
+#endif
+
+      chdstream_unlock(stream);
+      loaded          = chdstream_decompress(stream, stream->chd,
+            hunknum, hunk);
+      chdstream_lock(stream);
+
+      hunk->state     = loaded
+         ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+      chdstream_signal(stream);
+
+      if (!loaded)
+      {
+         chdstream_unlock(stream);
+         return NULL;
+      }
+
+      stream->stats.misses++;
+   }
+
+   hunk->prefetched     = false;
+   hunk->last_use       = ++stream->use_count;
+   stream->current      = slot;
+   stream->prev_hunknum = hunknum;
+
+   chdstream_unlock(stream);
+
+   return hunk->mem;
 }
 
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
@@ -320,9 +789,10 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
    uint32_t chd_frame;
    uint32_t hunk;
    uint32_t amount;
-   size_t data_offset   = 0;
-   const chd_header *hd = chd_get_header(stream->chd);
-   uint8_t         *out = (uint8_t*)data;
+   const uint8_t *hunkmem = NULL;
+   size_t data_offset     = 0;
+   const chd_header *hd   = chd_get_header(stream->chd);
+   uint8_t         *out   = (uint8_t*)data;
 
    if (stream->track_end - stream->offset < bytes)
       bytes = stream->track_end - stream->offset;
@@ -345,12 +815,13 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
          hunk = chd_frame / stream->frames_per_hunk;
          hunk_offset = (chd_frame % stream->frames_per_hunk) * hd->unitbytes;
 
-         if (!chdstream_load_hunk(stream, hunk))
+         hunkmem = chdstream_load_hunk(stream, hunk);
+         if (!hunkmem)
          {
             return -1;
          }
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                hunkmem + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
       }
 
@@ -361,6 +832,42 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
    return bytes;
 }
 
+void chdstream_set_cache_size(chdstream_t *stream, size_t bytes)
+{
+   chdstream_lock(stream);
+
+#ifdef HAVE_THREADS
+   if (stream->thread)
+      chdstream_wait_readahead(stream);
+#endif
+
+   chdstream_free_hunks(stream);
+   if (!chdstream_alloc_hunks(stream, bytes))
+      chdstream_alloc_hunks(stream, 0);
+
+   chdstream_unlock(stream);
+}
+
+void chdstream_set_readahead(chdstream_t *stream, unsigned hunks)
+{
+   chdstream_lock(stream);
+
+   stream->readahead = hunks;
+#ifdef HAVE_THREADS
+   if (!hunks)
+      stream->ahead_end = stream->ahead_begin;
+#endif
+
+   chdstream_unlock(stream);
+}
+
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats)
+{
+   chdstream_lock(stream);
+   *stats = stream->stats;
+   chdstream_unlock(stream);
+}
+
 int chdstream_getc(chdstream_t *stream)
 {
    char c = 0;
@@ -32,6 +32,15 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -46,12 +55,26 @@
 
 #define MAGIC_NUMBER "RARCHDB"
 
+/* Fields that get a hash index when a query needs one. */
+#define LIBRETRODB_MAX_HASH_INDEXES 4
+
 struct node_iter_ctx
 {
 	libretrodb_t *db;
 	libretrodb_index_t *idx;
 };
 
+/* Maps the hash of a field value to the offsets of the
+ * documents containing it. Open addressing, documents sharing
+ * a value occupy consecutive probes. */
+typedef struct libretrodb_hash_index
+{
+   char field[32];
+   uint64_t *offsets;
+   uint32_t *hashes;
+   uint32_t mask;
+} libretrodb_hash_index_t;
+
 struct libretrodb
 {
 	RFILE *fd;
@@ -59,6 +82,17 @@ struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char *path;
+   /* The whole file, documents are decoded straight from it.
+    * NULL when it can't be mapped, they are read through fd then. */
+   uint8_t *data;
+   size_t size;
+#ifdef HAVE_MMAP
+   int map_fd;
+#endif
+   /* End of the documents, where the metadata starts. */
+   size_t documents_end;
+   unsigned num_hash_indexes;
+   libretrodb_hash_index_t hash_indexes[LIBRETRODB_MAX_HASH_INDEXES];
 };
 
 struct libretrodb_index
@@ -82,10 +116,16 @@ typedef struct libretrodb_header
 struct libretrodb_cursor
 {
 	int is_valid;
-   RFILE *fd;
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   /* Offset of the next document when scanning. */
+   size_t pos;
+   /* Offsets of the only documents that can match the query,
+    * in file order. Used instead of a scan if not NULL. */
+   uint64_t *candidates;
+   size_t num_candidates;
+   size_t next_candidate;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -173,8 +213,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
       goto clean;
 
-   header.metadata_offset = swap_if_little64(filestream_seek(
-            fd, 0, RETRO_VFS_SEEK_POSITION_CURRENT));
+   header.metadata_offset = swap_if_little64(filestream_tell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
    filestream_seek(fd, root, RETRO_VFS_SEEK_POSITION_START);
@@ -204,14 +243,78 @@ static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
    rmsgpack_write_uint(fd, idx->next);
 }
 
+static void libretrodb_unmap(libretrodb_t *db)
+{
+#ifdef HAVE_MMAP
+   if (db->data)
+      munmap(db->data, db->size);
+   if (db->map_fd >= 0)
+      close(db->map_fd);
+   db->map_fd = -1;
+#else
+   if (db->data)
+      free(db->data);
+#endif
+   db->data = NULL;
+   db->size = 0;
+}
+
+static int libretrodb_map(libretrodb_t *db, const char *path)
+{
+#ifdef HAVE_MMAP
+   struct stat st;
+
+   db->map_fd = open(path, O_RDONLY);
+
+   if (db->map_fd < 0)
+      return -errno;
+
+   if (fstat(db->map_fd, &st) != 0 || st.st_size <= 0)
+      goto error;
+
+   db->size = (size_t)st.st_size;
+   db->data = (uint8_t*)mmap(NULL, db->size, PROT_READ, MAP_SHARED,
+         db->map_fd, 0);
+
+   if (db->data == MAP_FAILED)
+   {
+      db->data = NULL;
+      goto error;
+   }
+
+   return 0;
+
+error:
+   libretrodb_unmap(db);
+   return -EINVAL;
+#else
+   /* Documents are read through db->fd instead, holding every
+    * opened database in memory is too much for these targets. */
+   return 0;
+#endif
+}
+
 void libretrodb_close(libretrodb_t *db)
 {
+   unsigned i;
+
    if (db->fd)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
       free(db->path);
-   db->path = NULL;
-   db->fd   = NULL;
+
+   for (i = 0; i < db->num_hash_indexes; i++)
+   {
+      free(db->hash_indexes[i].offsets);
+      free(db->hash_indexes[i].hashes);
+   }
+
+   libretrodb_unmap(db);
+
+   db->num_hash_indexes = 0;
+   db->documents_end    = 0;
+   db->path             = NULL;
+   db->fd               = NULL;
 }
 
 int libretrodb_open(const char *path, libretrodb_t *db)
@@ -238,7 +341,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER,
+            sizeof(header.magic_number)) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -254,8 +358,24 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
+   libretrodb_unmap(db);
+
+   if ((rv = libretrodb_map(db, path)) < 0)
+      goto error;
+
+   if (!db->data)
+      db->size = (size_t)filestream_get_size(fd);
+
+   if (header.metadata_offset > db->size)
+   {
+      libretrodb_unmap(db);
+      rv = -EINVAL;
+      goto error;
+   }
+
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
+   db->documents_end      = (size_t)header.metadata_offset;
    db->fd                 = fd;
    return 0;
 
@@ -354,6 +474,332 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
    return rmsgpack_dom_read(db->fd, out);
 }
 
+static uint32_t libretrodb_hash(const uint8_t *s, uint32_t len)
+{
+   uint32_t hash = 5381;
+
+   while (len--)
+      hash = ((hash << 5) + hash) + *s++;
+
+   return hash;
+}
+
+/* Reads the string or binary at @pos without copying it.
+ * Returns: 0 on success, -1 if the value is neither. */
+static int libretrodb_read_bytes(const uint8_t *buf, size_t len,
+      size_t *pos, const uint8_t **out, uint32_t *out_len)
+{
+   size_t i;
+   size_t size   = 0;
+   uint32_t n    = 0;
+   uint8_t type  = buf[*pos];
+
+   if (type >= 0xa0 && type <= 0xbf)
+      n = type - 0xa0;
+   else if (type >= 0xd9 && type <= 0xdb)
+      size = (size_t)1 << (type - 0xd9);
+   else if (type >= 0xc4 && type <= 0xc6)
+      size = (size_t)1 << (type - 0xc4);
+   else
+      return -1;
+
+   if (len - *pos - 1 < size)
+      return -1;
+
+   for (i = 0; i < size; i++)
+      n = (n << 8) | buf[*pos + 1 + i];
+
+   if (len - *pos - 1 - size < n)
+      return -1;
+
+   *out     = buf + *pos + 1 + size;
+   *out_len = n;
+   *pos    += 1 + size + n;
+   return 0;
+}
+
+/* Reads the header of the map at @pos.
+ * Returns: number of pairs, -1 if the value is not a map. */
+static int64_t libretrodb_read_map_header(const uint8_t *buf, size_t len,
+      size_t *pos)
+{
+   size_t i;
+   size_t size   = 0;
+   int64_t n     = 0;
+   uint8_t type  = buf[*pos];
+
+   if (type >= 0x80 && type <= 0x8f)
+      n = type - 0x80;
+   else if (type == 0xde || type == 0xdf)
+      size = (size_t)2 << (type - 0xde);
+   else
+      return -1;
+
+   if (len - *pos - 1 < size)
+      return -1;
+
+   for (i = 0; i < size; i++)
+      n = (n << 8) | buf[*pos + 1 + i];
+
+   *pos += 1 + size;
+   return n;
+}
+
+static int libretrodb_hash_index_insert(libretrodb_hash_index_t *idx,
+      uint64_t *used, const uint8_t *value, uint32_t value_len, size_t doc)
+{
+   uint32_t hash, slot;
+
+   /* Keep at least half of the slots free. */
+   if (++*used > (idx->mask + 1) / 2)
+      return -1;
+
+   hash = libretrodb_hash(value, value_len);
+   slot = hash & idx->mask;
+
+   while (idx->offsets[slot])
+      slot = (slot + 1) & idx->mask;
+
+   idx->offsets[slot] = doc;
+   idx->hashes[slot]  = hash;
+   return 0;
+}
+
+/* Same as the walk in libretrodb_hash_index_build(), for
+ * databases read through db->fd. */
+static int libretrodb_hash_index_build_stream(libretrodb_t *db,
+      libretrodb_hash_index_t *idx, const char *field, uint32_t field_len)
+{
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value item;
+   uint64_t used  = 0;
+   size_t pos     = (size_t)(db->root + sizeof(libretrodb_header_t));
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = field_len;
+   key.val.string.buff = (char*)field;
+
+   filestream_seek(db->fd, (ssize_t)pos, RETRO_VFS_SEEK_POSITION_START);
+
+   while (pos < db->documents_end)
+   {
+      const struct rmsgpack_dom_value *value = NULL;
+      int rv                                 = 0;
+
+      if (rmsgpack_dom_read(db->fd, &item) < 0)
+         return -1;
+
+      if (item.type == RDT_NULL)
+         break;
+
+      if ((value = rmsgpack_dom_value_map_value(&item, &key)))
+      {
+         if (value->type == RDT_STRING)
+            rv = libretrodb_hash_index_insert(idx, &used,
+                  (const uint8_t*)value->val.string.buff,
+                  value->val.string.len, pos);
+         else if (value->type == RDT_BINARY)
+            rv = libretrodb_hash_index_insert(idx, &used,
+                  (const uint8_t*)value->val.binary.buff,
+                  value->val.binary.len, pos);
+      }
+
+      rmsgpack_dom_value_free(&item);
+
+      if (rv < 0)
+         return -1;
+
+      pos = (size_t)filestream_tell(db->fd);
+   }
+
+   return 0;
+}
+
+static int libretrodb_hash_index_build(libretrodb_t *db,
+      libretrodb_hash_index_t *idx, const char *field, uint32_t field_len)
+{
+   uint32_t cap   = 16;
+   uint64_t used  = 0;
+   size_t pos     = (size_t)(db->root + sizeof(libretrodb_header_t));
+   size_t end     = db->documents_end;
+
+   while (cap < db->count * 2)
+      cap <<= 1;
+
+   idx->offsets = (uint64_t*)calloc(cap, sizeof(*idx->offsets));
+   idx->hashes  = (uint32_t*)calloc(cap, sizeof(*idx->hashes));
+   idx->mask    = cap - 1;
+
+   if (!idx->offsets || !idx->hashes)
+      goto error;
+
+   strlcpy(idx->field, field, sizeof(idx->field));
+
+   if (!db->data)
+   {
+      if (libretrodb_hash_index_build_stream(db, idx, field, field_len) < 0)
+         goto error;
+      return 0;
+   }
+
+   while (pos < end && db->data[pos] != 0xc0)
+   {
+      int64_t i;
+      size_t doc   = pos;
+      int64_t size = libretrodb_read_map_header(db->data, end, &pos);
+
+      if (size < 0)
+      {
+         if (rmsgpack_skip_buf(db->data, end, &pos) < 0)
+            goto error;
+         continue;
+      }
+
+      for (i = 0; i < size && pos < end; i++)
+      {
+         const uint8_t *key   = NULL;
+         const uint8_t *value = NULL;
+         uint32_t key_len     = 0;
+         uint32_t value_len   = 0;
+
+         if (libretrodb_read_bytes(db->data, end, &pos, &key, &key_len) < 0)
+         {
+            if (rmsgpack_skip_buf(db->data, end, &pos) < 0)
+               goto error;
+         }
+         else if (key_len == field_len
+               && memcmp(key, field, field_len) == 0
+               && pos < end
+               && libretrodb_read_bytes(db->data, end, &pos,
+                  &value, &value_len) == 0)
+         {
+            if (libretrodb_hash_index_insert(idx, &used,
+                     value, value_len, doc) < 0)
+               goto error;
+            continue;
+         }
+
+         if (rmsgpack_skip_buf(db->data, end, &pos) < 0)
+            goto error;
+      }
+   }
+
+   return 0;
+
+error:
+   free(idx->offsets);
+   free(idx->hashes);
+   idx->offsets = NULL;
+   idx->hashes  = NULL;
+   return -1;
+}
+
+/* Builds the index on first use. */
+static libretrodb_hash_index_t *libretrodb_get_hash_index(libretrodb_t *db,
+      const char *field, uint32_t field_len)
+{
+   unsigned i;
+   libretrodb_hash_index_t *idx = NULL;
+
+   if (field_len >= sizeof(idx->field))
+      return NULL;
+
+   for (i = 0; i < db->num_hash_indexes; i++)
+      if (string_is_equal(db->hash_indexes[i].field, field))
+         return &db->hash_indexes[i];
+
+   if (db->num_hash_indexes >= LIBRETRODB_MAX_HASH_INDEXES)
+      return NULL;
+
+   idx = &db->hash_indexes[db->num_hash_indexes];
+
+   if (libretrodb_hash_index_build(db, idx, field, field_len) < 0)
+      return NULL;
+
+   db->num_hash_indexes++;
+   return idx;
+}
+
+static int libretrodb_offset_compare(const void *a, const void *b)
+{
+   uint64_t l = *(const uint64_t*)a;
+   uint64_t r = *(const uint64_t*)b;
+
+   return (l > r) - (l < r);
+}
+
+/* Resolves equality queries through a hash index, the query
+ * still gets evaluated against the few documents found. */
+static void libretrodb_cursor_find_candidates(libretrodb_cursor_t *cursor)
+{
+   unsigned i, num_keys;
+   const struct rmsgpack_dom_value *keys[QUERY_MAX_INDEX_KEYS];
+   const struct rmsgpack_dom_value *field = NULL;
+   libretrodb_hash_index_t *idx           = NULL;
+   size_t count                           = 0;
+   size_t cap                             = 4;
+   uint64_t *candidates                   = NULL;
+
+   num_keys = libretrodb_query_get_index_keys(cursor->query, &field,
+         keys, QUERY_MAX_INDEX_KEYS);
+
+   if (!num_keys)
+      return;
+
+   idx = libretrodb_get_hash_index(cursor->db, field->val.string.buff,
+         field->val.string.len);
+
+   if (!idx)
+      return;
+
+   candidates = (uint64_t*)malloc(cap * sizeof(*candidates));
+   if (!candidates)
+      return;
+
+   for (i = 0; i < num_keys; i++)
+   {
+      uint32_t hash = libretrodb_hash((const uint8_t*)keys[i]->val.string.buff,
+            keys[i]->val.string.len);
+      uint32_t slot = hash & idx->mask;
+
+      for (; idx->offsets[slot]; slot = (slot + 1) & idx->mask)
+      {
+         if (idx->hashes[slot] != hash)
+            continue;
+
+         if (count == cap)
+         {
+            uint64_t *tmp = (uint64_t*)realloc(candidates,
+                  cap * 2 * sizeof(*candidates));
+            if (!tmp)
+            {
+               free(candidates);
+               return;
+            }
+            candidates = tmp;
+            cap       *= 2;
+         }
+
+         candidates[count++] = idx->offsets[slot];
+      }
+   }
+
+   /* Same order as a scan, without duplicates. */
+   qsort(candidates, count, sizeof(*candidates), libretrodb_offset_compare);
+
+   if (count)
+   {
+      size_t j = 0;
+      for (i = 1; i < count; i++)
+         if (candidates[i] != candidates[j])
+            candidates[++j] = candidates[i];
+      count = j + 1;
+   }
+
+   cursor->candidates     = candidates;
+   cursor->num_candidates = count;
+}
+
 /**
  * libretrodb_cursor_reset:
  * @cursor              : Handle to database cursor.
@@ -364,25 +810,57 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
-   return (int)filestream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
-         RETRO_VFS_SEEK_POSITION_START);
+   cursor->eof            = 0;
+   cursor->next_candidate = 0;
+   cursor->pos            = (size_t)(cursor->db->root
+         + sizeof(libretrodb_header_t));
+   return 0;
 }
 
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
+   size_t pos;
+   libretrodb_t *db = cursor->db;
 
    if (cursor->eof)
       return EOF;
 
 retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
+   if (cursor->candidates)
+   {
+      if (cursor->next_candidate >= cursor->num_candidates)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+      pos = (size_t)cursor->candidates[cursor->next_candidate++];
+   }
+   else
+      pos = cursor->pos;
+
+   if (pos >= db->documents_end)
+   {
+      cursor->eof = 1;
+      return EOF;
+   }
+
+   if (db->data)
+      rv = rmsgpack_dom_read_buf(db->data, db->documents_end, &pos, out);
+   else
+   {
+      filestream_seek(db->fd, (ssize_t)pos, RETRO_VFS_SEEK_POSITION_START);
+      if ((rv = rmsgpack_dom_read(db->fd, out)) >= 0)
+         pos = (size_t)filestream_tell(db->fd);
+   }
+
    if (rv < 0)
       return rv;
 
+   if (!cursor->candidates)
+      cursor->pos = pos;
+
    if (out->type == RDT_NULL)
    {
       cursor->eof = 1;
@@ -412,17 +890,18 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (!cursor)
       return;
 
-   if (cursor->fd)
-      filestream_close(cursor->fd);
-
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   if (cursor->candidates)
+      free(cursor->candidates);
+
+   cursor->is_valid       = 0;
+   cursor->eof            = 1;
+   cursor->db             = NULL;
+   cursor->query          = NULL;
+   cursor->candidates     = NULL;
+   cursor->num_candidates = 0;
 }
 
 /**
@@ -438,25 +917,21 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
 int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
       libretrodb_query_t *q)
 {
-   RFILE *fd = NULL;
-   if (!db || string_is_empty(db->path))
-      return -errno;
-
-   fd = filestream_open(db->path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-   if (!fd)
-      return -errno;
+   if (!db || (!db->data && !db->fd))
+      return -EINVAL;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   cursor->db             = db;
+   cursor->is_valid       = 1;
+   cursor->candidates     = NULL;
+   cursor->num_candidates = 0;
    libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->query          = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_find_candidates(cursor);
+   }
 
    return 0;
 }
@@ -472,11 +947,6 @@ static int node_iter(void *value, void *ctx)
    return -1;
 }
 
-static uint64_t libretrodb_tell(libretrodb_t *db)
-{
-   return filestream_tell(db->fd);
-}
-
 static int node_compare(const void *a, const void *b, void *ctx)
 {
    return memcmp(a, b, *(uint8_t *)ctx);
@@ -494,7 +964,7 @@ int libretrodb_create_index(libretrodb_t *db,
    void *buff                       = NULL;
    uint64_t *buff_u64               = NULL;
    uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
+   uint64_t item_loc                = 0;
    bintree_t *tree                  = bintree_new(node_compare, &field_size);
 
    item.type                        = RDT_NULL;
@@ -502,6 +972,8 @@ int libretrodb_create_index(libretrodb_t *db,
    if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
       goto clean;
 
+   item_loc            = cur.pos;
+
    key.type            = RDT_STRING;
    key.val.string.len  = (uint32_t)strlen(field_name);
    key.val.string.buff = (char *) field_name;   /* We know we aren't going to change it */
@@ -561,7 +1033,7 @@ int libretrodb_create_index(libretrodb_t *db,
       }
       buff     = NULL;
       rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
+      item_loc = cur.pos;
    }
 
    filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
@@ -615,6 +1087,10 @@ libretrodb_t *libretrodb_new(void)
    if (!db)
       return NULL;
 
+#ifdef HAVE_MMAP
+   db->map_fd       = -1;
+#endif
+
    return db;
 }
 
@@ -970,6 +970,64 @@ void libretrodb_query_inc_ref(libretrodb_query_t *q)
       rq->ref_count += 1;
 }
 
+static int query_is_index_key(const struct argument *arg)
+{
+   return arg->type == AT_VALUE
+      && (arg->a.value.type == RDT_STRING
+            || arg->a.value.type == RDT_BINARY);
+}
+
+unsigned libretrodb_query_get_index_keys(libretrodb_query_t *q,
+      const struct rmsgpack_dom_value **field,
+      const struct rmsgpack_dom_value **keys, unsigned max)
+{
+   unsigned i, j;
+   struct invocation *root = &((struct query*)q)->root;
+
+   /* Only tables, every field has to match so any
+    * of them can narrow the search down. */
+   if (root->func != query_func_all_map)
+      return 0;
+
+   for (i = 0; i + 1 < root->argc; i += 2)
+   {
+      const struct argument *arg = &root->argv[i + 1];
+
+      if (root->argv[i].type != AT_VALUE
+            || root->argv[i].a.value.type != RDT_STRING)
+         continue;
+
+      if (query_is_index_key(arg))
+      {
+         if (max < 1)
+            return 0;
+         *field  = &root->argv[i].a.value;
+         keys[0] = &arg->a.value;
+         return 1;
+      }
+
+      if (arg->type != AT_FUNCTION
+            || arg->a.invocation.func != query_func_operator_or
+            || arg->a.invocation.argc == 0
+            || arg->a.invocation.argc > max)
+         continue;
+
+      for (j = 0; j < arg->a.invocation.argc; j++)
+         if (!query_is_index_key(&arg->a.invocation.argv[j]))
+            break;
+
+      if (j < arg->a.invocation.argc)
+         continue;
+
+      *field = &root->argv[i].a.value;
+      for (j = 0; j < arg->a.invocation.argc; j++)
+         keys[j] = &arg->a.invocation.argv[j].a.value;
+      return arg->a.invocation.argc;
+   }
+
+   return 0;
+}
+
 int libretrodb_query_filter(libretrodb_query_t *q,
       struct rmsgpack_dom_value *v)
 {
@@ -30,6 +30,9 @@
 
 RETRO_BEGIN_DECLS
 
+/* Most values libretrodb_query_get_index_keys() is asked for. */
+#define QUERY_MAX_INDEX_KEYS 8
+
 typedef struct libretrodb_query libretrodb_query_t;
 
 void libretrodb_query_inc_ref(libretrodb_query_t *q);
@@ -38,6 +41,25 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_get_index_keys:
+ * @q                   : Query to inspect.
+ * @field               : Receives the name of the field.
+ * @keys                : Receives up to @max values.
+ * @max                 : Size of @keys.
+ *
+ * Checks whether @q can only match documents whose @field is
+ * equal to one of a few string or binary values, like
+ * {crc:or(b"..",b"..")} does. Such queries can be answered
+ * by looking the values up instead of scanning the database.
+ *
+ * Returns: number of values stored in @keys, 0 if the query
+ * has to be evaluated against every document.
+ **/
+unsigned libretrodb_query_get_index_keys(libretrodb_query_t *q,
+      const struct rmsgpack_dom_value **field,
+      const struct rmsgpack_dom_value **keys, unsigned max);
+
 RETRO_END_DECLS
 
 #endif
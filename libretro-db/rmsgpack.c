@@ -658,3 +658,290 @@ int rmsgpack_read(RFILE *fd,
 error:
    return -errno;
 }
+
+static int rmsgpack_buf_read_uint(const uint8_t *buf, size_t len,
+      size_t *pos, uint64_t *out, size_t size)
+{
+   size_t i;
+   uint64_t v = 0;
+
+   if (len - *pos < size)
+      return -EINVAL;
+
+   /* Stored big-endian. */
+   for (i = 0; i < size; i++)
+      v = (v << 8) | buf[*pos + i];
+
+   *pos += size;
+   *out  = v;
+   return 0;
+}
+
+static int rmsgpack_buf_read_buff(const uint8_t *buf, size_t len,
+      size_t *pos, size_t size, char **pbuff, uint64_t *out_len)
+{
+   uint64_t tmp_len = 0;
+
+   if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len, size) < 0)
+      return -EINVAL;
+
+   if (len - *pos < tmp_len)
+      return -EINVAL;
+
+   *pbuff = (char*)malloc((size_t)(tmp_len + 1) * sizeof(char));
+   if (!*pbuff)
+      return -ENOMEM;
+
+   memcpy(*pbuff, buf + *pos, (size_t)tmp_len);
+   (*pbuff)[tmp_len] = '\0';
+
+   *pos     += (size_t)tmp_len;
+   *out_len  = tmp_len;
+   return 0;
+}
+
+int rmsgpack_read_buf(const uint8_t *buf, size_t len, size_t *pos,
+      struct rmsgpack_read_callbacks *callbacks, void *data)
+{
+   int rv;
+   uint64_t i;
+   uint64_t tmp_len  = 0;
+   uint64_t tmp_uint = 0;
+   uint8_t type      = 0;
+   char *buff        = NULL;
+
+   if (*pos >= len)
+      return -EINVAL;
+
+   type = buf[(*pos)++];
+
+   if (type < MPF_FIXMAP)
+   {
+      if (!callbacks->read_int)
+         return 0;
+      return callbacks->read_int(type, data);
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      tmp_len = type - MPF_FIXMAP;
+      goto map;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      tmp_len = type - MPF_FIXARRAY;
+      goto array;
+   }
+   else if (type < MPF_NIL)
+   {
+      tmp_len = type - MPF_FIXSTR;
+      if (len - *pos < tmp_len)
+         return -EINVAL;
+      buff = (char*)malloc((size_t)(tmp_len + 1) * sizeof(char));
+      if (!buff)
+         return -ENOMEM;
+      memcpy(buff, buf + *pos, (size_t)tmp_len);
+      buff[tmp_len] = '\0';
+      *pos         += (size_t)tmp_len;
+      if (!callbacks->read_string)
+      {
+         free(buff);
+         return 0;
+      }
+      return callbacks->read_string(buff, (uint32_t)tmp_len, data);
+   }
+   else if (type > MPF_MAP32)
+   {
+      if (!callbacks->read_int)
+         return 0;
+      return callbacks->read_int(type - 0xff - 1, data);
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         if (callbacks->read_nil)
+            return callbacks->read_nil(data);
+         break;
+      case _MPF_FALSE:
+         if (callbacks->read_bool)
+            return callbacks->read_bool(0, data);
+         break;
+      case _MPF_TRUE:
+         if (callbacks->read_bool)
+            return callbacks->read_bool(1, data);
+         break;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         if ((rv = rmsgpack_buf_read_buff(buf, len, pos,
+                     (size_t)(1 << (type - _MPF_BIN8)),
+                     &buff, &tmp_len)) < 0)
+            return rv;
+
+         if (callbacks->read_bin)
+            return callbacks->read_bin(buff, (uint32_t)tmp_len, data);
+         break;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_uint,
+                  (size_t)(UINT64_C(1) << (type - _MPF_UINT8))) < 0)
+            return -EINVAL;
+
+         if (callbacks->read_uint)
+            return callbacks->read_uint(tmp_uint, data);
+         break;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         tmp_len = UINT64_C(1) << (type - _MPF_INT8);
+         if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_uint,
+                  (size_t)tmp_len) < 0)
+            return -EINVAL;
+
+         /* Sign extend. */
+         if (tmp_len < 8 && (tmp_uint & (UINT64_C(1) << (tmp_len * 8 - 1))))
+            tmp_uint |= ~((UINT64_C(1) << (tmp_len * 8)) - 1);
+
+         if (callbacks->read_int)
+            return callbacks->read_int((int64_t)tmp_uint, data);
+         break;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         if ((rv = rmsgpack_buf_read_buff(buf, len, pos,
+                     (size_t)(1 << (type - _MPF_STR8)),
+                     &buff, &tmp_len)) < 0)
+            return rv;
+
+         if (callbacks->read_string)
+            return callbacks->read_string(buff, (uint32_t)tmp_len, data);
+         break;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                  2 << (type - _MPF_ARRAY16)) < 0)
+            return -EINVAL;
+         goto array;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                  2 << (type - _MPF_MAP16)) < 0)
+            return -EINVAL;
+         goto map;
+   }
+
+   if (buff)
+      free(buff);
+   return 0;
+
+map:
+   if (callbacks->read_map_start &&
+         (rv = callbacks->read_map_start((uint32_t)tmp_len, data)) < 0)
+      return rv;
+
+   for (i = 0; i < tmp_len * 2; i++)
+      if ((rv = rmsgpack_read_buf(buf, len, pos, callbacks, data)) < 0)
+         return rv;
+
+   return 0;
+
+array:
+   if (callbacks->read_array_start &&
+         (rv = callbacks->read_array_start((uint32_t)tmp_len, data)) < 0)
+      return rv;
+
+   for (i = 0; i < tmp_len; i++)
+      if ((rv = rmsgpack_read_buf(buf, len, pos, callbacks, data)) < 0)
+         return rv;
+
+   return 0;
+}
+
+int rmsgpack_skip_buf(const uint8_t *buf, size_t len, size_t *pos)
+{
+   /* Values left to skip, maps count twice. */
+   uint64_t pending = 1;
+
+   while (pending--)
+   {
+      uint64_t tmp_len = 0;
+      uint8_t type;
+
+      if (*pos >= len)
+         return -EINVAL;
+
+      type = buf[(*pos)++];
+
+      if (type < MPF_FIXMAP || type > MPF_MAP32)
+         continue;
+      else if (type < MPF_FIXARRAY)
+      {
+         pending += (uint64_t)(type - MPF_FIXMAP) * 2;
+         continue;
+      }
+      else if (type < MPF_FIXSTR)
+      {
+         pending += type - MPF_FIXARRAY;
+         continue;
+      }
+      else if (type < MPF_NIL)
+         tmp_len = type - MPF_FIXSTR;
+      else
+      {
+         switch (type)
+         {
+            case _MPF_BIN8:
+            case _MPF_BIN16:
+            case _MPF_BIN32:
+               if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                        (size_t)(1 << (type - _MPF_BIN8))) < 0)
+                  return -EINVAL;
+               break;
+            case _MPF_STR8:
+            case _MPF_STR16:
+            case _MPF_STR32:
+               if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                        (size_t)(1 << (type - _MPF_STR8))) < 0)
+                  return -EINVAL;
+               break;
+            case _MPF_UINT8:
+            case _MPF_UINT16:
+            case _MPF_UINT32:
+            case _MPF_UINT64:
+               tmp_len = UINT64_C(1) << (type - _MPF_UINT8);
+               break;
+            case _MPF_INT8:
+            case _MPF_INT16:
+            case _MPF_INT32:
+            case _MPF_INT64:
+               tmp_len = UINT64_C(1) << (type - _MPF_INT8);
+               break;
+            case _MPF_ARRAY16:
+            case _MPF_ARRAY32:
+               if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                        2 << (type - _MPF_ARRAY16)) < 0)
+                  return -EINVAL;
+               pending += tmp_len;
+               continue;
+            case _MPF_MAP16:
+            case _MPF_MAP32:
+               if (rmsgpack_buf_read_uint(buf, len, pos, &tmp_len,
+                        2 << (type - _MPF_MAP16)) < 0)
+                  return -EINVAL;
+               pending += tmp_len * 2;
+               continue;
+            default:
+               continue;
+         }
+      }
+
+      if (len - *pos < tmp_len)
+         return -EINVAL;
+      *pos += (size_t)tmp_len;
+   }
+
+   return 0;
+}
@@ -172,8 +172,6 @@ bool cheat_manager_save(const char *path, const char *cheat_database, bool overw
    if (!conf)
       return false;
 
-   conf->guaranteed_no_duplicates = true;
-
    config_set_int(conf, "cheats", cheat_manager_state.size);
 
    for (i = 0; i < cheat_manager_state.size; i++)
@@ -30,6 +30,7 @@
 #include "../verbosity.h"
 
 #ifdef HAVE_RUNAHEAD
+#include "../runahead/run_ahead.h"
 #include "../runahead/secondary_core.h"
 #endif
 
@@ -136,6 +137,7 @@ void core_option_manager_get(core_option_manager_t *opt, void *data)
    if (opt->updated)
    {
       secondary_core_set_variable_update();
+      runahead_invalidate_prediction();
    }
 #endif
 
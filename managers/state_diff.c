@@ -0,0 +1,432 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <retro_inline.h>
+#include <compat/intrinsics.h>
+#include <libretro.h>
+
+#include "state_diff.h"
+
+#if !defined(CPU_X86) && (defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || defined(_M_X64) || defined(_M_IX86))
+#define CPU_X86
+#endif
+
+/* Other arches SIGBUS (usually) on unaligned accesses. */
+#if !defined(CPU_X86) && !defined(NO_UNALIGNED_MEM)
+#define NO_UNALIGNED_MEM
+#endif
+
+/* Kernels for instruction sets above the build baseline are compiled
+ * with per-function target attributes where the compiler allows it,
+ * and only selected if the CPU reports support at runtime. */
+#if defined(CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define STATE_DIFF_TARGET(x) __attribute__((target(x)))
+#define HAVE_STATE_DIFF_SSE2
+#define HAVE_STATE_DIFF_SSE41
+#define HAVE_STATE_DIFF_AVX2
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_X64) || defined(_M_IX86))
+#define STATE_DIFF_TARGET(x)
+#define HAVE_STATE_DIFF_SSE2
+#define HAVE_STATE_DIFF_SSE41
+#define HAVE_STATE_DIFF_AVX2
+#else
+#define STATE_DIFF_TARGET(x)
+#if defined(__SSE2__)
+#define HAVE_STATE_DIFF_SSE2
+#endif
+#if defined(__SSE4_1__)
+#define HAVE_STATE_DIFF_SSE41
+#endif
+#if defined(__AVX2__)
+#define HAVE_STATE_DIFF_AVX2
+#endif
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define HAVE_STATE_DIFF_NEON
+#endif
+
+#if defined(HAVE_STATE_DIFF_SSE2)
+#include <emmintrin.h>
+#endif
+#if defined(HAVE_STATE_DIFF_SSE41)
+#include <smmintrin.h>
+#endif
+#if defined(HAVE_STATE_DIFF_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(HAVE_STATE_DIFF_NEON)
+#include <arm_neon.h>
+#endif
+
+/* There's no equivalent in libc, you'd think so ...
+ * std::mismatch exists, but it's not optimized at all. */
+static size_t find_change_c(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef NO_UNALIGNED_MEM
+   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a == *b)
+#endif
+   {
+      const size_t *a_big = (const size_t*)a;
+      const size_t *b_big = (const size_t*)b;
+
+      while (*a_big == *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      while (*a == *b)
+      {
+         a++;
+         b++;
+      }
+   }
+   return a - a_org;
+}
+
+static size_t find_same_c(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef NO_UNALIGNED_MEM
+   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a != *b)
+#endif
+   {
+      /* With this, it's random whether two consecutive identical
+       * words are caught.
+       *
+       * Luckily, compression rate is the same for both cases, and
+       * three is always caught.
+       *
+       * (We prefer to miss two-word blocks, anyways; fewer iterations
+       * of the outer loop, as well as in the decompressor.) */
+      const uint32_t *a_big = (const uint32_t*)a;
+      const uint32_t *b_big = (const uint32_t*)b;
+
+      while (*a_big != *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      if (a != a_org && a[-1] == b[-1])
+      {
+         a--;
+         b--;
+      }
+   }
+   return a - a_org;
+}
+
+/* The vector kernels compare whole uint32_t pairs in find_same,
+ * just like the C version, and then step back over a single
+ * equal uint16_t so runs are split at the same places. */
+static INLINE size_t find_same_finish(const uint16_t *a,
+      const uint16_t *b, size_t ret)
+{
+   if (ret && a[ret - 1] == b[ret - 1])
+      ret--;
+   return ret;
+}
+
+#if defined(HAVE_STATE_DIFF_SSE2)
+STATE_DIFF_TARGET("sse2")
+static size_t find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask))) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+STATE_DIFF_TARGET("sse2")
+static size_t find_same_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask)
+         return find_same_finish(a, b,
+               (((uint8_t*)a128 - (uint8_t*)a) | compat_ctz(mask)) >> 1);
+
+      a128++;
+      b128++;
+   }
+}
+#endif
+
+#if defined(HAVE_STATE_DIFF_SSE41)
+/* PTEST lets us check 32 bytes per iteration without going
+ * through the integer unit; the movemask is only needed once
+ * something was found. */
+STATE_DIFF_TARGET("sse4.1")
+static size_t find_change_sse41(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i x0 = _mm_xor_si128(
+            _mm_loadu_si128(a128),     _mm_loadu_si128(b128));
+      __m128i x1 = _mm_xor_si128(
+            _mm_loadu_si128(a128 + 1), _mm_loadu_si128(b128 + 1));
+
+      if (!_mm_testz_si128(_mm_or_si128(x0, x1), _mm_or_si128(x0, x1)))
+      {
+         uint32_t mask;
+         size_t offset = (uint8_t*)a128 - (uint8_t*)a;
+
+         if (_mm_testz_si128(x0, x0))
+         {
+            x0      = x1;
+            offset += sizeof(__m128i);
+         }
+
+         mask = _mm_movemask_epi8(
+               _mm_cmpeq_epi16(x0, _mm_setzero_si128()));
+         return (offset | compat_ctz(~mask & 0xffff)) >> 1;
+      }
+
+      a128 += 2;
+      b128 += 2;
+   }
+}
+
+STATE_DIFF_TARGET("sse4.1")
+static size_t find_same_sse41(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i c0 = _mm_cmpeq_epi32(
+            _mm_loadu_si128(a128),     _mm_loadu_si128(b128));
+      __m128i c1 = _mm_cmpeq_epi32(
+            _mm_loadu_si128(a128 + 1), _mm_loadu_si128(b128 + 1));
+
+      if (!_mm_testz_si128(_mm_or_si128(c0, c1), _mm_or_si128(c0, c1)))
+      {
+         size_t offset = (uint8_t*)a128 - (uint8_t*)a;
+         uint32_t mask = _mm_movemask_epi8(c0);
+
+         if (!mask)
+         {
+            mask    = _mm_movemask_epi8(c1);
+            offset += sizeof(__m128i);
+         }
+
+         return find_same_finish(a, b, (offset | compat_ctz(mask)) >> 1);
+      }
+
+      a128 += 2;
+      b128 += 2;
+   }
+}
+#endif
+
+#if defined(HAVE_STATE_DIFF_AVX2)
+STATE_DIFF_TARGET("avx2")
+static size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i c     = _mm256_cmpeq_epi16(
+            _mm256_loadu_si256(a256), _mm256_loadu_si256(b256));
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffff)
+      {
+         uint32_t diff = ~mask;
+         size_t offset = (uint8_t*)a256 - (uint8_t*)a;
+
+         /* compat_ctz() may only look at the low 16 bits. */
+         if (!(diff & 0xffff))
+         {
+            diff  >>= 16;
+            offset += 16;
+         }
+
+         return (offset + compat_ctz(diff)) >> 1;
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+STATE_DIFF_TARGET("avx2")
+static size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i c     = _mm256_cmpeq_epi32(
+            _mm256_loadu_si256(a256), _mm256_loadu_si256(b256));
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask)
+      {
+         size_t offset = (uint8_t*)a256 - (uint8_t*)a;
+
+         if (!(mask & 0xffff))
+         {
+            mask  >>= 16;
+            offset += 16;
+         }
+
+         return find_same_finish(a, b, (offset + compat_ctz(mask)) >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+#endif
+
+#if defined(HAVE_STATE_DIFF_NEON)
+static INLINE unsigned find_ctz64(uint64_t x)
+{
+#if defined(__GNUC__)
+   return __builtin_ctzll(x);
+#else
+   unsigned ret = 0;
+   while (!(x & 1))
+   {
+      x >>= 1;
+      ret++;
+   }
+   return ret;
+#endif
+}
+
+/* NEON has no movemask; narrowing the compare result gives
+ * a 64-bit mask with one byte per uint16_t lane instead. */
+static size_t find_change_neon(const uint16_t *a, const uint16_t *b)
+{
+   size_t i = 0;
+
+   for (;; i += 8)
+   {
+      uint16x8_t c  = vceqq_u16(vld1q_u16(a + i), vld1q_u16(b + i));
+      uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(c, 4)), 0);
+
+      if (mask != UINT64_C(0xffffffffffffffff))
+         return i + (find_ctz64(~mask) >> 3);
+   }
+}
+
+static size_t find_same_neon(const uint16_t *a, const uint16_t *b)
+{
+   size_t i = 0;
+
+   for (;; i += 8)
+   {
+      uint32x4_t c  = vceqq_u32(
+            vreinterpretq_u32_u16(vld1q_u16(a + i)),
+            vreinterpretq_u32_u16(vld1q_u16(b + i)));
+      uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u16(vmovn_u32(c)), 0);
+
+      if (mask)
+         return find_same_finish(a, b, i + (find_ctz64(mask) >> 3));
+   }
+}
+#endif
+
+static const state_diff_kernel_t state_diff_kernels[] = {
+#if defined(HAVE_STATE_DIFF_AVX2)
+   { "avx2",   RETRO_SIMD_AVX2, find_change_avx2,  find_same_avx2  },
+#endif
+#if defined(HAVE_STATE_DIFF_SSE41)
+   { "sse4.1", RETRO_SIMD_SSE4, find_change_sse41, find_same_sse41 },
+#endif
+#if defined(HAVE_STATE_DIFF_SSE2)
+   { "sse2",   RETRO_SIMD_SSE2, find_change_sse2,  find_same_sse2  },
+#endif
+#if defined(HAVE_STATE_DIFF_NEON)
+   { "neon",   RETRO_SIMD_NEON, find_change_neon,  find_same_neon  },
+#endif
+   { "c",      0,               find_change_c,     find_same_c     },
+};
+
+const state_diff_kernel_t *state_diff_get_kernels(unsigned *count)
+{
+   if (count)
+      *count = sizeof(state_diff_kernels) / sizeof(state_diff_kernels[0]);
+   return state_diff_kernels;
+}
+
+const state_diff_kernel_t *state_diff_get_kernel(uint64_t simd)
+{
+   unsigned i;
+   unsigned count = sizeof(state_diff_kernels) / sizeof(state_diff_kernels[0]);
+
+   for (i = 0; i < count; i++)
+      if ((simd & state_diff_kernels[i].simd) == state_diff_kernels[i].simd)
+         return &state_diff_kernels[i];
+
+   return &state_diff_kernels[count - 1];
+}
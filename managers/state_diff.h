@@ -0,0 +1,75 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STATE_DIFF_H
+#define __STATE_DIFF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Scans used by the rewind delta compressor.
+ *
+ * Both scans work in units of uint16_t and never check bounds;
+ * the caller must terminate the buffers:
+ *
+ * - find_change: 'a' and 'b' must differ somewhere after the start.
+ * - find_same:   'a' and 'b' must contain three consecutive equal
+ *                uint16_t somewhere after the start.
+ *
+ * Vector kernels may read up to STATE_DIFF_PADDING bytes past
+ * the terminating element. */
+#define STATE_DIFF_PADDING 32
+
+typedef size_t (*state_diff_scan_t)(const uint16_t *a, const uint16_t *b);
+
+typedef struct state_diff_kernel
+{
+   const char *ident;
+   /* RETRO_SIMD_* bits the CPU must report for this kernel. */
+   uint64_t simd;
+   /* Returns the index of the first differing uint16_t. */
+   state_diff_scan_t find_change;
+   /* Returns the length of the run of changed data, ending at
+    * the first pair of equal uint16_t. */
+   state_diff_scan_t find_same;
+} state_diff_kernel_t;
+
+/**
+ * state_diff_get_kernels:
+ * @count                : number of kernels compiled in.
+ *
+ * Returns: all kernels compiled into this build, fastest first.
+ * The last one is always the portable C kernel.
+ **/
+const state_diff_kernel_t *state_diff_get_kernels(unsigned *count);
+
+/**
+ * state_diff_get_kernel:
+ * @simd                 : RETRO_SIMD_* mask, usually cpu_features_get().
+ *
+ * Returns: the fastest kernel supported by @simd.
+ **/
+const state_diff_kernel_t *state_diff_get_kernel(uint64_t simd);
+
+RETRO_END_DECLS
+
+#endif
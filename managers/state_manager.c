@@ -25,9 +25,14 @@
 
 #include <retro_inline.h>
 #include <compat/strl.h>
-#include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "state_manager.h"
+#include "state_diff.h"
 #include "../msg_hash.h"
 #include "../movie.h"
 #include "../core.h"
@@ -50,116 +55,6 @@
 #define UINT32_MAX 0xffffffffu
 #endif
 
-#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
-#define CPU_X86
-#endif
-
-/* Other arches SIGBUS (usually) on unaligned accesses. */
-#ifndef CPU_X86
-#define NO_UNALIGNED_MEM
-#endif
-
-#if __SSE2__
-#include <emmintrin.h>
-#endif
-
-/* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
-{
-#if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-
-   for (;;)
-   {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi32(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
-
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask))) >> 1;
-         return ret | (a[ret] == b[ret]);
-      }
-
-      a128++;
-      b128++;
-   }
-#else
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a == *b)
-#endif
-   {
-      const size_t *a_big = (const size_t*)a;
-      const size_t *b_big = (const size_t*)b;
-
-      while (*a_big == *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
-
-      while (*a == *b)
-      {
-         a++;
-         b++;
-      }
-   }
-   return a - a_org;
-#endif
-}
-
-static size_t find_same(const uint16_t *a, const uint16_t *b)
-{
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a != *b)
-#endif
-   {
-      /* With this, it's random whether two consecutive identical
-       * words are caught.
-       *
-       * Luckily, compression rate is the same for both cases, and
-       * three is always caught.
-       *
-       * (We prefer to miss two-word blocks, anyways; fewer iterations
-       * of the outer loop, as well as in the decompressor.) */
-      const uint32_t *a_big = (const uint32_t*)a;
-      const uint32_t *b_big = (const uint32_t*)b;
-
-      while (*a_big != *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
-
-      if (a != a_org && a[-1] == b[-1])
-      {
-         a--;
-         b--;
-      }
-   }
-   return a - a_org;
-}
-
 struct state_manager
 {
    uint8_t *data;
@@ -180,6 +75,9 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* SIMD scans picked for this CPU. */
+   const state_diff_kernel_t *diff;
+
    unsigned entries;
    bool thisblock_valid;
 #if STRICT_BUF_SIZE
@@ -208,11 +106,18 @@ repeat {
 size thisstart;
 #endif
 
+typedef struct state_block_manager state_block_manager_t;
+
 struct state_manager_rewind_state
 {
    /* Rewind support. */
    state_manager_t *state;
+   /* Used instead of 'state' when block deduplication is enabled. */
+   state_block_manager_t *block;
    size_t size;
+   uint64_t pushes;
+   retro_time_t push_time_total;
+   retro_time_t push_time_max;
 };
 
 static struct state_manager_rewind_state rewind_state;
@@ -239,7 +144,8 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(
+         len16 + sizeof(uint16_t) * 4 + STATE_DIFF_PADDING, 1);
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -250,8 +156,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * The vector scans need it to stay in bounds, and sacrificing
+    * a few bytes to get Valgrind happy is worth it anyway. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
@@ -265,8 +171,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
  * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
  * Returns the number of bytes actually written to 'patch'.
  */
-static size_t state_manager_raw_compress(const void *src,
-      const void *dst, size_t len, void *patch)
+static size_t state_manager_raw_compress(const state_diff_kernel_t *diff,
+      const void *src, const void *dst, size_t len, void *patch)
 {
    const uint16_t  *old16 = (const uint16_t*)src;
    const uint16_t  *new16 = (const uint16_t*)dst;
@@ -277,7 +183,7 @@ static size_t state_manager_raw_compress(const void *src,
    while (num16s)
    {
       size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      size_t skip = diff->find_change(old16, new16);
 
       if (skip >= num16s)
          break;
@@ -301,7 +207,7 @@ static size_t state_manager_raw_compress(const void *src,
          continue;
       }
 
-      changed = find_same(old16, new16);
+      changed = diff->find_same(old16, new16);
       if (changed > UINT16_MAX)
          changed = UINT16_MAX;
 
@@ -459,6 +365,7 @@ static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
 
    state->blocksize   = block_size;
    state->maxcompsize = max_comp_size;
+   state->diff        = state_diff_get_kernel(cpu_features_get());
    state->data        = state_data;
    state->thisblock   = this_block;
    state->nextblock   = next_block;
@@ -572,7 +479,7 @@ recheckcapacity:;
       newb        = state->nextblock;
       compressed  = state->head + sizeof(size_t);
 
-      compressed += state_manager_raw_compress(oldb, newb,
+      compressed += state_manager_raw_compress(state->diff, oldb, newb,
             state->blocksize, compressed);
 
       if (compressed - state->data + state->maxcompsize > state->capacity)
@@ -596,7 +503,6 @@ recheckcapacity:;
    state->entries++;
 }
 
-#if 0
 static void state_manager_capacity(state_manager_t *state,
       unsigned *entries, size_t *bytes, bool *full)
 {
@@ -612,15 +518,582 @@ static void state_manager_capacity(state_manager_t *state,
    if (full)
       *full = remaining <= state->maxcompsize * 2;
 }
+
+/* Block-level deduplicating rewind backend.
+ *
+ * Every pushed state is cut into fixed-size blocks. Each block is
+ * stored once in a content-addressed pool and shared (refcounted)
+ * between all frames containing identical data, so a frame costs one
+ * pointer per block plus whatever actually changed.
+ *
+ * The frame loop only serializes into a staging buffer; splitting,
+ * hashing and deduplication happen on a worker thread. */
+
+/* Must be a multiple of sizeof(uint64_t). */
+#define STATE_BLOCK_SIZE        4096
+/* Number of staging buffers the frame loop can run ahead of the worker. */
+#define STATE_BLOCK_QUEUE_SIZE  4
+
+struct state_block
+{
+   /* Hash chain while in use, free list otherwise. */
+   struct state_block *next;
+   uint64_t hash;
+   unsigned refcount;
+};
+
+#define STATE_BLOCK_DATA(blk) ((uint8_t*)((blk) + 1))
+#define STATE_BLOCK_ALLOC_SIZE (sizeof(struct state_block) + STATE_BLOCK_SIZE)
+
+struct state_block_manager
+{
+   struct state_block **buckets;
+   size_t bucket_mask;
+
+   struct state_block *free_blocks;
+   size_t free_count;
+
+   /* Ring of frames, oldest first. Every frame is an array
+    * of 'num_blocks' block pointers. */
+   struct state_block ***frames;
+   size_t frame_first;
+   size_t frame_count;
+   size_t frame_capacity;
+
+   size_t state_size;
+   size_t num_blocks;
+   size_t capacity;
+   size_t used_blocks;
+
+   /* Last state returned by state_block_pop(). */
+   uint8_t *popbuf;
+
+   uint8_t *staging[STATE_BLOCK_QUEUE_SIZE];
+   unsigned staging_write;
+   unsigned staging_read;
+   unsigned staging_count;
+   retro_time_t process_time_total;
+   retro_time_t process_time_max;
+   uint64_t blocks_processed;
+   uint64_t blocks_shared;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool quit;
+#endif
+};
+
+static INLINE uint64_t state_block_hash(const uint8_t *data)
+{
+   size_t i;
+   const uint64_t *data64 = (const uint64_t*)data;
+   uint64_t h             = UINT64_C(0xcbf29ce484222325);
+
+   for (i = 0; i < STATE_BLOCK_SIZE / sizeof(uint64_t); i++)
+   {
+      h ^= data64[i];
+      h *= UINT64_C(0x100000001b3);
+      h ^= h >> 29;
+   }
+
+   return h;
+}
+
+static size_t state_block_used_bytes(const state_block_manager_t *mgr)
+{
+   return mgr->used_blocks * STATE_BLOCK_ALLOC_SIZE +
+      mgr->frame_count * mgr->num_blocks * sizeof(struct state_block*);
+}
+
+static void state_block_release(state_block_manager_t *mgr,
+      struct state_block *blk)
+{
+   struct state_block **link = NULL;
+
+   if (--blk->refcount)
+      return;
+
+   link = &mgr->buckets[blk->hash & mgr->bucket_mask];
+   while (*link != blk)
+      link = &(*link)->next;
+   *link = blk->next;
+
+   mgr->used_blocks--;
+
+   /* Keep about one state worth of blocks around for reuse. */
+   if (mgr->free_count < mgr->num_blocks)
+   {
+      blk->next         = mgr->free_blocks;
+      mgr->free_blocks  = blk;
+      mgr->free_count++;
+   }
+   else
+      free(blk);
+}
+
+static struct state_block *state_block_intern(
+      state_block_manager_t *mgr, const uint8_t *data)
+{
+   uint64_t hash            = state_block_hash(data);
+   struct state_block **bkt = &mgr->buckets[hash & mgr->bucket_mask];
+   struct state_block *blk  = *bkt;
+
+   for (; blk; blk = blk->next)
+   {
+      if (blk->hash == hash &&
+            !memcmp(STATE_BLOCK_DATA(blk), data, STATE_BLOCK_SIZE))
+      {
+         blk->refcount++;
+         mgr->blocks_shared++;
+         return blk;
+      }
+   }
+
+   if (mgr->free_blocks)
+   {
+      blk              = mgr->free_blocks;
+      mgr->free_blocks = blk->next;
+      mgr->free_count--;
+   }
+   else if (!(blk = (struct state_block*)malloc(STATE_BLOCK_ALLOC_SIZE)))
+      return NULL;
+
+   memcpy(STATE_BLOCK_DATA(blk), data, STATE_BLOCK_SIZE);
+   blk->hash     = hash;
+   blk->refcount = 1;
+   blk->next     = *bkt;
+   *bkt          = blk;
+
+   mgr->used_blocks++;
+   return blk;
+}
+
+static void state_block_drop_frame(state_block_manager_t *mgr,
+      struct state_block **frame)
+{
+   size_t i;
+   for (i = 0; i < mgr->num_blocks; i++)
+      state_block_release(mgr, frame[i]);
+   free(frame);
+}
+
+static void state_block_drop_oldest(state_block_manager_t *mgr)
+{
+   struct state_block **frame = mgr->frames[mgr->frame_first];
+
+   mgr->frames[mgr->frame_first] = NULL;
+   mgr->frame_first = (mgr->frame_first + 1) % mgr->frame_capacity;
+   mgr->frame_count--;
+
+   state_block_drop_frame(mgr, frame);
+}
+
+static struct state_block **state_block_newest(state_block_manager_t *mgr)
+{
+   if (!mgr->frame_count)
+      return NULL;
+   return mgr->frames[(mgr->frame_first + mgr->frame_count - 1)
+      % mgr->frame_capacity];
+}
+
+static bool state_block_append(state_block_manager_t *mgr,
+      struct state_block **frame)
+{
+   if (mgr->frame_count == mgr->frame_capacity)
+   {
+      size_t i;
+      size_t new_capacity          = mgr->frame_capacity * 2;
+      struct state_block ***frames = (struct state_block***)
+         calloc(new_capacity, sizeof(*frames));
+
+      if (!frames)
+         return false;
+
+      for (i = 0; i < mgr->frame_count; i++)
+         frames[i] = mgr->frames[(mgr->frame_first + i)
+            % mgr->frame_capacity];
+
+      free(mgr->frames);
+      mgr->frames         = frames;
+      mgr->frame_first    = 0;
+      mgr->frame_capacity = new_capacity;
+   }
+
+   mgr->frames[(mgr->frame_first + mgr->frame_count)
+      % mgr->frame_capacity] = frame;
+   mgr->frame_count++;
+   return true;
+}
+
+/* Turns one staged state into a frame of shared blocks.
+ * Runs on the worker thread when threads are available. */
+static void state_block_process(state_block_manager_t *mgr,
+      const uint8_t *data)
+{
+   size_t i;
+   retro_time_t start             = cpu_features_get_time_usec();
+   struct state_block **prev      = state_block_newest(mgr);
+   struct state_block **frame     = (struct state_block**)
+      malloc(mgr->num_blocks * sizeof(*frame));
+
+   if (!frame)
+      return;
+
+   for (i = 0; i < mgr->num_blocks; i++)
+   {
+      const uint8_t *src = data + i * STATE_BLOCK_SIZE;
+
+      /* Most blocks are unchanged since the previous frame. */
+      if (prev && !memcmp(STATE_BLOCK_DATA(prev[i]), src, STATE_BLOCK_SIZE))
+      {
+         frame[i] = prev[i];
+         frame[i]->refcount++;
+         mgr->blocks_shared++;
+         continue;
+      }
+
+      if (!(frame[i] = state_block_intern(mgr, src)))
+      {
+         while (i--)
+            state_block_release(mgr, frame[i]);
+         free(frame);
+         return;
+      }
+   }
+
+   mgr->blocks_processed += mgr->num_blocks;
+
+   if (!state_block_append(mgr, frame))
+   {
+      state_block_drop_frame(mgr, frame);
+      return;
+   }
+
+   /* Always keep the newest frame, even if it alone exceeds capacity. */
+   while (mgr->frame_count > 1 && state_block_used_bytes(mgr) > mgr->capacity)
+      state_block_drop_oldest(mgr);
+
+   start = cpu_features_get_time_usec() - start;
+   mgr->process_time_total += start;
+   if (start > mgr->process_time_max)
+      mgr->process_time_max = start;
+}
+
+#ifdef HAVE_THREADS
+static void state_block_thread(void *data)
+{
+   state_block_manager_t *mgr = (state_block_manager_t*)data;
+
+   slock_lock(mgr->lock);
+
+   for (;;)
+   {
+      const uint8_t *staged = NULL;
+
+      while (!mgr->staging_count && !mgr->quit)
+         scond_wait(mgr->cond, mgr->lock);
+
+      if (!mgr->staging_count)
+         break;
+
+      staged = mgr->staging[mgr->staging_read];
+
+      /* The frame loop never touches the block pool while a
+       * staged state is pending, so this can run unlocked. */
+      slock_unlock(mgr->lock);
+      state_block_process(mgr, staged);
+      slock_lock(mgr->lock);
+
+      mgr->staging_read = (mgr->staging_read + 1) % STATE_BLOCK_QUEUE_SIZE;
+      mgr->staging_count--;
+      scond_broadcast(mgr->cond);
+   }
+
+   slock_unlock(mgr->lock);
+}
+#endif
+
+/* Waits until the worker has processed every staged state. */
+static void state_block_flush(state_block_manager_t *mgr)
+{
+#ifdef HAVE_THREADS
+   if (mgr->thread)
+   {
+      slock_lock(mgr->lock);
+      while (mgr->staging_count)
+         scond_wait(mgr->cond, mgr->lock);
+      slock_unlock(mgr->lock);
+   }
+#endif
+}
+
+static void state_block_free(state_block_manager_t *mgr)
+{
+   unsigned i;
+
+   if (!mgr)
+      return;
+
+#ifdef HAVE_THREADS
+   if (mgr->thread)
+   {
+      slock_lock(mgr->lock);
+      mgr->quit = true;
+      scond_broadcast(mgr->cond);
+      slock_unlock(mgr->lock);
+      sthread_join(mgr->thread);
+   }
+   if (mgr->lock)
+      slock_free(mgr->lock);
+   if (mgr->cond)
+      scond_free(mgr->cond);
 #endif
 
-void state_manager_event_init(unsigned rewind_buffer_size)
+   while (mgr->frame_count)
+      state_block_drop_oldest(mgr);
+
+   while (mgr->free_blocks)
+   {
+      struct state_block *next = mgr->free_blocks->next;
+      free(mgr->free_blocks);
+      mgr->free_blocks = next;
+   }
+
+   for (i = 0; i < STATE_BLOCK_QUEUE_SIZE; i++)
+      free(mgr->staging[i]);
+
+   free(mgr->popbuf);
+   free(mgr->frames);
+   free(mgr->buckets);
+   free(mgr);
+}
+
+static state_block_manager_t *state_block_new(size_t state_size,
+      size_t buffer_size)
+{
+   unsigned i;
+   size_t padded_size;
+   size_t num_buckets         = 1024;
+   state_block_manager_t *mgr = (state_block_manager_t*)
+      calloc(1, sizeof(*mgr));
+
+   if (!mgr)
+      return NULL;
+
+   mgr->state_size     = state_size;
+   mgr->num_blocks     = (state_size + STATE_BLOCK_SIZE - 1)
+      / STATE_BLOCK_SIZE;
+   mgr->capacity       = buffer_size;
+   padded_size         = mgr->num_blocks * STATE_BLOCK_SIZE;
+
+   while (num_buckets < buffer_size / STATE_BLOCK_SIZE)
+      num_buckets <<= 1;
+
+   mgr->bucket_mask    = num_buckets - 1;
+   mgr->buckets        = (struct state_block**)
+      calloc(num_buckets, sizeof(*mgr->buckets));
+   mgr->frame_capacity = 64;
+   mgr->frames         = (struct state_block***)
+      calloc(mgr->frame_capacity, sizeof(*mgr->frames));
+   mgr->popbuf         = (uint8_t*)calloc(1, padded_size);
+
+   if (!mgr->buckets || !mgr->frames || !mgr->popbuf)
+      goto error;
+
+   /* The tail padding of the last block stays zeroed, so partial
+    * blocks compare and hash consistently. */
+   for (i = 0; i < STATE_BLOCK_QUEUE_SIZE; i++)
+      if (!(mgr->staging[i] = (uint8_t*)calloc(1, padded_size)))
+         goto error;
+
+#ifdef HAVE_THREADS
+   mgr->lock   = slock_new();
+   mgr->cond   = scond_new();
+
+   if (!mgr->lock || !mgr->cond)
+      goto error;
+
+   mgr->thread = sthread_create(state_block_thread, mgr);
+#endif
+
+   return mgr;
+
+error:
+   state_block_free(mgr);
+   return NULL;
+}
+
+static bool state_block_pop(state_block_manager_t *mgr, const void **data)
+{
+   size_t i;
+   struct state_block **frame = NULL;
+
+   state_block_flush(mgr);
+
+   *data = mgr->popbuf;
+
+   if (!(frame = state_block_newest(mgr)))
+      return false;
+
+   for (i = 0; i < mgr->num_blocks; i++)
+      memcpy(mgr->popbuf + i * STATE_BLOCK_SIZE,
+            STATE_BLOCK_DATA(frame[i]), STATE_BLOCK_SIZE);
+
+   /* Like the delta backend, the oldest state is never discarded. */
+   if (mgr->frame_count == 1)
+      return false;
+
+   mgr->frame_count--;
+   mgr->frames[(mgr->frame_first + mgr->frame_count)
+      % mgr->frame_capacity] = NULL;
+   state_block_drop_frame(mgr, frame);
+   return true;
+}
+
+static void state_block_push_where(state_block_manager_t *mgr, void **data)
+{
+#ifdef HAVE_THREADS
+   if (mgr->thread)
+   {
+      /* Only blocks if the worker is several frames behind. */
+      slock_lock(mgr->lock);
+      while (mgr->staging_count == STATE_BLOCK_QUEUE_SIZE)
+         scond_wait(mgr->cond, mgr->lock);
+      slock_unlock(mgr->lock);
+   }
+#endif
+
+   *data = mgr->staging[mgr->staging_write];
+}
+
+static void state_block_push_do(state_block_manager_t *mgr)
+{
+#ifdef HAVE_THREADS
+   if (mgr->thread)
+   {
+      slock_lock(mgr->lock);
+      mgr->staging_write = (mgr->staging_write + 1) % STATE_BLOCK_QUEUE_SIZE;
+      mgr->staging_count++;
+      scond_signal(mgr->cond);
+      slock_unlock(mgr->lock);
+      return;
+   }
+#endif
+
+   state_block_process(mgr, mgr->staging[mgr->staging_write]);
+}
+
+
+static bool state_manager_rewind_pop(const void **data)
+{
+   if (rewind_state.block)
+      return state_block_pop(rewind_state.block, data);
+   return state_manager_pop(rewind_state.state, data);
+}
+
+static void state_manager_rewind_push(void)
 {
    retro_ctx_serialize_info_t serial_info;
+   void *state        = NULL;
+   retro_time_t start = cpu_features_get_time_usec();
+
+   if (rewind_state.block)
+      state_block_push_where(rewind_state.block, &state);
+   else
+      state_manager_push_where(rewind_state.state, &state);
+
+   serial_info.data = state;
+   serial_info.size = rewind_state.size;
+
+   core_serialize(&serial_info);
+
+   if (rewind_state.block)
+      state_block_push_do(rewind_state.block);
+   else
+      state_manager_push_do(rewind_state.state);
+
+   start = cpu_features_get_time_usec() - start;
+
+   rewind_state.pushes++;
+   rewind_state.push_time_total += start;
+   if (start > rewind_state.push_time_max)
+      rewind_state.push_time_max = start;
+}
+
+/**
+ * state_manager_get_stats:
+ * @stats                : statistics of the rewind buffer.
+ *
+ * Returns: true if rewind is initialized and @stats was filled in.
+ **/
+bool state_manager_get_stats(state_manager_stats_t *stats)
+{
+   if (!stats || (!rewind_state.state && !rewind_state.block))
+      return false;
+
+   memset(stats, 0, sizeof(*stats));
+
+   stats->state_size      = rewind_state.size;
+   stats->pushes          = rewind_state.pushes;
+   stats->push_time_total = rewind_state.push_time_total;
+   stats->push_time_max   = rewind_state.push_time_max;
+
+   if (rewind_state.block)
+   {
+      state_block_manager_t *mgr = rewind_state.block;
+
+      state_block_flush(mgr);
+
+      stats->block_dedup        = true;
+      stats->frames             = (unsigned)mgr->frame_count;
+      stats->bytes_used         = state_block_used_bytes(mgr);
+      stats->capacity           = mgr->capacity;
+      stats->process_time_total = mgr->process_time_total;
+      stats->process_time_max   = mgr->process_time_max;
+      stats->blocks_processed   = mgr->blocks_processed;
+      stats->blocks_shared      = mgr->blocks_shared;
+   }
+   else
+   {
+      state_manager_capacity(rewind_state.state,
+            &stats->frames, &stats->bytes_used, NULL);
+      stats->capacity = rewind_state.state->capacity;
+   }
+
+   return true;
+}
+
+static void state_manager_log_stats(void)
+{
+   state_manager_stats_t stats;
+
+   if (!state_manager_get_stats(&stats) || !stats.pushes)
+      return;
+
+   RARCH_LOG("[Rewind]: %u frames in %.2f MB (%.1f frames/MB), "
+         "push avg %.3f ms, max %.3f ms.\n",
+         stats.frames,
+         stats.bytes_used / (1024.0 * 1024.0),
+         stats.bytes_used
+         ? stats.frames / (stats.bytes_used / (1024.0 * 1024.0)) : 0.0,
+         stats.push_time_total / (1000.0 * stats.pushes),
+         stats.push_time_max / 1000.0);
+
+   if (stats.block_dedup && stats.blocks_processed)
+      RARCH_LOG("[Rewind]: %.1f%% of blocks shared, "
+            "background avg %.3f ms, max %.3f ms.\n",
+            100.0 * stats.blocks_shared / stats.blocks_processed,
+            stats.process_time_total / (1000.0 * stats.pushes),
+            stats.process_time_max / 1000.0);
+}
+
+void state_manager_event_init(unsigned rewind_buffer_size,
+      bool block_dedup)
+{
    retro_ctx_size_info_t info;
-   void *state          = NULL;
 
-   if (rewind_state.state)
+   if (rewind_state.state || rewind_state.block)
       return;
 
    if (audio_driver_has_callback())
@@ -644,20 +1117,24 @@ void state_manager_event_init(unsigned rewind_buffer_size)
          msg_hash_to_str(MSG_REWIND_INIT),
          (unsigned)(rewind_buffer_size / 1000000));
 
-   rewind_state.state = state_manager_new(rewind_state.size,
-         rewind_buffer_size);
+   if (block_dedup)
+      rewind_state.block = state_block_new(rewind_state.size,
+            rewind_buffer_size);
+   else
+      rewind_state.state = state_manager_new(rewind_state.size,
+            rewind_buffer_size);
 
-   if (!rewind_state.state)
+   if (!rewind_state.state && !rewind_state.block)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      return;
+   }
 
-   state_manager_push_where(rewind_state.state, &state);
-
-   serial_info.data = state;
-   serial_info.size = rewind_state.size;
-
-   core_serialize(&serial_info);
+   rewind_state.pushes          = 0;
+   rewind_state.push_time_total = 0;
+   rewind_state.push_time_max   = 0;
 
-   state_manager_push_do(rewind_state.state);
+   state_manager_rewind_push();
 }
 
 
@@ -668,12 +1145,16 @@ bool state_manager_frame_is_reversed(void)
 
 void state_manager_event_deinit(void)
 {
+   state_manager_log_stats();
+
    if (rewind_state.state)
    {
       state_manager_free(rewind_state.state);
       free(rewind_state.state);
    }
+   state_block_free(rewind_state.block);
    rewind_state.state = NULL;
+   rewind_state.block = NULL;
    rewind_state.size  = 0;
 }
 
@@ -708,14 +1189,14 @@ bool state_manager_check_rewind(bool pressed,
       return false;
    }
 
-   if (!rewind_state.state)
+   if (!rewind_state.state && !rewind_state.block)
       return false;
 
    if (pressed)
    {
       const void *buf    = NULL;
 
-      if (state_manager_pop(rewind_state.state, &buf))
+      if (state_manager_rewind_pop(&buf))
       {
          retro_ctx_serialize_info_t serial_info;
 
@@ -777,19 +1258,7 @@ bool state_manager_check_rewind(bool pressed,
             rewind_granularity : 1); /* Avoid possible SIGFPE. */
 
       if ((cnt == 0) || bsv_movie_ctl(BSV_MOVIE_CTL_IS_INITED, NULL))
-      {
-         retro_ctx_serialize_info_t serial_info;
-         void *state = NULL;
-
-         state_manager_push_where(rewind_state.state, &state);
-
-         serial_info.data = state;
-         serial_info.size = rewind_state.size;
-
-         core_serialize(&serial_info);
-
-         state_manager_push_do(rewind_state.state);
-      }
+         state_manager_rewind_push();
    }
 
    core_set_rewind_callbacks();
@@ -23,16 +23,38 @@
 
 #include <boolean.h>
 #include <retro_common_api.h>
+#include <libretro.h>
 
 RETRO_BEGIN_DECLS
 
 typedef struct state_manager state_manager_t;
 
+typedef struct state_manager_stats
+{
+   bool block_dedup;
+   unsigned frames;
+   size_t state_size;
+   size_t bytes_used;
+   size_t capacity;
+   uint64_t pushes;
+   /* Time spent in the frame loop per push, in usec. */
+   retro_time_t push_time_total;
+   retro_time_t push_time_max;
+   /* Block backend only: time spent on the worker per push, in usec. */
+   retro_time_t process_time_total;
+   retro_time_t process_time_max;
+   uint64_t blocks_processed;
+   uint64_t blocks_shared;
+} state_manager_stats_t;
+
 bool state_manager_frame_is_reversed(void);
 
 void state_manager_event_deinit(void);
 
-void state_manager_event_init(unsigned rewind_buffer_size);
+void state_manager_event_init(unsigned rewind_buffer_size,
+      bool block_dedup);
+
+bool state_manager_get_stats(state_manager_stats_t *stats);
 
 /**
  * check_rewind:
@@ -35,6 +35,7 @@
 #include "../menu_cbs.h"
 #include "../menu_setting.h"
 #include "../menu_shader.h"
+#include "../menu_thumbnail_cache.h"
 #include "../widgets/menu_dialog.h"
 #include "../widgets/menu_entry.h"
 #include "../widgets/menu_filebrowser.h"
@@ -2011,7 +2012,9 @@ static int action_ok_menu_wallpaper_load(const char *path,
 
    filebrowser_clear_type();
 
-   settings->uints.menu_xmb_shader_pipeline = XMB_SHADER_PIPELINE_WALLPAPER;
+   configuration_set_uint(settings,
+         settings->uints.menu_xmb_shader_pipeline,
+         XMB_SHADER_PIPELINE_WALLPAPER);
    return generic_action_ok(path, label, type, idx, entry_idx,
          ACTION_OK_LOAD_WALLPAPER, MSG_UNKNOWN);
 }
@@ -3087,6 +3090,9 @@ static void cb_decompressed(void *task_data, void *user_data, const char *err)
          case CB_UPDATE_ASSETS:
             generic_action_ok_command(CMD_EVENT_REINIT);
             break;
+         case CB_CORE_THUMBNAILS_DOWNLOAD:
+            menu_thumbnail_cache_forget_failed();
+            break;
       }
    }
 
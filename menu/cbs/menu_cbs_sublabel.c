@@ -158,6 +158,7 @@ default_sublabel_macro(action_bind_sublabel_input_bind_hold,               MENU_
 default_sublabel_macro(action_bind_sublabel_audio_volume,                  MENU_ENUM_SUBLABEL_AUDIO_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_mixer_volume,            MENU_ENUM_SUBLABEL_AUDIO_MIXER_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_sync,                    MENU_ENUM_SUBLABEL_AUDIO_SYNC)
+default_sublabel_macro(action_bind_sublabel_audio_pipeline_enable,         MENU_ENUM_SUBLABEL_AUDIO_PIPELINE_ENABLE)
 default_sublabel_macro(action_bind_sublabel_axis_threshold,                MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD)
 default_sublabel_macro(action_bind_sublabel_input_turbo_period,            MENU_ENUM_SUBLABEL_INPUT_TURBO_PERIOD)
 default_sublabel_macro(action_bind_sublabel_input_duty_cycle,              MENU_ENUM_SUBLABEL_INPUT_DUTY_CYCLE)
@@ -213,6 +214,7 @@ default_sublabel_macro(action_bind_sublabel_vrr_runloop_enable,            MENU_
 default_sublabel_macro(action_bind_sublabel_slowmotion_ratio,              MENU_ENUM_SUBLABEL_SLOWMOTION_RATIO)
 default_sublabel_macro(action_bind_sublabel_run_ahead_enabled,             MENU_ENUM_SUBLABEL_RUN_AHEAD_ENABLED)
 default_sublabel_macro(action_bind_sublabel_run_ahead_secondary_instance,  MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE)
+default_sublabel_macro(action_bind_sublabel_run_ahead_state_pool,          MENU_ENUM_SUBLABEL_RUN_AHEAD_STATE_POOL)
 default_sublabel_macro(action_bind_sublabel_run_ahead_hide_warnings,       MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS)
 default_sublabel_macro(action_bind_sublabel_run_ahead_frames,              MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES)
 default_sublabel_macro(action_bind_sublabel_rewind,                        MENU_ENUM_SUBLABEL_REWIND_ENABLE)
@@ -221,6 +223,7 @@ default_sublabel_macro(action_bind_sublabel_cheat_apply_after_load,        MENU_
 default_sublabel_macro(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
 default_sublabel_macro(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 default_sublabel_macro(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+default_sublabel_macro(action_bind_sublabel_rewind_block_dedup,             MENU_ENUM_SUBLABEL_REWIND_BLOCK_DEDUP)
 default_sublabel_macro(action_bind_sublabel_cheat_idx,                     MENU_ENUM_SUBLABEL_CHEAT_IDX)
 default_sublabel_macro(action_bind_sublabel_cheat_match_idx,               MENU_ENUM_SUBLABEL_CHEAT_MATCH_IDX)
 default_sublabel_macro(action_bind_sublabel_cheat_big_endian,              MENU_ENUM_SUBLABEL_CHEAT_BIG_ENDIAN)
@@ -295,6 +298,8 @@ default_sublabel_macro(action_bind_sublabel_mouse_enable,                  MENU_
 default_sublabel_macro(action_bind_sublabel_pointer_enable,                MENU_ENUM_SUBLABEL_POINTER_ENABLE)
 default_sublabel_macro(action_bind_sublabel_thumbnails,                    MENU_ENUM_SUBLABEL_THUMBNAILS)
 default_sublabel_macro(action_bind_sublabel_left_thumbnails,               MENU_ENUM_SUBLABEL_LEFT_THUMBNAILS)
+default_sublabel_macro(action_bind_sublabel_thumbnail_cache_size,          MENU_ENUM_SUBLABEL_THUMBNAIL_CACHE_SIZE)
+default_sublabel_macro(action_bind_sublabel_thumbnail_prefetch,            MENU_ENUM_SUBLABEL_THUMBNAIL_PREFETCH)
 default_sublabel_macro(action_bind_sublabel_timedate_enable,               MENU_ENUM_SUBLABEL_TIMEDATE_ENABLE)
 default_sublabel_macro(action_bind_sublabel_timedate_style,                MENU_ENUM_SUBLABEL_TIMEDATE_STYLE)
 default_sublabel_macro(action_bind_sublabel_battery_level_enable,          MENU_ENUM_SUBLABEL_BATTERY_LEVEL_ENABLE)
@@ -354,8 +359,10 @@ default_sublabel_macro(action_bind_sublabel_core_input_remapping_options,
 default_sublabel_macro(action_bind_sublabel_core_options,                          MENU_ENUM_SUBLABEL_CORE_OPTIONS)
 default_sublabel_macro(action_bind_sublabel_show_advanced_settings,                MENU_ENUM_SUBLABEL_SHOW_ADVANCED_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_threaded_data_runloop_enable,          MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_ENABLE)
+default_sublabel_macro(action_bind_sublabel_threaded_data_runloop_workers,         MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_WORKERS)
 default_sublabel_macro(action_bind_sublabel_playlist_entry_rename,                 MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_RENAME)
 default_sublabel_macro(action_bind_sublabel_playlist_entry_remove,                 MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_REMOVE)
+default_sublabel_macro(action_bind_sublabel_playlist_compact_format,               MENU_ENUM_SUBLABEL_PLAYLIST_COMPACT_FORMAT)
 default_sublabel_macro(action_bind_sublabel_system_directory,                      MENU_ENUM_SUBLABEL_SYSTEM_DIRECTORY)
 default_sublabel_macro(action_bind_sublabel_rgui_browser_directory,                MENU_ENUM_SUBLABEL_RGUI_BROWSER_DIRECTORY)
 default_sublabel_macro(action_bind_sublabel_content_dir,                           MENU_ENUM_SUBLABEL_CONTENT_DIR)
@@ -1147,9 +1154,15 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_PLAYLIST_ENTRY_REMOVE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_playlist_entry_remove);
             break;
+         case MENU_ENUM_LABEL_PLAYLIST_COMPACT_FORMAT:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_playlist_compact_format);
+            break;
          case MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_threaded_data_runloop_enable);
             break;
+         case MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_WORKERS:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_threaded_data_runloop_workers);
+            break;
          case MENU_ENUM_LABEL_SHOW_ADVANCED_SETTINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_show_advanced_settings);
             break;
@@ -1312,6 +1325,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_LEFT_THUMBNAILS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_left_thumbnails);
             break;
+         case MENU_ENUM_LABEL_THUMBNAIL_CACHE_SIZE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_thumbnail_cache_size);
+            break;
+         case MENU_ENUM_LABEL_THUMBNAIL_PREFETCH:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_thumbnail_prefetch);
+            break;
          case MENU_ENUM_LABEL_MOUSE_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_mouse_enable);
             break;
@@ -1471,6 +1490,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_BLOCK_DEDUP:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_block_dedup);
+            break;
          case MENU_ENUM_LABEL_CHEAT_IDX:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_idx);
             break;
@@ -1552,6 +1574,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_instance);
             break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_STATE_POOL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_state_pool);
+            break;
          case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_hide_warnings);
             break;
@@ -1714,6 +1739,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_sync);
             break;
+         case MENU_ENUM_LABEL_AUDIO_PIPELINE_ENABLE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_pipeline_enable);
+            break;
          case MENU_ENUM_LABEL_AUDIO_VOLUME:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_volume);
             break;
@@ -1615,8 +1615,10 @@ static void *ozone_init(void **userdata, bool video_is_threaded)
          setsysGetColorSetId(&theme);
          color_theme = (theme == ColorSetId_Dark) ? 1 : 0;
          ozone_set_color_theme(ozone, color_theme);
-         settings->uints.menu_ozone_color_theme = color_theme;
-         settings->bools.menu_preferred_system_color_theme_set = true;
+         configuration_set_uint(settings,
+               settings->uints.menu_ozone_color_theme, color_theme);
+         configuration_set_bool(settings,
+               settings->bools.menu_preferred_system_color_theme_set, true);
          setsysExit();
       }
       else
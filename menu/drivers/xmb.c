@@ -43,6 +43,7 @@
 
 #include "../menu_driver.h"
 #include "../menu_animation.h"
+#include "../menu_thumbnail_cache.h"
 #include "../menu_entries.h"
 #include "../menu_input.h"
 
@@ -297,6 +298,8 @@ typedef struct xmb_handle
    char *savestate_thumbnail_file_path;
    char *thumbnail_file_path;
    char *left_thumbnail_file_path;
+   char *thumbnail_wanted;
+   char *left_thumbnail_wanted;
    char *bg_file_path;
 
    file_list_t *selection_buf_old;
@@ -929,19 +932,82 @@ end:
    string_list_free(list);
 }
 
-static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
+/* Hides a thumbnail and forgets about the image that was going
+ * to replace it. */
+static void xmb_release_thumbnail(char **wanted, uintptr_t *texture)
+{
+   if (*wanted)
+      free(*wanted);
+   *wanted = NULL;
+
+   menu_thumbnail_cache_release(texture);
+}
+
+/* Swaps in the image that was asked for once the cache has it. */
+static void xmb_poll_thumbnail(char **wanted, uintptr_t *texture,
+      float max_width, float *height)
+{
+   unsigned width, tex_height;
+   uintptr_t new_texture = 0;
+
+   if (!*wanted)
+      return;
+
+   switch (menu_thumbnail_cache_acquire(*wanted, (unsigned)max_width, 0,
+            &new_texture, &width, &tex_height))
+   {
+      case MENU_THUMBNAIL_LOADING:
+         return;
+      case MENU_THUMBNAIL_NONE:
+         /* Dropped from the cache before it could be shown. */
+         menu_thumbnail_cache_request(*wanted, (unsigned)max_width, 0);
+         return;
+      case MENU_THUMBNAIL_READY:
+         menu_thumbnail_cache_release(texture);
+         *texture = new_texture;
+         *height  = max_width * (float)tex_height / (float)width;
+         break;
+      case MENU_THUMBNAIL_FAILED:
+         menu_thumbnail_cache_release(texture);
+         break;
+   }
+
+   free(*wanted);
+   *wanted = NULL;
+}
+
+/* Asks the cache for a thumbnail scaled down to the width it is
+ * drawn at. The current one stays on screen until the new one is
+ * loaded, a cached one is shown right away. */
+static void xmb_request_thumbnail(char **wanted, uintptr_t *texture,
+      const char *path, float max_width, float *height)
+{
+   if (*wanted)
+      free(*wanted);
+   *wanted = strdup(path);
+
+   menu_thumbnail_cache_request(path, (unsigned)max_width, 0);
+   xmb_poll_thumbnail(wanted, texture, max_width, height);
+}
+
+/* Builds the path of the thumbnail shown at 'pos' for entry i,
+ * 'content' being the name of the entry. Returns false when the
+ * thumbnail at 'pos' has to be hidden. */
+static bool xmb_get_thumbnail_path(xmb_handle_t *xmb, unsigned i,
+      char pos, const char *content, char *new_path, size_t len)
 {
    menu_entry_t entry;
    unsigned entry_type            = 0;
-   char new_path[PATH_MAX_LENGTH] = {0};
+   bool ret                       = true;
    settings_t     *settings       = config_get_ptr();
-   xmb_handle_t     *xmb          = (xmb_handle_t*)data;
    playlist_t     *playlist       = NULL;
    const char    *dir_thumbnails  = settings->paths.directory_thumbnails;
 
    menu_entry_init(&entry);
 
-   if (!xmb || string_is_empty(dir_thumbnails))
+   new_path[0]                    = '\0';
+
+   if (string_is_empty(dir_thumbnails))
       goto end;
 
    menu_entry_get(&entry, 0, i, NULL, true);
@@ -963,14 +1029,14 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
                   new_path,
                   node->fullpath,
                   entry.path,
-                  sizeof(new_path));
+                  len);
 
          goto end;
       }
    }
    else if (filebrowser_get_type() != FILEBROWSER_NONE)
    {
-      video_driver_texture_unload(&xmb->thumbnail);
+      ret = false;
       goto end;
    }
 
@@ -995,10 +1061,10 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
          {
             if (!string_is_empty(entry.label))
                strlcpy(new_path, entry.label,
-                     sizeof(new_path));
+                     len);
          }
          else
-            video_driver_texture_unload(&xmb->left_thumbnail);
+            ret = false;
          goto end;
       }
    }
@@ -1009,7 +1075,7 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
             new_path,
             dir_thumbnails,
             xmb->thumbnail_system,
-            sizeof(new_path));
+            len);
 
    if (!string_is_empty(new_path))
    {
@@ -1036,12 +1102,12 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
     * http://datomatic.no-intro.org/stuff/The%20Official%20No-Intro%20Convention%20(20071030).zip
     * Replace these characters in the entry name with underscores.
     */
-   if (!string_is_empty(xmb->thumbnail_content))
+   if (!string_is_empty(content))
    {
       char *scrub_char_pointer       = NULL;
       char            *tmp_new       = (char*)
          malloc(PATH_MAX_LENGTH * sizeof(char));
-      char            *tmp           = strdup(xmb->thumbnail_content);
+      char            *tmp           = strdup(content);
 
       tmp_new[0]                     = '\0';
 
@@ -1056,7 +1122,7 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
 
       if (!string_is_empty(tmp_new))
          strlcpy(new_path,
-               tmp_new, sizeof(new_path));
+               tmp_new, len);
 
       free(tmp_new);
       free(tmp);
@@ -1066,18 +1132,40 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
    if (!string_is_empty(new_path))
       strlcat(new_path,
             file_path_str(FILE_PATH_PNG_EXTENSION),
-            sizeof(new_path));
+            len);
 
 end:
-   if (xmb && !string_is_empty(new_path))
+   menu_entry_free(&entry);
+
+   return ret;
+}
+
+static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
+{
+   char new_path[PATH_MAX_LENGTH] = {0};
+   xmb_handle_t     *xmb          = (xmb_handle_t*)data;
+
+   if (!xmb)
+      return;
+
+   if (!xmb_get_thumbnail_path(xmb, i, pos, xmb->thumbnail_content,
+            new_path, sizeof(new_path)))
    {
       if (pos == 'R')
-         xmb->thumbnail_file_path = strdup(new_path);
+         xmb_release_thumbnail(&xmb->thumbnail_wanted, &xmb->thumbnail);
       if (pos == 'L')
-         xmb->left_thumbnail_file_path = strdup(new_path);
+         xmb_release_thumbnail(&xmb->left_thumbnail_wanted,
+               &xmb->left_thumbnail);
+      return;
    }
 
-   menu_entry_free(&entry);
+   if (string_is_empty(new_path))
+      return;
+
+   if (pos == 'R')
+      xmb->thumbnail_file_path = strdup(new_path);
+   if (pos == 'L')
+      xmb->left_thumbnail_file_path = strdup(new_path);
 }
 
 static void xmb_update_savestate_thumbnail_path(void *data, unsigned i)
@@ -1147,11 +1235,9 @@ static void xmb_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(xmb->thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->thumbnail_file_path))
-         task_push_image_load(xmb->thumbnail_file_path,
-               menu_display_handle_thumbnail_upload, NULL);
-      else
-         video_driver_texture_unload(&xmb->thumbnail);
+      xmb_request_thumbnail(&xmb->thumbnail_wanted, &xmb->thumbnail,
+            xmb->thumbnail_file_path, xmb->thumbnail_width,
+            &xmb->thumbnail_height);
 
       free(xmb->thumbnail_file_path);
       xmb->thumbnail_file_path = NULL;
@@ -1159,17 +1245,60 @@ static void xmb_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(xmb->left_thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->left_thumbnail_file_path))
-         task_push_image_load(xmb->left_thumbnail_file_path,
-               menu_display_handle_left_thumbnail_upload, NULL);
-      else
-         video_driver_texture_unload(&xmb->left_thumbnail);
+      xmb_request_thumbnail(&xmb->left_thumbnail_wanted,
+            &xmb->left_thumbnail, xmb->left_thumbnail_file_path,
+            xmb->left_thumbnail_width, &xmb->left_thumbnail_height);
 
       free(xmb->left_thumbnail_file_path);
       xmb->left_thumbnail_file_path = NULL;
    }
 }
 
+/* Loads the thumbnails of the playlist entries around the selection
+ * ahead of time, and cancels the loads for entries which were
+ * scrolled past. */
+static void xmb_prefetch_thumbnails(xmb_handle_t *xmb,
+      unsigned selection, unsigned end)
+{
+   unsigned n;
+   settings_t *settings    = config_get_ptr();
+   unsigned count          = settings->uints.menu_thumbnail_prefetch;
+   bool right              = !string_is_equal(xmb_thumbnails_ident('R'),
+         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF));
+   bool left               = !string_is_equal(xmb_thumbnails_ident('L'),
+         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF));
+
+   /* Nearest entries first, the task queue runs them in order. */
+   for (n = 1; n <= count * 2; n++)
+   {
+      menu_entry_t entry;
+      char path[PATH_MAX_LENGTH];
+      unsigned i = (n & 1) ? selection + (n + 1) / 2 : selection - n / 2;
+
+      if ((n & 1) ? i >= end : selection < n / 2)
+         continue;
+
+      menu_entry_init(&entry);
+      menu_entry_get(&entry, 0, i, NULL, true);
+
+      if (!string_is_empty(entry.path))
+      {
+         if (right && xmb_get_thumbnail_path(xmb, i, 'R',
+                  entry.path, path, sizeof(path)))
+            menu_thumbnail_cache_request(path,
+                  (unsigned)xmb->thumbnail_width, 0);
+         if (left && xmb_get_thumbnail_path(xmb, i, 'L',
+                  entry.path, path, sizeof(path)))
+            menu_thumbnail_cache_request(path,
+                  (unsigned)xmb->left_thumbnail_width, 0);
+      }
+
+      menu_entry_free(&entry);
+   }
+
+   menu_thumbnail_cache_cancel_stale();
+}
+
 static void xmb_set_thumbnail_system(void *data, char*s, size_t len)
 {
    xmb_handle_t *xmb = (xmb_handle_t*)data;
@@ -1299,6 +1428,7 @@ static void xmb_selection_pointer_changed(
                   xmb_update_thumbnail_path(xmb, i, 'L');
                   xmb_update_thumbnail_image(xmb);
                }
+               xmb_prefetch_thumbnails(xmb, i, end);
             }
             else if (((entry_type == FILE_TYPE_IMAGE || entry_type == FILE_TYPE_IMAGEVIEWER ||
                         entry_type == FILE_TYPE_RDB || entry_type == FILE_TYPE_RDB_ENTRY)
@@ -3103,6 +3233,11 @@ static void xmb_render(void *data, bool is_idle)
    if (!xmb)
       return;
 
+   xmb_poll_thumbnail(&xmb->thumbnail_wanted, &xmb->thumbnail,
+         xmb->thumbnail_width, &xmb->thumbnail_height);
+   xmb_poll_thumbnail(&xmb->left_thumbnail_wanted, &xmb->left_thumbnail,
+         xmb->left_thumbnail_width, &xmb->left_thumbnail_height);
+
    delta.current = menu_animation_get_delta_time();
 
    if (menu_animation_get_ideal_delta_time(&delta))
@@ -4520,6 +4655,10 @@ static void xmb_free(void *data)
          free(xmb->thumbnail_file_path);
       if (!string_is_empty(xmb->left_thumbnail_file_path))
          free(xmb->left_thumbnail_file_path);
+      if (!string_is_empty(xmb->thumbnail_wanted))
+         free(xmb->thumbnail_wanted);
+      if (!string_is_empty(xmb->left_thumbnail_wanted))
+         free(xmb->left_thumbnail_wanted);
       if (!string_is_empty(xmb->bg_file_path))
          free(xmb->bg_file_path);
    }
@@ -4559,7 +4698,7 @@ static bool xmb_load_image(void *userdata, void *data, enum menu_image_type type
             struct texture_image *img  = (struct texture_image*)data;
             xmb->thumbnail_height      = xmb->thumbnail_width
                * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->thumbnail);
+            menu_thumbnail_cache_release(&xmb->thumbnail);
             video_driver_texture_load(data,
                   TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->thumbnail);
          }
@@ -4569,7 +4708,7 @@ static bool xmb_load_image(void *userdata, void *data, enum menu_image_type type
             struct texture_image *img  = (struct texture_image*)data;
             xmb->left_thumbnail_height      = xmb->left_thumbnail_width
                * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->left_thumbnail);
+            menu_thumbnail_cache_release(&xmb->left_thumbnail);
             video_driver_texture_load(data,
                   TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->left_thumbnail);
          }
@@ -5364,8 +5503,9 @@ static void xmb_context_destroy(void *data)
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&xmb->textures.list[i]);
 
-   video_driver_texture_unload(&xmb->thumbnail);
-   video_driver_texture_unload(&xmb->left_thumbnail);
+   xmb_release_thumbnail(&xmb->thumbnail_wanted, &xmb->thumbnail);
+   xmb_release_thumbnail(&xmb->left_thumbnail_wanted, &xmb->left_thumbnail);
+   menu_thumbnail_cache_clear();
    video_driver_texture_unload(&xmb->savestate_thumbnail);
 
    xmb_context_destroy_horizontal_list(xmb);
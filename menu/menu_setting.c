@@ -72,6 +72,7 @@
 #include "../paths.h"
 #include "../dynamic.h"
 #include "../list_special.h"
+#include "../playlist.h"
 #include "../verbosity.h"
 #include "../camera/camera_driver.h"
 #include "../wifi/wifi_driver.h"
@@ -2015,13 +2016,16 @@ void menu_settings_list_current_add_enum_value_idx(
 
 int menu_setting_generic(rarch_setting_t *setting, bool wraparound)
 {
-   uint64_t flags = setting->flags;
+   settings_t *settings = config_get_ptr();
+   uint64_t flags       = setting->flags;
    if (setting_generic_action_ok_default(setting, wraparound) != 0)
       return -1;
 
    if (setting->change_handler)
       setting->change_handler(setting);
 
+   configuration_set_modified(settings);
+
    if ((flags & SD_FLAG_EXIT) && setting->cmd_trigger.triggered)
    {
       setting->cmd_trigger.triggered = false;
@@ -2719,6 +2723,12 @@ void general_write_handler(rarch_setting_t *setting)
                task_queue_unset_threaded();
          }
          break;
+      case MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_WORKERS:
+         task_queue_set_workers(*setting->value.target.unsigned_integer);
+         break;
+      case MENU_ENUM_LABEL_PLAYLIST_COMPACT_FORMAT:
+         playlist_set_compact_format(*setting->value.target.boolean);
+         break;
       case MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR:
          core_set_poll_type((unsigned int*)setting->value.target.integer);
          break;
@@ -4617,6 +4627,21 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_block_dedup,
+                  MENU_ENUM_LABEL_REWIND_BLOCK_DEDUP,
+                  MENU_ENUM_LABEL_VALUE_REWIND_BLOCK_DEDUP,
+                  rewind_block_dedup,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -6050,6 +6075,26 @@ static bool setting_append_list(
                );
          settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#if defined(HAVE_THREADS)
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_pipeline_enable,
+               MENU_ENUM_LABEL_AUDIO_PIPELINE_ENABLE,
+               MENU_ENUM_LABEL_VALUE_AUDIO_PIPELINE_ENABLE,
+               audio_pipeline_enable,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_latency,
@@ -6968,6 +7013,22 @@ static bool setting_append_list(
                );
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_state_pool,
+               MENU_ENUM_LABEL_RUN_AHEAD_STATE_POOL,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_STATE_POOL,
+               run_ahead_state_pool,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.run_ahead_hide_warnings,
@@ -7718,6 +7779,21 @@ static bool setting_append_list(
                general_read_handler,
                SD_FLAG_ADVANCED
                );
+
+         CONFIG_UINT(
+               list, list_info,
+               &settings->uints.threaded_data_runloop_workers,
+               MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_WORKERS,
+               MENU_ENUM_LABEL_VALUE_THREADED_DATA_RUNLOOP_WORKERS,
+               threaded_data_runloop_workers,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+         (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 0, 8, 1, true, true);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 #endif
 
 
@@ -8429,6 +8505,34 @@ static bool setting_append_list(
                &setting_get_string_representation_uint_menu_left_thumbnails;
             menu_settings_list_current_add_range(list, list_info, 0, 3, 1, true, true);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.menu_thumbnail_cache_size,
+                  MENU_ENUM_LABEL_THUMBNAIL_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_THUMBNAIL_CACHE_SIZE,
+                  menu_thumbnail_cache_size,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            menu_settings_list_current_add_range(list, list_info, 8, 512, 8, true, true);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.menu_thumbnail_prefetch,
+                  MENU_ENUM_LABEL_THUMBNAIL_PREFETCH,
+                  MENU_ENUM_LABEL_VALUE_THUMBNAIL_PREFETCH,
+                  menu_thumbnail_prefetch,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            menu_settings_list_current_add_range(list, list_info, 0, 8, 1, true, true);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                list, list_info,
                &settings->bools.menu_xmb_vertical_thumbnails,
@@ -9091,6 +9195,21 @@ static bool setting_append_list(
                general_read_handler,
                SD_FLAG_NONE);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.playlist_compact_format,
+               MENU_ENUM_LABEL_PLAYLIST_COMPACT_FORMAT,
+               MENU_ENUM_LABEL_VALUE_PLAYLIST_COMPACT_FORMAT,
+               def_playlist_compact_format,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
 
          END_GROUP(list, list_info, parent_group);
@@ -0,0 +1,356 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <formats/image.h>
+#include <queues/task_queue.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "menu_thumbnail_cache.h"
+#include "../configuration.h"
+#include "../msg_hash.h"
+#include "../gfx/video_driver.h"
+#include "../tasks/tasks_internal.h"
+
+/* Failed lookups are kept as well so that missing or broken
+ * images are not loaded again on every selection change, this
+ * bounds how many of them (and of the textures) are kept. */
+#define MENU_THUMBNAIL_CACHE_MAX_ENTRIES 256
+
+typedef struct menu_thumbnail_entry
+{
+   char *path;
+   uint32_t hash;
+   unsigned max_width;
+   unsigned max_height;
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+   size_t size;
+   unsigned refs;
+   unsigned id;
+   unsigned generation;
+   uint64_t last_use;
+   void *task;
+   enum menu_thumbnail_state state;
+   /* Failed because the image did not exist. */
+   bool missing;
+} menu_thumbnail_entry_t;
+
+static menu_thumbnail_entry_t *cache_entries = NULL;
+static size_t cache_count                    = 0;
+static size_t cache_capacity                 = 0;
+static size_t cache_size                     = 0;
+static unsigned cache_next_id                = 1;
+static unsigned cache_generation             = 0;
+static uint64_t cache_clock                  = 0;
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_find(const char *path,
+      unsigned max_width, unsigned max_height)
+{
+   size_t i;
+   uint32_t hash = msg_hash_calculate(path);
+
+   for (i = 0; i < cache_count; i++)
+   {
+      menu_thumbnail_entry_t *entry = &cache_entries[i];
+
+      if (     entry->hash       == hash
+            && entry->max_width  == max_width
+            && entry->max_height == max_height
+            && string_is_equal(entry->path, path))
+         return entry;
+   }
+
+   return NULL;
+}
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_find_id(unsigned id)
+{
+   size_t i;
+
+   for (i = 0; i < cache_count; i++)
+      if (cache_entries[i].id == id)
+         return &cache_entries[i];
+
+   return NULL;
+}
+
+/* Unloads the texture of an entry and moves the last entry into
+ * its slot. */
+static void menu_thumbnail_cache_remove(menu_thumbnail_entry_t *entry)
+{
+   if (entry->state == MENU_THUMBNAIL_READY)
+   {
+      video_driver_texture_unload(&entry->texture);
+      cache_size -= entry->size;
+   }
+
+   free(entry->path);
+
+   *entry = cache_entries[--cache_count];
+}
+
+/* Unloads the least recently used textures which are not in use
+ * until the cache is back under its budget. */
+static void menu_thumbnail_cache_evict(void)
+{
+   settings_t *settings = config_get_ptr();
+   size_t budget        = (size_t)
+      settings->uints.menu_thumbnail_cache_size * 1024 * 1024;
+
+   while (cache_size > budget
+         || cache_count > MENU_THUMBNAIL_CACHE_MAX_ENTRIES)
+   {
+      size_t i;
+      menu_thumbnail_entry_t *oldest = NULL;
+
+      for (i = 0; i < cache_count; i++)
+      {
+         menu_thumbnail_entry_t *entry = &cache_entries[i];
+
+         if (entry->refs || entry->state == MENU_THUMBNAIL_LOADING)
+            continue;
+
+         if (!oldest || entry->last_use < oldest->last_use)
+            oldest = entry;
+      }
+
+      if (!oldest)
+         break;
+
+      menu_thumbnail_cache_remove(oldest);
+   }
+}
+
+static void menu_thumbnail_cache_loaded(void *task_data,
+      void *user_data, const char *err)
+{
+   struct texture_image *img     = (struct texture_image*)task_data;
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache_find_id(
+         (unsigned)(uintptr_t)user_data);
+
+   /* The entry is gone when the load was cancelled or the cache
+    * was cleared in the meantime. */
+   if (entry)
+   {
+      entry->task  = NULL;
+      entry->state = MENU_THUMBNAIL_FAILED;
+
+      if (img && img->pixels && string_is_empty(err) &&
+            video_driver_texture_load(img,
+               TEXTURE_FILTER_MIPMAP_LINEAR, &entry->texture)
+            && entry->texture)
+      {
+         entry->state  = MENU_THUMBNAIL_READY;
+         entry->width  = img->width;
+         entry->height = img->height;
+         entry->size   = img->width * img->height * sizeof(uint32_t);
+         cache_size   += entry->size;
+      }
+
+      menu_thumbnail_cache_evict();
+   }
+
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+}
+
+void menu_thumbnail_cache_request(const char *path,
+      unsigned max_width, unsigned max_height)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+
+   if (string_is_empty(path))
+      return;
+
+   entry = menu_thumbnail_cache_find(path, max_width, max_height);
+
+   if (entry)
+   {
+      entry->generation = cache_generation;
+      entry->last_use   = ++cache_clock;
+      return;
+   }
+
+   if (cache_count == cache_capacity)
+   {
+      size_t capacity                    = cache_capacity ?
+         cache_capacity * 2 : 32;
+      menu_thumbnail_entry_t *new_entries = (menu_thumbnail_entry_t*)
+         realloc(cache_entries, capacity * sizeof(*new_entries));
+
+      if (!new_entries)
+         return;
+
+      cache_entries  = new_entries;
+      cache_capacity = capacity;
+   }
+
+   entry             = &cache_entries[cache_count];
+   memset(entry, 0, sizeof(*entry));
+
+   entry->path       = strdup(path);
+
+   if (!entry->path)
+      return;
+
+   cache_count++;
+
+   entry->hash       = msg_hash_calculate(path);
+   entry->max_width  = max_width;
+   entry->max_height = max_height;
+   entry->id         = cache_next_id++;
+   entry->generation = cache_generation;
+   entry->last_use   = ++cache_clock;
+   entry->state      = MENU_THUMBNAIL_FAILED;
+
+   /* Missing images are remembered like broken ones, until
+    * they are no longer requested. */
+   if (!filestream_exists(path))
+   {
+      entry->missing = true;
+      menu_thumbnail_cache_evict();
+      return;
+   }
+
+   entry->task       = task_push_image_load_scaled(path,
+         max_width, max_height, menu_thumbnail_cache_loaded,
+         (void*)(uintptr_t)entry->id);
+
+   if (entry->task)
+      entry->state   = MENU_THUMBNAIL_LOADING;
+}
+
+void menu_thumbnail_cache_cancel_stale(void)
+{
+   size_t i = 0;
+
+   while (i < cache_count)
+   {
+      menu_thumbnail_entry_t *entry = &cache_entries[i];
+
+      if (entry->generation != cache_generation)
+      {
+         if (entry->state == MENU_THUMBNAIL_LOADING)
+         {
+            task_queue_cancel_task(entry->task);
+            menu_thumbnail_cache_remove(entry);
+            continue;
+         }
+
+         /* The image may have been downloaded in the meantime,
+          * so look for it again the next time it is requested. */
+         if (entry->state == MENU_THUMBNAIL_FAILED && entry->missing)
+         {
+            menu_thumbnail_cache_remove(entry);
+            continue;
+         }
+      }
+
+      i++;
+   }
+
+   cache_generation++;
+}
+
+void menu_thumbnail_cache_forget_failed(void)
+{
+   size_t i = 0;
+
+   while (i < cache_count)
+   {
+      if (cache_entries[i].state == MENU_THUMBNAIL_FAILED)
+         menu_thumbnail_cache_remove(&cache_entries[i]);
+      else
+         i++;
+   }
+}
+
+enum menu_thumbnail_state menu_thumbnail_cache_acquire(const char *path,
+      unsigned max_width, unsigned max_height,
+      uintptr_t *texture, unsigned *width, unsigned *height)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+
+   if (string_is_empty(path))
+      return MENU_THUMBNAIL_NONE;
+
+   entry = menu_thumbnail_cache_find(path, max_width, max_height);
+
+   if (!entry)
+      return MENU_THUMBNAIL_NONE;
+
+   if (entry->state == MENU_THUMBNAIL_READY)
+   {
+      entry->refs++;
+      entry->last_use = ++cache_clock;
+      *texture        = entry->texture;
+      *width          = entry->width;
+      *height         = entry->height;
+   }
+
+   return entry->state;
+}
+
+void menu_thumbnail_cache_release(uintptr_t *texture)
+{
+   size_t i;
+
+   if (!texture || !*texture)
+      return;
+
+   for (i = 0; i < cache_count; i++)
+   {
+      menu_thumbnail_entry_t *entry = &cache_entries[i];
+
+      if (entry->state == MENU_THUMBNAIL_READY
+            && entry->texture == *texture)
+      {
+         if (entry->refs)
+            entry->refs--;
+         *texture = 0;
+         menu_thumbnail_cache_evict();
+         return;
+      }
+   }
+
+   /* Not one of ours. */
+   video_driver_texture_unload(texture);
+}
+
+void menu_thumbnail_cache_clear(void)
+{
+   while (cache_count)
+   {
+      menu_thumbnail_entry_t *entry = &cache_entries[cache_count - 1];
+
+      if (entry->state == MENU_THUMBNAIL_LOADING)
+         task_queue_cancel_task(entry->task);
+
+      menu_thumbnail_cache_remove(entry);
+   }
+
+   free(cache_entries);
+
+   cache_entries  = NULL;
+   cache_capacity = 0;
+   cache_size     = 0;
+}
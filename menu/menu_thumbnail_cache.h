@@ -0,0 +1,76 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MENU_THUMBNAIL_CACHE_H
+#define _MENU_THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Thumbnail textures shared by the menu drivers.
+ *
+ * Images are loaded on the task queue, scaled down to the size they
+ * are drawn at and kept as textures until the cache grows over the
+ * 'menu_thumbnail_cache_size' budget, at which point the least
+ * recently used ones are unloaded. Missing and broken images are
+ * remembered as failed, missing ones only while they are still
+ * requested. Textures handed out with
+ * menu_thumbnail_cache_acquire stay valid until they are released. */
+
+enum menu_thumbnail_state
+{
+   MENU_THUMBNAIL_NONE = 0,
+   MENU_THUMBNAIL_LOADING,
+   MENU_THUMBNAIL_READY,
+   MENU_THUMBNAIL_FAILED
+};
+
+/* Starts loading the image at 'path' scaled to fit into
+ * max_width x max_height (0 for no limit), unless it is
+ * already cached or being loaded. */
+void menu_thumbnail_cache_request(const char *path,
+      unsigned max_width, unsigned max_height);
+
+/* Cancels the loads which were not requested again since the
+ * last call. Call it after requesting everything that is still
+ * needed, e.g. on every selection change. */
+void menu_thumbnail_cache_cancel_stale(void);
+
+/* Drops the missing and broken images, so that they are loaded
+ * again, e.g. after new thumbnails were downloaded. */
+void menu_thumbnail_cache_forget_failed(void);
+
+/* When the image is ready, takes a reference on its texture and
+ * stores it in 'texture'. */
+enum menu_thumbnail_state menu_thumbnail_cache_acquire(const char *path,
+      unsigned max_width, unsigned max_height,
+      uintptr_t *texture, unsigned *width, unsigned *height);
+
+/* Drops the reference taken by menu_thumbnail_cache_acquire
+ * and sets 'texture' to 0. */
+void menu_thumbnail_cache_release(uintptr_t *texture);
+
+/* Unloads all textures and cancels all loads, e.g. when the
+ * video context goes away. All textures must be released. */
+void menu_thumbnail_cache_clear(void);
+
+RETRO_END_DECLS
+
+#endif
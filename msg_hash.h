@@ -815,6 +815,7 @@ enum msg_hash_enums
    MENU_LABEL(NAVIGATION_WRAPAROUND),
    MENU_LABEL(SHOW_ADVANCED_SETTINGS),
    MENU_LABEL(THREADED_DATA_RUNLOOP_ENABLE),
+   MENU_LABEL(THREADED_DATA_RUNLOOP_WORKERS),
    MENU_LABEL(ENTRY_NORMAL_COLOR),
    MENU_LABEL(ENTRY_HOVER_COLOR),
    MENU_LABEL(XMB_ALPHA_FACTOR),
@@ -843,6 +844,8 @@ enum msg_hash_enums
    MENU_LABEL(XMB_RIBBON_ENABLE),
    MENU_LABEL(THUMBNAILS),
    MENU_LABEL(LEFT_THUMBNAILS),
+   MENU_LABEL(THUMBNAIL_CACHE_SIZE),
+   MENU_LABEL(THUMBNAIL_PREFETCH),
    MENU_LABEL(XMB_VERTICAL_THUMBNAILS),
    MENU_LABEL(TIMEDATE_ENABLE),
    MENU_LABEL(TIMEDATE_STYLE),
@@ -907,6 +910,7 @@ enum msg_hash_enums
    MENU_LABEL(CONTENT_HISTORY_SIZE),
    MENU_LABEL(PLAYLIST_ENTRY_REMOVE),
    MENU_LABEL(PLAYLIST_ENTRY_RENAME),
+   MENU_LABEL(PLAYLIST_COMPACT_FORMAT),
    MENU_LABEL(GOTO_FAVORITES),
    MENU_LABEL(GOTO_MUSIC),
    MENU_LABEL(GOTO_IMAGES),
@@ -1206,6 +1210,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_MUTE),
    MENU_LABEL(AUDIO_MIXER_MUTE),
    MENU_LABEL(AUDIO_SYNC),
+   MENU_LABEL(AUDIO_PIPELINE_ENABLE),
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
@@ -1252,6 +1257,7 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_BLOCK_DEDUP),
    MENU_LABEL(INPUT_META_REWIND),
    MENU_LABEL(INPUT_META_CHEAT_DETAILS),
    MENU_LABEL(INPUT_META_CHEAT_SEARCH),
@@ -1423,6 +1429,7 @@ enum msg_hash_enums
    MENU_LABEL(SLOWMOTION_RATIO),
    MENU_LABEL(RUN_AHEAD_ENABLED),
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
+   MENU_LABEL(RUN_AHEAD_STATE_POOL),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
    MENU_LABEL(TURBO),
@@ -2177,6 +2184,7 @@ enum msg_hash_enums
 /* Callback strings */
 
 #define CB_CORE_UPDATER_DOWNLOAD                                               0x7412da7dU
+#define CB_CORE_THUMBNAILS_DOWNLOAD                                            0xc9d6519fU
 #define CB_UPDATE_ASSETS                                                       0xbf85795eU
 
 /* Deferred */
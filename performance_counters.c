@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
@@ -24,6 +25,7 @@
 #endif
 
 #include <compat/strl.h>
+#include <queues/task_queue.h>
 
 #include "performance_counters.h"
 
@@ -32,15 +34,26 @@
 
 #ifdef _WIN32
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %I64u ticks, %I64u runs.\n"
+#define PERF_FRAME_LOG_FMT "[PERF]: Frame (%s): %I64u / %I64u / %I64u / %I64u ticks.\n"
+#define PERF_TASK_LOG_FMT "[PERF]: Task (%s): %I64u runs, %u deep, %I64d / %I64d us queued, %I64d / %I64d us running.\n"
 #else
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %llu ticks, %llu runs.\n"
+#define PERF_FRAME_LOG_FMT "[PERF]: Frame (%s): %llu / %llu / %llu / %llu ticks.\n"
+#define PERF_TASK_LOG_FMT "[PERF]: Task (%s): %llu runs, %u deep, %lld / %lld us queued, %lld / %lld us running.\n"
 #endif
 
+/* Frames kept for the percentiles, the oldest ones are overwritten. */
+#define PERF_FRAME_SAMPLES 8192
+
 static struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
 static struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
 static unsigned perf_ptr_rarch;
 static unsigned perf_ptr_libretro;
 
+static retro_perf_tick_t *perf_frame_samples[MAX_COUNTERS];
+static retro_perf_tick_t perf_frame_last[MAX_COUNTERS];
+static unsigned perf_frame_count;
+
 struct retro_perf_counter **retro_get_perf_counter_rarch(void)
 {
    return perf_counters_rarch;
@@ -105,6 +118,107 @@ static void log_counters(struct retro_perf_counter **counters, unsigned num)
    }
 }
 
+void rarch_perf_sample_frame(void)
+{
+   unsigned i;
+   unsigned slot = perf_frame_count % PERF_FRAME_SAMPLES;
+
+   for (i = 0; i < perf_ptr_rarch; i++)
+   {
+      retro_perf_tick_t total = perf_counters_rarch[i]->total;
+
+      if (!perf_frame_samples[i])
+      {
+         perf_frame_samples[i] = (retro_perf_tick_t*)
+            calloc(PERF_FRAME_SAMPLES, sizeof(retro_perf_tick_t));
+
+         if (!perf_frame_samples[i])
+            continue;
+      }
+
+      perf_frame_samples[i][slot] = total - perf_frame_last[i];
+      perf_frame_last[i]          = total;
+   }
+
+   perf_frame_count++;
+}
+
+static int perf_tick_compare(const void *a, const void *b)
+{
+   retro_perf_tick_t x = *(const retro_perf_tick_t*)a;
+   retro_perf_tick_t y = *(const retro_perf_tick_t*)b;
+
+   return (x > y) - (x < y);
+}
+
+static void log_frame_samples(void)
+{
+   unsigned i;
+   retro_perf_tick_t *sorted = NULL;
+   unsigned count            = perf_frame_count < PERF_FRAME_SAMPLES
+      ? perf_frame_count : PERF_FRAME_SAMPLES;
+
+   if (!count)
+      return;
+
+   sorted = (retro_perf_tick_t*)malloc(count * sizeof(*sorted));
+
+   if (!sorted)
+      return;
+
+   RARCH_LOG("[PERF]: Time per frame over %u frames (p50 / p90 / p99 / max):\n",
+         count);
+
+   for (i = 0; i < perf_ptr_rarch; i++)
+   {
+      if (!perf_frame_samples[i] || !perf_counters_rarch[i]->call_cnt)
+         continue;
+
+      memcpy(sorted, perf_frame_samples[i], count * sizeof(*sorted));
+      qsort(sorted, count, sizeof(*sorted), perf_tick_compare);
+
+      RARCH_LOG(PERF_FRAME_LOG_FMT,
+            perf_counters_rarch[i]->ident,
+            (uint64_t)sorted[(count - 1) * 50 / 100],
+            (uint64_t)sorted[(count - 1) * 90 / 100],
+            (uint64_t)sorted[(count - 1) * 99 / 100],
+            (uint64_t)sorted[count - 1]);
+   }
+
+   free(sorted);
+}
+
+/* One line per type of task, with the deepest the queue got
+ * and the average / longest times spent queued and running. */
+static void log_task_stats(void)
+{
+   unsigned i;
+   task_queue_handler_stats_t stats[TASK_QUEUE_MAX_STATS];
+   unsigned count = task_queue_get_all_stats(stats, TASK_QUEUE_MAX_STATS);
+
+   if (!count)
+      return;
+
+   RARCH_LOG("[PERF]: Tasks (runs, max depth, avg / max times):\n");
+
+   for (i = 0; i < count; i++)
+   {
+      const task_queue_stats_t *s = &stats[i].stats;
+
+      if (!s->runs)
+         continue;
+
+      RARCH_LOG(PERF_TASK_LOG_FMT,
+            stats[i].label[0] ? stats[i].label : "untitled",
+            (uint64_t)s->runs,
+            s->max_depth,
+            (int64_t)(s->wait_usec / (int64_t)s->runs),
+            (int64_t)s->max_wait_usec,
+            (int64_t)(s->run_usec / (int64_t)s->runs),
+            (int64_t)s->max_run_usec);
+   }
+}
+
 void rarch_perf_log(void)
 {
    if (!rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL))
@@ -112,6 +226,8 @@ void rarch_perf_log(void)
 
    RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
    log_counters(perf_counters_rarch, perf_ptr_rarch);
+   log_frame_samples();
+   log_task_stats();
 }
 
 void retro_perf_log(void)
@@ -57,6 +57,11 @@ void rarch_perf_log(void);
 
 void rarch_perf_register(struct retro_perf_counter *perf);
 
+/* Records how much time each RetroArch counter accumulated since
+ * the previous call, call once per frame. rarch_perf_log then
+ * reports percentiles of these per-frame times. */
+void rarch_perf_sample_frame(void);
+
 #define performance_counter_init(perf, name) \
    perf.ident = name; \
    if (!perf.registered) \
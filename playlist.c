@@ -17,12 +17,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <libretro.h>
 #include <boolean.h>
+#include <retro_endianness.h>
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
-#include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 #include <file/file_path.h>
 
@@ -33,6 +34,16 @@
 #define PLAYLIST_ENTRIES 6
 #endif
 
+/* Compact playlists start with this, followed by the number
+ * of entries and the size of the string pool (both 32-bit LE),
+ * PLAYLIST_ENTRIES string offsets per entry and the pool of
+ * NUL terminated strings. Offset 0 stands for an empty field. */
+#define PLAYLIST_COMPACT_MAGIC "RPLBIN01"
+#define PLAYLIST_COMPACT_MAGIC_LEN 8
+#define PLAYLIST_COMPACT_HEADER_LEN (PLAYLIST_COMPACT_MAGIC_LEN + 8)
+
+#define PLAYLIST_INDEX_MIN_CAP 64
+
 struct playlist_entry
 {
    char *path;
@@ -43,21 +54,201 @@ struct playlist_entry
    char *crc32;
 };
 
+struct playlist_index_slot
+{
+   uint32_t hash;
+   /* Position of the entry + 1, 0 if the slot is free. */
+   uint32_t pos;
+};
+
 struct content_playlist
 {
    bool modified;
+   /* Set when entries moved, the index gets
+    * rebuilt on the next lookup. */
+   bool index_dirty;
    size_t size;
    size_t cap;
+   size_t index_cap;
 
    char *conf_path;
+   /* Contents of the file the playlist was loaded from.
+    * Loaded entries point into it until they are updated. */
+   char *pool;
+   size_t pool_size;
+   /* Stored from the bottom of the playlist to the top,
+    * so pushing an entry doesn't move all the others. */
    struct playlist_entry *entries;
+   /* Open addressing hash table of entry paths. */
+   struct playlist_index_slot *index;
 };
 static playlist_t *playlist_cached = NULL;
+static bool playlist_compact_format = false;
 
 typedef int (playlist_sort_fun_t)(
       const struct playlist_entry *a,
       const struct playlist_entry *b);
 
+/* Position in the entries array of the entry at @idx. */
+#define PLAYLIST_POS(playlist, idx) ((playlist)->size - 1 - (idx))
+
+static bool playlist_string_in_pool(playlist_t *playlist, const char *str)
+{
+   return playlist->pool && str >= playlist->pool &&
+      str < playlist->pool + playlist->pool_size;
+}
+
+static void playlist_free_string(playlist_t *playlist, char **str)
+{
+   if (*str && !playlist_string_in_pool(playlist, *str))
+      free(*str);
+   *str = NULL;
+}
+
+static uint32_t playlist_hash_path(const char *path)
+{
+   uint32_t hash = 5381;
+
+   /* Lookups might be case insensitive on Windows,
+    * see playlist_push. */
+   for (; *path; path++)
+#ifdef _WIN32
+      hash = (hash << 5) + hash + (uint8_t)tolower((uint8_t)*path);
+#else
+      hash = (hash << 5) + hash + (uint8_t)*path;
+#endif
+
+   return hash;
+}
+
+static void playlist_index_insert(playlist_t *playlist, size_t pos)
+{
+   size_t mask     = playlist->index_cap - 1;
+   uint32_t hash   = playlist_hash_path(playlist->entries[pos].path);
+   size_t i        = hash & mask;
+
+   while (playlist->index[i].pos)
+      i = (i + 1) & mask;
+
+   playlist->index[i].hash = hash;
+   playlist->index[i].pos  = (uint32_t)(pos + 1);
+}
+
+static bool playlist_index_rebuild(playlist_t *playlist)
+{
+   size_t i;
+   size_t cap = PLAYLIST_INDEX_MIN_CAP;
+
+   /* Keep the table at most half full. */
+   while (cap < playlist->size * 2 + 2)
+      cap <<= 1;
+
+   if (cap != playlist->index_cap)
+   {
+      struct playlist_index_slot *index = (struct playlist_index_slot*)
+         realloc(playlist->index, cap * sizeof(*index));
+
+      if (!index)
+         return false;
+
+      playlist->index     = index;
+      playlist->index_cap = cap;
+   }
+
+   memset(playlist->index, 0, playlist->index_cap * sizeof(*playlist->index));
+
+   for (i = 0; i < playlist->size; i++)
+      if (playlist->entries[i].path)
+         playlist_index_insert(playlist, i);
+
+   playlist->index_dirty = false;
+   return true;
+}
+
+/* Adds the entry that was just appended to the entries array. */
+static void playlist_index_append(playlist_t *playlist)
+{
+   if (playlist->index_dirty)
+      return;
+
+   if ((playlist->size + 1) * 2 > playlist->index_cap)
+   {
+      playlist->index_dirty = true;
+      return;
+   }
+
+   if (playlist->entries[playlist->size - 1].path)
+      playlist_index_insert(playlist, playlist->size - 1);
+}
+
+/**
+ * playlist_index_find:
+ * @path                : Path to look for, not NULL.
+ * @core_path           : Core path to look for, NULL for any core.
+ * @noncase             : Compare paths case-insensitively.
+ * @pos                 : Position of the entry in the entries array.
+ *
+ * Finds the entry nearest to the top of the playlist.
+ *
+ * Returns: true if an entry was found.
+ **/
+static bool playlist_index_find(playlist_t *playlist,
+      const char *path, const char *core_path, bool noncase,
+      size_t *pos)
+{
+   size_t i, mask;
+   uint32_t hash;
+   bool found = false;
+
+   if (playlist->index_dirty || !playlist->index)
+   {
+      if (!playlist_index_rebuild(playlist))
+      {
+         /* Fall back to a linear search from the top. */
+         for (i = playlist->size; i-- > 0; )
+         {
+            const struct playlist_entry *entry = &playlist->entries[i];
+
+            if (!entry->path || !(noncase
+                     ? string_is_equal_noncase(path, entry->path)
+                     : string_is_equal(path, entry->path)))
+               continue;
+            if (core_path && !string_is_equal(entry->core_path, core_path))
+               continue;
+
+            *pos = i;
+            return true;
+         }
+         return false;
+      }
+   }
+
+   hash = playlist_hash_path(path);
+   mask = playlist->index_cap - 1;
+
+   for (i = hash & mask; playlist->index[i].pos; i = (i + 1) & mask)
+   {
+      size_t entry_pos                   = playlist->index[i].pos - 1;
+      const struct playlist_entry *entry = &playlist->entries[entry_pos];
+
+      if (playlist->index[i].hash != hash)
+         continue;
+      if (found && entry_pos < *pos)
+         continue;
+      if (!(noncase
+               ? string_is_equal_noncase(path, entry->path)
+               : string_is_equal(path, entry->path)))
+         continue;
+      if (core_path && !string_is_equal(entry->core_path, core_path))
+         continue;
+
+      *pos  = entry_pos;
+      found = true;
+   }
+
+   return found;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -89,21 +280,48 @@ void playlist_get_index(playlist_t *playlist,
       const char **crc32,
       const char **db_name)
 {
+   static const struct playlist_entry empty_entry = {0};
+   const struct playlist_entry *entry             = &empty_entry;
+
    if (!playlist)
       return;
 
+   if (idx < playlist->size)
+      entry      = &playlist->entries[PLAYLIST_POS(playlist, idx)];
+
    if (path)
-      *path      = playlist->entries[idx].path;
+      *path      = entry->path;
    if (label)
-      *label     = playlist->entries[idx].label;
+      *label     = entry->label;
    if (core_path)
-      *core_path = playlist->entries[idx].core_path;
+      *core_path = entry->core_path;
    if (core_name)
-      *core_name = playlist->entries[idx].core_name;
+      *core_name = entry->core_name;
    if (db_name)
-      *db_name   = playlist->entries[idx].db_name;
+      *db_name   = entry->db_name;
    if (crc32)
-      *crc32     = playlist->entries[idx].crc32;
+      *crc32     = entry->crc32;
+}
+
+/**
+ * playlist_free_entry:
+ * @playlist            : Playlist handle.
+ * @entry               : Playlist entry handle.
+ *
+ * Frees playlist entry.
+ **/
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
+{
+   if (!entry)
+      return;
+
+   playlist_free_string(playlist, &entry->path);
+   playlist_free_string(playlist, &entry->label);
+   playlist_free_string(playlist, &entry->core_path);
+   playlist_free_string(playlist, &entry->core_name);
+   playlist_free_string(playlist, &entry->db_name);
+   playlist_free_string(playlist, &entry->crc32);
 }
 
 /**
@@ -116,14 +334,24 @@ void playlist_get_index(playlist_t *playlist,
 void playlist_delete_index(playlist_t *playlist,
       size_t idx)
 {
-   if (!playlist)
+   size_t pos;
+
+   if (!playlist || idx >= playlist->size)
       return;
 
-   memmove(playlist->entries + idx, playlist->entries + idx + 1,
-         (playlist->size - idx) * sizeof(struct playlist_entry));
+   pos = PLAYLIST_POS(playlist, idx);
 
-   playlist->size     = playlist->size - 1;
-   playlist->modified = true;
+   playlist_free_entry(playlist, &playlist->entries[pos]);
+
+   memmove(playlist->entries + pos, playlist->entries + pos + 1,
+         (playlist->size - pos - 1) * sizeof(struct playlist_entry));
+
+   playlist->size        = playlist->size - 1;
+   memset(&playlist->entries[playlist->size], 0,
+         sizeof(struct playlist_entry));
+
+   playlist->index_dirty = true;
+   playlist->modified    = true;
 }
 
 void playlist_get_index_by_path(playlist_t *playlist,
@@ -133,76 +361,41 @@ void playlist_get_index_by_path(playlist_t *playlist,
       char **crc32,
       char **db_name)
 {
-   size_t i;
-   if (!playlist)
+   size_t pos;
+   struct playlist_entry *entry = NULL;
+
+   if (!playlist || !search_path)
       return;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      if (!string_is_equal(playlist->entries[i].path, search_path))
-         continue;
+   if (!playlist_index_find(playlist, search_path, NULL, false, &pos))
+      return;
 
-      if (path)
-         *path      = playlist->entries[i].path;
-      if (label)
-         *label     = playlist->entries[i].label;
-      if (core_path)
-         *core_path = playlist->entries[i].core_path;
-      if (core_name)
-         *core_name = playlist->entries[i].core_name;
-      if (db_name)
-         *db_name   = playlist->entries[i].db_name;
-      if (crc32)
-         *crc32     = playlist->entries[i].crc32;
-      break;
-   }
+   entry          = &playlist->entries[pos];
+
+   if (path)
+      *path      = entry->path;
+   if (label)
+      *label     = entry->label;
+   if (core_path)
+      *core_path = entry->core_path;
+   if (core_name)
+      *core_name = entry->core_name;
+   if (db_name)
+      *db_name   = entry->db_name;
+   if (crc32)
+      *crc32     = entry->crc32;
 }
 
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path,
       const char *crc32)
 {
-   size_t i;
-   if (!playlist)
-      return false;
+   size_t pos;
 
-   for (i = 0; i < playlist->size; i++)
-      if (string_is_equal(playlist->entries[i].path, path))
-         return true;
-
-   return false;
-}
-
-/**
- * playlist_free_entry:
- * @entry               : Playlist entry handle.
- *
- * Frees playlist entry.
- **/
-static void playlist_free_entry(struct playlist_entry *entry)
-{
-   if (!entry)
-      return;
-
-   if (entry->path != NULL)
-      free(entry->path);
-   if (entry->label != NULL)
-      free(entry->label);
-   if (entry->core_path != NULL)
-      free(entry->core_path);
-   if (entry->core_name != NULL)
-      free(entry->core_name);
-   if (entry->db_name != NULL)
-      free(entry->db_name);
-   if (entry->crc32 != NULL)
-      free(entry->crc32);
+   if (!playlist || !path)
+      return false;
 
-   entry->path      = NULL;
-   entry->label     = NULL;
-   entry->core_path = NULL;
-   entry->core_name = NULL;
-   entry->db_name   = NULL;
-   entry->crc32     = NULL;
+   return playlist_index_find(playlist, path, NULL, false, &pos);
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -213,56 +406,50 @@ void playlist_update(playlist_t *playlist, size_t idx,
 {
    struct playlist_entry *entry = NULL;
 
-   if (!playlist || idx > playlist->size)
+   if (!playlist || idx >= playlist->size)
       return;
 
-   entry            = &playlist->entries[idx];
+   entry            = &playlist->entries[PLAYLIST_POS(playlist, idx)];
 
    if (path && (path != entry->path))
    {
-      if (entry->path != NULL)
-         free(entry->path);
-      entry->path        = strdup(path);
-      playlist->modified = true;
+      playlist_free_string(playlist, &entry->path);
+      entry->path           = strdup(path);
+      playlist->index_dirty = true;
+      playlist->modified    = true;
    }
 
    if (label && (label != entry->label))
    {
-      if (entry->label != NULL)
-         free(entry->label);
+      playlist_free_string(playlist, &entry->label);
       entry->label       = strdup(label);
       playlist->modified = true;
    }
 
    if (core_path && (core_path != entry->core_path))
    {
-      if (entry->core_path != NULL)
-         free(entry->core_path);
-      entry->core_path   = NULL;
+      playlist_free_string(playlist, &entry->core_path);
       entry->core_path   = strdup(core_path);
       playlist->modified = true;
    }
 
    if (core_name && (core_name != entry->core_name))
    {
-      if (entry->core_name != NULL)
-         free(entry->core_name);
+      playlist_free_string(playlist, &entry->core_name);
       entry->core_name   = strdup(core_name);
       playlist->modified = true;
    }
 
    if (db_name && (db_name != entry->db_name))
    {
-      if (entry->db_name != NULL)
-         free(entry->db_name);
+      playlist_free_string(playlist, &entry->db_name);
       entry->db_name     = strdup(db_name);
       playlist->modified = true;
    }
 
    if (crc32 && (crc32 != entry->crc32))
    {
-      if (entry->crc32 != NULL)
-         free(entry->crc32);
+      playlist_free_string(playlist, &entry->crc32);
       entry->crc32       = strdup(crc32);
       playlist->modified = true;
    }
@@ -284,8 +471,10 @@ bool playlist_push(playlist_t *playlist,
       const char *db_name)
 {
    size_t i;
-   bool core_path_empty = string_is_empty(core_path);
-   bool core_name_empty = string_is_empty(core_name);
+   struct playlist_entry *entry = NULL;
+   bool core_path_empty         = string_is_empty(core_path);
+   bool core_name_empty         = string_is_empty(core_name);
+   bool found                   = false;
 
    if (core_path_empty || core_name_empty)
    {
@@ -309,78 +498,85 @@ bool playlist_push(playlist_t *playlist,
    if (!playlist)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry tmp;
-      bool equal_path;
-
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+   /* Core name can have changed while still being the same core.
+    * Differentiate based on the core path only. */
+   if (path)
+      found = playlist_index_find(playlist, path, core_path,
 #ifdef _WIN32
-          /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+            /*prevent duplicates on case-insensitive operating systems*/
+            true,
 #else
-          string_is_equal(path,playlist->entries[i].path)
+            false,
 #endif
-          );
-
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!equal_path)
-         continue;
+            &i);
+   else
+   {
+      for (i = playlist->size; i-- > 0; )
+      {
+         if (playlist->entries[i].path)
+            continue;
+         if (!string_is_equal(playlist->entries[i].core_path, core_path))
+            continue;
+         found = true;
+         break;
+      }
+   }
 
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
-         continue;
+   if (found)
+   {
+      struct playlist_entry tmp;
 
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
-      if (i == 0)
+      if (i == playlist->size - 1)
          return false;
 
       /* Seen it before, bump to top. */
       tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      memmove(playlist->entries + i, playlist->entries + i + 1,
+            (playlist->size - i - 1) * sizeof(struct playlist_entry));
+      playlist->entries[playlist->size - 1] = tmp;
+      playlist->index_dirty                 = true;
 
       goto success;
    }
 
    if (playlist->size == playlist->cap)
    {
-      struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
+      if (playlist->cap == 0)
+         return false;
 
-      if (entry)
-         playlist_free_entry(entry);
+      /* Drop the bottom entry. */
+      playlist_free_entry(playlist, &playlist->entries[0]);
+      memmove(playlist->entries, playlist->entries + 1,
+            (playlist->size - 1) * sizeof(struct playlist_entry));
       playlist->size--;
+      playlist->index_dirty = true;
    }
 
-   if (playlist->entries)
-   {
-      memmove(playlist->entries + 1, playlist->entries,
-            (playlist->cap - 1) * sizeof(struct playlist_entry));
-
-      playlist->entries[0].path         = NULL;
-      playlist->entries[0].label        = NULL;
-      playlist->entries[0].core_path    = NULL;
-      playlist->entries[0].core_name    = NULL;
-      playlist->entries[0].db_name      = NULL;
-      playlist->entries[0].crc32        = NULL;
-      if (!string_is_empty(path))
-         playlist->entries[0].path      = strdup(path);
-      if (!string_is_empty(label))
-         playlist->entries[0].label     = strdup(label);
-      if (!string_is_empty(core_path))
-         playlist->entries[0].core_path = strdup(core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name = strdup(core_name);
-      if (!string_is_empty(db_name))
-         playlist->entries[0].db_name   = strdup(db_name);
-      if (!string_is_empty(crc32))
-         playlist->entries[0].crc32     = strdup(crc32);
-   }
+   entry            = &playlist->entries[playlist->size];
+
+   entry->path      = NULL;
+   entry->label     = NULL;
+   entry->core_path = NULL;
+   entry->core_name = NULL;
+   entry->db_name   = NULL;
+   entry->crc32     = NULL;
+   if (!string_is_empty(path))
+      entry->path      = strdup(path);
+   if (!string_is_empty(label))
+      entry->label     = strdup(label);
+   if (!string_is_empty(core_path))
+      entry->core_path = strdup(core_path);
+   if (!string_is_empty(core_name))
+      entry->core_name = strdup(core_name);
+   if (!string_is_empty(db_name))
+      entry->db_name   = strdup(db_name);
+   if (!string_is_empty(crc32))
+      entry->crc32     = strdup(crc32);
 
    playlist->size++;
+   playlist_index_append(playlist);
 
 success:
    playlist->modified = true;
@@ -388,38 +584,137 @@ success:
    return true;
 }
 
-void playlist_write_file(playlist_t *playlist)
+static bool playlist_write_file_compact(playlist_t *playlist)
+{
+   size_t i, j;
+   bool ret         = false;
+   size_t pool_size = 1;
+   size_t size      = PLAYLIST_COMPACT_HEADER_LEN +
+      playlist->size * PLAYLIST_ENTRIES * sizeof(uint32_t);
+   uint8_t *buf     = NULL;
+   uint32_t *offs   = NULL;
+   char *pool       = NULL;
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      const char *fields[PLAYLIST_ENTRIES];
+
+      fields[0] = entry->path;
+      fields[1] = entry->label;
+      fields[2] = entry->core_path;
+      fields[3] = entry->core_name;
+      fields[4] = entry->crc32;
+      fields[5] = entry->db_name;
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+         if (!string_is_empty(fields[j]))
+            pool_size += strlen(fields[j]) + 1;
+   }
+
+   if (pool_size > UINT32_MAX || playlist->size > UINT32_MAX)
+      return false;
+
+   buf = (uint8_t*)malloc(size + pool_size);
+   if (!buf)
+      return false;
+
+   offs      = (uint32_t*)(buf + PLAYLIST_COMPACT_HEADER_LEN);
+   pool      = (char*)buf + size;
+   pool[0]   = '\0';
+   pool_size = 1;
+
+   memcpy(buf, PLAYLIST_COMPACT_MAGIC, PLAYLIST_COMPACT_MAGIC_LEN);
+   ((uint32_t*)buf)[2] = swap_if_big32((uint32_t)playlist->size);
+
+   /* Written from the top of the playlist, like text playlists. */
+   for (i = 0; i < playlist->size; i++)
+   {
+      const struct playlist_entry *entry =
+         &playlist->entries[PLAYLIST_POS(playlist, i)];
+      const char *fields[PLAYLIST_ENTRIES];
+
+      fields[0] = entry->path;
+      fields[1] = entry->label;
+      fields[2] = entry->core_path;
+      fields[3] = entry->core_name;
+      fields[4] = entry->crc32;
+      fields[5] = entry->db_name;
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+      {
+         size_t len;
+
+         if (string_is_empty(fields[j]))
+         {
+            *offs++ = 0;
+            continue;
+         }
+
+         len     = strlen(fields[j]) + 1;
+         *offs++ = swap_if_big32((uint32_t)pool_size);
+         memcpy(pool + pool_size, fields[j], len);
+         pool_size += len;
+      }
+   }
+
+   ((uint32_t*)buf)[3] = swap_if_big32((uint32_t)pool_size);
+
+   ret = filestream_write_file(playlist->conf_path, buf, size + pool_size);
+
+   free(buf);
+   return ret;
+}
+
+static bool playlist_write_file_text(playlist_t *playlist)
 {
    size_t i;
-   RFILE *file = NULL;
+   RFILE *file = filestream_open(playlist->conf_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const struct playlist_entry *entry =
+         &playlist->entries[PLAYLIST_POS(playlist, i)];
+
+      filestream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
+            entry->path    ? entry->path    : "",
+            entry->label   ? entry->label   : "",
+            entry->core_path,
+            entry->core_name,
+            entry->crc32   ? entry->crc32   : "",
+            entry->db_name ? entry->db_name : ""
+            );
+   }
+
+   filestream_close(file);
+   return true;
+}
+
+void playlist_write_file(playlist_t *playlist)
+{
+   bool ret;
 
    if (!playlist || !playlist->modified)
       return;
 
-   file = filestream_open(playlist->conf_path,
-         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (playlist_compact_format)
+      ret = playlist_write_file_compact(playlist);
+   else
+      ret = playlist_write_file_text(playlist);
 
-   if (!file)
+   if (!ret)
    {
       RARCH_ERR("Failed to write to playlist file: %s\n", playlist->conf_path);
       return;
    }
 
-   for (i = 0; i < playlist->size; i++)
-      filestream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
-            playlist->entries[i].path    ? playlist->entries[i].path    : "",
-            playlist->entries[i].label   ? playlist->entries[i].label   : "",
-            playlist->entries[i].core_path,
-            playlist->entries[i].core_name,
-            playlist->entries[i].crc32   ? playlist->entries[i].crc32   : "",
-            playlist->entries[i].db_name ? playlist->entries[i].db_name : ""
-            );
-
    playlist->modified = false;
 
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
-
-   filestream_close(file);
 }
 
 /**
@@ -441,16 +736,16 @@ void playlist_free(playlist_t *playlist)
    playlist->conf_path = NULL;
 
    for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry *entry = &playlist->entries[i];
-
-      if (entry)
-         playlist_free_entry(entry);
-   }
+      playlist_free_entry(playlist, &playlist->entries[i]);
 
    free(playlist->entries);
    playlist->entries = NULL;
 
+   if (playlist->pool)
+      free(playlist->pool);
+   if (playlist->index)
+      free(playlist->index);
+
    free(playlist);
 }
 
@@ -467,13 +762,9 @@ void playlist_clear(playlist_t *playlist)
       return;
 
    for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry *entry = &playlist->entries[i];
-
-      if (entry)
-         playlist_free_entry(entry);
-   }
-   playlist->size = 0;
+      playlist_free_entry(playlist, &playlist->entries[i]);
+   playlist->size        = 0;
+   playlist->index_dirty = true;
 }
 
 /**
@@ -490,71 +781,165 @@ size_t playlist_size(playlist_t *playlist)
    return playlist->size;
 }
 
+/* Points the fields of the next entry to the strings
+ * of @fields, entries without a core are skipped. */
+static void playlist_read_entry(playlist_t *playlist,
+      char **fields)
+{
+   struct playlist_entry *entry = NULL;
+
+   if (!*fields[2] || !*fields[3])
+      return;
 
-static bool playlist_read_file(
-      playlist_t *playlist, const char *path)
+   entry            = &playlist->entries[playlist->size++];
+
+   if (*fields[0])
+      entry->path      = fields[0];
+   if (*fields[1])
+      entry->label     = fields[1];
+
+   entry->core_path    = fields[2];
+   entry->core_name    = fields[3];
+   if (*fields[4])
+      entry->crc32     = fields[4];
+   if (*fields[5])
+      entry->db_name   = fields[5];
+}
+
+static void playlist_read_compact(playlist_t *playlist)
 {
-   unsigned i;
-   char buf[PLAYLIST_ENTRIES][1024];
-   intfstream_t *file = intfstream_open_file(
-         path, RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   size_t i, j;
+   size_t count, pool_size;
+   const uint32_t *offs = NULL;
+   char *pool           = NULL;
 
-   /* If playlist file does not exist,
-    * create an empty playlist instead.
-    */
-   if (!file)
-      return true;
+   if (playlist->pool_size < PLAYLIST_COMPACT_HEADER_LEN)
+      return;
+
+   count     = swap_if_big32(((const uint32_t*)playlist->pool)[2]);
+   pool_size = swap_if_big32(((const uint32_t*)playlist->pool)[3]);
+   offs      = (const uint32_t*)(playlist->pool + PLAYLIST_COMPACT_HEADER_LEN);
+
+   if (count > (playlist->pool_size - PLAYLIST_COMPACT_HEADER_LEN)
+         / (PLAYLIST_ENTRIES * sizeof(uint32_t)))
+      goto error;
+
+   pool = (char*)(offs + count * PLAYLIST_ENTRIES);
 
-   for (i = 0; i < PLAYLIST_ENTRIES; i++)
-      buf[i][0] = '\0';
+   /* Make sure all the strings are terminated. */
+   if (pool_size == 0 ||
+         pool_size != (size_t)(playlist->pool + playlist->pool_size - pool) ||
+         pool[0] != '\0' || pool[pool_size - 1] != '\0')
+      goto error;
 
-   for (playlist->size = 0; playlist->size < playlist->cap; )
+   for (i = 0; i < count && playlist->size < playlist->cap; i++)
+   {
+      char *fields[PLAYLIST_ENTRIES];
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+      {
+         uint32_t off = swap_if_big32(offs[i * PLAYLIST_ENTRIES + j]);
+         if (off >= pool_size)
+            goto error;
+         fields[j] = pool + off;
+      }
+
+      playlist_read_entry(playlist, fields);
+   }
+
+   return;
+
+error:
+   RARCH_ERR("Invalid playlist file: %s\n", playlist->conf_path);
+   for (i = 0; i < playlist->size; i++)
+      memset(&playlist->entries[i], 0, sizeof(struct playlist_entry));
+   playlist->size = 0;
+}
+
+static void playlist_read_text(playlist_t *playlist)
+{
+   char *line = playlist->pool;
+   char *end  = playlist->pool + playlist->pool_size;
+
+   while (playlist->size < playlist->cap)
    {
       unsigned i;
-      struct playlist_entry *entry     = NULL;
+      char *fields[PLAYLIST_ENTRIES];
+
       for (i = 0; i < PLAYLIST_ENTRIES; i++)
       {
-         char *last  = NULL;
-         *buf[i]     = '\0';
+         char *last = NULL;
+         char *eol  = NULL;
 
-         if (!intfstream_gets(file, buf[i], sizeof(buf[i])))
-            goto end;
+         if (line >= end)
+            return;
 
-         /* Read playlist entry and terminate string with NUL character
+         eol  = (char*)memchr(line, '\n', end - line);
+         if (!eol)
+            eol = end;
+         *eol = '\0';
+
+         /* Terminate string with NUL character
           * regardless of Windows or Unix line endings
           */
-         if((last = strrchr(buf[i], '\r')))
-            *last = '\0';
-         else if((last = strrchr(buf[i], '\n')))
+         if ((last = strrchr(line, '\r')))
             *last = '\0';
+
+         fields[i] = line;
+         line      = eol + 1;
       }
 
-      entry = &playlist->entries[playlist->size];
+      playlist_read_entry(playlist, fields);
+   }
+}
 
-      if (!*buf[2] || !*buf[3])
-         continue;
+static bool playlist_read_file(
+      playlist_t *playlist, const char *path)
+{
+   size_t i;
+   void *buf   = NULL;
+   int64_t len = 0;
 
-      if (*buf[0])
-         entry->path      = strdup(buf[0]);
-      if (*buf[1])
-         entry->label     = strdup(buf[1]);
-
-      entry->core_path    = strdup(buf[2]);
-      entry->core_name    = strdup(buf[3]);
-      if (*buf[4])
-         entry->crc32     = strdup(buf[4]);
-      if (*buf[5])
-         entry->db_name   = strdup(buf[5]);
-      playlist->size++;
+   /* If playlist file does not exist,
+    * create an empty playlist instead.
+    */
+   if (!path_is_valid(path))
+      return true;
+
+   /* The file is loaded at once and the entries point into it,
+    * strings are only allocated for the entries that change. */
+   if (!filestream_read_file(path, &buf, &len))
+      return true;
+
+   playlist->pool      = (char*)buf;
+   playlist->pool_size = (size_t)len;
+
+   if (playlist->pool_size >= PLAYLIST_COMPACT_MAGIC_LEN &&
+         !memcmp(playlist->pool, PLAYLIST_COMPACT_MAGIC,
+            PLAYLIST_COMPACT_MAGIC_LEN))
+      playlist_read_compact(playlist);
+   else
+      playlist_read_text(playlist);
+
+   /* Entries are read from the top of the playlist. */
+   for (i = 0; i < playlist->size / 2; i++)
+   {
+      struct playlist_entry tmp                 = playlist->entries[i];
+      playlist->entries[i]                      =
+         playlist->entries[playlist->size - 1 - i];
+      playlist->entries[playlist->size - 1 - i] = tmp;
    }
 
-end:
-   intfstream_close(file);
-   free(file);
+   /* Leave room for the terminator filestream_read_file appends. */
+   playlist->pool_size++;
    return true;
 }
 
+void playlist_set_compact_format(bool compact)
+{
+   playlist_compact_format = compact;
+}
+
 void playlist_free_cached(void)
 {
    playlist_free(playlist_cached);
@@ -601,11 +986,16 @@ playlist_t *playlist_init(const char *path, size_t size)
       return NULL;
    }
 
-   playlist->modified  = false;
-   playlist->size      = 0;
-   playlist->cap       = size;
-   playlist->conf_path = strdup(path);
-   playlist->entries   = entries;
+   playlist->modified    = false;
+   playlist->index_dirty = true;
+   playlist->size        = 0;
+   playlist->cap         = size;
+   playlist->index_cap   = 0;
+   playlist->conf_path   = strdup(path);
+   playlist->pool        = NULL;
+   playlist->pool_size   = 0;
+   playlist->entries     = entries;
+   playlist->index       = NULL;
 
    playlist_read_file(playlist, path);
 
@@ -624,9 +1014,17 @@ static int playlist_qsort_func(const struct playlist_entry *a,
    return strcasecmp(a_label, b_label);
 }
 
+/* Entries are stored from the bottom, sort them in reverse. */
+static int playlist_qsort_func_reverse(const struct playlist_entry *a,
+      const struct playlist_entry *b)
+{
+   return playlist_qsort_func(b, a);
+}
+
 void playlist_qsort(playlist_t *playlist)
 {
    qsort(playlist->entries, playlist->size,
          sizeof(struct playlist_entry),
-         (int (*)(const void *, const void *))playlist_qsort_func);
+         (int (*)(const void *, const void *))playlist_qsort_func_reverse);
+   playlist->index_dirty = true;
 }
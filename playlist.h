@@ -129,6 +129,15 @@ void playlist_write_file(playlist_t *playlist);
 
 void playlist_qsort(playlist_t *playlist);
 
+/**
+ * playlist_set_compact_format:
+ * @compact             : Write playlists in the binary format.
+ *
+ * Sets the format used by playlist_write_file(). Playlists
+ * are read in either format.
+ **/
+void playlist_set_compact_format(bool compact);
+
 void playlist_free_cached(void);
 
 playlist_t *playlist_get_cached(void);
@@ -25,6 +25,7 @@
 #include <boolean.h>
 #include <queues/fifo_queue.h>
 #include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <file/config_file.h>
@@ -139,11 +140,52 @@ struct ff_video_info
 
    AVFormatContext *format;
 
+   /* Formats used by the scale workers. */
    struct scaler_ctx scaler;
-   struct SwsContext *sws;
    bool use_sws;
 };
 
+enum ff_frame_state
+{
+   FF_FRAME_FREE = 0,
+   /* Copied from the frontend, waiting for a scale worker. */
+   FF_FRAME_QUEUED,
+   FF_FRAME_CONVERTING,
+   /* Ready to be encoded. */
+   FF_FRAME_CONVERTED
+};
+
+struct ff_frame
+{
+   enum ff_frame_state state;
+   /* Tightly packed copy of the frame, data points to buf. */
+   struct record_video_data vid;
+   uint8_t *buf;
+
+   AVFrame *conv_frame;
+   uint8_t *conv_frame_buf;
+};
+
+struct ff_scale_worker
+{
+   struct ffmpeg *handle;
+   sthread_t *thread;
+
+   /* Each worker has its own contexts, they are not thread-safe. */
+   struct scaler_ctx scaler;
+   struct SwsContext *sws;
+};
+
+/* How long the frontend had to wait for the encoder. */
+struct ff_pipeline_stats
+{
+   uint64_t frames;
+   uint64_t dupes;
+   uint64_t stalls;
+   retro_time_t stall_time;
+   unsigned max_pending;
+};
+
 struct ff_audio_info
 {
    AVCodecContext *codec;
@@ -198,6 +240,8 @@ struct ff_config_param
    char format[64];
    enum PixelFormat out_pix_fmt;
    unsigned threads;
+   /* 0 picks a number based on the number of CPU cores. */
+   unsigned scale_threads;
    unsigned frame_drop_ratio;
    unsigned sample_rate;
    float scale_factor;
@@ -215,6 +259,9 @@ struct ff_config_param
    AVDictionary *audio_opts;
 };
 
+#define FF_FRAME_POOL_SIZE 8
+#define FF_MAX_SCALE_THREADS 4
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
@@ -224,16 +271,26 @@ typedef struct ffmpeg
 
    struct record_params params;
 
+   /* Protects the frame pool and the audio FIFO,
+    * cond is broadcast whenever either changes. */
    scond_t *cond;
-   slock_t *cond_lock;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
    sthread_t *thread;
 
-   volatile bool alive;
-   volatile bool can_sleep;
+   /* Frame n lives in frames[n % FF_FRAME_POOL_SIZE].
+    * Frames are encoded in order, so a slot is free again
+    * once the frame before it in the ring was encoded. */
+   struct ff_frame frames[FF_FRAME_POOL_SIZE];
+   uint64_t frame_push;
+   uint64_t frame_encode;
+
+   struct ff_scale_worker workers[FF_MAX_SCALE_THREADS];
+   unsigned num_workers;
+
+   struct ff_pipeline_stats stats;
+
+   bool alive;
 } ffmpeg_t;
 
 AVFormatContext *ctx;
@@ -409,9 +466,32 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
    return true;
 }
 
+static bool ffmpeg_alloc_conv_frame(ffmpeg_t *handle,
+      AVFrame **frame, uint8_t **frame_buf)
+{
+   struct ff_video_info *video = &handle->video;
+   struct record_params *param = &handle->params;
+   size_t size                 = avpicture_get_size(video->pix_fmt,
+         param->out_width, param->out_height);
+
+   *frame_buf = (uint8_t*)av_malloc(size);
+   *frame     = av_frame_alloc();
+
+   if (!*frame_buf || !*frame)
+      return false;
+
+   avpicture_fill((AVPicture*)*frame, *frame_buf,
+         video->pix_fmt, param->out_width, param->out_height);
+
+   (*frame)->width  = param->out_width;
+   (*frame)->height = param->out_height;
+   (*frame)->format = video->pix_fmt;
+
+   return true;
+}
+
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
-   size_t size;
    struct ff_config_param *params  = &handle->config;
    struct ff_video_info *video     = &handle->video;
    struct record_params *param     = &handle->params;
@@ -533,19 +613,9 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    video->frame_drop_ratio = params->frame_drop_ratio;
 
-   size = avpicture_get_size(video->pix_fmt, param->out_width,
-         param->out_height);
-   video->conv_frame_buf = (uint8_t*)av_malloc(size);
-   video->conv_frame = av_frame_alloc();
-
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
-
-   video->conv_frame->width  = param->out_width;
-   video->conv_frame->height = param->out_height;
-   video->conv_frame->format = video->pix_fmt;
-
-   return true;
+   /* Holds the last encoded frame, dupes are encoded from it. */
+   return ffmpeg_alloc_conv_frame(handle,
+         &video->conv_frame, &video->conv_frame_buf);
 }
 
 static bool ffmpeg_init_config_common(struct ff_config_param *params, unsigned preset)
@@ -603,7 +673,9 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params, unsigned p
          av_dict_set(&params->audio_opts, "audio_global_quality", "100", 0);
          break;
       case RECORD_CONFIG_TYPE_RECORDING_LOSSLESS_QUALITY:
-         params->threads              = 1;
+         /* Let libavcodec pick, a single x264 thread can't
+          * keep up with lossless encoding at high resolutions. */
+         params->threads              = 0;
          params->frame_drop_ratio     = 1;
          params->audio_enable         = true;
          params->audio_global_quality = 100;
@@ -716,6 +788,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
          sizeof(params->format));
 
    config_get_uint(params->conf, "threads", &params->threads);
+   config_get_uint(params->conf, "scale_threads", &params->scale_threads);
 
    if (!config_get_uint(params->conf, "frame_drop_ratio",
             &params->frame_drop_ratio) || !params->frame_drop_ratio)
@@ -816,68 +889,130 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
 #define MAX_FRAMES 32
 
 static void ffmpeg_thread(void *data);
+static void ffmpeg_scale_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
 {
+   unsigned i;
+   unsigned num_workers  = handle->config.scale_threads;
+   size_t frame_buf_size = handle->params.fb_width *
+      handle->params.fb_height * handle->video.pix_size;
+
+   if (!num_workers)
+   {
+      /* Leave a core to the frontend and one to the encoder. */
+      unsigned cores = cpu_features_get_core_amount();
+      num_workers    = cores > 2 ? cores - 2 : 1;
+   }
+   if (num_workers > FF_MAX_SCALE_THREADS)
+      num_workers = FF_MAX_SCALE_THREADS;
+
    handle->lock = slock_new();
-   handle->cond_lock = slock_new();
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
+
+   if (!handle->lock || !handle->cond || !handle->audio_fifo)
+      return false;
+
+   for (i = 0; i < FF_FRAME_POOL_SIZE; i++)
+   {
+      struct ff_frame *frame = &handle->frames[i];
+
+      frame->buf = (uint8_t*)av_malloc(frame_buf_size);
+      if (!frame->buf || !ffmpeg_alloc_conv_frame(handle,
+               &frame->conv_frame, &frame->conv_frame_buf))
+         return false;
+   }
 
    handle->alive = true;
-   handle->can_sleep = true;
-   handle->thread = sthread_create(ffmpeg_thread, handle);
 
-   retro_assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+   for (i = 0; i < num_workers; i++)
+   {
+      struct ff_scale_worker *worker = &handle->workers[i];
+
+      worker->handle         = handle;
+      worker->scaler.in_fmt  = handle->video.scaler.in_fmt;
+      worker->scaler.out_fmt = handle->video.scaler.out_fmt;
+      worker->thread         = sthread_create(ffmpeg_scale_thread, worker);
+
+      if (!worker->thread)
+         break;
+   }
+
+   handle->num_workers = i;
+   handle->thread      = sthread_create(ffmpeg_thread, handle);
+
+   if (!handle->num_workers || !handle->thread)
+      return false;
+
+   RARCH_LOG("[FFmpeg]: Using %u scale thread(s).\n", handle->num_workers);
 
    return true;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
+   unsigned i;
+
+   if (!handle->lock)
       return;
 
-   slock_lock(handle->cond_lock);
+   slock_lock(handle->lock);
    handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
-
-   scond_signal(handle->cond);
-   sthread_join(handle->thread);
-
-   slock_free(handle->lock);
-   slock_free(handle->cond_lock);
-   scond_free(handle->cond);
+   scond_broadcast(handle->cond);
+   slock_unlock(handle->lock);
 
+   if (handle->thread)
+      sthread_join(handle->thread);
    handle->thread = NULL;
+
+   for (i = 0; i < handle->num_workers; i++)
+   {
+      sthread_join(handle->workers[i].thread);
+      handle->workers[i].thread = NULL;
+   }
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
 {
+   unsigned i;
+
    if (handle->audio_fifo)
    {
       fifo_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
 
-   if (handle->attr_fifo)
+   for (i = 0; i < FF_FRAME_POOL_SIZE; i++)
    {
-      fifo_free(handle->attr_fifo);
-      handle->attr_fifo = NULL;
+      struct ff_frame *frame = &handle->frames[i];
+
+      av_free(frame->buf);
+      av_frame_free(&frame->conv_frame);
+      av_free(frame->conv_frame_buf);
+
+      frame->buf            = NULL;
+      frame->conv_frame_buf = NULL;
    }
 
-   if (handle->video_fifo)
+   for (i = 0; i < FF_MAX_SCALE_THREADS; i++)
    {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
+      struct ff_scale_worker *worker = &handle->workers[i];
+
+      scaler_ctx_gen_reset(&worker->scaler);
+      if (worker->sws)
+         sws_freeContext(worker->sws);
+      worker->sws = NULL;
    }
+
+   if (handle->lock)
+      slock_free(handle->lock);
+   if (handle->cond)
+      scond_free(handle->cond);
+
+   handle->lock = NULL;
+   handle->cond = NULL;
 }
 
 static void ffmpeg_free(void *data)
@@ -908,9 +1043,6 @@ static void ffmpeg_free(void *data)
 
    scaler_ctx_gen_reset(&handle->video.scaler);
 
-   if (handle->video.sws)
-      sws_freeContext(handle->video.sws);
-
    if (handle->config.conf)
       config_file_free(handle->config.conf);
    if (handle->config.video_opts)
@@ -978,9 +1110,12 @@ static bool ffmpeg_push_video(void *data,
 {
    unsigned y;
    bool drop_frame;
-   struct record_video_data attr_data;
-   ffmpeg_t *handle = (ffmpeg_t*)data;
-   int       offset = 0;
+   unsigned pending;
+   retro_time_t stall_start = 0;
+   struct ff_frame *frame   = NULL;
+   ffmpeg_t *handle         = (ffmpeg_t*)data;
+   const uint8_t *src       = NULL;
+   uint8_t *dst             = NULL;
 
    if (!handle || !vid)
       return false;
@@ -993,52 +1128,66 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
+   slock_lock(handle->lock);
 
-      if (!handle->alive)
-         return false;
+   /* Only this thread hands out slots, so the frame
+    * can be filled in without holding the lock. */
+   frame = &handle->frames[handle->frame_push % FF_FRAME_POOL_SIZE];
 
-      if (avail >= sizeof(*vid))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   while (handle->alive && frame->state != FF_FRAME_FREE)
+   {
+      if (!stall_start)
+         stall_start = cpu_features_get_time_usec();
+      scond_wait(handle->cond, handle->lock);
+   }
 
-      slock_unlock(handle->cond_lock);
+   if (stall_start)
+   {
+      handle->stats.stalls++;
+      handle->stats.stall_time += cpu_features_get_time_usec() - stall_start;
    }
 
-   slock_lock(handle->lock);
+   slock_unlock(handle->lock);
+
+   if (!handle->alive)
+      return false;
 
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
+    * Dupes are encoded from the previous frame and not copied.
     */
-   attr_data = *vid;
+   frame->vid      = *vid;
+   frame->vid.data = frame->buf;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (frame->vid.is_dupe)
+      frame->vid.width = frame->vid.height = frame->vid.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+      frame->vid.pitch = frame->vid.width * handle->video.pix_size;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   src = (const uint8_t*)vid->data;
+   dst = frame->buf;
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+   if (frame->vid.pitch == vid->pitch)
+      memcpy(dst, src, frame->vid.pitch * frame->vid.height);
+   else
+      for (y = 0; y < frame->vid.height; y++,
+            src += vid->pitch, dst += frame->vid.pitch)
+         memcpy(dst, src, frame->vid.pitch);
+
+   slock_lock(handle->lock);
 
+   frame->state = frame->vid.is_dupe ? FF_FRAME_CONVERTED : FF_FRAME_QUEUED;
+   handle->frame_push++;
+
+   pending      = (unsigned)(handle->frame_push - handle->frame_encode);
+   if (pending > handle->stats.max_pending)
+      handle->stats.max_pending = pending;
+   handle->stats.frames++;
+   if (frame->vid.is_dupe)
+      handle->stats.dupes++;
+
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
@@ -1046,6 +1195,7 @@ static bool ffmpeg_push_video(void *data,
 static bool ffmpeg_push_audio(void *data,
       const struct record_audio_data *audio_data)
 {
+   size_t size;
    ffmpeg_t *handle = (ffmpeg_t*)data;
 
    if (!handle || !audio_data)
@@ -1054,38 +1204,22 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->audio_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
+   size = audio_data->frames * handle->params.channels * sizeof(int16_t);
 
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
-         break;
+   slock_lock(handle->lock);
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   while (handle->alive && fifo_write_avail(handle->audio_fifo) < size)
+      scond_wait(handle->cond, handle->lock);
 
-      slock_unlock(handle->cond_lock);
+   if (!handle->alive)
+   {
+      slock_unlock(handle->lock);
+      return false;
    }
 
-   slock_lock(handle->lock);
-   fifo_write(handle->audio_fifo, audio_data->data,
-         audio_data->frames * handle->params.channels * sizeof(int16_t));
+   fifo_write(handle->audio_fifo, audio_data->data, size);
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
@@ -1126,8 +1260,10 @@ static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
 }
 
 static void ffmpeg_scale_input(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      struct ff_scale_worker *worker, struct ff_frame *frame)
 {
+   const struct record_video_data *vid = &frame->vid;
+   AVFrame *conv_frame                 = frame->conv_frame;
    /* Attempt to preserve more information if we scale down. */
    bool shrunk = handle->params.out_width < vid->width
       || handle->params.out_height < vid->height;
@@ -1136,25 +1272,25 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
    {
       int linesize = vid->pitch;
 
-      handle->video.sws = sws_getCachedContext(handle->video.sws,
+      worker->sws = sws_getCachedContext(worker->sws,
             vid->width, vid->height, handle->video.in_pix_fmt,
             handle->params.out_width, handle->params.out_height,
             handle->video.pix_fmt,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
-      sws_scale(handle->video.sws, (const uint8_t* const*)&vid->data,
-            &linesize, 0, vid->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+      sws_scale(worker->sws, (const uint8_t* const*)&vid->data,
+            &linesize, 0, vid->height, conv_frame->data,
+            conv_frame->linesize);
    }
    else
    {
       video_frame_record_scale(
-            &handle->video.scaler,
-            handle->video.conv_frame->data[0],
+            &worker->scaler,
+            conv_frame->data[0],
             vid->data,
             handle->params.out_width,
             handle->params.out_height,
-            handle->video.conv_frame->linesize[0],
+            conv_frame->linesize[0],
             vid->width,
             vid->height,
             vid->pitch,
@@ -1163,12 +1299,22 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 }
 
 static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      struct ff_frame *frame)
 {
    AVPacket pkt;
 
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+   if (!frame->vid.is_dupe)
+   {
+      /* Keep the picture around for the dupes that follow,
+       * the converted frame of the slot gets reused. */
+      AVFrame *conv_frame           = handle->video.conv_frame;
+      uint8_t *conv_frame_buf       = handle->video.conv_frame_buf;
+
+      handle->video.conv_frame      = frame->conv_frame;
+      handle->video.conv_frame_buf  = frame->conv_frame_buf;
+      frame->conv_frame             = conv_frame;
+      frame->conv_frame_buf         = conv_frame_buf;
+   }
 
    handle->video.conv_frame->pts = handle->video.frame_cnt;
 
@@ -1451,11 +1597,10 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
    }
 }
 
+/* Called once the threads are stopped, so no locking. */
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    bool did_work;
-   void *video_buf = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1468,8 +1613,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    do
    {
-      struct record_video_data attr_buf;
-
       did_work = false;
 
       if (handle->config.audio_enable)
@@ -1488,13 +1631,17 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
+      if (handle->frame_encode != handle->frame_push)
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+         struct ff_frame *frame = &handle->frames[
+            handle->frame_encode % FF_FRAME_POOL_SIZE];
+
+         if (frame->state == FF_FRAME_QUEUED)
+            ffmpeg_scale_input(handle, &handle->workers[0], frame);
+
+         ffmpeg_push_video_thread(handle, frame);
+         frame->state = FF_FRAME_FREE;
+         handle->frame_encode++;
 
          did_work = true;
       }
@@ -1507,7 +1654,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1522,6 +1668,14 @@ static bool ffmpeg_finalize(void *data)
    /* Flush out data still in buffers (internal, and FFmpeg internal). */
    ffmpeg_flush_buffers(handle);
 
+   RARCH_LOG("[FFmpeg]: %llu frames (%llu dupes), at most %u queued, "
+         "%llu waits for the encoder (%.1f ms).\n",
+         (unsigned long long)handle->stats.frames,
+         (unsigned long long)handle->stats.dupes,
+         handle->stats.max_pending,
+         (unsigned long long)handle->stats.stalls,
+         handle->stats.stall_time / 1000.0);
+
    deinit_thread_buf(handle);
 
    /* Write final data. */
@@ -1532,83 +1686,117 @@ static bool ffmpeg_finalize(void *data)
    return true;
 }
 
+static void ffmpeg_scale_thread(void *data)
+{
+   struct ff_scale_worker *worker = (struct ff_scale_worker*)data;
+   ffmpeg_t *ff                   = worker->handle;
+
+   slock_lock(ff->lock);
+
+   for (;;)
+   {
+      uint64_t i;
+      struct ff_frame *frame = NULL;
+
+      /* Pick the oldest frame nobody is working on. */
+      for (i = ff->frame_encode; i < ff->frame_push; i++)
+      {
+         if (ff->frames[i % FF_FRAME_POOL_SIZE].state == FF_FRAME_QUEUED)
+         {
+            frame = &ff->frames[i % FF_FRAME_POOL_SIZE];
+            break;
+         }
+      }
+
+      if (!frame)
+      {
+         if (!ff->alive)
+            break;
+         scond_wait(ff->cond, ff->lock);
+         continue;
+      }
+
+      frame->state = FF_FRAME_CONVERTING;
+      slock_unlock(ff->lock);
+
+      ffmpeg_scale_input(ff, worker, frame);
+
+      slock_lock(ff->lock);
+      frame->state = FF_FRAME_CONVERTED;
+      scond_broadcast(ff->cond);
+   }
+
+   slock_unlock(ff->lock);
+}
+
 static void ffmpeg_thread(void *data)
 {
    size_t audio_buf_size;
    void *audio_buf = NULL;
    ffmpeg_t *ff    = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-
-   retro_assert(video_buf);
 
    audio_buf_size = ff->config.audio_enable ?
       (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
    audio_buf      = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
 
+   slock_lock(ff->lock);
+
    while (ff->alive)
    {
-      struct record_video_data attr_buf;
+      struct ff_frame *frame = NULL;
+      bool avail_audio       = false;
 
-      bool avail_video = false;
-      bool avail_audio = false;
-
-      slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      if (ff->frame_encode != ff->frame_push)
+      {
+         frame = &ff->frames[ff->frame_encode % FF_FRAME_POOL_SIZE];
+         if (frame->state != FF_FRAME_CONVERTED)
+            frame = NULL;
+      }
 
-      if (ff->config.audio_enable)
+      if (audio_buf)
          if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
             avail_audio = true;
-      slock_unlock(ff->lock);
 
-      if (!avail_video && !avail_audio)
+      if (!frame && !avail_audio)
       {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
-
-         slock_unlock(ff->cond_lock);
+         scond_wait(ff->cond, ff->lock);
+         continue;
       }
 
-      if (avail_video && video_buf)
+      if (avail_audio)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+         scond_broadcast(ff->cond);
       }
 
-      if (avail_audio && audio_buf)
+      /* The frame isn't touched by anyone else until it's freed. */
+      slock_unlock(ff->lock);
+
+      if (frame)
+         ffmpeg_push_video_thread(ff, frame);
+
+      if (avail_audio)
       {
          struct record_audio_data aud = {0};
 
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
          aud.frames = ff->audio.codec->frame_size;
          aud.data = audio_buf;
 
          ffmpeg_push_audio_thread(ff, &aud, true);
       }
+
+      slock_lock(ff->lock);
+
+      if (frame)
+      {
+         frame->state = FF_FRAME_FREE;
+         ff->frame_encode++;
+         scond_broadcast(ff->cond);
+      }
    }
 
-   av_free(video_buf);
+   slock_unlock(ff->lock);
+
    av_free(audio_buf);
 }
 
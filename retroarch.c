@@ -1860,6 +1860,9 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
 #ifdef HAVE_THREADS
             settings_t *settings = config_get_ptr();
             bool threaded_enable = settings->bools.threaded_data_runloop_enable;
+
+            task_queue_set_workers(
+                  settings->uints.threaded_data_runloop_workers);
 #else
             bool threaded_enable = false;
 #endif
@@ -3161,13 +3164,20 @@ static enum runloop_state runloop_check_state(
    if (!cheevos_hardcore_active)
 #endif
    {
+      static struct retro_perf_counter runloop_perf_rewind;
       char s[128];
+      bool rewinding;
       unsigned t = 0;
 
       s[0] = '\0';
 
-      if (state_manager_check_rewind(BIT256_GET(current_input, RARCH_REWIND),
-            settings->uints.rewind_granularity, runloop_paused, s, sizeof(s), &t))
+      performance_counter_init(runloop_perf_rewind, "state_manager_check_rewind");
+      performance_counter_start_plus(runloop_perfcnt_enable, runloop_perf_rewind);
+      rewinding = state_manager_check_rewind(BIT256_GET(current_input, RARCH_REWIND),
+            settings->uints.rewind_granularity, runloop_paused, s, sizeof(s), &t);
+      performance_counter_stop_plus(runloop_perfcnt_enable, runloop_perf_rewind);
+
+      if (rewinding)
          runloop_msg_queue_push(s, 0, t, true);
    }
 
@@ -3393,6 +3403,9 @@ void runloop_unset(enum runloop_action action)
 int runloop_iterate(unsigned *sleep_ms)
 {
    unsigned i;
+   enum runloop_state state;
+   static struct retro_perf_counter runloop_perf_check_state;
+   static struct retro_perf_counter runloop_perf_frame;
    bool input_nonblock_state                    = input_driver_is_nonblock_state();
    settings_t *settings                         = config_get_ptr();
    unsigned max_users                           = *(input_driver_get_uint(INPUT_ACTION_MAX_USERS));
@@ -3428,11 +3441,12 @@ int runloop_iterate(unsigned *sleep_ms)
       runloop_frame_time.callback(delta);
    }
 
-   switch ((enum runloop_state)
-         runloop_check_state(
-            settings,
-            input_nonblock_state,
-            sleep_ms))
+   performance_counter_init(runloop_perf_check_state, "runloop_check_state");
+   performance_counter_start_plus(runloop_perfcnt_enable, runloop_perf_check_state);
+   state = runloop_check_state(settings, input_nonblock_state, sleep_ms);
+   performance_counter_stop_plus(runloop_perfcnt_enable, runloop_perf_check_state);
+
+   switch (state)
    {
       case RUNLOOP_STATE_QUIT:
          frame_limit_last_time = 0.0;
@@ -3457,6 +3471,9 @@ int runloop_iterate(unsigned *sleep_ms)
          break;
    }
 
+   performance_counter_init(runloop_perf_frame, "runloop_frame");
+   performance_counter_start_plus(runloop_perfcnt_enable, runloop_perf_frame);
+
    if (runloop_autosave)
       autosave_lock();
 
@@ -3488,7 +3505,9 @@ int runloop_iterate(unsigned *sleep_ms)
       && !netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL)
 #endif
       )
-      run_ahead(settings->uints.run_ahead_frames, settings->bools.run_ahead_secondary_instance);
+      run_ahead(settings->uints.run_ahead_frames,
+            settings->bools.run_ahead_secondary_instance,
+            settings->bools.run_ahead_state_pool);
    else
 #endif
       core_run();
@@ -3499,6 +3518,8 @@ int runloop_iterate(unsigned *sleep_ms)
 #endif
    cheat_manager_apply_retro_cheats() ;
 
+   command_watch_ram_push();
+
 #ifdef HAVE_DISCORD
    if (discord_is_inited)
    {
@@ -3527,6 +3548,11 @@ int runloop_iterate(unsigned *sleep_ms)
    if (runloop_autosave)
       autosave_unlock();
 
+   performance_counter_stop_plus(runloop_perfcnt_enable, runloop_perf_frame);
+
+   if (runloop_perfcnt_enable)
+      rarch_perf_sample_frame();
+
    /* Condition for max speed x0.0 when vrr_runloop is off to skip that part */
    if (settings->floats.fastforward_ratio || settings->bools.vrr_runloop_enable)
       end:
@@ -4,8 +4,9 @@
 
 #include <boolean.h>
 
+#include <memalign.h>
+
 #include "dirty_input.h"
-#include "mylist.h"
 #include "secondary_core.h"
 #include "run_ahead.h"
 
@@ -14,11 +15,12 @@
 #include "../audio/audio_driver.h"
 #include "../gfx/video_driver.h"
 #include "../configuration.h"
+#include "../performance_counters.h"
 #include "../retroarch.h"
 
 static bool runahead_create(void);
-static bool runahead_save_state(void);
-static bool runahead_load_state(void);
+static bool runahead_save_state(unsigned slot);
+static bool runahead_load_state(unsigned slot);
 static bool runahead_load_state_secondary(void);
 static bool runahead_run_secondary(void);
 static void runahead_suspend_audio(void);
@@ -35,67 +37,66 @@ static bool core_run_use_last_input(void);
 static size_t runahead_save_state_size = 0;
 static bool runahead_save_state_size_known = false;
 
-/* Save State List for Run Ahead */
-static MyList *runahead_save_state_list;
+/* State Pool for Run Ahead
+ *
+ * Savestates are serialized straight into slots of a single
+ * page-aligned arena, which is allocated once and reused for
+ * the whole session. */
+#define RUNAHEAD_POOL_ALIGN 4096
 
-static void *runahead_save_state_alloc(void)
+enum runahead_slot
 {
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)
-      malloc(sizeof(retro_ctx_serialize_info_t));
-
-   if (!savestate)
-      return NULL;
-
-   savestate->data          = NULL;
-   savestate->data_const    = NULL;
-   savestate->size          = 0;
+   /* State after the last real frame. */
+   RUNAHEAD_SLOT_REAL = 0,
+   /* State after the last frame that was shown. */
+   RUNAHEAD_SLOT_PREDICTED,
+   RUNAHEAD_SLOT_COUNT
+};
 
-   if (runahead_save_state_size > 0 && runahead_save_state_size_known)
-   {
-      savestate->data       = malloc(runahead_save_state_size);
-      savestate->data_const = savestate->data;
-      savestate->size       = runahead_save_state_size;
-   }
+static uint8_t *runahead_pool_arena     = NULL;
+static size_t runahead_pool_slot_size   = 0;
+static bool runahead_predicted_valid    = false;
+static int runahead_predicted_count     = 0;
 
-   return savestate;
-}
+static struct retro_perf_counter runahead_perf_save;
+static struct retro_perf_counter runahead_perf_load;
+static struct retro_perf_counter runahead_perf_hidden_run;
 
-static void runahead_save_state_free(void *state)
+static void *runahead_pool_slot(unsigned slot)
 {
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)state;
-   if (!savestate)
-      return;
-   free(savestate->data);
-   free(savestate);
+   return runahead_pool_arena + slot * runahead_pool_slot_size;
 }
 
-static void runahead_save_state_list_init(size_t saveStateSize)
+static bool runahead_pool_init(size_t save_state_size)
 {
-   runahead_save_state_size = saveStateSize;
+   runahead_save_state_size       = save_state_size;
    runahead_save_state_size_known = true;
-   mylist_create(&runahead_save_state_list, 16,
-         runahead_save_state_alloc, runahead_save_state_free);
+   runahead_predicted_valid       = false;
+
+   if (!save_state_size)
+      return false;
+
+   runahead_pool_slot_size = (save_state_size + RUNAHEAD_POOL_ALIGN - 1)
+      & ~(size_t)(RUNAHEAD_POOL_ALIGN - 1);
+   runahead_pool_arena     = (uint8_t*)memalign_alloc(RUNAHEAD_POOL_ALIGN,
+         runahead_pool_slot_size * RUNAHEAD_SLOT_COUNT);
+
+   return runahead_pool_arena != NULL;
 }
 
-static void runahead_save_state_list_destroy(void)
+static void runahead_pool_destroy(void)
 {
-   mylist_destroy(&runahead_save_state_list);
+   if (runahead_pool_arena)
+      memalign_free(runahead_pool_arena);
+   runahead_pool_arena      = NULL;
+   runahead_pool_slot_size  = 0;
+   runahead_predicted_valid = false;
 }
 
-#if 0
-static void runahead_save_state_list_rotate(void)
+static bool runahead_perfcnt_enabled(void)
 {
-   int i;
-   void *element;
-   void *firstElement;
-   firstElement = runahead_save_state_list->data[0];
-   for (i = 1; i < runahead_save_state_list->size; i++)
-      runahead_save_state_list->data[i - 1] =
-         runahead_save_state_list->data[i];
-   runahead_save_state_list->data[runahead_save_state_list->size - 1] =
-      firstElement;
+   return rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL);
 }
-#endif
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
 
@@ -174,6 +175,8 @@ static void runahead_clear_variables(void)
    runahead_secondary_core_available = true;
    runahead_force_input_dirty        = true;
    runahead_last_frame_count         = 0;
+   runahead_predicted_valid          = false;
+   runahead_predicted_count          = 0;
 }
 
 static uint64_t runahead_get_frame_count()
@@ -196,7 +199,84 @@ static void runahead_check_for_gui(void)
    runahead_last_frame_count = frame_count;
 }
 
-void run_ahead(int runahead_count, bool useSecondary)
+static void runahead_hidden_run(void)
+{
+   bool perfcnt = runahead_perfcnt_enabled();
+
+   performance_counter_init(runahead_perf_hidden_run, "runahead_hidden_run");
+   performance_counter_start_plus(perfcnt, runahead_perf_hidden_run);
+   core_run_use_last_input();
+   performance_counter_stop_plus(perfcnt, runahead_perf_hidden_run);
+}
+
+/* Single instance run-ahead that keeps the state of the last shown
+ * frame around. As long as the input does not change, that state is
+ * exactly what the hidden frames would produce again, so only one
+ * frame has to be run ahead instead of runahead_count - 1. */
+static bool run_ahead_pooled(int runahead_count)
+{
+   int frame_number;
+   bool reuse;
+
+   runahead_suspend_audio();
+   runahead_suspend_video();
+   core_run();
+   runahead_resume_video();
+   runahead_resume_audio();
+
+   reuse = runahead_predicted_valid
+      && runahead_predicted_count == runahead_count
+      && !input_is_dirty
+      && !runahead_force_input_dirty;
+   input_is_dirty = false;
+
+   if (!runahead_save_state(RUNAHEAD_SLOT_REAL))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
+      return false;
+   }
+
+   if (reuse)
+   {
+      if (!runahead_load_state(RUNAHEAD_SLOT_PREDICTED))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true);
+         return false;
+      }
+   }
+   else
+   {
+      for (frame_number = 1; frame_number < runahead_count; frame_number++)
+      {
+         runahead_suspend_audio();
+         runahead_suspend_video();
+         runahead_hidden_run();
+         runahead_resume_video();
+         runahead_resume_audio();
+      }
+   }
+
+   core_run_use_last_input();
+
+   if (!runahead_save_state(RUNAHEAD_SLOT_PREDICTED))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
+      return false;
+   }
+
+   runahead_predicted_valid = true;
+   runahead_predicted_count = runahead_count;
+
+   if (!runahead_load_state(RUNAHEAD_SLOT_REAL))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true);
+      return false;
+   }
+
+   return true;
+}
+
+void run_ahead(int runahead_count, bool useSecondary, bool use_pool)
 {
    int frame_number        = 0;
    bool last_frame         = false;
@@ -233,45 +313,55 @@ void run_ahead(int runahead_count, bool useSecondary)
 
    if (!useSecondary || !have_dynamic || !runahead_secondary_core_available)
    {
-      /* TODO: multiple savestates for higher performance 
-       * when not using secondary core */
-      for (frame_number = 0; frame_number <= runahead_count; frame_number++)
+      if (use_pool && runahead_count > 1)
       {
-         last_frame      = frame_number == runahead_count;
-         suspended_frame = !last_frame;
+         if (!run_ahead_pooled(runahead_count))
+            return;
+      }
+      else
+      {
+         runahead_predicted_valid = false;
 
-         if (suspended_frame)
+         for (frame_number = 0; frame_number <= runahead_count; frame_number++)
          {
-            runahead_suspend_audio();
-            runahead_suspend_video();
-         }
+            last_frame      = frame_number == runahead_count;
+            suspended_frame = !last_frame;
 
-         if (frame_number == 0)
-            core_run();
-         else
-            core_run_use_last_input();
+            if (suspended_frame)
+            {
+               runahead_suspend_audio();
+               runahead_suspend_video();
+            }
 
-         if (suspended_frame)
-         {
-            runahead_resume_video();
-            runahead_resume_audio();
-         }
+            if (frame_number == 0)
+               core_run();
+            else if (suspended_frame)
+               runahead_hidden_run();
+            else
+               core_run_use_last_input();
 
-         if (frame_number == 0)
-         {
-            if (!runahead_save_state())
+            if (suspended_frame)
             {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
-               return;
+               runahead_resume_video();
+               runahead_resume_audio();
             }
-         }
 
-         if (last_frame)
-         {
-            if (!runahead_load_state())
+            if (frame_number == 0)
             {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true);
-               return;
+               if (!runahead_save_state(RUNAHEAD_SLOT_REAL))
+               {
+                  runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
+                  return;
+               }
+            }
+
+            if (last_frame)
+            {
+               if (!runahead_load_state(RUNAHEAD_SLOT_REAL))
+               {
+                  runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true);
+                  return;
+               }
             }
          }
       }
@@ -297,7 +387,7 @@ void run_ahead(int runahead_count, bool useSecondary)
       {
          input_is_dirty       = false;
 
-         if (!runahead_save_state())
+         if (!runahead_save_state(RUNAHEAD_SLOT_REAL))
          {
             runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
             return;
@@ -330,10 +420,24 @@ void run_ahead(int runahead_count, bool useSecondary)
    runahead_force_input_dirty = false;
 }
 
+/**
+ * runahead_invalidate_prediction:
+ *
+ * Drops the kept state of the last shown frame and makes the next
+ * frame run all hidden frames again. Has to be called whenever the
+ * core state changes outside of run-ahead, e.g. on load state,
+ * reset, cheat or core option changes.
+ **/
+void runahead_invalidate_prediction(void)
+{
+   runahead_predicted_valid   = false;
+   runahead_force_input_dirty = true;
+}
+
 static void runahead_error(void)
 {
    runahead_available = false;
-   runahead_save_state_list_destroy();
+   runahead_pool_destroy();
    remove_hooks();
    runahead_save_state_size = 0;
    runahead_save_state_size_known = true;
@@ -347,10 +451,9 @@ static bool runahead_create(void)
    core_serialize_size(&info);
    unset_fast_savestate();
 
-   runahead_save_state_list_init(info.size);
    runahead_video_driver_is_active = video_driver_is_active();
 
-   if (runahead_save_state_size == 0 || !runahead_save_state_size_known)
+   if (!runahead_pool_init(info.size))
    {
       runahead_error();
       return false;
@@ -358,21 +461,29 @@ static bool runahead_create(void)
 
    add_hooks();
    runahead_force_input_dirty = true;
-   mylist_resize(runahead_save_state_list, 1, true);
    return true;
 }
 
-static bool runahead_save_state(void)
+static bool runahead_save_state(unsigned slot)
 {
-   bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info;
-   if (!runahead_save_state_list)
+   retro_ctx_serialize_info_t serialize_info;
+   bool okay          = false;
+   bool perfcnt       = runahead_perfcnt_enabled();
+
+   if (!runahead_pool_arena)
       return false;
-   serialize_info =
-      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[0];
+
+   serialize_info.data       = runahead_pool_slot(slot);
+   serialize_info.data_const = serialize_info.data;
+   serialize_info.size       = runahead_save_state_size;
+
+   performance_counter_init(runahead_perf_save, "runahead_save");
+   performance_counter_start_plus(perfcnt, runahead_perf_save);
    set_fast_savestate();
-   okay = core_serialize(serialize_info);
+   okay = core_serialize(&serialize_info);
    unset_fast_savestate();
+   performance_counter_stop_plus(perfcnt, runahead_perf_save);
+
    if (!okay)
    {
       runahead_error();
@@ -381,20 +492,22 @@ static bool runahead_save_state(void)
    return true;
 }
 
-static bool runahead_load_state(void)
+static bool runahead_load_state(unsigned slot)
 {
-   bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      runahead_save_state_list->data[0];
-   bool last_dirty                            = input_is_dirty;
+   bool okay          = false;
+   bool last_dirty    = input_is_dirty;
+   bool perfcnt       = runahead_perfcnt_enabled();
 
+   performance_counter_init(runahead_perf_load, "runahead_load");
+   performance_counter_start_plus(perfcnt, runahead_perf_load);
    set_fast_savestate();
    /* calling core_unserialize has side effects with 
     * netplay (it triggers transmitting your save state)
       call retro_unserialize directly from the core instead */
    okay = current_core.retro_unserialize(
-         serialize_info->data_const, serialize_info->size);
+         runahead_pool_slot(slot), runahead_save_state_size);
    unset_fast_savestate();
+   performance_counter_stop_plus(perfcnt, runahead_perf_load);
    input_is_dirty = last_dirty;
 
    if (!okay)
@@ -405,13 +518,12 @@ static bool runahead_load_state(void)
 
 static bool runahead_load_state_secondary(void)
 {
-   bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[0];
+   bool okay = false;
 
    set_fast_savestate();
    okay = secondary_core_deserialize(
-         serialize_info->data_const, (int)serialize_info->size);
+         runahead_pool_slot(RUNAHEAD_SLOT_REAL),
+         (int)runahead_save_state_size);
    unset_fast_savestate();
 
    if (!okay)
@@ -426,7 +538,9 @@ static bool runahead_load_state_secondary(void)
 
 static bool runahead_run_secondary(void)
 {
-   if (!secondary_core_run_use_last_input())
+   bool okay = secondary_core_run_use_last_input();
+
+   if (!okay)
    {
       runahead_secondary_core_available = false;
       return false;
@@ -459,7 +573,7 @@ static void runahead_resume_video(void)
 
 void runahead_destroy(void)
 {
-   runahead_save_state_list_destroy();
+   runahead_pool_destroy();
    remove_hooks();
    runahead_clear_variables();
 }
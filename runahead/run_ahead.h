@@ -10,7 +10,9 @@ RETRO_BEGIN_DECLS
 
 void runahead_destroy(void);
 
-void run_ahead(int runAheadCount, bool useSecondary);
+void run_ahead(int runAheadCount, bool useSecondary, bool use_pool);
+
+void runahead_invalidate_prediction(void);
 
 bool want_fast_savestate(void);
 bool get_hard_disable_audio(void);
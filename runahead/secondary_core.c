@@ -1,5 +1,6 @@
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
 
+#include <ctype.h>
 #include <string.h>
 #include <time.h>
 
@@ -9,11 +10,25 @@
 #endif
 #endif
 
+#if defined(__linux__) && !defined(ANDROID)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#if defined(__NR_memfd_create)
+#define HAVE_SECONDARY_CORE_MEMFD
+#endif
+#endif
+
 #include <boolean.h>
+#include <encodings/crc32.h>
 #include <encodings/utf.h>
 #include <dynamic/dylib.h>
 #include <file/file_path.h>
+#include <lists/dir_list.h>
 #include <streams/file_stream.h>
+#include <string/stdstring.h>
 
 #include "mem_util.h"
 
@@ -28,6 +43,12 @@
 static int port_map[16];
 
 static char *secondary_library_path;
+/* Set if secondary_library_path is a one-off copy
+ * that has to be deleted with the secondary core. */
+static bool secondary_library_delete;
+#ifdef HAVE_SECONDARY_CORE_MEMFD
+static int secondary_library_fd = -1;
+#endif
 static dylib_t secondary_module;
 static struct retro_core_t secondary_core;
 static struct retro_callbacks secondary_callbacks;
@@ -127,16 +148,110 @@ static bool write_file_with_random_name(char **tempDllPath,
    return okay;
 }
 
+#ifdef HAVE_SECONDARY_CORE_MEMFD
+/* Copies the core into an anonymous in-memory file and returns
+ * a path dlopen() can use. The copy is done by the kernel and
+ * never touches the disk. */
+static char *copy_core_to_memfd(void)
+{
+   char fd_path[64];
+   struct stat core_stat;
+   off_t offset         = 0;
+   int mem_fd           = -1;
+   const char *corePath = path_get(RARCH_PATH_CORE);
+   int core_fd          = open(corePath, O_RDONLY);
+
+   if (core_fd < 0)
+      return NULL;
+
+   if (fstat(core_fd, &core_stat) != 0)
+      goto error;
+
+   /* 1 == MFD_CLOEXEC; glibc only exposes memfd_create() since 2.27. */
+   mem_fd = (int)syscall(__NR_memfd_create, "retroarch_secondary_core", 1);
+   if (mem_fd < 0)
+      goto error;
+
+   while (offset < core_stat.st_size)
+   {
+      if (sendfile(mem_fd, core_fd, &offset,
+               (size_t)(core_stat.st_size - offset)) <= 0)
+         goto error;
+   }
+
+   close(core_fd);
+
+   snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", mem_fd);
+   secondary_library_fd = mem_fd;
+
+   return strcpy_alloc_force(fd_path);
+
+error:
+   if (mem_fd >= 0)
+      close(mem_fd);
+   close(core_fd);
+   return NULL;
+}
+#endif
+
+/* Deletes the copies of older builds of a core, which are named
+ * <core>_<8 hex digits>.<ext>, from the temp directory. */
+static void delete_old_core_copies(const char *dir,
+      const char *coreNameNoExt, const char *coreExt, const char *keep)
+{
+   size_t i;
+   size_t prefix_len        = strlen(coreNameNoExt);
+   struct string_list *list = dir_list_new(dir,
+         string_is_empty(coreExt) ? NULL : coreExt,
+         false, true, false, false);
+
+   if (!list)
+      return;
+
+   for (i = 0; i < list->size; i++)
+   {
+      unsigned j;
+      const char *path = list->elems[i].data;
+      const char *name = path_basename(path);
+
+      if (string_is_equal(name, path_basename(keep)))
+         continue;
+      if (strncmp(name, coreNameNoExt, prefix_len) != 0
+            || name[prefix_len] != '_')
+         continue;
+
+      for (j = 1; j <= 8; j++)
+         if (!isxdigit((unsigned char)name[prefix_len + j]))
+            break;
+      if (j <= 8 || (name[prefix_len + 9] != '.'
+               && name[prefix_len + 9] != '\0'))
+         continue;
+
+      filestream_delete(path);
+   }
+
+   string_list_free(list);
+}
+
+/* Copies the core to the temp directory, under a name keyed on
+ * the size and modification time of the core. If a copy of the
+ * same core is already there from a previous session, it is used
+ * as-is without reading the core. */
 static char *copy_core_to_temp_file(void)
 {
+   char crc_buf[16];
+   int64_t coreStat[2];
    bool failed              = false;
    char *tempDirectory      = NULL;
    char *retroarchTempPath  = NULL;
    char *tempDllPath        = NULL;
+   char *cachedDllPath      = NULL;
+   char *coreNameNoExt      = NULL;
    void *dllFileData        = NULL;
    int64_t dllFileSize      = 0;
    const char *corePath     = path_get(RARCH_PATH_CORE);
    const char *coreBaseName = path_basename(corePath);
+   const char *coreExt      = NULL;
 
    if (strlen(coreBaseName) == 0)
    {
@@ -162,28 +277,73 @@ static char *copy_core_to_temp_file(void)
       goto end;
    }
 
+   if (!path_get_size_mtime(corePath, &coreStat[0], &coreStat[1]))
+   {
+      failed = true;
+      goto end;
+   }
+
+   snprintf(crc_buf, sizeof(crc_buf), "_%08x",
+         encoding_crc32(0, (const uint8_t*)coreStat, sizeof(coreStat)));
+
+   coreNameNoExt = strcpy_alloc_force(coreBaseName);
+   path_remove_extension(coreNameNoExt);
+   coreExt       = path_get_extension(coreBaseName);
+
+   strcat_alloc(&cachedDllPath, retroarchTempPath);
+   strcat_alloc(&cachedDllPath, coreNameNoExt);
+   strcat_alloc(&cachedDllPath, crc_buf);
+   if (!string_is_empty(coreExt))
+   {
+      strcat_alloc(&cachedDllPath, ".");
+      strcat_alloc(&cachedDllPath, coreExt);
+   }
+
+   if (path_get_size(cachedDllPath) == coreStat[0])
+   {
+      tempDllPath   = cachedDllPath;
+      cachedDllPath = NULL;
+      goto end;
+   }
+
    if (!filestream_read_file(corePath, &dllFileData, &dllFileSize))
    {
       failed = true;
       goto end;
    }
 
-   strcat_alloc(&tempDllPath, retroarchTempPath);
-   strcat_alloc(&tempDllPath, coreBaseName);
+   /* Write under a unique name first, so a concurrent instance
+    * never sees a partially written copy under the cached name. */
+   tempDllPath = strcpy_alloc_force(coreBaseName);
+   if (!write_file_with_random_name(&tempDllPath,
+            retroarchTempPath, dllFileData, dllFileSize))
+   {
+      failed = true;
+      goto end;
+   }
 
-   if (!filestream_write_file(tempDllPath, dllFileData, dllFileSize))
+   filestream_delete(cachedDllPath);
+   if (filestream_rename(tempDllPath, cachedDllPath) == 0)
    {
-      /* try other file names */
-      if (!write_file_with_random_name(&tempDllPath,
-               retroarchTempPath, dllFileData, dllFileSize))
-         failed = true;
+      free(tempDllPath);
+      tempDllPath   = cachedDllPath;
+      cachedDllPath = NULL;
+
+      delete_old_core_copies(retroarchTempPath,
+            coreNameNoExt, coreExt, tempDllPath);
    }
+   else
+      secondary_library_delete = true;
 
 end:
    if (tempDirectory)
       free(tempDirectory);
    if (retroarchTempPath)
       free(retroarchTempPath);
+   if (cachedDllPath)
+      free(cachedDllPath);
+   if (coreNameNoExt)
+      free(coreNameNoExt);
    if (dllFileData)
       free(dllFileData);
 
@@ -235,87 +395,103 @@ static bool secondary_core_create(void)
 
    if (secondary_library_path)
       free(secondary_library_path);
-   secondary_library_path = NULL;
-   secondary_library_path = copy_core_to_temp_file();
-
-   if (!secondary_library_path)
-      return false;
+   secondary_library_path   = NULL;
+   secondary_library_delete = false;
+#ifdef HAVE_SECONDARY_CORE_MEMFD
+   secondary_library_path   = copy_core_to_memfd();
 
-   /* Load Core */
-   if (init_libretro_sym_custom(
+   if (secondary_library_path && !init_libretro_sym_custom(
             CORE_TYPE_PLAIN, &secondary_core,
             secondary_library_path, &secondary_module))
    {
-      secondary_core.symbols_inited = true;
-      secondary_core.retro_set_environment(
-            rarch_environment_secondary_core_hook);
-      secondary_core_set_variable_update();
+      /* e.g. /proc is not mounted; go through the temp directory. */
+      close(secondary_library_fd);
+      secondary_library_fd   = -1;
+      free(secondary_library_path);
+      secondary_library_path = NULL;
+   }
 
-      secondary_core.retro_init();
+   if (!secondary_library_path)
+#endif
+   {
+      secondary_library_path = copy_core_to_temp_file();
 
-      content_get_status(&contentless, &is_inited);
-      secondary_core.inited = is_inited;
+      if (!secondary_library_path)
+         return false;
 
-      /* Load Content */
-      if (!load_content_info || load_content_info->special)
-      {
-         /* disabled due to crashes */
+      if (!init_libretro_sym_custom(
+               CORE_TYPE_PLAIN, &secondary_core,
+               secondary_library_path, &secondary_module))
          return false;
+   }
+
+   secondary_core.symbols_inited = true;
+   secondary_core.retro_set_environment(
+         rarch_environment_secondary_core_hook);
+   secondary_core_set_variable_update();
+
+   secondary_core.retro_init();
+
+   content_get_status(&contentless, &is_inited);
+   secondary_core.inited = is_inited;
+
+   /* Load Content */
+   if (!load_content_info || load_content_info->special)
+   {
+      /* disabled due to crashes */
+      return false;
 #if 0
-         secondary_core.game_loaded = secondary_core.retro_load_game_special(
-               loadContentInfo.special->id, loadContentInfo.info, loadContentInfo.content->size);
-         if (!secondary_core.game_loaded)
-         {
-            secondary_core_destroy();
-            return false;
-         }
-#endif
-      }
-      else if (load_content_info->content->size > 0 && load_content_info->content->elems[0].data)
-      {
-         secondary_core.game_loaded = secondary_core.retro_load_game(load_content_info->info);
-         if (!secondary_core.game_loaded)
-         {
-            secondary_core_destroy();
-            return false;
-         }
-      }
-      else if (contentless)
+      secondary_core.game_loaded = secondary_core.retro_load_game_special(
+            loadContentInfo.special->id, loadContentInfo.info, loadContentInfo.content->size);
+      if (!secondary_core.game_loaded)
       {
-         secondary_core.game_loaded = secondary_core.retro_load_game(NULL);
-         if (!secondary_core.game_loaded)
-         {
-            secondary_core_destroy();
-            return false;
-         }
+         secondary_core_destroy();
+         return false;
       }
-      else
-         secondary_core.game_loaded = false;
-
-      if (!secondary_core.inited)
+#endif
+   }
+   else if (load_content_info->content->size > 0 && load_content_info->content->elems[0].data)
+   {
+      secondary_core.game_loaded = secondary_core.retro_load_game(load_content_info->info);
+      if (!secondary_core.game_loaded)
       {
          secondary_core_destroy();
          return false;
       }
-
-      core_set_default_callbacks(&secondary_callbacks);
-      secondary_core.retro_set_video_refresh(secondary_callbacks.frame_cb);
-      secondary_core.retro_set_audio_sample(secondary_callbacks.sample_cb);
-      secondary_core.retro_set_audio_sample_batch(secondary_callbacks.sample_batch_cb);
-      secondary_core.retro_set_input_state(secondary_callbacks.state_cb);
-      secondary_core.retro_set_input_poll(secondary_callbacks.poll_cb);
-
-      for (port = 0; port < 16; port++)
+   }
+   else if (contentless)
+   {
+      secondary_core.game_loaded = secondary_core.retro_load_game(NULL);
+      if (!secondary_core.game_loaded)
       {
-         device = port_map[port];
-         if (device >= 0)
-            secondary_core.retro_set_controller_port_device(
-                  (unsigned)port, (unsigned)device);
+         secondary_core_destroy();
+         return false;
       }
-      clear_controller_port_map();
    }
    else
+      secondary_core.game_loaded = false;
+
+   if (!secondary_core.inited)
+   {
+      secondary_core_destroy();
       return false;
+   }
+
+   core_set_default_callbacks(&secondary_callbacks);
+   secondary_core.retro_set_video_refresh(secondary_callbacks.frame_cb);
+   secondary_core.retro_set_audio_sample(secondary_callbacks.sample_cb);
+   secondary_core.retro_set_audio_sample_batch(secondary_callbacks.sample_batch_cb);
+   secondary_core.retro_set_input_state(secondary_callbacks.state_cb);
+   secondary_core.retro_set_input_poll(secondary_callbacks.poll_cb);
+
+   for (port = 0; port < 16; port++)
+   {
+      device = port_map[port];
+      if (device >= 0)
+         secondary_core.retro_set_controller_port_device(
+               (unsigned)port, (unsigned)device);
+   }
+   clear_controller_port_map();
 
    return true;
 }
@@ -389,7 +565,15 @@ void secondary_core_destroy(void)
 
    dylib_close(secondary_module);
    secondary_module = NULL;
-   filestream_delete(secondary_library_path);
+#ifdef HAVE_SECONDARY_CORE_MEMFD
+   if (secondary_library_fd >= 0)
+      close(secondary_library_fd);
+   secondary_library_fd = -1;
+#endif
+   /* Cached copies are kept around for the next session. */
+   if (secondary_library_delete)
+      filestream_delete(secondary_library_path);
+   secondary_library_delete = false;
    if (secondary_library_path)
       free(secondary_library_path);
    secondary_library_path = NULL;
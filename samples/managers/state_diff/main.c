@@ -0,0 +1,183 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Micro-benchmark for the rewind state diffing kernels.
+ *
+ * Builds pairs of synthetic savestates with different amounts of
+ * change, runs the same find_change/find_same walk the rewind
+ * compressor does with every kernel the CPU supports, checks that
+ * all kernels agree with the C version and reports GB/s. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+
+#include "../../../managers/state_diff.h"
+
+struct bench_profile
+{
+   const char *ident;
+   /* Average distance between changed runs, in uint16_t. */
+   unsigned spacing;
+   /* Length of each changed run, in uint16_t. */
+   unsigned run;
+};
+
+static const struct bench_profile profiles[] = {
+   { "idle",    1 << 20, 1  },
+   { "sparse",  4096,    4  },
+   { "typical", 512,     16 },
+   { "dense",   32,      8  },
+};
+
+/* Same layout as state_manager_raw_alloc(): three equal uint16_t
+ * followed by a differing one terminate both scans. */
+static uint16_t *bench_alloc(size_t num16, uint16_t uniq)
+{
+   uint16_t *buf = (uint16_t*)calloc(
+         num16 * sizeof(uint16_t) + sizeof(uint16_t) * 4
+         + STATE_DIFF_PADDING, 1);
+   if (buf)
+      buf[num16 + 3] = uniq;
+   return buf;
+}
+
+/* Walks the buffers like state_manager_raw_compress() does and
+ * returns a checksum of the run boundaries. */
+static uint64_t bench_walk(const state_diff_kernel_t *kernel,
+      const uint16_t *a, const uint16_t *b, size_t num16)
+{
+   uint64_t sum = 0;
+
+   while (num16)
+   {
+      size_t changed;
+      size_t skip = kernel->find_change(a, b);
+
+      if (skip >= num16)
+         break;
+
+      a     += skip;
+      b     += skip;
+      num16 -= skip;
+
+      changed = kernel->find_same(a, b);
+      if (changed > num16)
+         changed = num16;
+
+      sum    = sum * 31 + skip * 65537 + changed;
+      a     += changed;
+      b     += changed;
+      num16 -= changed;
+   }
+
+   return sum;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, j, count;
+   size_t state_size                 = 4 * 1024 * 1024;
+   unsigned iterations               = 50;
+   uint64_t simd                     = cpu_features_get();
+   const state_diff_kernel_t *kernels = state_diff_get_kernels(&count);
+   const state_diff_kernel_t *best    = state_diff_get_kernel(simd);
+   int ret                           = 0;
+
+   if (argc > 1)
+      state_size = (size_t)strtoul(argv[1], NULL, 0) * 1024;
+   if (argc > 2)
+      iterations = (unsigned)strtoul(argv[2], NULL, 0);
+
+   if (!state_size || !iterations)
+   {
+      fprintf(stderr, "Usage: %s [state size in KiB] [iterations]\n", argv[0]);
+      return 1;
+   }
+
+   printf("State size: %u KiB, iterations: %u, selected kernel: %s\n",
+         (unsigned)(state_size / 1024), iterations, best->ident);
+
+   for (i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+   {
+      size_t k;
+      uint64_t reference = 0;
+      size_t num16       = state_size / sizeof(uint16_t);
+      uint16_t *a        = bench_alloc(num16, 0);
+      uint16_t *b        = bench_alloc(num16, 1);
+
+      if (!a || !b)
+      {
+         free(a);
+         free(b);
+         return 1;
+      }
+
+      srand(i + 1);
+      for (k = 0; k < num16; k++)
+         a[k] = b[k] = (uint16_t)rand();
+
+      for (k = rand() % profiles[i].spacing; k < num16;
+            k += 1 + rand() % (profiles[i].spacing * 2))
+      {
+         unsigned r;
+         for (r = 0; r < profiles[i].run && k + r < num16; r++)
+            b[k + r] ^= 1 + (rand() & 0x7fff);
+      }
+
+      for (j = count; j-- > 0; )
+      {
+         unsigned it;
+         uint64_t sum;
+         retro_time_t start, elapsed;
+
+         if ((simd & kernels[j].simd) != kernels[j].simd)
+         {
+            printf("  %-8s %-8s unsupported by this CPU\n",
+                  profiles[i].ident, kernels[j].ident);
+            continue;
+         }
+
+         start = cpu_features_get_time_usec();
+         for (it = 0; it < iterations; it++)
+            sum = bench_walk(&kernels[j], a, b, num16);
+         elapsed = cpu_features_get_time_usec() - start;
+
+         /* The C kernel is last and runs first. */
+         if (!kernels[j].simd)
+            reference = sum;
+         else if (sum != reference)
+         {
+            printf("  %-8s %-8s MISMATCH\n",
+                  profiles[i].ident, kernels[j].ident);
+            ret = 1;
+            continue;
+         }
+
+         printf("  %-8s %-8s %8.2f GB/s%s\n",
+               profiles[i].ident, kernels[j].ident,
+               elapsed ? (double)state_size * iterations
+               / (elapsed * 1000.0) : 0.0,
+               &kernels[j] == best ? " (selected)" : "");
+      }
+
+      free(a);
+      free(b);
+   }
+
+   return ret;
+}
@@ -64,7 +64,7 @@ int main(int argc, char *argv[])
 
    task_queue_init(false /* threaded enable */, main_msg_queue_push);
 
-   core_info_init_list(core_info_dir, core_dir, exts, true);
+   core_info_init_list(core_info_dir, core_dir, exts, true, NULL);
 
    task_push_dbscan(playlist_dir, db_dir, input_dir, true,
          true, main_db_cb);
@@ -74,6 +74,19 @@ int main(int argc, char *argv[])
 
    fprintf(stderr, "Exit loop\n");
 
+   {
+      unsigned i;
+      task_queue_handler_stats_t stats[TASK_QUEUE_MAX_STATS];
+      unsigned count = task_queue_get_all_stats(stats, TASK_QUEUE_MAX_STATS);
+
+      for (i = 0; i < count; i++)
+         fprintf(stderr, "%s: %u runs, %.1f ms queued, %.1f ms running\n",
+               stats[i].label[0] ? stats[i].label : "untitled",
+               (unsigned)stats[i].stats.runs,
+               stats[i].stats.wait_usec / 1000.0,
+               stats[i].stats.run_usec / 1000.0);
+   }
+
    core_info_deinit_list();
    task_queue_deinit();
 
@@ -459,6 +459,7 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
 {
    double min, max;
    uint64_t flags;
+   settings_t *settings = config_get_ptr();
    if (!setting || !value)
       return -1;
 
@@ -477,7 +478,6 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
             if (setting->enforce_maxrange && *setting->value.target.integer > max)
             {
 #ifdef HAVE_MENU
-               settings_t *settings = config_get_ptr();
                if (settings && settings->bools.menu_navigation_wraparound_enable)
                   *setting->value.target.integer = min;
                else
@@ -495,7 +495,6 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
             if (setting->enforce_maxrange && *setting->value.target.unsigned_integer > max)
             {
 #ifdef HAVE_MENU
-               settings_t *settings = config_get_ptr();
                if (settings && settings->bools.menu_navigation_wraparound_enable)
                   *setting->value.target.unsigned_integer = min;
                else
@@ -513,7 +512,6 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
             if (setting->enforce_maxrange && *setting->value.target.sizet > max)
             {
 #ifdef HAVE_MENU
-               settings_t *settings = config_get_ptr();
                if (settings && settings->bools.menu_navigation_wraparound_enable)
                   *setting->value.target.sizet = min;
                else
@@ -531,7 +529,6 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
             if (setting->enforce_maxrange && *setting->value.target.fraction > max)
             {
 #ifdef HAVE_MENU
-               settings_t *settings = config_get_ptr();
                if (settings && settings->bools.menu_navigation_wraparound_enable)
                   *setting->value.target.fraction = min;
                else
@@ -558,6 +555,9 @@ int setting_set_with_string_representation(rarch_setting_t* setting,
          break;
    }
 
+   if (settings)
+      configuration_set_modified(settings);
+
    if (setting->change_handler)
       setting->change_handler(setting);
 
@@ -640,6 +640,8 @@ static int setting_fraction_action_right_default(
  **/
 static void setting_reset_setting(rarch_setting_t* setting)
 {
+   settings_t *settings = config_get_ptr();
+
    if (!setting)
       return;
 
@@ -680,6 +682,9 @@ static void setting_reset_setting(rarch_setting_t* setting)
          break;
    }
 
+   if (settings)
+      configuration_set_modified(settings);
+
    if (setting->change_handler)
       setting->change_handler(setting);
 }
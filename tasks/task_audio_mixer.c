@@ -107,6 +107,7 @@ static void task_audio_mixer_handle_upload_ogg(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -132,6 +133,7 @@ static void task_audio_mixer_handle_upload_ogg_and_play(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -157,6 +159,7 @@ static void task_audio_mixer_handle_upload_flac(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -182,6 +185,7 @@ static void task_audio_mixer_handle_upload_flac_and_play(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -207,6 +211,7 @@ static void task_audio_mixer_handle_upload_mp3(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -232,6 +237,7 @@ static void task_audio_mixer_handle_upload_mp3_and_play(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -257,6 +263,7 @@ static void task_audio_mixer_handle_upload_mod(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -282,6 +289,7 @@ static void task_audio_mixer_handle_upload_mod_and_play(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -307,6 +315,7 @@ static void task_audio_mixer_handle_upload_wav(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -332,6 +341,7 @@ static void task_audio_mixer_handle_upload_wav_and_play(void *task_data,
    params.buf                  = img->buf;
    params.bufsize              = img->bufsize;
    params.cb                   = NULL;
+   params.path                 = NULL;
    params.basename             = !string_is_empty(img->path) ? strdup(path_basename(img->path)) : NULL;
 
    audio_driver_mixer_add_stream(&params);
@@ -374,11 +384,54 @@ bool task_audio_mixer_load_handler(retro_task_t *task)
    return true;
 }
 
+/* OGG, MP3 and FLAC tracks are decoded from the file while
+ * they play, so there is nothing to read in beforehand. */
+static bool task_audio_mixer_add_file(const char *fullpath,
+      enum audio_mixer_state state)
+{
+   bool ret;
+   audio_mixer_stream_params_t params;
+
+   params.type                 = AUDIO_MIXER_TYPE_NONE;
+
+   if (strstr(fullpath, file_path_str(FILE_PATH_OGG_EXTENSION)))
+      params.type              = AUDIO_MIXER_TYPE_OGG;
+   else if (strstr(fullpath, file_path_str(FILE_PATH_MP3_EXTENSION)))
+      params.type              = AUDIO_MIXER_TYPE_MP3;
+   else if (strstr(fullpath, file_path_str(FILE_PATH_FLAC_EXTENSION)))
+      params.type              = AUDIO_MIXER_TYPE_FLAC;
+   else
+      return false;
+
+   params.volume               = 1.0f;
+   params.state                = state;
+   params.buf                  = NULL;
+   params.bufsize              = 0;
+   params.cb                   = NULL;
+   params.path                 = (char*)fullpath;
+   params.basename             = strdup(path_basename(fullpath));
+
+   ret = audio_driver_mixer_add_stream(&params);
+
+   if (params.basename != NULL)
+      free(params.basename);
+
+   return ret;
+}
+
 bool task_push_audio_mixer_load_and_play(const char *fullpath, retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio    = NULL;
    struct audio_mixer_handle   *image = NULL;
-   retro_task_t                   *t  = (retro_task_t*)calloc(1, sizeof(*t));
+   retro_task_t                   *t  = NULL;
+
+   if (task_audio_mixer_add_file(fullpath, AUDIO_STREAM_STATE_PLAYING))
+   {
+      free(user_data);
+      return true;
+   }
+
+   t                  = (retro_task_t*)calloc(1, sizeof(*t));
 
    if (!t)
       goto error;
@@ -471,7 +524,15 @@ bool task_push_audio_mixer_load(const char *fullpath, retro_task_callback_t cb,
 {
    nbio_handle_t             *nbio    = NULL;
    struct audio_mixer_handle   *image = NULL;
-   retro_task_t                   *t  = (retro_task_t*)calloc(1, sizeof(*t));
+   retro_task_t                   *t  = NULL;
+
+   if (task_audio_mixer_add_file(fullpath, AUDIO_STREAM_STATE_STOPPED))
+   {
+      free(user_data);
+      return true;
+   }
+
+   t                  = (retro_task_t*)calloc(1, sizeof(*t));
 
    if (!t)
       goto error;
@@ -26,7 +26,12 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
+#include "task_database_cache.h"
 
 #include "../core_info.h"
 #include "../database_info.h"
@@ -43,6 +48,10 @@
 #define COLLECTION_SIZE                99999
 #endif
 
+#define DATABASE_SCAN_MAX_THREADS      8
+/* microseconds */
+#define DATABASE_PLAYLIST_WRITE_INTERVAL 2000000
+
 typedef struct database_state_handle
 {
    uint32_t crc;
@@ -53,9 +62,41 @@ typedef struct database_state_handle
    char archive_name[511];
    char serial[4096];
    database_info_list_t *info;
+   /* Databases stay opened for the whole scan. */
+   database_info_rdb_cache_t *rdb_cache;
    struct string_list *list;
 } database_state_handle_t;
 
+typedef struct database_scan_job
+{
+   /* NULL for entries that were pruned */
+   char *path;
+   database_scan_result_t result;
+   bool done;
+} database_scan_job_t;
+
+/* Identifies the scanned files ahead of the database lookups,
+ * one job per entry of the initial file list. */
+typedef struct database_scan_pool
+{
+   database_scan_job_t *jobs;
+   database_scan_cache_t *cache;
+   size_t count;
+   /* next job to be picked up by a thread */
+   size_t next;
+   /* jobs before this one are done, only used by the task */
+   size_t ready;
+   unsigned cache_hits;
+   unsigned num_threads;
+   bool cancelled;
+   retro_time_t start_time;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+   scond_t *cond;
+   sthread_t *threads[DATABASE_SCAN_MAX_THREADS];
+#endif
+} database_scan_pool_t;
+
 typedef struct db_handle
 {
    bool is_directory;
@@ -66,9 +107,50 @@ typedef struct db_handle
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   database_scan_pool_t *pool;
+   /* Playlists stay opened for the whole scan and are
+    * written out every DATABASE_PLAYLIST_WRITE_INTERVAL.
+    * They are shared with other running scans, see
+    * database_playlists below. */
+   playlist_t **playlists;
+   size_t playlists_count;
+   retro_time_t playlists_written;
    database_state_handle_t state;
 } db_handle_t;
 
+/* Playlists opened by the running scans. Scans that add to the
+ * same playlist share one instance, so that a scan writing it
+ * out can not drop the entries added by another one. The last
+ * scan that releases a playlist frees it. */
+typedef struct database_playlist
+{
+   playlist_t *playlist;
+   unsigned refs;
+} database_playlist_t;
+
+static database_playlist_t *database_playlists = NULL;
+static size_t database_playlists_count         = 0;
+#ifdef HAVE_THREADS
+/* Guards database_playlists and every playlist in it. */
+static slock_t *database_playlists_lock        = NULL;
+#endif
+
+static void task_database_playlists_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (database_playlists_lock)
+      slock_lock(database_playlists_lock);
+#endif
+}
+
+static void task_database_playlists_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (database_playlists_lock)
+      slock_unlock(database_playlists_lock);
+#endif
+}
+
 int cue_find_track(const char *cue_path, bool first,
       uint64_t *offset, uint64_t *size,
       char *track_path, uint64_t max_len);
@@ -609,71 +691,416 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/* Prunes the files referenced by CUE and GDI sheets, so
+ * that their tracks are not scanned on their own. */
+static void task_database_prune(database_info_handle_t *db)
 {
+   size_t i;
+   size_t list_ptr = db->list_ptr;
+
+   for (i = list_ptr; i < db->list->size; i++)
+   {
+      const char *name = db->list->elems[i].data;
+
+      if (!name)
+         continue;
+
+      db->list_ptr = i;
+
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, name);
+            break;
+         default:
+            break;
+      }
+   }
+
+   db->list_ptr = list_ptr;
+}
+
+/* Identifies a content file by its serial or CRC.
+ * Only reads the file, so it can run on any thread. */
+static void task_database_scan_file(const char *name,
+      database_scan_result_t *result)
+{
+   char serial[4096];
+
+   serial[0]           = '\0';
+   result->type        = DATABASE_TYPE_NONE;
+   result->crc         = 0;
+   result->archive_crc = 0;
+   result->serial      = NULL;
+   result->ret         = 1;
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
+         result->type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
-#else
-         break;
+         result->ret  = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &result->archive_crc);
 #endif
+         break;
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_cue_get_serial(name, serial))
+            result->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_cue_get_crc(name, &db_state->crc);
+            result->type = DATABASE_TYPE_CRC_LOOKUP;
+            result->ret  = task_database_cue_get_crc(name, &result->crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (0 && task_database_gdi_get_serial(name, serial))
+            result->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            result->type = DATABASE_TYPE_CRC_LOOKUP;
+            result->ret  = task_database_gdi_get_crc(name, &result->crc);
          }
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial);
+         result->type = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_chd_get_serial(name, serial))
+            result->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_chd_get_crc(name, &db_state->crc);
+            result->type = DATABASE_TYPE_CRC_LOOKUP;
+            result->ret  = task_database_chd_get_crc(name, &result->crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         database_info_set_type(db, DATABASE_TYPE_ITERATE_LUTRO);
+         result->type = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         result->type = DATABASE_TYPE_CRC_LOOKUP;
+         result->ret  = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &result->crc);
+         break;
    }
 
-   return 1;
+   if (!string_is_empty(serial))
+      result->serial = strdup(serial);
+}
+
+/* The key of a file in the scan cache. For cue and gdi sheets
+ * the CRC and serial come from the referenced tracks, so their
+ * sizes and modification times are folded in as well. */
+static bool task_database_scan_stat(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+   bool ret                             = true;
+   char *track                          = NULL;
+   intfstream_t *fd                     = NULL;
+   enum msg_file_type type              = FILE_TYPE_NONE;
+   bool (*next_file)(intfstream_t *, const char *,
+         char *, uint64_t)              = NULL;
+
+   if (!database_scan_cache_stat(path, size, mtime))
+      return false;
+
+   type = extension_to_file_type(path_get_extension(path));
+   if (type == FILE_TYPE_CUE)
+      next_file = cue_next_file;
+   else if (type == FILE_TYPE_GDI)
+      next_file = gdi_next_file;
+   else
+      return true;
+
+   track = (char*)malloc(PATH_MAX_LENGTH + 1);
+   fd    = intfstream_open_file(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!track || !fd)
+      ret = false;
+   else
+   {
+      /* Unsigned, so that folding in the tracks wraps around
+       * instead of overflowing. */
+      uint64_t key = (uint64_t)*mtime;
+
+      while (next_file(fd, path, track, PATH_MAX_LENGTH))
+      {
+         int64_t track_size  = 0;
+         int64_t track_mtime = 0;
+
+         /* Missing tracks are not cached, they may show up later. */
+         if (!database_scan_cache_stat(track, &track_size, &track_mtime))
+         {
+            ret = false;
+            break;
+         }
+
+         *size += track_size;
+         key    = key * 31 + (uint64_t)track_mtime;
+      }
+
+      *mtime = (int64_t)key;
+   }
+
+   if (fd)
+   {
+      intfstream_close(fd);
+      free(fd);
+   }
+   free(track);
+
+   return ret;
+}
+
+static void task_database_scan_job(database_scan_pool_t *pool,
+      database_scan_job_t *job)
+{
+   int64_t size    = 0;
+   int64_t mtime   = 0;
+   bool cacheable  = pool->cache
+      && task_database_scan_stat(job->path, &size, &mtime);
+
+   if (cacheable && database_scan_cache_find(pool->cache,
+            job->path, size, mtime, &job->result))
+   {
+#ifdef HAVE_THREADS
+      slock_lock(pool->lock);
+#endif
+      pool->cache_hits++;
+#ifdef HAVE_THREADS
+      slock_unlock(pool->lock);
+#endif
+      return;
+   }
+
+   task_database_scan_file(job->path, &job->result);
+
+   if (cacheable && job->result.ret)
+      database_scan_cache_add(pool->cache, job->path, size, mtime,
+            &job->result);
+}
+
+#ifdef HAVE_THREADS
+static void task_database_scan_thread(void *data)
+{
+   database_scan_pool_t *pool = (database_scan_pool_t*)data;
+
+   for (;;)
+   {
+      database_scan_job_t *job = NULL;
+
+      slock_lock(pool->lock);
+      while (!pool->cancelled && pool->next < pool->count
+            && pool->jobs[pool->next].done)
+         pool->next++;
+      if (!pool->cancelled && pool->next < pool->count)
+         job = &pool->jobs[pool->next++];
+      slock_unlock(pool->lock);
+
+      if (!job)
+         break;
+
+      task_database_scan_job(pool, job);
+
+      slock_lock(pool->lock);
+      job->done = true;
+      scond_signal(pool->cond);
+      slock_unlock(pool->lock);
+   }
+}
+#endif
+
+static void task_database_scan_pool_free(database_scan_pool_t *pool)
+{
+   size_t i;
+
+   if (!pool)
+      return;
+
+#ifdef HAVE_THREADS
+   if (pool->lock)
+   {
+      slock_lock(pool->lock);
+      pool->cancelled = true;
+      slock_unlock(pool->lock);
+   }
+
+   for (i = 0; i < pool->num_threads; i++)
+      sthread_join(pool->threads[i]);
+
+   if (pool->cond)
+      scond_free(pool->cond);
+   if (pool->lock)
+      slock_free(pool->lock);
+#endif
+
+   RARCH_LOG("Identified %u files (%u from cache) in %.2f s.\n",
+         (unsigned)pool->ready, pool->cache_hits,
+         (cpu_features_get_time_usec() - pool->start_time) / 1000000.0);
+
+   for (i = 0; i < pool->count; i++)
+   {
+      free(pool->jobs[i].path);
+      database_scan_result_free(&pool->jobs[i].result);
+   }
+
+   database_scan_cache_close(pool->cache);
+   free(pool->jobs);
+   free(pool);
+}
+
+static database_scan_pool_t *task_database_scan_pool_new(
+      database_info_handle_t *db, const char *cache_path)
+{
+   size_t i;
+   database_scan_pool_t *pool = (database_scan_pool_t*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->count      = db->list->size;
+   pool->jobs       = (database_scan_job_t*)
+      calloc(pool->count, sizeof(*pool->jobs));
+   pool->cache      = database_scan_cache_open(cache_path);
+   pool->start_time = cpu_features_get_time_usec();
+
+   if (!pool->jobs)
+   {
+      task_database_scan_pool_free(pool);
+      return NULL;
+   }
+
+   for (i = 0; i < pool->count; i++)
+   {
+      const char *name = db->list->elems[i].data;
+
+      /* Archive members are identified by the task itself */
+      if (!name || path_contains_compressed_file(name))
+         pool->jobs[i].done = true;
+      else
+         pool->jobs[i].path = strdup(name);
+   }
+
+#ifdef HAVE_THREADS
+   pool->lock = slock_new();
+   pool->cond = scond_new();
+
+   if (pool->lock && pool->cond)
+   {
+      unsigned num_threads = cpu_features_get_core_amount();
+
+      if (num_threads > DATABASE_SCAN_MAX_THREADS)
+         num_threads = DATABASE_SCAN_MAX_THREADS;
+
+      for (i = 0; i < num_threads; i++)
+      {
+         pool->threads[pool->num_threads] = sthread_create(
+               task_database_scan_thread, pool);
+         if (!pool->threads[pool->num_threads])
+            break;
+         pool->num_threads++;
+      }
+   }
+#endif
+
+   RARCH_LOG("Identifying %u files on %u threads.\n",
+         (unsigned)pool->count, pool->num_threads);
+
+   return pool;
+}
+
+/* Returns the job of the file at @index once it is done,
+ * NULL if the task should try again later. Done jobs are
+ * taken over in batches so that the lock is only taken once
+ * the results taken over last time have been used up. */
+static database_scan_job_t *task_database_scan_pool_get(
+      database_scan_pool_t *pool, size_t index)
+{
+   database_scan_job_t *job = &pool->jobs[index];
+
+   if (index < pool->ready)
+      return job;
+
+   if (!pool->num_threads)
+   {
+      if (!job->done)
+         task_database_scan_job(pool, job);
+      job->done   = true;
+      pool->ready = index + 1;
+      return job;
+   }
+
+#ifdef HAVE_THREADS
+   slock_lock(pool->lock);
+   if (!job->done)
+      scond_wait_timeout(pool->cond, pool->lock, 10000);
+   while (pool->ready < pool->count && pool->jobs[pool->ready].done)
+      pool->ready++;
+   slock_unlock(pool->lock);
+#endif
+
+   return index < pool->ready ? job : NULL;
+}
+
+static int task_database_apply_result(
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name,
+      const database_scan_result_t *result)
+{
+   if (result->type != DATABASE_TYPE_NONE)
+      database_info_set_type(db, result->type);
+
+   db_state->serial[0] = '\0';
+   if (result->serial)
+      strlcpy(db_state->serial, result->serial, sizeof(db_state->serial));
+
+   if (extension_to_file_type(path_get_extension(name))
+         == FILE_TYPE_COMPRESSED)
+   {
+      if (result->ret)
+         db_state->archive_crc = result->archive_crc;
+   }
+   else if (result->type == DATABASE_TYPE_CRC_LOOKUP && result->ret)
+      db_state->crc = result->crc;
+
+   return result->ret;
+}
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   int ret;
+   database_scan_result_t result;
+
+   if (_db->pool && db->list_ptr < _db->pool->count)
+   {
+      database_scan_job_t *job = task_database_scan_pool_get(
+            _db->pool, db->list_ptr);
+
+      /* Not identified yet, keep iterating */
+      if (!job)
+         return 1;
+
+      return task_database_apply_result(db_state, db, name, &job->result);
+   }
+
+   task_database_scan_file(name, &result);
+   ret = task_database_apply_result(db_state, db, name, &result);
+   database_scan_result_free(&result);
+
+   return ret;
 }
 
 static int database_info_list_iterate_end_no_match(
@@ -758,10 +1185,123 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
       database_info_list_free(db_state->info);
       free(db_state->info);
    }
-   db_state->info = database_info_list_new(new_database, query);
+   db_state->info = database_info_list_new_cached(db_state->rdb_cache,
+         new_database, query);
    return 0;
 }
 
+/* Has to be called with the playlists lock held. */
+static playlist_t *task_database_acquire_playlist(const char *path)
+{
+   size_t i;
+   database_playlist_t *playlists = NULL;
+   playlist_t *playlist           = NULL;
+
+   for (i = 0; i < database_playlists_count; i++)
+   {
+      if (string_is_equal(
+               playlist_get_conf_path(database_playlists[i].playlist), path))
+      {
+         database_playlists[i].refs++;
+         return database_playlists[i].playlist;
+      }
+   }
+
+   playlist = playlist_init(path, COLLECTION_SIZE);
+   if (!playlist)
+      return NULL;
+
+   playlists = (database_playlist_t*)realloc(database_playlists,
+         (database_playlists_count + 1) * sizeof(*playlists));
+   if (!playlists)
+   {
+      playlist_free(playlist);
+      return NULL;
+   }
+
+   playlists[database_playlists_count].playlist = playlist;
+   playlists[database_playlists_count].refs     = 1;
+   database_playlists_count++;
+   database_playlists                           = playlists;
+
+   return playlist;
+}
+
+/* Has to be called with the playlists lock held. */
+static void task_database_release_playlist(playlist_t *playlist)
+{
+   size_t i;
+
+   for (i = 0; i < database_playlists_count; i++)
+   {
+      if (database_playlists[i].playlist != playlist)
+         continue;
+
+      if (--database_playlists[i].refs)
+         return;
+
+      playlist_write_file(playlist);
+      playlist_free(playlist);
+
+      database_playlists[i] =
+         database_playlists[--database_playlists_count];
+      if (!database_playlists_count)
+      {
+         free(database_playlists);
+         database_playlists = NULL;
+      }
+      return;
+   }
+}
+
+/* Has to be called with the playlists lock held. */
+static playlist_t *task_database_get_playlist(db_handle_t *_db,
+      const char *path)
+{
+   size_t i;
+   playlist_t **playlists = NULL;
+   playlist_t *playlist   = NULL;
+
+   for (i = 0; i < _db->playlists_count; i++)
+      if (string_is_equal(
+               playlist_get_conf_path(_db->playlists[i]), path))
+         return _db->playlists[i];
+
+   playlist = task_database_acquire_playlist(path);
+   if (!playlist)
+      return NULL;
+
+   playlists = (playlist_t**)realloc(_db->playlists,
+         (_db->playlists_count + 1) * sizeof(*playlists));
+   if (!playlists)
+   {
+      task_database_release_playlist(playlist);
+      return NULL;
+   }
+
+   playlists[_db->playlists_count++] = playlist;
+   _db->playlists                    = playlists;
+
+   return playlist;
+}
+
+/* Has to be called with the playlists lock held. */
+static void task_database_write_playlists(db_handle_t *_db, bool force)
+{
+   size_t i;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   if (!force && now - _db->playlists_written <
+         DATABASE_PLAYLIST_WRITE_INTERVAL)
+      return;
+
+   /* Only the modified playlists get written. */
+   for (i = 0; i < _db->playlists_count; i++)
+      playlist_write_file(_db->playlists[i]);
+
+   _db->playlists_written = now;
+}
+
 static int database_info_list_iterate_found_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -798,8 +1338,6 @@ static int database_info_list_iterate_found_match(
       fill_pathname_join(db_playlist_path, _db->playlist_directory,
             db_playlist_base_str, PATH_MAX_LENGTH * sizeof(char));
 
-   playlist = playlist_init(db_playlist_path, COLLECTION_SIZE);
-
    snprintf(db_crc, PATH_MAX_LENGTH * sizeof(char),
          "%08X|crc", db_info_entry->crc32);
 
@@ -840,7 +1378,11 @@ static int database_info_list_iterate_found_match(
    fprintf(stderr, "entry path str: %s\n", entry_path_str);
 #endif
 
-   if(!playlist_entry_exists(playlist, entry_path_str, db_crc))
+   task_database_playlists_lock();
+
+   playlist = task_database_get_playlist(_db, db_playlist_path);
+
+   if(playlist && !playlist_entry_exists(playlist, entry_path_str, db_crc))
    {
       playlist_push(playlist, entry_path_str,
             db_info_entry->name,
@@ -849,8 +1391,9 @@ static int database_info_list_iterate_found_match(
             db_crc, db_playlist_base_str);
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
+   task_database_write_playlists(_db, false);
+
+   task_database_playlists_unlock();
 
    database_info_list_free(db_state->info);
    free(db_state->info);
@@ -1002,11 +1545,13 @@ static int task_database_iterate_playlist_lutro(
             file_path_str(FILE_PATH_LUTRO_PLAYLIST),
             PATH_MAX_LENGTH * sizeof(char));
 
-   playlist = playlist_init(db_playlist_path, COLLECTION_SIZE);
+   task_database_playlists_lock();
+
+   playlist = task_database_get_playlist(_db, db_playlist_path);
 
    free(db_playlist_path);
 
-   if(!playlist_entry_exists(playlist,
+   if(playlist && !playlist_entry_exists(playlist,
             path, file_path_str(FILE_PATH_DETECT)))
    {
       char *game_title = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
@@ -1026,8 +1571,9 @@ static int task_database_iterate_playlist_lutro(
       free(game_title);
    }
 
-   playlist_write_file(playlist);
-   playlist_free(playlist);
+   task_database_write_playlists(_db, false);
+
+   task_database_playlists_unlock();
 
    return 0;
 }
@@ -1112,7 +1658,7 @@ static int task_database_iterate(
    switch (database_info_get_type(db))
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
          return task_database_iterate_playlist_archive(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_LUTRO:
@@ -1231,6 +1777,26 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+
+         if (dbstate && !dbstate->rdb_cache)
+            dbstate->rdb_cache = database_info_rdb_cache_new();
+
+         if (!db->pool && dbinfo->list)
+         {
+            char *cache_path = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+
+            cache_path[0]    = '\0';
+
+            if (!string_is_empty(db->playlist_directory))
+               fill_pathname_join(cache_path, db->playlist_directory,
+                     file_path_str(FILE_PATH_CONTENT_SCAN_CACHE),
+                     PATH_MAX_LENGTH * sizeof(char));
+
+            task_database_prune(dbinfo);
+            db->pool = task_database_scan_pool_new(dbinfo, cache_path);
+
+            free(cache_path);
+         }
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1284,10 +1850,25 @@ task_finished:
    {
       if (dbstate->list)
          dir_list_free(dbstate->list);
+      if (dbstate->rdb_cache)
+         database_info_rdb_cache_free(dbstate->rdb_cache);
    }
 
    if (db)
    {
+      if (db->pool)
+         task_database_scan_pool_free(db->pool);
+      if (db->playlists)
+      {
+         size_t i;
+
+         task_database_playlists_lock();
+         task_database_write_playlists(db, true);
+         for (i = 0; i < db->playlists_count; i++)
+            task_database_release_playlist(db->playlists[i]);
+         task_database_playlists_unlock();
+         free(db->playlists);
+      }
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1320,7 +1901,15 @@ bool task_push_dbscan(
    if (!t || !db)
       goto error;
 
+#ifdef HAVE_THREADS
+   /* Created on the main thread before any scan can use it. */
+   if (!database_playlists_lock)
+      database_playlists_lock = slock_new();
+#endif
+   database_scan_cache_init();
+
    t->handler                = task_database_handler;
+   t->priority               = TASK_PRIORITY_BULK;
    t->state                  = db;
    t->callback               = cb;
    t->title                  = strdup(msg_hash_to_str(MSG_PREPARING_FOR_CONTENT_SCAN));
@@ -0,0 +1,657 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <rhash.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#include "task_database_cache.h"
+
+#include "../verbosity.h"
+
+/* Scan Cache
+ *
+ * The cache file is a header followed by a log of records that
+ * is only ever appended to. When a file is scanned again after
+ * it changed, the newer record wins. The log is rewritten when
+ * most of its records went stale, or when a record does not
+ * match its checksum. */
+#define DATABASE_SCAN_CACHE_MAGIC      "RASCACHE"
+#define DATABASE_SCAN_CACHE_VERSION    2
+#define DATABASE_SCAN_CACHE_HEADER     12
+#define DATABASE_SCAN_CACHE_RECORD     36
+/* Pending records are written out in batches of this size. */
+#define DATABASE_SCAN_CACHE_BATCH      256
+
+typedef struct database_scan_cache_entry
+{
+   char *path;
+   char *serial;
+   int64_t size;
+   int64_t mtime;
+   uint32_t hash;
+   uint32_t crc;
+   uint32_t archive_crc;
+   uint8_t type;
+   uint8_t ret;
+} database_scan_cache_entry_t;
+
+struct database_scan_cache
+{
+   char *path;
+   /* scans sharing this handle, see database_scan_caches */
+   unsigned refs;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   database_scan_cache_entry_t *entries;
+   size_t count;
+   size_t capacity;
+   /* open addressing, entry index + 1, 0 for empty buckets */
+   size_t *buckets;
+   size_t bucket_count;
+   /* serialized records not written to disk yet */
+   uint8_t *pending;
+   size_t pending_size;
+   size_t pending_capacity;
+   size_t pending_count;
+};
+
+/* Caches opened by the running scans. Scans using the same
+ * cache file share one handle, so that only that handle
+ * appends to the file. */
+static database_scan_cache_t **database_scan_caches = NULL;
+static size_t database_scan_caches_count            = 0;
+#ifdef HAVE_THREADS
+static slock_t *database_scan_caches_lock           = NULL;
+#endif
+
+static void database_scan_cache_lock(database_scan_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_lock(cache->lock);
+#endif
+}
+
+static void database_scan_cache_unlock(database_scan_cache_t *cache)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(cache->lock);
+#endif
+}
+
+static void database_scan_cache_put_le(uint8_t *out,
+      uint64_t val, unsigned bytes)
+{
+   unsigned i;
+   for (i = 0; i < bytes; i++)
+      out[i] = (uint8_t)(val >> (i * 8));
+}
+
+static uint64_t database_scan_cache_get_le(const uint8_t *in,
+      unsigned bytes)
+{
+   unsigned i;
+   uint64_t val = 0;
+   for (i = 0; i < bytes; i++)
+      val |= (uint64_t)in[i] << (i * 8);
+   return val;
+}
+
+static bool database_scan_cache_rehash(database_scan_cache_t *cache,
+      size_t bucket_count)
+{
+   size_t i;
+   size_t *buckets = (size_t*)calloc(bucket_count, sizeof(*buckets));
+
+   if (!buckets)
+      return false;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      size_t slot = cache->entries[i].hash & (bucket_count - 1);
+
+      while (buckets[slot])
+         slot = (slot + 1) & (bucket_count - 1);
+
+      buckets[slot] = i + 1;
+   }
+
+   free(cache->buckets);
+   cache->buckets      = buckets;
+   cache->bucket_count = bucket_count;
+   return true;
+}
+
+static database_scan_cache_entry_t *database_scan_cache_lookup(
+      database_scan_cache_t *cache, const char *path, uint32_t hash)
+{
+   size_t slot;
+
+   if (!cache->bucket_count)
+      return NULL;
+
+   for (slot = hash & (cache->bucket_count - 1); cache->buckets[slot];
+         slot = (slot + 1) & (cache->bucket_count - 1))
+   {
+      database_scan_cache_entry_t *entry =
+         &cache->entries[cache->buckets[slot] - 1];
+
+      if (entry->hash == hash && string_is_equal(entry->path, path))
+         return entry;
+   }
+
+   return NULL;
+}
+
+/* Takes ownership of the strings in @entry.
+ * Returns true if an older entry was replaced. */
+static bool database_scan_cache_insert(database_scan_cache_t *cache,
+      database_scan_cache_entry_t *entry)
+{
+   size_t slot;
+   database_scan_cache_entry_t *old =
+      database_scan_cache_lookup(cache, entry->path, entry->hash);
+
+   if (old)
+   {
+      free(old->path);
+      free(old->serial);
+      *old = *entry;
+      return true;
+   }
+
+   if (cache->count == cache->capacity)
+   {
+      size_t capacity = cache->capacity ? cache->capacity * 2 : 1024;
+      database_scan_cache_entry_t *entries = (database_scan_cache_entry_t*)
+         realloc(cache->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         goto error;
+
+      cache->entries  = entries;
+      cache->capacity = capacity;
+   }
+
+   if ((cache->count + 1) * 2 > cache->bucket_count)
+      if (!database_scan_cache_rehash(cache,
+               cache->bucket_count ? cache->bucket_count * 2 : 2048))
+         goto error;
+
+   cache->entries[cache->count] = *entry;
+
+   for (slot = entry->hash & (cache->bucket_count - 1); cache->buckets[slot];
+         slot = (slot + 1) & (cache->bucket_count - 1));
+
+   cache->buckets[slot] = ++cache->count;
+   return false;
+
+error:
+   free(entry->path);
+   free(entry->serial);
+   return false;
+}
+
+/* Checksum of the record at @rec, covering everything
+ * but the checksum itself. */
+static uint32_t database_scan_cache_record_crc(const uint8_t *rec,
+      size_t len)
+{
+   uint32_t crc = encoding_crc32(0, rec, DATABASE_SCAN_CACHE_RECORD - 4);
+   return encoding_crc32(crc, rec + DATABASE_SCAN_CACHE_RECORD,
+         len - DATABASE_SCAN_CACHE_RECORD);
+}
+
+static size_t database_scan_cache_serialize(
+      const database_scan_cache_entry_t *entry, uint8_t *out)
+{
+   size_t path_len   = strlen(entry->path);
+   size_t serial_len = entry->serial ? strlen(entry->serial) : 0;
+   size_t len        = DATABASE_SCAN_CACHE_RECORD + path_len + serial_len;
+
+   if (out)
+   {
+      database_scan_cache_put_le(out +  0, path_len, 4);
+      database_scan_cache_put_le(out +  4, serial_len, 2);
+      database_scan_cache_put_le(out +  6, entry->type, 1);
+      database_scan_cache_put_le(out +  7, entry->ret, 1);
+      database_scan_cache_put_le(out +  8, (uint64_t)entry->size, 8);
+      database_scan_cache_put_le(out + 16, (uint64_t)entry->mtime, 8);
+      database_scan_cache_put_le(out + 24, entry->crc, 4);
+      database_scan_cache_put_le(out + 28, entry->archive_crc, 4);
+      memcpy(out + DATABASE_SCAN_CACHE_RECORD, entry->path, path_len);
+      if (serial_len)
+         memcpy(out + DATABASE_SCAN_CACHE_RECORD + path_len,
+               entry->serial, serial_len);
+      database_scan_cache_put_le(out + 32,
+            database_scan_cache_record_crc(out, len), 4);
+   }
+
+   return len;
+}
+
+static void database_scan_cache_header(uint8_t *out)
+{
+   memcpy(out, DATABASE_SCAN_CACHE_MAGIC, 8);
+   database_scan_cache_put_le(out +  8, DATABASE_SCAN_CACHE_VERSION, 4);
+}
+
+/* Returns the number of records that were superseded by later
+ * ones, or -1 if the file has to be rewritten. */
+static int64_t database_scan_cache_parse(database_scan_cache_t *cache,
+      const uint8_t *data, int64_t len)
+{
+   int64_t stale = 0;
+   int64_t pos   = DATABASE_SCAN_CACHE_HEADER;
+
+   if (len < DATABASE_SCAN_CACHE_HEADER
+         || memcmp(data, DATABASE_SCAN_CACHE_MAGIC, 8)
+         || database_scan_cache_get_le(data + 8, 4) != DATABASE_SCAN_CACHE_VERSION)
+      return -1;
+
+   while (pos + DATABASE_SCAN_CACHE_RECORD <= len)
+   {
+      database_scan_cache_entry_t entry;
+      const uint8_t *rec = data + pos;
+      size_t path_len    = (size_t)database_scan_cache_get_le(rec, 4);
+      size_t serial_len  = (size_t)database_scan_cache_get_le(rec + 4, 2);
+
+      if (!path_len || pos + DATABASE_SCAN_CACHE_RECORD
+            + (int64_t)path_len + (int64_t)serial_len > len)
+         break;
+
+      /* Drop everything from a damaged record on, its lengths
+       * can't be trusted either. */
+      if ((uint32_t)database_scan_cache_get_le(rec + 32, 4)
+            != database_scan_cache_record_crc(rec,
+               DATABASE_SCAN_CACHE_RECORD + path_len + serial_len))
+         break;
+
+      entry.type        = (uint8_t)database_scan_cache_get_le(rec + 6, 1);
+      entry.ret         = (uint8_t)database_scan_cache_get_le(rec + 7, 1);
+      entry.size        = (int64_t)database_scan_cache_get_le(rec + 8, 8);
+      entry.mtime       = (int64_t)database_scan_cache_get_le(rec + 16, 8);
+      entry.crc         = (uint32_t)database_scan_cache_get_le(rec + 24, 4);
+      entry.archive_crc = (uint32_t)database_scan_cache_get_le(rec + 28, 4);
+      entry.path        = (char*)malloc(path_len + 1);
+      entry.serial      = NULL;
+
+      if (!entry.path)
+         break;
+
+      memcpy(entry.path, rec + DATABASE_SCAN_CACHE_RECORD, path_len);
+      entry.path[path_len] = '\0';
+      entry.hash           = djb2_calculate(entry.path);
+
+      if (serial_len)
+      {
+         entry.serial = (char*)malloc(serial_len + 1);
+         if (entry.serial)
+         {
+            memcpy(entry.serial,
+                  rec + DATABASE_SCAN_CACHE_RECORD + path_len, serial_len);
+            entry.serial[serial_len] = '\0';
+         }
+      }
+
+      if (database_scan_cache_insert(cache, &entry))
+         stale++;
+
+      pos += DATABASE_SCAN_CACHE_RECORD + path_len + serial_len;
+   }
+
+   /* A truncated record at the end is the result of an
+    * interrupted write, drop it and anything after a damaged
+    * one before appending again. */
+   if (pos != len)
+      return -1;
+
+   return stale;
+}
+
+/* Writes all entries to a new cache file. */
+static bool database_scan_cache_rewrite(database_scan_cache_t *cache)
+{
+   size_t i;
+   bool ret     = false;
+   size_t size  = DATABASE_SCAN_CACHE_HEADER;
+   uint8_t *buf = NULL;
+   uint8_t *out = NULL;
+
+   for (i = 0; i < cache->count; i++)
+      size += database_scan_cache_serialize(&cache->entries[i], NULL);
+
+   buf = (uint8_t*)malloc(size);
+   if (!buf)
+      return false;
+
+   database_scan_cache_header(buf);
+   out = buf + DATABASE_SCAN_CACHE_HEADER;
+
+   for (i = 0; i < cache->count; i++)
+      out += database_scan_cache_serialize(&cache->entries[i], out);
+
+   ret = filestream_write_file(cache->path, buf, (int64_t)size);
+   free(buf);
+   return ret;
+}
+
+static void database_scan_cache_free(database_scan_cache_t *cache)
+{
+   size_t i;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      free(cache->entries[i].path);
+      free(cache->entries[i].serial);
+   }
+
+#ifdef HAVE_THREADS
+   if (cache->lock)
+      slock_free(cache->lock);
+#endif
+
+   free(cache->entries);
+   free(cache->buckets);
+   free(cache->pending);
+   free(cache->path);
+   free(cache);
+}
+
+void database_scan_cache_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!database_scan_caches_lock)
+      database_scan_caches_lock = slock_new();
+#endif
+}
+
+static void database_scan_caches_lock_acquire(void)
+{
+#ifdef HAVE_THREADS
+   if (database_scan_caches_lock)
+      slock_lock(database_scan_caches_lock);
+#endif
+}
+
+static void database_scan_caches_lock_release(void)
+{
+#ifdef HAVE_THREADS
+   if (database_scan_caches_lock)
+      slock_unlock(database_scan_caches_lock);
+#endif
+}
+
+static database_scan_cache_t *database_scan_cache_load(const char *path)
+{
+   void *data                   = NULL;
+   int64_t len                  = 0;
+   int64_t stale                = -1;
+   database_scan_cache_t *cache =
+      (database_scan_cache_t*)calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   cache->path = strdup(path);
+   cache->refs = 1;
+
+   if (filestream_exists(path)
+         && filestream_read_file(path, &data, &len) && data)
+   {
+      stale = database_scan_cache_parse(cache, (const uint8_t*)data, len);
+      free(data);
+   }
+
+   if (stale < 0 || (stale > 1024 && (size_t)stale > cache->count))
+   {
+      if (!database_scan_cache_rewrite(cache))
+      {
+         RARCH_WARN("Could not write scan cache: %s\n", path);
+         database_scan_cache_free(cache);
+         return NULL;
+      }
+   }
+
+   RARCH_LOG("Loaded %u entries from scan cache: %s\n",
+         (unsigned)cache->count, path);
+
+#ifdef HAVE_THREADS
+   cache->lock = slock_new();
+#endif
+
+   return cache;
+}
+
+database_scan_cache_t *database_scan_cache_open(const char *path)
+{
+   size_t i;
+   database_scan_cache_t **caches = NULL;
+   database_scan_cache_t *cache   = NULL;
+
+   if (string_is_empty(path))
+      return NULL;
+
+   database_scan_caches_lock_acquire();
+
+   for (i = 0; i < database_scan_caches_count; i++)
+   {
+      if (string_is_equal(database_scan_caches[i]->path, path))
+      {
+         cache = database_scan_caches[i];
+         cache->refs++;
+         goto end;
+      }
+   }
+
+   caches = (database_scan_cache_t**)realloc(database_scan_caches,
+         (database_scan_caches_count + 1) * sizeof(*caches));
+   if (!caches)
+      goto end;
+   database_scan_caches = caches;
+
+   if ((cache = database_scan_cache_load(path)))
+      database_scan_caches[database_scan_caches_count++] = cache;
+
+end:
+   database_scan_caches_lock_release();
+   return cache;
+}
+
+bool database_scan_cache_flush(database_scan_cache_t *cache)
+{
+   RFILE *file = NULL;
+   bool ret    = false;
+
+   if (!cache)
+      return false;
+
+   database_scan_cache_lock(cache);
+
+   if (!cache->pending_size)
+   {
+      database_scan_cache_unlock(cache);
+      return true;
+   }
+
+   file = filestream_open(cache->path,
+         RETRO_VFS_FILE_ACCESS_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (file)
+   {
+      filestream_seek(file, 0, SEEK_END);
+      ret = filestream_write(file, cache->pending,
+            (int64_t)cache->pending_size) == (int64_t)cache->pending_size;
+      filestream_close(file);
+   }
+
+   cache->pending_size  = 0;
+   cache->pending_count = 0;
+
+   database_scan_cache_unlock(cache);
+
+   return ret;
+}
+
+void database_scan_cache_close(database_scan_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   database_scan_cache_flush(cache);
+
+   database_scan_caches_lock_acquire();
+
+   if (--cache->refs)
+   {
+      database_scan_caches_lock_release();
+      return;
+   }
+
+   for (i = 0; i < database_scan_caches_count; i++)
+   {
+      if (database_scan_caches[i] != cache)
+         continue;
+
+      database_scan_caches[i] =
+         database_scan_caches[--database_scan_caches_count];
+      if (!database_scan_caches_count)
+      {
+         free(database_scan_caches);
+         database_scan_caches = NULL;
+      }
+      break;
+   }
+
+   database_scan_caches_lock_release();
+
+   database_scan_cache_free(cache);
+}
+
+bool database_scan_cache_stat(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+   return path_get_size_mtime(path, size, mtime);
+}
+
+bool database_scan_cache_find(database_scan_cache_t *cache,
+      const char *path, int64_t size, int64_t mtime,
+      database_scan_result_t *result)
+{
+   database_scan_cache_entry_t *entry = NULL;
+   bool found                         = false;
+
+   if (!cache)
+      return false;
+
+   database_scan_cache_lock(cache);
+   entry = database_scan_cache_lookup(cache, path, djb2_calculate(path));
+
+   if (entry && entry->size == size && entry->mtime == mtime)
+   {
+      result->type        = (enum database_type)entry->type;
+      result->ret         = entry->ret;
+      result->crc         = entry->crc;
+      result->archive_crc = entry->archive_crc;
+      result->serial      = entry->serial ? strdup(entry->serial) : NULL;
+      found               = true;
+   }
+   database_scan_cache_unlock(cache);
+
+   return found;
+}
+
+void database_scan_cache_add(database_scan_cache_t *cache,
+      const char *path, int64_t size, int64_t mtime,
+      const database_scan_result_t *result)
+{
+   database_scan_cache_entry_t entry;
+   size_t len;
+   bool flush = false;
+
+   if (!cache)
+      return;
+
+   entry.path        = strdup(path);
+   entry.serial      = result->serial ? strdup(result->serial) : NULL;
+   entry.hash        = djb2_calculate(path);
+   entry.size        = size;
+   entry.mtime       = mtime;
+   entry.type        = (uint8_t)result->type;
+   entry.ret         = (uint8_t)result->ret;
+   entry.crc         = result->crc;
+   entry.archive_crc = result->archive_crc;
+
+   if (!entry.path)
+   {
+      free(entry.serial);
+      return;
+   }
+
+   database_scan_cache_lock(cache);
+
+   len = database_scan_cache_serialize(&entry, NULL);
+
+   if (cache->pending_size + len > cache->pending_capacity)
+   {
+      size_t capacity  = (cache->pending_size + len) * 2;
+      uint8_t *pending = (uint8_t*)realloc(cache->pending, capacity);
+
+      if (pending)
+      {
+         cache->pending          = pending;
+         cache->pending_capacity = capacity;
+      }
+   }
+
+   if (cache->pending_size + len <= cache->pending_capacity)
+   {
+      database_scan_cache_serialize(&entry,
+            cache->pending + cache->pending_size);
+      cache->pending_size += len;
+      flush = ++cache->pending_count >= DATABASE_SCAN_CACHE_BATCH;
+   }
+
+   database_scan_cache_insert(cache, &entry);
+   database_scan_cache_unlock(cache);
+
+   if (flush)
+      database_scan_cache_flush(cache);
+}
+
+void database_scan_result_free(database_scan_result_t *result)
+{
+   if (!result)
+      return;
+   free(result->serial);
+   result->serial = NULL;
+}
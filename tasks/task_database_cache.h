@@ -0,0 +1,110 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TASK_DATABASE_CACHE_H
+#define __TASK_DATABASE_CACHE_H
+
+#include <stdint.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+
+#include "../database_info.h"
+
+RETRO_BEGIN_DECLS
+
+/* What was found out about a content file before
+ * looking it up in the databases. */
+typedef struct database_scan_result
+{
+   enum database_type type;
+   uint32_t crc;
+   uint32_t archive_crc;
+   /* NULL when no serial was found, owned by the result. */
+   char *serial;
+   /* 0 if the file could not be identified. */
+   int ret;
+} database_scan_result_t;
+
+typedef struct database_scan_cache database_scan_cache_t;
+
+/**
+ * database_scan_cache_init:
+ *
+ * Has to be called from the main thread before caches
+ * get opened from several threads.
+ **/
+void database_scan_cache_init(void);
+
+/**
+ * database_scan_cache_open:
+ * @path                 : path of the cache file.
+ *
+ * Loads the results of previous scans. The cache file is
+ * created if it does not exist yet. Scans opening the same
+ * file get the same handle.
+ *
+ * Returns: handle to the cache, NULL on error.
+ **/
+database_scan_cache_t *database_scan_cache_open(const char *path);
+
+/**
+ * database_scan_cache_close:
+ *
+ * Writes pending results to disk, the cache is freed once
+ * every scan that opened it closed it.
+ **/
+void database_scan_cache_close(database_scan_cache_t *cache);
+
+/**
+ * database_scan_cache_stat:
+ * @path                 : path of a content file.
+ * @size                 : size of the file.
+ * @mtime                : modification time of the file.
+ *
+ * Returns: true if the file can be looked up in the cache.
+ **/
+bool database_scan_cache_stat(const char *path,
+      int64_t *size, int64_t *mtime);
+
+/**
+ * database_scan_cache_find:
+ *
+ * Looks up the result of a file that has not changed since it
+ * was last scanned. On success, @result receives a copy which
+ * has to be freed with database_scan_result_free().
+ *
+ * Returns: true if a result was found.
+ **/
+bool database_scan_cache_find(database_scan_cache_t *cache,
+      const char *path, int64_t size, int64_t mtime,
+      database_scan_result_t *result);
+
+void database_scan_cache_add(database_scan_cache_t *cache,
+      const char *path, int64_t size, int64_t mtime,
+      const database_scan_result_t *result);
+
+/**
+ * database_scan_cache_flush:
+ *
+ * Appends the results added since the last flush to the cache file.
+ **/
+bool database_scan_cache_flush(database_scan_cache_t *cache);
+
+void database_scan_result_free(database_scan_result_t *result);
+
+RETRO_END_DECLS
+
+#endif
@@ -49,11 +49,102 @@ struct nbio_image_handle
    unsigned processing_pos_increment;
    unsigned pos_increment;
    size_t size;
+   unsigned max_width;
+   unsigned max_height;
    void *handle;
    transfer_cb_t  cb;
    struct texture_image ti;
 };
 
+/* Shrinks the decoded image to fit into max_width x max_height
+ * (0 means no limit), keeping the aspect ratio. Every target pixel
+ * is the average of the source pixels it covers. */
+static void task_image_downscale(struct texture_image *ti,
+      unsigned max_width, unsigned max_height)
+{
+   unsigned x, y;
+   unsigned width        = ti->width;
+   unsigned height       = ti->height;
+   const uint32_t *src   = ti->pixels;
+   uint32_t *dst         = NULL;
+
+   if (!src || !width || !height)
+      return;
+
+   if (max_width && width > max_width)
+   {
+      height = (unsigned)((uint64_t)height * max_width / width);
+      width  = max_width;
+   }
+
+   if (max_height && height > max_height)
+   {
+      width  = (unsigned)((uint64_t)width * max_height / height);
+      height = max_height;
+   }
+
+   if (!width)
+      width  = 1;
+   if (!height)
+      height = 1;
+
+   if (width == ti->width && height == ti->height)
+      return;
+
+   dst = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+
+   if (!dst)
+      return;
+
+   for (y = 0; y < height; y++)
+   {
+      unsigned y0 = (unsigned)((uint64_t)y * ti->height / height);
+      unsigned y1 = (unsigned)((uint64_t)(y + 1) * ti->height / height);
+
+      if (y1 <= y0)
+         y1 = y0 + 1;
+
+      for (x = 0; x < width; x++)
+      {
+         unsigned sx, sy;
+         uint32_t sum[4] = {0};
+         unsigned x0     = (unsigned)((uint64_t)x * ti->width / width);
+         unsigned x1     = (unsigned)((uint64_t)(x + 1) * ti->width / width);
+         unsigned count;
+
+         if (x1 <= x0)
+            x1 = x0 + 1;
+
+         count = (x1 - x0) * (y1 - y0);
+
+         for (sy = y0; sy < y1; sy++)
+         {
+            const uint32_t *row = src + sy * ti->width;
+
+            for (sx = x0; sx < x1; sx++)
+            {
+               uint32_t col = row[sx];
+               sum[0]      += (col >>  0) & 0xff;
+               sum[1]      += (col >>  8) & 0xff;
+               sum[2]      += (col >> 16) & 0xff;
+               sum[3]      += (col >> 24) & 0xff;
+            }
+         }
+
+         dst[y * width + x] =
+               ((sum[0] / count) <<  0)
+            |  ((sum[1] / count) <<  8)
+            |  ((sum[2] / count) << 16)
+            |  ((sum[3] / count) << 24);
+      }
+   }
+
+   free(ti->pixels);
+   ti->pixels = dst;
+   ti->width  = width;
+   ti->height = height;
+}
+
 static int cb_image_menu_upload_generic(void *data, size_t len)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
@@ -72,6 +163,11 @@ static int cb_image_menu_upload_generic(void *data, size_t len)
          break;
    }
 
+   /* Scale down before anything else touches the pixels. */
+   if (image->max_width || image->max_height)
+      task_image_downscale(&image->ti,
+            image->max_width, image->max_height);
+
    image_texture_set_color_shifts(&r_shift, &g_shift, &b_shift,
          &a_shift, &image->ti);
 
@@ -287,6 +383,13 @@ bool task_image_load_handler(retro_task_t *task)
 }
 
 bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_scaled(fullpath, 0, 0, cb, user_data) != NULL;
+}
+
+void *task_push_image_load_scaled(const char *fullpath,
+      unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
    struct nbio_image_handle   *image = NULL;
@@ -327,6 +430,8 @@ bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *
    image->processing_pos_increment   = 0;
    image->pos_increment              = 0;
    image->size                       = 0;
+   image->max_width                  = max_width;
+   image->max_height                 = max_height;
    image->handle                     = NULL;
 
    image->ti.width                   = 0;
@@ -360,13 +465,14 @@ bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *
 
    t->state           = nbio;
    t->handler         = task_file_load_handler;
+   t->priority        = TASK_PRIORITY_INTERACTIVE;
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
 
    task_queue_push(t);
 
-   return true;
+   return t;
 
 error:
    task_image_load_free(t);
@@ -382,5 +488,5 @@ error_msg:
    RARCH_ERR("[image load] Failed to open '%s': %s.\n",
          fullpath, strerror(errno));
 
-   return false;
+   return NULL;
 }
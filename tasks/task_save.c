@@ -706,6 +706,7 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -1076,6 +1077,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type              = TASK_TYPE_BLOCKING;
+   task->priority          = TASK_PRIORITY_INTERACTIVE;
    task->state             = state;
    task->handler           = task_save_handler;
    task->callback          = save_state_cb;
@@ -1150,6 +1152,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state       = state;
    task->type        = TASK_TYPE_BLOCKING;
+   task->priority    = TASK_PRIORITY_INTERACTIVE;
    task->handler     = task_load_handler;
    task->callback    = content_load_and_save_state_cb;
    task->title       = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1290,6 +1293,7 @@ bool content_load_state(const char *path,
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_INTERACTIVE;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
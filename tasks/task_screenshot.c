@@ -256,6 +256,7 @@ static bool screenshot_dump(
 #endif
 
    task->type        = TASK_TYPE_BLOCKING;
+   task->priority    = TASK_PRIORITY_INTERACTIVE;
    task->state       = state;
    task->handler     = task_screenshot_handler;
 
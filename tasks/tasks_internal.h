@@ -124,6 +124,13 @@ bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port);
 bool task_push_image_load(const char *fullpath,
       retro_task_callback_t cb, void *userdata);
 
+/* Like task_push_image_load, but the decoded image is scaled down
+ * to fit into max_width x max_height (0 for no limit) on the task.
+ * Returns the task, or NULL on failure. */
+void *task_push_image_load_scaled(const char *fullpath,
+      unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *userdata);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,